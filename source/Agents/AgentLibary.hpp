@@ -8,8 +8,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <map>
-#include <queue>
 #include <regex>
 #include <sstream>
 #include <tuple>
@@ -21,119 +25,235 @@
 namespace walle {
 
     /**
-     * @brief Node class to hold information about positions for A* search
+     * @brief Reusable scratch memory for A* searches
+     *
+     * Every per-cell array is flat (indexed by y * width + x) and sized to the largest grid
+     * searched so far.  Rather than clearing the arrays between searches, each cell records
+     * the generation in which it was last touched; entries from older searches are simply
+     * treated as unvisited.  Reusing a workspace therefore makes a search allocation-free.
+     *
+     * The open list is a binary heap that tracks where each cell sits within it, so a cheaper
+     * route to an open cell updates it in place instead of pushing a duplicate.
      */
-    struct Node {
-        cse491::GridPosition position; ///< Where node is located
-        double g;                      ///< Cost from start to current node
-        double h; ///< Heuristic (estimated cost from current node to goal)
-        std::shared_ptr<Node>
-            parent; ///< How we got to this node (Used to construct final path)
+    class PathWorkspace {
+    public:
+        static constexpr size_t NO_CELL = static_cast<size_t>(-1); ///< Marks a missing cell index
+
+    private:
+        /// Heap entries carry their own costs so comparisons stay inside the heap array.
+        struct HeapEntry {
+            double f;    ///< Total estimated cost through this cell
+            double g;    ///< Cost from start to this cell
+            size_t cell; ///< Index of the cell
+        };
+
+        std::vector<double> g_cost;   ///< Cost from start to each cell
+        std::vector<size_t> parent;   ///< Cell each cell was reached from (used to build path)
+        std::vector<size_t> heap_pos; ///< Position of each cell in the heap, or NO_CELL if closed
+        std::vector<uint32_t> stamp;  ///< Generation in which each cell was last touched
+        std::vector<HeapEntry> heap;  ///< Open list
+        uint32_t generation = 0;      ///< ID of the current search
+
+        /// Should heap entry a be explored before heap entry b?
+        /// Ties on total cost go to the entry closest to the goal (largest g).
+        [[nodiscard]] static bool IsBetter(const HeapEntry &a, const HeapEntry &b) {
+            return a.f < b.f || (a.f == b.f && a.g > b.g);
+        }
+
+        /// Place an entry in the heap, recording where it ended up.
+        void Place(size_t pos, const HeapEntry &entry) {
+            heap[pos] = entry;
+            heap_pos[entry.cell] = pos;
+        }
+
+        void SiftUp(size_t pos) {
+            const HeapEntry entry = heap[pos];
+            while (pos > 0) {
+                const size_t parent_pos = (pos - 1) / 2;
+                if (!IsBetter(entry, heap[parent_pos])) break;
+                Place(pos, heap[parent_pos]);
+                pos = parent_pos;
+            }
+            Place(pos, entry);
+        }
+
+        void SiftDown(size_t pos) {
+            const HeapEntry entry = heap[pos];
+            const size_t size = heap.size();
+            while (true) {
+                size_t child = 2 * pos + 1;
+                if (child >= size) break;
+                if (child + 1 < size && IsBetter(heap[child + 1], heap[child])) ++child;
+                if (!IsBetter(heap[child], entry)) break;
+                Place(pos, heap[child]);
+                pos = child;
+            }
+            Place(pos, entry);
+        }
 
+    public:
         /**
-         * Constructor for a node
-         * @param position location on grid of this node
-         * @param g actual distance to get from start to this node
-         * @param h heuristic guess for distance from this node to end location
-         * @param parent Used to construct path back at end
+         * @brief Prepare for a new search
+         * @param num_cells Number of cells in the grid about to be searched
          */
-        Node(const cse491::GridPosition &position, double g, double h,
-            std::shared_ptr<Node> parent)
-            : position(position), g(g), h(h), parent(std::move(parent)) {}
+        void Begin(size_t num_cells) {
+            if (stamp.size() < num_cells) {
+                g_cost.resize(num_cells);
+                parent.resize(num_cells);
+                heap_pos.resize(num_cells);
+                stamp.resize(num_cells, 0);
+            }
+            heap.clear();
+            if (++generation == 0) { // Stamps wrapped around; old ones could look current.
+                std::fill(stamp.begin(), stamp.end(), 0);
+                generation = 1;
+            }
+        }
+
+        /// @return Number of cells this workspace can currently search without growing
+        [[nodiscard]] size_t GetCapacity() const { return stamp.size(); }
+
+        /// @return Has this cell been reached during the current search?
+        [[nodiscard]] bool IsVisited(size_t cell) const { return stamp[cell] == generation; }
+
+        /// @return Has this cell already been expanded (its cost is final)?
+        [[nodiscard]] bool IsClosed(size_t cell) const {
+            return IsVisited(cell) && heap_pos[cell] == NO_CELL;
+        }
+
+        /// @return Best known cost from the start to this cell
+        [[nodiscard]] double GetCost(size_t cell) const {
+            return IsVisited(cell) ? g_cost[cell] : std::numeric_limits<double>::infinity();
+        }
+
+        /// @return The cell this cell was reached from, or NO_CELL for the start
+        [[nodiscard]] size_t GetParent(size_t cell) const { return parent[cell]; }
+
+        [[nodiscard]] bool HasOpen() const { return !heap.empty(); }
 
         /**
-         * @brief Calculate the total cost (f) of the node
-         * @return sum of actual distance and heuristic distance
+         * @brief Record a (better) route to a cell and make sure it is in the open list
+         * @param cell Index of the cell reached
+         * @param g Cost from the start to this cell
+         * @param h Heuristic estimate from this cell to the goal
+         * @param from Index of the cell we came from, or NO_CELL for the start
          */
-        [[nodiscard]] double f() const { return g + h; }
-    };
+        void Open(size_t cell, double g, double h, size_t from) {
+            const bool in_heap = IsVisited(cell) && heap_pos[cell] != NO_CELL;
+            stamp[cell] = generation;
+            g_cost[cell] = g;
+            parent[cell] = from;
+            if (in_heap) {
+                // Lower cost for a cell already in the heap; it can only move up.
+                heap[heap_pos[cell]].f = g + h;
+                heap[heap_pos[cell]].g = g;
+                SiftUp(heap_pos[cell]);
+            } else {
+                heap.push_back(HeapEntry{g + h, g, cell});
+                SiftUp(heap.size() - 1);
+            }
+        }
 
-    /**
-     * @brief Custom comparison function for priority queue
-     * @return if a has a greater total cost than b
-     */
-    struct CompareNodes {
-        bool operator()(const std::shared_ptr<walle::Node> &a,
-                        const std::shared_ptr<walle::Node> &b) const {
-            return a->f() > b->f();
+        /// @brief Remove the most promising cell from the open list and mark it closed.
+        /// @return Index of that cell
+        size_t PopBest() {
+            assert(!heap.empty());
+            const size_t best = heap.front().cell;
+            heap_pos[best] = NO_CELL;
+            const HeapEntry last = heap.back();
+            heap.pop_back();
+            if (!heap.empty()) {
+                heap[0] = last;
+                SiftDown(0);
+            }
+            return best;
         }
     };
 
+    /// @brief Workspace shared by all searches on the calling thread.
+    inline PathWorkspace &GetThreadPathWorkspace() {
+        thread_local PathWorkspace workspace;
+        return workspace;
+    }
+
     /// @brief Uses A* to return a  list of grid positions
     /// @author @mdkdoc15
     /// @param start Starting position for search
     /// @param end Ending position for the search
-    /// @return vector of A* path from start to end, empty vector if no path exists
+    /// @param world World the search takes place in
+    /// @param agent Agent that would be following this path (used for traversability)
+    /// @param workspace Scratch memory to reuse for the search
+    /// @return vector of A* path from end back to start (inclusive), empty vector if no path exists
     inline std::vector<cse491::GridPosition>
     GetShortestPath(const cse491::GridPosition &start,
                     const cse491::GridPosition &end, const cse491::WorldBase &world,
-                    const cse491::AgentBase &agent) {
-    // Generated with the help of chat.openai.com
-    const size_t rows = world.GetGrid().GetWidth();
-    const size_t cols = world.GetGrid().GetHeight();
-    std::vector<cse491::GridPosition> path;
-    // If the start or end is not valid then return empty list
-    if (!(world.GetGrid().IsValid(start) && world.GetGrid().IsValid(end)))
-        return path;
-
-    // Define possible movements (up, down, left, right)
-    const int dx[] = {-1, 1, 0, 0};
-    const int dy[] = {0, 0, -1, 1};
-
-    // Create a 2D vector to store the cost to reach each cell
-    std::vector<std::vector<double>> cost(rows,
-                                            std::vector<double>(cols, INT_MAX));
-
-    // Create an open list as a priority queue
-    std::priority_queue<std::shared_ptr<walle::Node>,
-                        std::vector<std::shared_ptr<walle::Node>>,
-                        walle::CompareNodes>
-        openList;
-
-    // Create the start and end nodes
-    auto startNode = std::make_shared<walle::Node>(start, 0, 0, nullptr);
-    auto endNode = std::make_shared<walle::Node>(end, 0, 0, nullptr);
-
-    openList.push(startNode);
-    cost[start.CellX()][start.CellY()] = 0;
-
-    while (!openList.empty()) {
-        auto current = openList.top();
-        openList.pop();
-
-        if (current->position == endNode->position) {
-
-        // Reached the goal, reconstruct the path
-        while (current != nullptr) {
-            path.push_back(current->position);
-            current = current->parent;
-        }
-        break;
-        }
-
-        // Explore the neighbors
-        for (int i = 0; i < 4; ++i) {
-            cse491::GridPosition newPos(current->position.GetX() + dx[i],
-                                        current->position.GetY() + dy[i]);
-            // Check if the neighbor is within bounds and is a valid move
-            if (world.GetGrid().IsValid(newPos) &&
-                world.IsTraversable(agent, newPos)) {
-                double newG =
-                    current->g + 1; // Assuming a cost of 1 to move to a neighbor
-                double newH = std::abs(newPos.GetX() - endNode->position.GetX()) +
-                    std::abs(newPos.GetY() -
-                        endNode->position.GetY()); // Manhattan distance
-
-                if (newG + newH < cost[newPos.CellX()][newPos.CellY()]) {
-                    auto neighbor =
-                        std::make_shared<walle::Node>(newPos, newG, newH, current);
-                    openList.push(neighbor);
-                    cost[newPos.CellX()][newPos.CellY()] = newG + newH;
+                    const cse491::AgentBase &agent, PathWorkspace &workspace) {
+        const cse491::WorldGrid &grid = world.GetGrid();
+        const size_t width = grid.GetWidth();
+        std::vector<cse491::GridPosition> path;
+        // If the start or end is not valid then return empty list
+        if (!(grid.IsValid(start) && grid.IsValid(end)))
+            return path;
+
+        // Define possible movements (up, down, left, right)
+        const int dx[] = {-1, 1, 0, 0};
+        const int dy[] = {0, 0, -1, 1};
+
+        const size_t end_x = end.CellX();
+        const size_t end_y = end.CellY();
+        const size_t start_cell = start.CellY() * width + start.CellX();
+        const size_t end_cell = end_y * width + end_x;
+
+        workspace.Begin(grid.GetNumCells());
+        workspace.Open(start_cell, 0.0, 0.0, PathWorkspace::NO_CELL);
+
+        while (workspace.HasOpen()) {
+            const size_t current = workspace.PopBest();
+
+            if (current == end_cell) {
+                // Reached the goal, reconstruct the path
+                for (size_t cell = current; cell != PathWorkspace::NO_CELL;
+                     cell = workspace.GetParent(cell)) {
+                    path.emplace_back(static_cast<double>(cell % width),
+                                      static_cast<double>(cell / width));
                 }
+                break;
+            }
+
+            const double x = static_cast<double>(current % width);
+            const double y = static_cast<double>(current / width);
+            const double new_g = workspace.GetCost(current) + 1; // Assuming a cost of 1 to move
+
+            // Explore the neighbors
+            for (int i = 0; i < 4; ++i) {
+                const cse491::GridPosition new_pos(x + dx[i], y + dy[i]);
+                // Check if the neighbor is within bounds and is a valid move
+                if (!grid.IsValid(new_pos)) continue;
+                const size_t neighbor = new_pos.CellY() * width + new_pos.CellX();
+                if (workspace.IsClosed(neighbor) || new_g >= workspace.GetCost(neighbor)) continue;
+                if (!world.IsTraversable(agent, new_pos)) continue;
+
+                const double new_h = std::abs(new_pos.GetX() - static_cast<double>(end_x)) +
+                    std::abs(new_pos.GetY() - static_cast<double>(end_y)); // Manhattan distance
+                workspace.Open(neighbor, new_g, new_h, current);
             }
         }
+        return path;
     }
-    return path;
+
+    /// @brief Uses A* to return a  list of grid positions
+    /// @author @mdkdoc15
+    /// @param start Starting position for search
+    /// @param end Ending position for the search
+    /// @param world World the search takes place in
+    /// @param agent Agent that would be following this path (used for traversability)
+    /// @return vector of A* path from end back to start (inclusive), empty vector if no path exists
+    /// @note Uses the calling thread's shared workspace; see GetThreadPathWorkspace().
+    inline std::vector<cse491::GridPosition>
+    GetShortestPath(const cse491::GridPosition &start,
+                    const cse491::GridPosition &end, const cse491::WorldBase &world,
+                    const cse491::AgentBase &agent) {
+        return GetShortestPath(start, end, world, agent, GetThreadPathWorkspace());
     }
 
     /**
@@ -35,7 +35,7 @@ namespace cowboys {
     CGPGenotype genotype;
 
     /// The decision graph for this agent.
-    std::unique_ptr<Graph> decision_graph;
+    std::unique_ptr<CompiledGraph> decision_graph;
 
 
 
@@ -54,7 +54,7 @@ namespace cowboys {
 
       genotype.MutateDefault(mutation, *this);
 
-      decision_graph = graph_builder.CartesianGraph(genotype, FUNCTION_SET, this);
+      decision_graph = graph_builder.CompiledCartesianGraph(genotype, FUNCTION_SET, this);
     }
     /// @brief Setup graph.
     /// @return Success.
@@ -106,7 +106,7 @@ namespace cowboys {
     /// @param other The CGPAgent to copy.
     void Configure(const CGPAgent &other) {
       genotype = other.GetGenotype();
-      decision_graph = GraphBuilder().CartesianGraph(genotype, FUNCTION_SET, this);
+      decision_graph = GraphBuilder().CompiledCartesianGraph(genotype, FUNCTION_SET, this);
     }
 
     /// @brief Copy the behavior of another agent into this agent.
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <array>
+#include <bit>
 #include <bitset>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <random>
@@ -25,6 +28,14 @@ namespace cowboys {
   constexpr char NODE_GENE_SEP = '.';
   /// The separator between each node in the genotype.
   constexpr char NODE_SEP = ':';
+  /// Identifies the start of a binary genotype (see CGPGenotype::SaveBinary).
+  constexpr char BINARY_MAGIC[4] = {'C', 'G', 'P', 'B'};
+  /// The version of the binary genotype format.
+  constexpr uint8_t BINARY_VERSION = 1;
+  /// The most functional nodes a binary genotype may have; larger counts are treated as corrupt.
+  constexpr size_t MAX_BINARY_NODES = size_t(1) << 24;
+  /// The most connection words a binary genotype may need; larger counts are treated as corrupt.
+  constexpr size_t MAX_BINARY_CONNECTION_WORDS = size_t(1) << 26;
 
   /// @brief A namespace for base64 encoding and decoding. Does not convert to and from base64 in the typical way. Only
   /// guarantees that x == b64_inv(b64(x)), aside from doubles which have problems with precision,
@@ -169,11 +180,89 @@ namespace cowboys {
     }
   } // namespace base64
 
-  /// @brief Holds the representation of a cartesian graph node.
-  struct CGPNodeGene {
-    /// The input connections of this node. '1' means connected, '0' means not connected.
-    std::vector<char> input_connections{};
+  /// The type of word that input connections are packed into.
+  using connection_word_t = uint64_t;
+  /// The number of input connections packed into each word.
+  constexpr size_t CONNECTION_WORD_BITS = 64;
+
+  /// @brief Returns the number of words needed to hold a number of input connections.
+  /// @param num_connections The number of input connections.
+  /// @return The number of words needed.
+  constexpr size_t NumConnectionWords(size_t num_connections) {
+    return (num_connections + CONNECTION_WORD_BITS - 1) / CONNECTION_WORD_BITS;
+  }
+
+  /// @brief Returns a mask of the bits of a word that hold input connections.
+  /// @param num_connections The number of input connections packed into the words.
+  /// @param word_idx The index of the word.
+  /// @return The mask of valid bits in the word.
+  constexpr connection_word_t ConnectionWordMask(size_t num_connections, size_t word_idx) {
+    size_t num_bits = num_connections - word_idx * CONNECTION_WORD_BITS;
+    return num_bits >= CONNECTION_WORD_BITS ? ~connection_word_t{0} : (connection_word_t{1} << num_bits) - 1;
+  }
+
+  /// @brief A read-only view of the input connections of a node. Connection i is bit i % 64 of word i / 64, and a set
+  /// bit means connected. Bits past the last connection are always 0.
+  class ConnectionBits {
+  private:
+    /// The packed connections.
+    const connection_word_t *words{nullptr};
+    /// The number of connections.
+    size_t num_connections{0};
+
+  public:
+    ConnectionBits(const connection_word_t *words, size_t num_connections)
+        : words(words), num_connections(num_connections) {}
+
+    /// @brief Returns the number of possible connections.
+    size_t size() const { return num_connections; }
+
+    /// @brief Returns the number of words the connections are packed into.
+    size_t GetNumWords() const { return NumConnectionWords(num_connections); }
 
+    /// @brief Returns a word of packed connections.
+    connection_word_t GetWord(size_t word_idx) const {
+      assert(word_idx < GetNumWords());
+      return words[word_idx];
+    }
+
+    /// @brief Returns whether a connection is connected.
+    bool operator[](size_t idx) const {
+      assert(idx < num_connections);
+      return (words[idx / CONNECTION_WORD_BITS] >> (idx % CONNECTION_WORD_BITS)) & 1;
+    }
+
+    /// @brief Returns the number of connected connections.
+    size_t Count() const {
+      size_t count = 0;
+      for (size_t i = 0; i < GetNumWords(); ++i)
+        count += std::popcount(words[i]);
+      return count;
+    }
+
+    /// @brief Returns whether any connection is connected.
+    bool Any() const { return std::any_of(words, words + GetNumWords(), [](connection_word_t w) { return w != 0; }); }
+
+    /// @brief Calls a function with the index of each connected connection, in increasing order.
+    /// @param fun The function to call.
+    template <typename FUN_T> void ForEachConnected(FUN_T &&fun) const {
+      for (size_t i = 0; i < GetNumWords(); ++i) {
+        for (connection_word_t word = words[i]; word != 0; word &= word - 1)
+          fun(i * CONNECTION_WORD_BITS + std::countr_zero(word));
+      }
+    }
+
+    /// @brief Returns the connections as a string, '1' for connected and '0' for not connected.
+    std::string ToString() const {
+      std::string result(num_connections, '0');
+      ForEachConnected([&result](size_t idx) { result[idx] = '1'; });
+      return result;
+    }
+  };
+
+  /// @brief Holds the representation of a cartesian graph node. Input connections are packed separately, see
+  /// CGPGenotype::GetConnections().
+  struct CGPNodeGene {
     /// The index of the function the node uses.
     size_t function_idx{0};
 
@@ -184,8 +273,7 @@ namespace cowboys {
     /// @param other The other CGPNodeGene to compare to.
     /// @return True if the two CGPNodeGenes are equal, false otherwise.
     inline bool operator==(const CGPNodeGene &other) const {
-      return input_connections == other.input_connections && function_idx == other.function_idx &&
-             default_output == other.default_output;
+      return function_idx == other.function_idx && default_output == other.default_output;
     }
   };
 
@@ -214,6 +302,31 @@ namespace cowboys {
     /// @return The number of functional nodes in the graph.
     size_t GetFunctionalNodeCount() const { return num_layers * num_nodes_per_layer + num_outputs; }
 
+    /// @brief Returns the number of possible input connections for each node in a layer.
+    /// @param layer The layer, where 0 is the input layer and num_layers + 1 is the output layer.
+    /// @return The number of possible input connections for each node in the layer.
+    size_t GetNumLayerConnections(size_t layer) const {
+      if (layer == 0)
+        return 0;
+      // Count up possible input connections from each layer backwards
+      size_t valid_layers_back = std::min(layers_back, layer);
+      size_t num_input_connections = valid_layers_back * num_nodes_per_layer;
+      if (layer <= layers_back) {
+        num_input_connections -= num_nodes_per_layer;
+        num_input_connections += num_inputs;
+      }
+      return num_input_connections;
+    }
+
+    /// @brief Returns the most possible input connections of any node in the graph.
+    /// @return The most possible input connections of any node in the graph.
+    size_t GetMaxLayerConnections() const {
+      size_t max_connections = 0;
+      for (size_t i = 1; i <= num_layers + 1; ++i)
+        max_connections = std::max(max_connections, GetNumLayerConnections(i));
+      return max_connections;
+    }
+
     /// @brief Check if two CGPParameters are equal.
     /// @param other The other CGPParameters to compare to.
     /// @return True if the two CGPParameters are equal, false otherwise.
@@ -232,10 +345,62 @@ namespace cowboys {
     /// The node configurations.
     std::vector<CGPNodeGene> nodes;
 
+    /// The input connections of every node, packed into words_per_node words each.
+    std::vector<connection_word_t> connections;
+
+    /// The number of words of connections for each node, enough for the node with the most connections.
+    size_t words_per_node{0};
+
     /// The random number generator.
     std::mt19937 rng;
 
   private:
+    /// @brief Writes an unsigned integer as 8 little-endian bytes.
+    static void WriteU64(std::ostream &os, uint64_t value) {
+      char bytes[8];
+      for (size_t i = 0; i < 8; ++i)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+      os.write(bytes, 8);
+    }
+
+    /// @brief Reads an unsigned integer written by WriteU64.
+    static uint64_t ReadU64(std::istream &is) {
+      unsigned char bytes[8];
+      if (!is.read(reinterpret_cast<char *>(bytes), 8))
+        throw std::runtime_error("Invalid binary genotype: Unexpected end of data.");
+      uint64_t value = 0;
+      for (size_t i = 0; i < 8; ++i)
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+      return value;
+    }
+
+    /// @brief Returns the layer of a functional node, where 1 is the first middle layer.
+    size_t GetNodeLayer(size_t node_idx) const {
+      size_t num_middle_nodes = params.num_layers * params.num_nodes_per_layer;
+      return node_idx < num_middle_nodes ? node_idx / params.num_nodes_per_layer + 1 : params.num_layers + 1;
+    }
+
+    /// @brief Returns the packed connections of a node.
+    connection_word_t *GetConnectionWords(size_t node_idx) {
+      assert(node_idx < nodes.size());
+      return connections.data() + node_idx * words_per_node;
+    }
+
+    /// @brief Replaces all connections with unpacked ones, resizing the packed words to fit the current parameters.
+    /// @param node_connections The connections of each node as strings of '0's and '1's.
+    void PackConnections(const std::vector<std::string> &node_connections) {
+      assert(node_connections.size() == nodes.size());
+      words_per_node = NumConnectionWords(params.GetMaxLayerConnections());
+      connections.assign(nodes.size() * words_per_node, 0);
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        assert(node_connections[i].size() == GetNumNodeConnections(i));
+        for (size_t j = 0; j < node_connections[i].size(); ++j) {
+          if (node_connections[i][j] != '0')
+            SetConnection(i, j);
+        }
+      }
+    }
+
     /// @brief Encodes the header into a string.
     /// @return The encoded header.
 
@@ -284,9 +449,10 @@ namespace cowboys {
     /// @return The encoded genotype.
     std::string EncodeGenotype() const {
       std::string genotype = "";
-      for (const CGPNodeGene &node : nodes) {
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        const CGPNodeGene &node = nodes[i];
         // Input Connections
-        genotype += base64::B2ToB64(std::string(node.input_connections.cbegin(), node.input_connections.cend()));
+        genotype += base64::B2ToB64(GetConnections(i).ToString());
         genotype += NODE_GENE_SEP;
         // Function index
         genotype += base64::ULLToB64(node.function_idx);
@@ -303,9 +469,10 @@ namespace cowboys {
     /// @return The encoded genotype.
     std::string EncodeGenotypeRaw() const {
       std::string genotype = "";
-      for (const CGPNodeGene &node : nodes) {
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        const CGPNodeGene &node = nodes[i];
         // Input Connections
-        genotype += std::string(node.input_connections.cbegin(), node.input_connections.cend());
+        genotype += GetConnections(i).ToString();
         genotype += NODE_GENE_SEP;
         // Function index
         genotype += std::to_string(node.function_idx);
@@ -337,15 +504,13 @@ namespace cowboys {
         assert(sep_pos != std::string::npos);
         std::string input_connections_b64 = node_gene.substr(0, sep_pos);
         std::string input_connections_b2 = base64::B64ToB2(input_connections_b64);
-        auto &input_connections = current_node.input_connections;
+        size_t num_connections = GetNumNodeConnections(node_idx);
         // If there were leading bits that were 0 when converted to base 64, they were dropped. Add them back.
-        std::string input_connections_str = std::string(input_connections.cbegin(), input_connections.cend());
-        assert(input_connections.size() >= input_connections_b2.size()); // Invalid genotype if this fails
-        input_connections_b2 =
-            std::string(input_connections.size() - input_connections_b2.size(), '0') + input_connections_b2;
-        assert(input_connections.size() == input_connections_b2.size());
+        assert(num_connections >= input_connections_b2.size()); // Invalid genotype if this fails
+        input_connections_b2 = std::string(num_connections - input_connections_b2.size(), '0') + input_connections_b2;
+        assert(num_connections == input_connections_b2.size());
         for (size_t i = 0; i < input_connections_b2.size(); ++i) {
-          input_connections[i] = input_connections_b2[i];
+          SetConnection(node_idx, i, input_connections_b2[i] != '0');
         }
         node_gene = node_gene.substr(sep_pos + 1);
 
@@ -382,14 +547,21 @@ namespace cowboys {
 
     // Rule of 5
     ~CGPGenotype() = default;
-    /// @brief Copy constructor for the cartesian graph genotype.
+    /// @brief Copy constructor for the cartesian graph genotype. As with moves, the random number generator is not
+    /// copied.
     /// @param other The other cartesian graph genotype to copy from.
-    CGPGenotype(const CGPGenotype &other) { Configure(other.Export()); }
-    /// @brief Copy assignment operator for the cartesian graph genotype.
+    CGPGenotype(const CGPGenotype &other)
+        : params(other.params), nodes(other.nodes), connections(other.connections),
+          words_per_node(other.words_per_node) {}
+    /// @brief Copy assignment operator for the cartesian graph genotype. As with moves, the random number generator is
+    /// not copied.
     /// @param other The other cartesian graph genotype to copy from.
     /// @return This cartesian graph genotype.
     CGPGenotype &operator=(const CGPGenotype &other) {
-      Configure(other.Export());
+      params = other.params;
+      nodes = other.nodes;
+      connections = other.connections;
+      words_per_node = other.words_per_node;
       return *this;
     }
     /// @brief Move constructor for the cartesian graph genotype.
@@ -397,6 +569,8 @@ namespace cowboys {
     CGPGenotype(CGPGenotype &&other) noexcept {
       params = other.params;
       nodes = std::move(other.nodes);
+      connections = std::move(other.connections);
+      words_per_node = other.words_per_node;
     }
     /// @brief Move assignment operator for the cartesian graph genotype.
     /// @param other The other cartesian graph genotype to move from.
@@ -404,6 +578,8 @@ namespace cowboys {
     CGPGenotype &operator=(CGPGenotype &&other) noexcept {
       params = other.params;
       nodes = std::move(other.nodes);
+      connections = std::move(other.connections);
+      words_per_node = other.words_per_node;
       return *this;
     }
 
@@ -461,8 +637,8 @@ namespace cowboys {
     /// @return The number of possible connections in the graph.
     size_t GetNumPossibleConnections() const {
       size_t num_connections = 0;
-      for (const CGPNodeGene &node : nodes) {
-        num_connections += node.input_connections.size();
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        num_connections += GetNumNodeConnections(i);
       }
       return num_connections;
     }
@@ -471,15 +647,50 @@ namespace cowboys {
     /// @return The number of connected connections in the graph.
     size_t GetNumConnections() const {
       size_t num_connections = 0;
-      for (const CGPNodeGene &node : nodes) {
-        for (char con : node.input_connections) {
-          if (con == '1')
-            ++num_connections;
-        }
+      for (connection_word_t word : connections) {
+        num_connections += std::popcount(word);
       }
       return num_connections;
     }
 
+    /// @brief Returns the number of possible input connections of a functional node.
+    /// @param node_idx The index of the functional node.
+    /// @return The number of possible input connections of the node.
+    size_t GetNumNodeConnections(size_t node_idx) const {
+      assert(node_idx < nodes.size());
+      return params.GetNumLayerConnections(GetNodeLayer(node_idx));
+    }
+
+    /// @brief Returns the input connections of a functional node. Connections are to the nodes just before the node's
+    /// layer, in order, so the last connection is to the last node of the previous layer.
+    /// @param node_idx The index of the functional node.
+    /// @return A view of the node's input connections.
+    ConnectionBits GetConnections(size_t node_idx) const {
+      assert(node_idx < nodes.size());
+      return {connections.data() + node_idx * words_per_node, GetNumNodeConnections(node_idx)};
+    }
+
+    /// @brief Connects or disconnects one input connection of a functional node.
+    /// @param node_idx The index of the functional node.
+    /// @param connection_idx The index of the input connection.
+    /// @param connected Whether the input should be connected.
+    void SetConnection(size_t node_idx, size_t connection_idx, bool connected = true) {
+      assert(connection_idx < GetNumNodeConnections(node_idx));
+      connection_word_t &word = GetConnectionWords(node_idx)[connection_idx / CONNECTION_WORD_BITS];
+      connection_word_t bit = connection_word_t{1} << (connection_idx % CONNECTION_WORD_BITS);
+      word = connected ? word | bit : word & ~bit;
+    }
+
+    /// @brief Connects or disconnects every input connection of a functional node.
+    /// @param node_idx The index of the functional node.
+    /// @param connected Whether the inputs should be connected.
+    void SetConnections(size_t node_idx, bool connected) {
+      size_t num_connections = GetNumNodeConnections(node_idx);
+      connection_word_t *words = GetConnectionWords(node_idx);
+      for (size_t i = 0; i < NumConnectionWords(num_connections); ++i)
+        words[i] = connected ? ConnectionWordMask(num_connections, i) : 0;
+    }
+
     /// @brief Set the parameters of the cartesian graph.
     /// @param params The parameters of the cartesian graph. Basically a 5-tuple.
     void SetParameters(const CGPParameters &params) { this->params = params; }
@@ -511,40 +722,16 @@ namespace cowboys {
     /// @brief Identify if the genome has any non-zero input connections in it.
     /// @return Bool value to indicate if any input connections non-zero.
     bool HasInputConnections() const {
-      for (auto it = begin(); it != end(); ++it) {
-        if (std::any_of(
-          it->input_connections.begin(),
-          it->input_connections.end(),
-          [](char c) { return c != '0'; }
-        )) return true;
-      }
-      return false;
+      return std::any_of(connections.cbegin(), connections.cend(), [](connection_word_t w) { return w != 0; });
     }
 
     /// @brief Initializes an empty genotype with the cartesian graph parameters.
     void InitGenotype() {
-      // Clear node configurations
-      nodes.clear();
-
-      // Input nodes won't have any inputs and no function, so they are skipped
-
-      // Start at 1 to account for the input layer
-      for (size_t i = 1; i <= params.num_layers + 1; ++i) {
-        size_t layer_size = i == params.num_layers + 1 ? params.num_outputs : params.num_nodes_per_layer;
-        for (size_t j = 0; j < layer_size; ++j) {
-          // Count up possible input connections from each layer backwards
-          size_t valid_layers_back = std::min(params.layers_back, i);
-          size_t num_input_connections = valid_layers_back * params.num_nodes_per_layer;
-          if (i <= params.layers_back) {
-            num_input_connections -= params.num_nodes_per_layer;
-            num_input_connections += params.num_inputs;
-          }
-          // Create node gene using empty connections
-          std::vector<char> input_connections(num_input_connections, '0');
-          // Add the node configuration. With default values
-          nodes.push_back({input_connections});
-        }
-      }
+      // Input nodes won't have any inputs and no function, so they are skipped. Every other node gets default values
+      // and no connections.
+      nodes.assign(params.GetFunctionalNodeCount(), {});
+      words_per_node = NumConnectionWords(params.GetMaxLayerConnections());
+      connections.assign(nodes.size() * words_per_node, 0);
     }
 
     /// @brief Exports this genotype into a string representation.
@@ -563,6 +750,85 @@ namespace cowboys {
       return header + HEADER_END + genotype;
     }
 
+    /// @brief Writes this genotype to a stream in a compact binary format. Unlike Export(), default outputs are saved
+    /// exactly.
+    /// @param os The output stream to write to.
+    void SaveBinary(std::ostream &os) const {
+      os.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+      os.put(static_cast<char>(BINARY_VERSION));
+      for (size_t param : {params.num_inputs, params.num_outputs, params.num_layers, params.num_nodes_per_layer,
+                           params.layers_back})
+        WriteU64(os, param);
+      WriteU64(os, nodes.size());
+
+      std::vector<char> packed;
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        const CGPNodeGene &node = nodes[i];
+        WriteU64(os, node.function_idx);
+        uint64_t output_bits;
+        std::memcpy(&output_bits, &node.default_output, sizeof(output_bits));
+        WriteU64(os, output_bits);
+        // Connections, 8 per byte
+        auto node_connections = GetConnections(i);
+        packed.resize((node_connections.size() + 7) / 8);
+        for (size_t j = 0; j < packed.size(); ++j)
+          packed[j] = static_cast<char>(node_connections.GetWord(j / 8) >> (8 * (j % 8)));
+        os.write(packed.data(), packed.size());
+      }
+    }
+
+    /// @brief Configures this genotype from the binary format written by SaveBinary().
+    /// @param is The input stream to read from.
+    /// @return This genotype.
+    CGPGenotype &LoadBinary(std::istream &is) {
+      char magic[sizeof(BINARY_MAGIC)];
+      if (!is.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0)
+        throw std::runtime_error("Invalid binary genotype: Missing header.");
+      if (is.get() != BINARY_VERSION)
+        throw std::runtime_error("Invalid binary genotype: Unsupported version.");
+      CGPParameters read_params;
+      read_params.num_inputs = ReadU64(is);
+      read_params.num_outputs = ReadU64(is);
+      read_params.num_layers = ReadU64(is);
+      read_params.num_nodes_per_layer = ReadU64(is);
+      read_params.layers_back = ReadU64(is);
+
+      // Check the size of the graph before allocating it, without letting the arithmetic overflow
+      if (read_params.num_inputs > MAX_BINARY_NODES || read_params.num_outputs > MAX_BINARY_NODES ||
+          read_params.num_layers > MAX_BINARY_NODES || read_params.num_nodes_per_layer > MAX_BINARY_NODES ||
+          (read_params.num_nodes_per_layer != 0 &&
+           read_params.num_layers > (MAX_BINARY_NODES - read_params.num_outputs) / read_params.num_nodes_per_layer))
+        throw std::runtime_error("Invalid binary genotype: Too many nodes.");
+      size_t node_words = NumConnectionWords(read_params.GetMaxLayerConnections());
+      if (node_words != 0 && read_params.GetFunctionalNodeCount() > MAX_BINARY_CONNECTION_WORDS / node_words)
+        throw std::runtime_error("Invalid binary genotype: Too many connections.");
+
+      // Node layout is determined by the parameters
+      params = read_params;
+      InitGenotype();
+      if (ReadU64(is) != nodes.size())
+        throw std::runtime_error("Invalid binary genotype: Node count does not match parameters.");
+
+      std::vector<char> packed;
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        CGPNodeGene &node = nodes[i];
+        node.function_idx = ReadU64(is);
+        uint64_t output_bits = ReadU64(is);
+        std::memcpy(&node.default_output, &output_bits, sizeof(output_bits));
+        size_t num_connections = GetNumNodeConnections(i);
+        packed.resize((num_connections + 7) / 8);
+        if (!is.read(packed.data(), packed.size()))
+          throw std::runtime_error("Invalid binary genotype: Unexpected end of data.");
+        connection_word_t *words = GetConnectionWords(i);
+        for (size_t j = 0; j < packed.size(); ++j)
+          words[j / 8] |= static_cast<connection_word_t>(static_cast<unsigned char>(packed[j])) << (8 * (j % 8));
+        // Ignore any bits past the last connection
+        for (size_t j = 0; j < NumConnectionWords(num_connections); ++j)
+          words[j] &= ConnectionWordMask(num_connections, j);
+      }
+      return *this;
+    }
+
     /// @brief Sets the seed of the random number generator.
     CGPGenotype &SetSeed(size_t seed) {
       rng.seed(seed);
@@ -575,11 +841,20 @@ namespace cowboys {
     /// parameter.
     /// @return This genotype.
     CGPGenotype &Mutate(double mutation_rate, std::function<void(CGPNodeGene &)> mutation) {
+      return MutateNodes(mutation_rate, [this, &mutation](size_t node_idx) { mutation(nodes[node_idx]); });
+    }
+
+    /// @brief Mutates the genotype.
+    /// @param mutation_rate Value between 0 and 1 representing the probability of mutating a value.
+    /// @param mutation The function to use for mutating each chosen node. The function will receive the index of the
+    /// node as a parameter.
+    /// @return This genotype.
+    CGPGenotype &MutateNodes(double mutation_rate, std::function<void(size_t)> mutation) {
       assert(mutation_rate >= 0.0 && mutation_rate <= 1.0);
       std::uniform_real_distribution<double> dist_mutation(0.0, 1.0);
-      for (CGPNodeGene &node : nodes)
+      for (size_t i = 0; i < nodes.size(); ++i)
         if (dist_mutation(rng) < mutation_rate)
-          mutation(node);
+          mutation(i);
       return *this;
     }
 
@@ -589,10 +864,12 @@ namespace cowboys {
     /// @param agent The agent to use for random number generation.
     /// @return This genotype.
     CGPGenotype &MutateConnections(double mutation_rate, GPAgentBase &agent) {
-      std::uniform_int_distribution<size_t> dist(0, 1);
-      Mutate(mutation_rate, [&agent](CGPNodeGene &node) {
-        for (char &con : node.input_connections) {
-          con = agent.GetRandomULL(2) == 0 ? '0' : '1';
+      MutateNodes(mutation_rate, [this, &agent](size_t node_idx) {
+        // Every connection is equally likely to be connected or not, so draw a whole word of them at once
+        size_t num_connections = GetNumNodeConnections(node_idx);
+        connection_word_t *words = GetConnectionWords(node_idx);
+        for (size_t i = 0; i < NumConnectionWords(num_connections); ++i) {
+          words[i] = agent.GetRandomBits() & ConnectionWordMask(num_connections, i);
         }
       });
       return *this;
@@ -642,8 +919,19 @@ namespace cowboys {
       // Can mutate number of inputs and outputs to adapt to changing state and action spaces, but not doing it for
       // now
 
+      bool mutate_layers_back = agent.GetRandom() < mutation_rate;
+      bool mutate_nodes_per_layer = agent.GetRandom() < mutation_rate;
+      if (!mutate_layers_back && !mutate_nodes_per_layer)
+        return *this;
+
+      // Changing the shape of the graph is rare, so work on unpacked connections and pack them again at the end
+      std::vector<std::string> node_connections;
+      node_connections.reserve(nodes.size());
+      for (size_t i = 0; i < nodes.size(); ++i)
+        node_connections.push_back(GetConnections(i).ToString());
+
       // Mutate layers back
-      if (agent.GetRandom() < mutation_rate) {
+      if (mutate_layers_back) {
         // Update params
         params.layers_back += 1;
         // Add empty connections to each node at the front
@@ -653,33 +941,26 @@ namespace cowboys {
           for (size_t j = 0; j < layer_size; ++j) {
 
             // Get the old number of input connections
-            auto &curr_connections = nodes[(i - 1) * params.num_nodes_per_layer + j].input_connections;
+            auto &curr_connections = node_connections[(i - 1) * params.num_nodes_per_layer + j];
             size_t old_num_input_connections = curr_connections.size();
 
             // Get the new number of input connections
-            size_t valid_layers_back = std::min(params.layers_back, i);
-            size_t num_input_connections = valid_layers_back * params.num_nodes_per_layer;
-            if (i <= params.layers_back) {
-              num_input_connections -= params.num_nodes_per_layer;
-              num_input_connections += params.num_inputs;
-            }
+            size_t num_input_connections = params.GetNumLayerConnections(i);
 
-            // Push empty connections to the front of the vector of input connections
+            // Push empty connections to the front of the input connections
             size_t num_needed = num_input_connections - old_num_input_connections;
             if (num_needed > 0) {
-              // Create empty connections
-              std::vector<char> input_connections(num_needed, '0');
-              // Insert the empty connections into the front of the vector
-              curr_connections.insert(curr_connections.cbegin(), input_connections.cbegin(), input_connections.cend());
+              curr_connections.insert(0, num_needed, '0');
             }
           }
         }
       }
 
       // Mutate number of nodes in each layer
-      if (agent.GetRandom() < mutation_rate) {
+      if (mutate_nodes_per_layer) {
         // Add a node to each middle layer and update connections for middle and output layers
         std::vector<CGPNodeGene> new_nodes;
+        std::vector<std::string> new_node_connections;
         for (size_t i = 1; i <= params.num_layers + 1; ++i) {
           // Add the nodes in this layer to the new node vector
           size_t layer_start = (i - 1) * params.num_nodes_per_layer;
@@ -693,13 +974,15 @@ namespace cowboys {
             new_num_connections -= params.num_nodes_per_layer + 1;
             new_num_connections += params.num_inputs;
           }
-          size_t num_needed = new_num_connections - nodes[layer_start].input_connections.size();
+          size_t num_needed = new_num_connections - node_connections[layer_start].size();
           new_nodes.insert(new_nodes.cend(), nodes.cbegin() + layer_start, nodes.cbegin() + layer_end);
+          new_node_connections.insert(new_node_connections.cend(), node_connections.cbegin() + layer_start,
+                                      node_connections.cbegin() + layer_end);
 
           // For middle layers, add a new node
           if (i != params.num_layers + 1) {
-            auto newNode = std::vector<char>(new_num_connections, '0');
-            new_nodes.push_back({newNode});
+            new_nodes.push_back({});
+            new_node_connections.push_back(std::string(new_num_connections, '0'));
           }
 
           // Add the extra connections for each node in this layer
@@ -711,37 +994,25 @@ namespace cowboys {
           for (size_t j = 0; j < layer_size; ++j) {
             // Add an empty connection at the end of each layer of connections in the valid layers back
             assert(new_layer_start + j < new_nodes.size());
-            auto &connections = new_nodes[new_layer_start + j].input_connections;
+            auto &connections = new_node_connections[new_layer_start + j];
             // Only iterate over the valid layers back that are middle layers, not including the input layer
             for (size_t k = 0; k < num_needed; ++k) {
               // Insert in reverse order to keep indices correct
               size_t insert_pos = params.num_nodes_per_layer * (num_needed - k);
-              connections.insert(connections.cbegin() + insert_pos, '0');
-              assert(*(connections.cbegin() + insert_pos) == '0');
+              connections.insert(insert_pos, 1, '0');
+              assert(connections[insert_pos] == '0');
             }
           }
         }
         // Update params
         params.num_nodes_per_layer += 1;
         nodes = std::move(new_nodes);
+        node_connections = std::move(new_node_connections);
         // Check if everything is correct
         assert(nodes.size() == params.GetFunctionalNodeCount());
-        for (size_t i = 1; i < params.num_layers + 1; ++i) {
-          size_t layer_start = (i - 1) * params.num_nodes_per_layer;
-          size_t layer_size = i == params.num_layers + 1 ? params.num_outputs : params.num_nodes_per_layer;
-          size_t valid_layers_back = std::min(params.layers_back, i);
-          for (size_t j = 0; j < layer_size; ++j) {
-            // Check that the number of connections is correct
-            size_t num_connections = valid_layers_back * params.num_nodes_per_layer;
-            if (i <= params.layers_back) {
-              num_connections -= params.num_nodes_per_layer;
-              num_connections += params.num_inputs;
-            }
-            assert(nodes[layer_start + j].input_connections.size() == num_connections);
-          }
-        }
       }
 
+      PackConnections(node_connections);
       return *this;
     }
 
@@ -770,7 +1041,8 @@ namespace cowboys {
       for (auto it = cbegin(), it2 = other.cbegin(); it != cend(); ++it, ++it2) {
         all_same = all_same && (*it == *it2); // Compare CGPNodeGenes for equality
       }
-      return all_same;
+      // Same parameters means the same packing, and unused bits are always 0
+      return all_same && connections == other.connections;
     }
 
     /// @brief Write the genotype representation to an output stream.
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -98,6 +99,9 @@ namespace cowboys {
     /// @brief  Return a uniform random unsigned long long between 0 (inclusive) and max (exclusive)
     size_t GetRandomULL(size_t max) { return static_cast<size_t>(GetRandom(max)); }
 
+    /// @brief  Return 64 uniform random bits
+    uint64_t GetRandomBits() { return (static_cast<uint64_t>(rng()) << 32) | rng(); }
+
     /// @brief  Return a gaussian random value with mean 0.0 and sd 1.0
     double GetRandomNormal() { return norm_dist(rng); }
 
@@ -8,7 +8,10 @@
 
 
 #include "CGPAgent.hpp"
+#include "WorkStealingPool.hpp"
 
+#include <atomic>
+#include <mutex>
 #include <thread>
 #include <iostream>
 #include <vector>
@@ -75,6 +78,31 @@ namespace cowboys {
         std::vector<std::vector<std::vector<cse491::GridPosition>>> endPositions = std::vector<std::vector<std::vector<cse491::GridPosition>>>();
         std::vector<std::vector<std::vector<double>>> independentAgentFitness = std::vector<std::vector<std::vector<double>>>();
 
+        /// Worker threads that run arenas and mutations; kept between generations
+        std::unique_ptr<WorkStealingPool> pool;
+
+        /// Keeps progress output from different threads from interleaving
+        std::mutex printMutex;
+
+        /// Run the agents within each arena on separate threads (see SetIndependentAgents())
+        bool independentAgents = false;
+
+        /// Number of agents run by each task in independent agents mode
+        size_t agentsPerTask = 64;
+
+        /**
+         * @brief Gets the thread pool, starting it if needed
+         * @param maxThreads : Number of threads to use, 0 for one per hardware thread
+         * @return The thread pool
+         */
+        WorkStealingPool &GetPool(size_t maxThreads) {
+          size_t numThreads = maxThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : maxThreads;
+          if (!pool || pool->GetNumThreads() != numThreads) {
+            pool = std::make_unique<WorkStealingPool>(numThreads);
+          }
+          return *pool;
+        }
+
     public:
 
         /**
@@ -105,10 +133,10 @@ namespace cowboys {
          * @brief Initialize the training loop with a number of environments and agents per environment.
          * @param numArenas
          * @param NumAgentsForArena
+         * @param seed : Seed for the environments and agents, 0 for a random seed
          */
-        void Initialize(size_t numArenas = 5, size_t NumAgentsForArena = 100) {
+        void Initialize(size_t numArenas = 5, size_t NumAgentsForArena = 100, unsigned int seed = TRAINING_SEED) {
 
-          unsigned int seed = TRAINING_SEED;
           if (seed == 0) {
             seed = std::random_device()();
           }
@@ -160,6 +188,27 @@ namespace cowboys {
         }
 
 
+        /**
+         * @brief Runs the agents within each arena on separate threads, instead of only running arenas in parallel.
+         *        Each task moves its own agents through every turn against the shared grid, so this gives the same
+         *        fitness as running whole arenas, but keeps all threads busy when there are few arenas.
+         * @note Only valid when agents never affect each other or the world (as in MazeWorld): the world's
+         *       UpdateWorld() is not called, and agents cannot find each other by position while running.
+         * @param independent : Whether to run agents independently
+         * @param numAgentsPerTask : Number of agents run by each task
+         */
+        void SetIndependentAgents(bool independent, size_t numAgentsPerTask = 64) {
+          assert(numAgentsPerTask > 0);
+          independentAgents = independent;
+          agentsPerTask = numAgentsPerTask;
+        }
+
+        /**
+         * @brief Gets the fitness of every agent from the last run of the arenas
+         * @return Fitness for each arena and agent
+         */
+        const std::vector<std::vector<double>> &GetAgentFitness() const { return TEMPAgentFitness; }
+
         /**
          * Simple and temporary fitness function
          * @param agent
@@ -224,54 +273,67 @@ namespace cowboys {
         }
 
         /**
-         *
-         * @param maxThreads
+         * @brief Runs every arena as a task on the thread pool, so that threads which finish an arena early move on
+         *        to the next one instead of waiting on a slow arena.
+         * @param maxThreads : Number of threads to use, 0 for one per hardware thread
          * @param numberOfTurns
          */
         void ThreadTrainLoop(size_t maxThreads = 1, int numberOfTurns = 100) {
-          std::vector<std::thread> threads;
+          WorkStealingPool &threadPool = GetPool(maxThreads);
 
-          size_t threadsComplete = 0;
-
-
-          for (size_t arena = 0; arena < environments.size(); ++arena) {
-            if (maxThreads == 0 || threads.size() < maxThreads) {
-              threads.emplace_back(&GPTrainingLoop::RunArena, this, arena, numberOfTurns);
-
-            } else {
-              // Wait for one of the existing threads to finish
-              threads[0].join();
-              threads.erase(threads.begin());
-              threadsComplete++;
-              threads.emplace_back(&GPTrainingLoop::RunArena, this, arena, numberOfTurns);
+          std::atomic<size_t> tasksComplete = 0;
+          if (independentAgents) {
+            // One task per group of agents, so the agents of a large arena spread over several threads.
+            struct AgentGroup {
+              size_t arena, begin, end;
+            };
+            std::vector<AgentGroup> groups;
+            for (size_t arena = 0; arena < environments.size(); ++arena) {
+              for (size_t begin = 0; begin < agents[arena].size(); begin += agentsPerTask) {
+                groups.push_back({arena, begin, std::min(begin + agentsPerTask, agents[arena].size())});
+              }
             }
 
-
-            size_t barWidth = 64;
-            float progress = (float) (arena+1) / environments.size();
-            size_t pos = barWidth * progress;
-            std::cout << "[";
-            for (size_t i = 0; i < barWidth; ++i) {
-              if (i < pos) std::cout << "=";
-              else if (i == pos) std::cout << ">";
-              else std::cout << " ";
+            for (auto &environment: environments) {
+              environment->BeginIndependentAgents();
             }
-            std::cout << "] " << int(progress * 100.0) << " % - " << threadsComplete << " threads done\r";
-            std::cout.flush();
-          }
-
-          // Wait for all threads to finish
-          for (auto &thread: threads) {
-            if (thread.joinable()) {
-              thread.join();
-              threadsComplete+=maxThreads;
+            threadPool.ParallelFor(0, groups.size(), [this, &groups, numberOfTurns, &tasksComplete](size_t i) {
+                RunArenaAgents(groups[i].arena, groups[i].begin, groups[i].end, numberOfTurns);
+                PrintProgress(++tasksComplete, groups.size());
+            });
+            for (auto &environment: environments) {
+              environment->EndIndependentAgents();
             }
+          } else {
+            threadPool.ParallelFor(0, environments.size(), [this, numberOfTurns, &tasksComplete](size_t arena) {
+                RunArena(arena, numberOfTurns);
+                PrintProgress(++tasksComplete, environments.size());
+            });
           }
 
           std::cout << std::endl;
-          std::cout << "All threads done" << std::endl;
-
+          std::cout << "All arenas done on " << threadPool.GetNumThreads() << " threads" << std::endl;
+        }
 
+        /**
+         * @brief Prints a progress bar for the arenas
+         * @param complete : Number of tasks finished
+         * @param total : Total number of tasks
+         */
+        void PrintProgress(size_t complete, size_t total) {
+          std::lock_guard lock(printMutex);
+
+          size_t barWidth = 64;
+          float progress = (float) complete / total;
+          size_t pos = barWidth * progress;
+          std::cout << "[";
+          for (size_t i = 0; i < barWidth; ++i) {
+            if (i < pos) std::cout << "=";
+            else if (i == pos) std::cout << ">";
+            else std::cout << " ";
+          }
+          std::cout << "] " << int(progress * 100.0) << " % - " << complete << "/" << total << " tasks done\r";
+          std::cout.flush();
         }
 
         /**
@@ -301,7 +363,9 @@ namespace cowboys {
             saveDataParams.updateGeneration(generation);
 
             InitTEMPAgentFitness();
+            auto simulationStartTime = std::chrono::high_resolution_clock::now();
             ThreadTrainLoop(maxThreads, numberOfTurns);
+            auto simulationEndTime = std::chrono::high_resolution_clock::now();
 
             std::cout << std::endl;
 
@@ -313,13 +377,21 @@ namespace cowboys {
             saveDataParams.countMaxAgents = countMaxAgents;
             SaveDataCheckPoint(saveDataParams);
 
-            GpLoopMutateHelper();
+            auto mutationStartTime = std::chrono::high_resolution_clock::now();
+            GpLoopMutateHelper(maxThreads);
+            auto mutationEndTime = std::chrono::high_resolution_clock::now();
             resetEnvironments();
 
             auto generationEndTime = std::chrono::high_resolution_clock::now();
             auto generationDuration = std::chrono::duration_cast<std::chrono::microseconds>(
                     generationEndTime - generationStartTime);
+            auto simulationDuration = std::chrono::duration_cast<std::chrono::microseconds>(
+                    simulationEndTime - simulationStartTime);
+            auto mutationDuration = std::chrono::duration_cast<std::chrono::microseconds>(
+                    mutationEndTime - mutationStartTime);
             std::cout << "Generation " << generation << " took " << generationDuration.count() / 1000000.0 << " seconds"
+                      << " (arenas " << simulationDuration.count() / 1000000.0 << " s, mutation "
+                      << mutationDuration.count() / 1000000.0 << " s, " << pool->GetNumThreads() << " threads)"
                       << std::endl;
 
           }
@@ -650,8 +722,9 @@ namespace cowboys {
         /**
          * @brief Helper function for the GP loop mutate function.
          *
+         * @param maxThreads : Number of threads to use, 0 for one per hardware thread
          */
-        void GpLoopMutateHelper() {
+        void GpLoopMutateHelper(size_t maxThreads = 0) {
 
           constexpr double ELITE_POPULATION_PERCENT = 0.1;
           constexpr double UNFIT_POPULATION_PERCENT = 0.2;
@@ -673,47 +746,26 @@ namespace cowboys {
           const int MIDDLE_MUTATE_ENDBOUND = int(sortedAgents.size() * (1 - UNFIT_POPULATION_PERCENT));
           const int MIDDLE_MUTATE_STARTBOUND = int(ELITE_POPULATION_PERCENT * sortedAgents.size());
 
-          // Determine the number of threads to use
-          const int num_threads = std::thread::hardware_concurrency();
-
-          std::vector<std::thread> threads;
-
-          // Calculate the number of agents per thread
-          int agents_per_thread = (MIDDLE_MUTATE_ENDBOUND - MIDDLE_MUTATE_STARTBOUND) / num_threads;
+          // Mutations only touch the middle and unfit agents, and copies only read the elite agents, so both
+          // loops can share the pool at once. Small chunks keep the threads evenly loaded.
+          WorkStealingPool &threadPool = GetPool(maxThreads);
+          const int chunkSize = std::max<int>(1, (sortedAgents.size() / threadPool.GetNumThreads()) / 8);
 
-          // Launch threads for the first loop
-          for (int i = 0; i < num_threads; ++i) {
-            int start = MIDDLE_MUTATE_STARTBOUND + i * agents_per_thread;
-            int end = (i == num_threads - 1) ? MIDDLE_MUTATE_ENDBOUND : start + agents_per_thread;
-            threads.push_back(std::thread([this, start, end] {
+          for (int start = MIDDLE_MUTATE_STARTBOUND; start < MIDDLE_MUTATE_ENDBOUND; start += chunkSize) {
+            int end = std::min(start + chunkSize, MIDDLE_MUTATE_ENDBOUND);
+            threadPool.Submit([this, start, end] {
                 this->MutateAgents(start, end, sortedAgents, agents, 0.05);
-            }));
+            });
           }
 
-          // Join the threads
-          for (auto &t: threads) {
-            t.join();
-          }
-
-          threads.clear();
-
-          // Second loop - copy and mutate agents
-          // int unfitAgents = int(sortedAgents.size() * UNFIT_POPULATION_PERCENT);
-          agents_per_thread = (sortedAgents.size() - MIDDLE_MUTATE_ENDBOUND) / num_threads;
-          for (int i = 0; i < num_threads; ++i) {
-            int start = MIDDLE_MUTATE_ENDBOUND + i * agents_per_thread;
-            int end = (i == num_threads - 1) ? sortedAgents.size() : start + agents_per_thread;
-
-            threads.push_back(std::thread([this, start, end, ELITE_POPULATION_SIZE] {
+          for (int start = MIDDLE_MUTATE_ENDBOUND; start < int(sortedAgents.size()); start += chunkSize) {
+            int end = std::min(start + chunkSize, int(sortedAgents.size()));
+            threadPool.Submit([this, start, end, ELITE_POPULATION_SIZE] {
                 this->MutateAndCopyAgents(start, end, sortedAgents, agents, ELITE_POPULATION_SIZE);
-            }));
+            });
           }
 
-          for (auto &t: threads) {
-            t.join();
-          }
-
-
+          threadPool.Wait();
         }
 
         /**
@@ -838,7 +890,50 @@ namespace cowboys {
               environments[arena]->RunAgents();
               environments[arena]->UpdateWorld();
             }
-            for (size_t a = 0; a < agents[arena].size(); ++a) {
+            ScoreAgents(arena, 0, agents[arena].size(), startPos_idx);
+          }
+
+          FinalizeFitness(arena, 0, agents[arena].size());
+        }
+
+        /**
+         * @brief Runs some of the agents of an arena on their own, for independent agents mode.
+         *      Gives the same results as RunArena() for these agents, as long as agents don't interact.
+         *      Different threads may run different agents of the same arena at once.
+         *
+         * @param arena : The arena the agents are in.
+         * @param begin : Index of the first agent to run.
+         * @param end : One past the index of the last agent to run.
+         * @param numberOfTurns : The number of turns to run the agents for.
+         */
+        void RunArenaAgents(size_t arena, size_t begin, size_t end, size_t numberOfTurns) {
+          auto &environment = *environments[arena];
+          for (size_t startPos_idx = 0; startPos_idx < STARTPOSITIONS.size(); ++startPos_idx) {
+            for (size_t a = begin; a < end; ++a) {
+              agents[arena][a]->SetPosition(STARTPOSITIONS[startPos_idx]);
+            }
+
+            for (size_t turn = 0; turn < numberOfTurns; turn++) {
+              for (size_t a = begin; a < end; ++a) {
+                environment.RunAgent(*agents[arena][a]);
+              }
+            }
+            ScoreAgents(arena, begin, end, startPos_idx);
+          }
+
+          FinalizeFitness(arena, begin, end);
+        }
+
+        /**
+         * @brief Scores agents after a run from one of the start positions.
+         *
+         * @param arena : The arena the agents are in.
+         * @param begin : Index of the first agent to score.
+         * @param end : One past the index of the last agent to score.
+         * @param startPos_idx : Index of the start position the agents ran from.
+         */
+        void ScoreAgents(size_t arena, size_t begin, size_t end, size_t startPos_idx) {
+            for (size_t a = begin; a < end; ++a) {
               double tempscore = SimpleFitnessFunction(*agents[arena][a], STARTPOSITIONS[startPos_idx]);
               auto tempEndPosition = agents[arena][a]->GetPosition();
               endPositions[arena][a][startPos_idx] = tempEndPosition;
@@ -846,10 +941,17 @@ namespace cowboys {
               TEMPAgentFitness[arena][a] += tempscore;
 
             }
+        }
 
-          }
-
-          for (size_t a = 0; a < agents[arena].size(); ++a) {
+        /**
+         * @brief Combines the scores of agents from every start position into their fitness.
+         *
+         * @param arena : The arena the agents are in.
+         * @param begin : Index of the first agent.
+         * @param end : One past the index of the last agent.
+         */
+        void FinalizeFitness(size_t arena, size_t begin, size_t end) {
+          for (size_t a = begin; a < end; ++a) {
             std::vector<double> scores = independentAgentFitness[arena][a];
             auto computeMedian = [&scores]() -> double {
                 std::vector<double> temp(scores);  // Copy the data
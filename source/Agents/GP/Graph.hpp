@@ -2,7 +2,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <memory>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -97,6 +99,153 @@ namespace cowboys {
     }
   };
 
+  /// @brief A decision graph flattened into arrays, for fast repeated decisions.
+  ///
+  /// Nodes are stored by value in topological order (inputs first, outputs last) and their
+  /// outputs live in one contiguous buffer alongside a validity flag. Each node reads its inputs
+  /// by index from this buffer instead of chasing shared pointers. Nodes are only evaluated when
+  /// an output needs them, so inactive nodes are skipped entirely.
+  ///
+  /// Caching matches Graph exactly: changing a graph input invalidates everything downstream of
+  /// it, and nothing else. Sensor nodes depend on the agent rather than their inputs, so this is
+  /// needed to keep decisions bit-identical to the equivalent Graph.
+  class CompiledGraph : public NodeOutputSource {
+  protected:
+    /// Every node in the graph, in topological order.
+    std::vector<GraphNode> nodes;
+
+    /// Indices of every node's inputs, concatenated in node order.
+    std::vector<size_t> connections;
+
+    /// Where each node's inputs start within connections (with a final entry for the end).
+    std::vector<size_t> connection_starts;
+
+    /// The number of graph input nodes (at the start of nodes).
+    size_t num_inputs{0};
+
+    /// The number of output nodes (at the end of nodes).
+    size_t num_outputs{0};
+
+    /// Cached output of each node.
+    mutable std::vector<double> values;
+
+    /// Whether each entry in values is current.
+    mutable std::vector<char> valid;
+
+    /// Scratch flags used to propagate invalidation.
+    std::vector<char> stale;
+
+    /// Scratch storage for the output values of each decision.
+    std::vector<double> outputs;
+
+  public:
+    /// @brief Create a compiled graph.
+    /// @param num_inputs Number of graph input nodes.
+    /// @param num_outputs Number of output nodes (the last nodes added).
+    CompiledGraph(size_t num_inputs, size_t num_outputs) : num_inputs{num_inputs}, num_outputs{num_outputs} {
+      connection_starts.push_back(0);
+      for (size_t i = 0; i < num_inputs; ++i)
+        AddNode(NodeFunction{}, 0, {});
+    }
+    ~CompiledGraph() override = default;
+
+    // Nodes hold pointers into this object, so it cannot be copied or moved.
+    CompiledGraph(const CompiledGraph &) = delete;
+    CompiledGraph &operator=(const CompiledGraph &) = delete;
+
+    /// @brief Get the number of nodes in the graph.
+    size_t GetNodeCount() const { return nodes.size(); }
+
+    /// @brief Add the next (functional) node to the graph. Inputs must refer to earlier nodes.
+    /// @param function The function for the node to use.
+    /// @param default_output The default output of the node.
+    /// @param input_indices The indices of the node's inputs.
+    void AddNode(NodeFunction function, double default_output, const std::vector<size_t> &input_indices) {
+      assert(std::all_of(input_indices.cbegin(), input_indices.cend(),
+                         [this](size_t index) { return index < nodes.size(); }));
+      nodes.emplace_back(function);
+      nodes.back().SetDefaultOutput(default_output);
+      connections.insert(connections.cend(), input_indices.cbegin(), input_indices.cend());
+      connection_starts.push_back(connections.size());
+      values.push_back(0);
+      valid.push_back(nodes.size() <= num_inputs); // Input values start valid at 0.
+      stale.push_back(0);
+    }
+
+    /// @brief Link every node to its inputs. Must be called once, after all nodes are added.
+    void Finalize() {
+      assert(nodes.size() >= num_inputs + num_outputs);
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        std::span<const size_t> indices(connections.data() + connection_starts[i],
+                                        connection_starts[i + 1] - connection_starts[i]);
+        nodes[i].SetInputSource(*this, indices);
+      }
+      outputs.reserve(num_outputs);
+    }
+
+    /// @brief Get the output of a node, evaluating it only if its cached value is out of date.
+    /// @param index The index of the node.
+    /// @return The output of the node.
+    double GetNodeOutput(size_t index) const override {
+      if (!valid[index]) {
+        values[index] = nodes[index].ComputeOutput();
+        valid[index] = true;
+      }
+      return values[index];
+    }
+
+    /// @brief Makes a decision based on the inputs and the action vector (same as Graph::MakeDecision).
+    /// @param inputs The inputs to the graph.
+    /// @param action_vec The action vector.
+    /// @return The action to take.
+    size_t MakeDecision(const std::vector<double> &inputs, const std::vector<size_t> &actions) {
+      // Set inputs, marking any that change as stale
+      bool any_changed = false;
+      for (size_t i = 0; i < num_inputs; ++i) {
+        double input = 0;
+        if (i < inputs.size())
+          input = inputs.at(i);
+        if (values[i] != input) {
+          values[i] = input;
+          stale[i] = true;
+          any_changed = true;
+        }
+      }
+
+      // Invalidate every node downstream of a changed input; nodes are in topological order
+      if (any_changed) {
+        for (size_t i = num_inputs; i < nodes.size(); ++i) {
+          for (size_t c = connection_starts[i]; c < connection_starts[i + 1]; ++c) {
+            if (stale[connections[c]]) {
+              stale[i] = true;
+              valid[i] = false;
+              break;
+            }
+          }
+        }
+        std::fill(stale.begin(), stale.end(), 0);
+      }
+
+      // Get output of last layer
+      outputs.clear();
+      for (size_t i = nodes.size() - num_outputs; i < nodes.size(); ++i) {
+        outputs.push_back(GetNodeOutput(i));
+      }
+
+      // Choose the action with the highest output
+      auto max_output = std::max_element(outputs.cbegin(), outputs.cend());
+      size_t index = std::distance(outputs.cbegin(), max_output);
+
+      // If index is out of bounds, return the last action
+      size_t action = 0;
+      if (index >= actions.size())
+        action = actions.back();
+      else // Otherwise, return the action at the index
+        action = actions.at(index);
+      return action;
+    }
+  };
+
   /// @brief Encodes the actions from an agent's action map into a vector of
   /// size_t, representing action IDs.
   /// @param action_map The action map from the agent.
@@ -18,6 +18,7 @@
 #include <numeric>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -39,6 +40,15 @@ namespace cowboys {
     bool IsNull() const { return function == nullptr; }
   };
 
+  /// @brief Something that can provide node outputs by index. Lets a node read its inputs from
+  /// flat storage (see CompiledGraph) rather than from linked nodes.
+  class NodeOutputSource {
+  public:
+    virtual ~NodeOutputSource() = default;
+    /// @brief Get the output of the node at the given index.
+    virtual double GetNodeOutput(size_t index) const = 0;
+  };
+
   /// @brief A node in a decision graph.
   /// @note This should always be a shared pointer. Caching will not work otherwise.
   class GraphNode : public std::enable_shared_from_this<GraphNode> {
@@ -61,6 +71,26 @@ namespace cowboys {
     /// Flag indicating whether the cached output is valid.
     mutable bool cached_output_valid{false};
 
+    /// If set, input values are looked up here (using input_indices) instead of in inputs.
+    const NodeOutputSource *input_source{nullptr};
+
+    /// Indices of this node's inputs within input_source.
+    std::span<const size_t> input_indices;
+
+    /// Reused storage for input values so that reading them does not allocate.
+    mutable std::vector<double> input_values;
+
+    /// @brief Get the number of inputs to this node, wherever they come from.
+    size_t GetNumInputs() const { return input_source ? input_indices.size() : inputs.size(); }
+
+    /// @brief Get the output of one of this node's inputs.
+    /// @param index The position of the input (must be valid).
+    double GetInputValue(size_t index) const {
+      if (input_source)
+        return input_source->GetNodeOutput(input_indices[index]);
+      return inputs[index]->GetOutput();
+    }
+
     /// @brief Add an output node to this node. Used for cache invalidation.
     /// @param node The node to add as an output.
     void AddOutput(GraphNode *node) { outputs.push_back(node); }
@@ -88,27 +118,33 @@ namespace cowboys {
       if (cached_output_valid)
         return cached_output;
 
+      // Cache the output
+      cached_output = ComputeOutput();
+      cached_output_valid = true;
+
+      return cached_output;
+    }
+
+    /// @brief Calculate the output of this node, ignoring (and not updating) the cache.
+    /// @return The output of this node.
+    double ComputeOutput() const {
       double result = default_output;
       // Invoke function pointer if it exists
       if (!function_pointer.IsNull()) {
         result = function_pointer(*this);
       }
-
-      // Cache the output
-      cached_output = result;
-      cached_output_valid = true;
-
       return result;
     }
 
     /// @brief Get the output values of the inputs of this node.
-    /// @return A vector of doubles representing the input values.
-    std::vector<double> GetInputValues() const {
-      std::vector<double> values;
-      values.reserve(inputs.size());
-      std::transform(inputs.cbegin(), inputs.cend(), std::back_inserter(values),
-                     [](const auto &node) { return node->GetOutput(); });
-      return values;
+    /// @return A view of the input values, valid until the next call on this node.
+    std::span<const double> GetInputValues() const {
+      const size_t num_inputs = GetNumInputs();
+      input_values.resize(num_inputs);
+      for (size_t i = 0; i < num_inputs; ++i) {
+        input_values[i] = GetInputValue(i);
+      }
+      return input_values;
     }
 
     /// @brief Get the output values of the inputs of this node given an array of indices.
@@ -117,12 +153,12 @@ namespace cowboys {
     /// @return A vector of doubles representing the input values in the same order of the indices.
     template <size_t N> std::optional<std::vector<double>> GetInputValues(const std::array<size_t, N> &indices) const {
       size_t max_index = *std::max_element(indices.cbegin(), indices.cend());
-      if (max_index >= inputs.size())
+      if (max_index >= GetNumInputs())
         return std::nullopt;
       std::vector<double> values;
       values.reserve(N);
       std::transform(indices.cbegin(), indices.cend(), std::back_inserter(values),
-                     [this](const auto &index) { return inputs.at(index)->GetOutput(); });
+                     [this](const auto &index) { return GetInputValue(index); });
       return values;
     }
 
@@ -163,6 +199,15 @@ namespace cowboys {
       RecursiveInvalidateCache();
     }
 
+    /// @brief Read this node's inputs from an outside source instead of from linked input nodes.
+    /// @param source Provider of node outputs; must outlive this node.
+    /// @param indices Index of each input within source; the viewed storage must outlive this node.
+    void SetInputSource(const NodeOutputSource &source, std::span<const size_t> indices) {
+      input_source = &source;
+      input_indices = indices;
+      RecursiveInvalidateCache();
+    }
+
     /// @brief Set the default output of this node.
     /// @param value The new default output.
     void SetDefaultOutput(double value) {
@@ -186,7 +231,7 @@ namespace cowboys {
   /// @return The function result as a double.
   double Sum(const GraphNode &node, const cse491::AgentBase &) {
     auto vals = node.GetInputValues();
-    return std::reduce(PAR vals.cbegin(), vals.cend(), 0.);
+    return std::reduce(PAR vals.begin(), vals.end(), 0.);
   }
 
   /// @brief Returns 1 if all inputs are not equal to 0, 0 otherwise.
@@ -194,7 +239,7 @@ namespace cowboys {
   /// @return The function result as a double.
   double And(const GraphNode &node, const cse491::AgentBase &) {
     auto vals = node.GetInputValues();
-    return std::any_of(vals.cbegin(), vals.cend(), [](const double val) { return val == 0.; }) ? 0. : 1.;
+    return std::any_of(vals.begin(), vals.end(), [](const double val) { return val == 0.; }) ? 0. : 1.;
   }
 
   /// @brief Returns 1 if any of the inputs besides the first are equal to the first
@@ -202,11 +247,11 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double AnyEq(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
+    auto vals = node.GetInputValues();
     if (vals.size() == 0)
       return node.GetDefaultOutput();
     for (size_t i = 1; i < vals.size(); ++i) {
-      if (vals.at(0) == vals.at(i))
+      if (vals[0] == vals[i])
         return 1.;
     }
     return 0.;
@@ -237,8 +282,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Sin(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::sin(val); });
   }
 
@@ -246,8 +291,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Cos(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::cos(val); });
   }
 
@@ -256,7 +301,7 @@ namespace cowboys {
   /// @return The function result as a double.
   double Product(const GraphNode &node, const cse491::AgentBase &) {
     auto vals = node.GetInputValues();
-    return std::reduce(PAR vals.cbegin(), vals.cend(), 1., std::multiplies{});
+    return std::reduce(PAR vals.begin(), vals.end(), 1., std::multiplies{});
   }
 
   /// @brief Returns the sum of the reciprocal of all inputs.
@@ -264,7 +309,7 @@ namespace cowboys {
   /// @return The function result as a double.
   double Reciprocal(const GraphNode &node, const cse491::AgentBase &) {
     auto vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return 1. / (val + std::numeric_limits<double>::epsilon()); });
   }
 
@@ -272,8 +317,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Exp(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::exp(val); });
   }
 
@@ -281,7 +326,7 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double LessThan(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
+    auto vals = node.GetInputValues();
     return std::is_sorted(vals.begin(), vals.end(), std::less{});
   }
 
@@ -289,7 +334,7 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double GreaterThan(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
+    auto vals = node.GetInputValues();
     return std::is_sorted(vals.begin(), vals.end(), std::greater{});
   }
 
@@ -297,20 +342,20 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Max(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
+    auto vals = node.GetInputValues();
     if (vals.empty())
       return node.GetDefaultOutput();
-    return *std::max_element(vals.cbegin(), vals.cend());
+    return *std::max_element(vals.begin(), vals.end());
   }
 
   /// @brief Returns the minimum value of all inputs.
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Min(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
+    auto vals = node.GetInputValues();
     if (vals.empty())
       return node.GetDefaultOutput();
-    return *std::min_element(vals.cbegin(), vals.cend());
+    return *std::min_element(vals.begin(), vals.end());
   }
 
   /// @brief Returns the sum of negated inputs.
@@ -322,8 +367,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Square(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return val * val; });
   }
 
@@ -331,8 +376,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double PosClamp(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::max(0., val); });
   }
 
@@ -340,8 +385,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double NegClamp(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::min(0., val); });
   }
 
@@ -349,8 +394,8 @@ namespace cowboys {
   /// @param node The node to get the inputs from.
   /// @return The function result as a double.
   double Sqrt(const GraphNode &node, const cse491::AgentBase &) {
-    std::vector<double> vals = node.GetInputValues();
-    return std::transform_reduce(PAR vals.cbegin(), vals.cend(), 0., std::plus{},
+    auto vals = node.GetInputValues();
+    return std::transform_reduce(PAR vals.begin(), vals.end(), 0., std::plus{},
                                  [](const double val) { return std::sqrt(std::max(0., val)); });
   }
 
@@ -0,0 +1,232 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A persistent pool of worker threads that steal work from each other.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cowboys {
+
+  /// @brief A fixed set of worker threads that run submitted tasks until the pool is destroyed.
+  ///
+  /// Every worker has its own queue. Tasks submitted from outside the pool are dealt out to the queues in turn, and
+  /// tasks submitted by a worker go to its own queue. A worker runs its newest task first and, when its queue is
+  /// empty, steals the oldest task from another queue. So one long task never holds up the rest: idle workers keep
+  /// taking whatever work is left.
+  ///
+  /// Wait() waits for every task, so it must not be called from a task. ParallelFor() only waits for its own tasks,
+  /// so tasks may call it.
+  class WorkStealingPool {
+  private:
+    /// The tasks waiting to run on one worker.
+    struct WorkerQueue {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    /// The tasks submitted by one call to ParallelFor(), which waits for just these.
+    struct Batch {
+      std::atomic<size_t> num_pending{0}; ///< Tasks of the batch not yet finished.
+      std::mutex error_mutex;             ///< Guards error.
+      std::exception_ptr error;           ///< The first exception thrown by a task of the batch.
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues; ///< One queue per worker.
+    std::vector<std::thread> workers;                 ///< The worker threads.
+
+    std::mutex wake_mutex;               ///< Guards sleeping and waking (workers and Wait()).
+    std::condition_variable wake_cv;     ///< Wakes workers when tasks are queued or the pool stops.
+    std::condition_variable done_cv;     ///< Wakes Wait() when tasks are queued or all tasks finish.
+    bool stopping = false;               ///< Set when the pool is being destroyed.
+
+    std::atomic<size_t> num_queued{0};   ///< Tasks sitting in a queue.
+    std::atomic<size_t> num_pending{0};  ///< Tasks submitted but not yet finished.
+    std::atomic<size_t> next_queue{0};   ///< Where the next task from outside the pool goes.
+
+    std::mutex error_mutex;              ///< Guards first_error.
+    std::exception_ptr first_error;      ///< The first exception thrown by a task since the last Wait().
+
+    /// @brief The index of the calling thread's queue if it is a worker of this pool, or the number of workers if not.
+    size_t CurrentWorker() const {
+      auto this_id = std::this_thread::get_id();
+      for (size_t i = 0; i < workers.size(); ++i) {
+        if (workers[i].get_id() == this_id) return i;
+      }
+      return workers.size();
+    }
+
+    /// @brief Take a task, from the back of the home queue or else from the front of any other queue.
+    /// @param home The queue to look in first.
+    /// @param task Set to the task that was taken.
+    /// @return Whether a task was found.
+    bool TakeTask(size_t home, std::function<void()> &task) {
+      const size_t num_queues = queues.size();
+      for (size_t offset = 0; offset < num_queues; ++offset) {
+        WorkerQueue &queue = *queues[(home + offset) % num_queues];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (offset == 0) {
+          task = std::move(queue.tasks.back());
+          queue.tasks.pop_back();
+        } else {
+          task = std::move(queue.tasks.front());
+          queue.tasks.pop_front();
+        }
+        --num_queued;
+        return true;
+      }
+      return false;
+    }
+
+    /// @brief Run one queued task, if there are any.
+    /// @param home The queue to look in first.
+    /// @return Whether a task was run.
+    bool RunOneTask(size_t home) {
+      std::function<void()> task;
+      if (!TakeTask(home, task)) return false;
+
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard lock(error_mutex);
+        if (!first_error) first_error = std::current_exception();
+      }
+
+      if (--num_pending == 0) {
+        std::lock_guard lock(wake_mutex);
+        done_cv.notify_all();
+      }
+      return true;
+    }
+
+    /// @brief Run queued tasks on the calling thread until a condition holds, sleeping while there are none.
+    /// @param done Returns whether to stop; checked under wake_mutex before sleeping.
+    template <typename PRED_T>
+    void HelpUntil(PRED_T done) {
+      const size_t home = std::min(CurrentWorker(), queues.size() - 1);
+      while (!done()) {
+        if (RunOneTask(home)) continue;
+        std::unique_lock lock(wake_mutex);
+        done_cv.wait(lock, [this, &done]() { return done() || num_queued > 0; });
+      }
+    }
+
+    /// @brief Record that a task of a batch has finished, waking its ParallelFor() if it was the last.
+    /// The batch may be gone as soon as its count reaches zero, so it is not touched after that.
+    void FinishBatchTask(Batch &batch) {
+      if (--batch.num_pending == 0) {
+        std::lock_guard lock(wake_mutex);
+        done_cv.notify_all();
+      }
+    }
+
+    /// @brief The loop run by each worker thread.
+    void WorkerLoop(size_t index) {
+      while (true) {
+        if (RunOneTask(index)) continue;
+        std::unique_lock lock(wake_mutex);
+        wake_cv.wait(lock, [this]() { return stopping || num_queued > 0; });
+        if (stopping && num_queued == 0) return;
+      }
+    }
+
+  public:
+    /// @brief Start the worker threads.
+    /// @param num_threads The number of workers; 0 means one per hardware thread.
+    explicit WorkStealingPool(size_t num_threads = 0) {
+      if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+      for (size_t i = 0; i < num_threads; ++i) queues.push_back(std::make_unique<WorkerQueue>());
+      for (size_t i = 0; i < num_threads; ++i) workers.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+
+    /// @brief Finish every queued task, then stop the workers.
+    ~WorkStealingPool() {
+      {
+        std::lock_guard lock(wake_mutex);
+        stopping = true;
+      }
+      wake_cv.notify_all();
+      for (auto &worker : workers) worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /// @brief Get the number of worker threads.
+    [[nodiscard]] size_t GetNumThreads() const { return workers.size(); }
+
+    /// @brief Queue a task to be run by a worker.
+    void Submit(std::function<void()> task) {
+      size_t home = CurrentWorker();
+      if (home == workers.size()) home = next_queue++ % queues.size();
+
+      ++num_pending;
+      {
+        std::lock_guard lock(queues[home]->mutex);
+        queues[home]->tasks.push_back(std::move(task));
+      }
+      ++num_queued;
+
+      std::lock_guard lock(wake_mutex);
+      wake_cv.notify_one();
+      done_cv.notify_all();
+    }
+
+    /// @brief Block until every submitted task has finished. The calling thread helps run tasks while it waits.
+    /// Rethrows the first exception thrown by a task since the last call. Must not be called from a task of this pool,
+    /// since the calling task would never finish; tasks should use ParallelFor() instead.
+    void Wait() {
+      assert(CurrentWorker() == workers.size() && "Wait() called from a pool task");
+      HelpUntil([this]() { return num_pending == 0; });
+
+      std::exception_ptr error;
+      {
+        std::lock_guard lock(error_mutex);
+        std::swap(error, first_error);
+      }
+      if (error) std::rethrow_exception(error);
+    }
+
+    /// @brief Call a function on every index in a range, split into tasks, and wait for those tasks to finish.
+    /// Other tasks in the pool are not waited for, so this may be called from inside a task. Rethrows the first
+    /// exception thrown by the function.
+    /// @param begin The first index.
+    /// @param end One past the last index.
+    /// @param fun The function to call with each index.
+    /// @param grain_size The number of indices handled by each task.
+    template <typename FUN_T>
+    void ParallelFor(size_t begin, size_t end, FUN_T fun, size_t grain_size = 1) {
+      assert(grain_size > 0);
+      Batch batch;
+      for (size_t start = begin; start < end; start += grain_size) {
+        const size_t stop = std::min(end, start + grain_size);
+        ++batch.num_pending;
+        Submit([this, start, stop, &fun, &batch]() {
+          try {
+            for (size_t i = start; i < stop; ++i) fun(i);
+          } catch (...) {
+            std::lock_guard lock(batch.error_mutex);
+            if (!batch.error) batch.error = std::current_exception();
+          }
+          FinishBatchTask(batch);
+        });
+      }
+      HelpUntil([&batch]() { return batch.num_pending == 0; });
+      if (batch.error) std::rethrow_exception(batch.error);
+    }
+  };
+
+} // End of namespace cowboys
@@ -60,7 +60,7 @@ namespace walle {
      * @return true if so; false otherwise
      */
     bool PathAgent::Initialize() {
-        if (property_map.contains("path")) {
+        if (HasProperty("path")) {
             offsets_ = StrToOffsets(GetProperty<std::basic_string_view<char>>("path"));
         } else {
             return false;
@@ -157,14 +157,14 @@ class TrackingAgent : public cse491::AgentBase {
      */
     bool Initialize() override {
         SetStartPosition(GetPosition());
-        if (property_map.contains("path")) {
+        if (HasProperty("path")) {
             auto view = GetProperty<std::basic_string_view<char>>("path");
             offsets_ = StrToOffsets(view);
             std::get<PathAgent>(inner_).SetProperty("path", view);
             std::get<PathAgent>(inner_).SetWorld(GetWorld());
             std::get<PathAgent>(inner_).SetPosition(GetPosition());
 
-            if (property_map.contains("alerter")) {
+            if (HasProperty("alerter")) {
                 auto alerter_property = GetProperty<std::shared_ptr<Alerter>>("alerter");
                 AddToAlerter(alerter_property);
             }
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "AgentData.hpp"
+#include "../core/ActionRecorderBase.hpp"
+#include "../core/AgentBase.hpp"
+
+namespace DataCollection {
+
+    /**
+     * @brief Action recorder that keeps an AgentData history for each agent.
+     *
+     * Attach one to a world with WorldBase::SetActionRecorder(). Each action taken is stored
+     * as an action ID, and each agent's action map is stored once, when the agent first acts.
+     */
+    class AgentActionRecorder : public cse491::ActionRecorderBase {
+    private:
+        std::unordered_map<std::string, std::shared_ptr<AgentData>> agent_map;  ///< History for each agent name.
+        std::mutex record_mutex;  ///< Guards agent_map, since agents may act on several threads.
+        size_t num_actions = 0;   ///< Total number of actions recorded.
+
+    public:
+        /**
+         * @brief Records an action taken by an agent.
+         * @param agent The agent that took the action.
+         * @param action_id The ID of the action taken.
+         * @param result The result of the action (unused).
+         */
+        void RecordAction(const cse491::AgentBase & agent, size_t action_id, [[maybe_unused]] int result) override {
+            std::lock_guard lock(record_mutex);
+            auto & data = agent_map[agent.GetName()];
+            if (!data) {
+                data = std::make_shared<AgentData>(agent.GetName());
+                data->StoreAction(agent.GetActionMap());
+            }
+            data->StoreActionId(action_id);
+            ++num_actions;
+        }
+
+        /**
+         * @brief Gets the total number of actions recorded.
+         * @return The number of actions.
+         */
+        size_t GetNumActions() {
+            std::lock_guard lock(record_mutex);
+            return num_actions;
+        }
+
+        /**
+         * @brief Gets the recorded history of an agent.
+         * @param name The name of the agent.
+         * @return The agent's data, or nullptr if it has not acted.
+         */
+        std::shared_ptr<AgentData> GetAgent(const std::string & name) {
+            std::lock_guard lock(record_mutex);
+            auto it = agent_map.find(name);
+            return it == agent_map.end() ? nullptr : it->second;
+        }
+    };
+} // namespace DataCollection
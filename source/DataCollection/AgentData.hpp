@@ -16,6 +16,7 @@ namespace DataCollection
     private:
         std::string name;  ///< The name of the agent.
         std::vector<int> actionIds;  ///< IDs associated with the agent's actions.
+        std::vector<size_t> actionHistory;  ///< ID of each action the agent took, oldest first.
         std::vector<cse491::GridPosition> position;  ///list of grid positions.
         std::vector<std::unordered_map<std::string,size_t>> actions;  ///< Vector of action maps.
 
@@ -55,6 +56,22 @@ namespace DataCollection
             actionIds.push_back(id);
         }
 
+        /**
+         * @brief Stores the ID of an action the agent took.
+         * @param id The action ID to be stored.
+         */
+        void StoreActionId(size_t id) {
+            actionHistory.push_back(id);
+        }
+
+        /**
+         * @brief Gets the IDs of the actions the agent took.
+         * @return The action IDs, oldest first.
+         */
+        const std::vector<size_t>& GetActionIds() const {
+            return actionHistory;
+        }
+
         /**
          * @brief Retrieves the stored actions.
          * @return Reference to the vector of action maps.
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "../core/GridPosition.hpp"
+
+namespace DataCollection {
+
+    /**
+     * @brief One sample of an agent's state, as stored in an AgentEventLog.
+     */
+    struct AgentEvent {
+        size_t agent_id = 0;            ///< ID of the agent.
+        size_t tick = 0;                ///< When the sample was taken.
+        cse491::GridPosition position;  ///< Where the agent was.
+        size_t action = 0;              ///< The action the agent last took.
+        int result = 0;                 ///< The result of that action.
+    };
+
+    /**
+     * @brief An append-only log of agent events, stored by column.
+     *
+     * Events are kept in fixed-size chunks, with each field in its own array. Appending never
+     * moves or copies earlier events, so each sample costs O(1) however long a run goes, and
+     * queries that only need a few fields (such as one agent's trajectory) only touch those.
+     */
+    class AgentEventLog {
+    public:
+        static constexpr size_t CHUNK_SIZE = 4096;  ///< Number of events in each chunk.
+
+    private:
+        /// Storage for CHUNK_SIZE events, one array per field.
+        struct Chunk {
+            size_t agent_ids[CHUNK_SIZE];
+            size_t ticks[CHUNK_SIZE];
+            double xs[CHUNK_SIZE];
+            double ys[CHUNK_SIZE];
+            size_t actions[CHUNK_SIZE];
+            int results[CHUNK_SIZE];
+        };
+
+        std::vector<std::unique_ptr<Chunk>> chunks;  ///< All chunks; only the last may be partly full.
+        size_t num_events = 0;                       ///< Total number of events stored.
+
+    public:
+        AgentEventLog() = default;
+        AgentEventLog(const AgentEventLog & other) { *this = other; }
+        AgentEventLog(AgentEventLog &&) = default;
+        ~AgentEventLog() = default;
+
+        AgentEventLog & operator=(const AgentEventLog & other) {
+            if (this == &other) return *this;
+            chunks.clear();
+            for (const auto & chunk : other.chunks) chunks.push_back(std::make_unique<Chunk>(*chunk));
+            num_events = other.num_events;
+            return *this;
+        }
+        AgentEventLog & operator=(AgentEventLog &&) = default;
+
+        /**
+         * @brief Adds an event to the end of the log.
+         * @param agent_id ID of the agent.
+         * @param tick When the sample was taken.
+         * @param pos Where the agent was.
+         * @param action The action the agent last took.
+         * @param result The result of that action.
+         */
+        void Append(size_t agent_id, size_t tick, cse491::GridPosition pos, size_t action, int result) {
+            const size_t offset = num_events % CHUNK_SIZE;
+            if (offset == 0) chunks.push_back(std::make_unique_for_overwrite<Chunk>());
+            Chunk & chunk = *chunks.back();
+            chunk.agent_ids[offset] = agent_id;
+            chunk.ticks[offset] = tick;
+            chunk.xs[offset] = pos.GetX();
+            chunk.ys[offset] = pos.GetY();
+            chunk.actions[offset] = action;
+            chunk.results[offset] = result;
+            ++num_events;
+        }
+
+        /**
+         * @brief Adds an event to the end of the log.
+         * @param event The event to add.
+         */
+        void Append(const AgentEvent & event) {
+            Append(event.agent_id, event.tick, event.position, event.action, event.result);
+        }
+
+        /**
+         * @brief Gets the number of events in the log.
+         * @return The number of events.
+         */
+        [[nodiscard]] size_t GetNumEvents() const { return num_events; }
+
+        /**
+         * @brief Gets the number of chunks allocated for events.
+         * @return The number of chunks.
+         */
+        [[nodiscard]] size_t GetNumChunks() const { return chunks.size(); }
+
+        /**
+         * @brief Checks if the log is empty.
+         * @return True if no events have been stored.
+         */
+        [[nodiscard]] bool IsEmpty() const { return num_events == 0; }
+
+        /**
+         * @brief Retrieves a single event.
+         * @param index Position of the event in the log.
+         * @return The event.
+         */
+        [[nodiscard]] AgentEvent GetEvent(size_t index) const {
+            assert(index < num_events);
+            const Chunk & chunk = *chunks[index / CHUNK_SIZE];
+            const size_t offset = index % CHUNK_SIZE;
+            return AgentEvent{chunk.agent_ids[offset], chunk.ticks[offset],
+                              cse491::GridPosition(chunk.xs[offset], chunk.ys[offset]),
+                              chunk.actions[offset], chunk.results[offset]};
+        }
+
+        /**
+         * @brief Calls a function on every event, in the order they were stored.
+         * @param fun Function taking a const AgentEvent &.
+         */
+        template <typename FUN_T>
+        void ForEachEvent(FUN_T && fun) const {
+            for (size_t i = 0; i < num_events; ++i) fun(GetEvent(i));
+        }
+
+        /**
+         * @brief Calls a function on the index of every event for one agent, reading only the ID column.
+         * @param agent_id ID of the agent.
+         * @param fun Function taking the index of each matching event.
+         */
+        template <typename FUN_T>
+        void ForEachAgentIndex(size_t agent_id, FUN_T && fun) const {
+            for (size_t c = 0; c < chunks.size(); ++c) {
+                const size_t * ids = chunks[c]->agent_ids;
+                const size_t count = (c + 1 < chunks.size()) ? CHUNK_SIZE : num_events - c * CHUNK_SIZE;
+                for (size_t i = 0; i < count; ++i) {
+                    if (ids[i] == agent_id) fun(c * CHUNK_SIZE + i);
+                }
+            }
+        }
+
+        /**
+         * @brief Reconstructs the path one agent took.
+         * @param agent_id ID of the agent.
+         * @return The agent's positions, in the order they were stored.
+         */
+        [[nodiscard]] std::vector<cse491::GridPosition> GetTrajectory(size_t agent_id) const {
+            std::vector<cse491::GridPosition> trajectory;
+            ForEachAgentIndex(agent_id, [this, &trajectory](size_t index) {
+                const Chunk & chunk = *chunks[index / CHUNK_SIZE];
+                const size_t offset = index % CHUNK_SIZE;
+                trajectory.emplace_back(chunk.xs[offset], chunk.ys[offset]);
+            });
+            return trajectory;
+        }
+
+        /**
+         * @brief Retrieves every event for one agent.
+         * @param agent_id ID of the agent.
+         * @return The agent's events, in the order they were stored.
+         */
+        [[nodiscard]] std::vector<AgentEvent> GetAgentEvents(size_t agent_id) const {
+            std::vector<AgentEvent> events;
+            ForEachAgentIndex(agent_id, [this, &events](size_t index) { events.push_back(GetEvent(index)); });
+            return events;
+        }
+
+        /**
+         * @brief Removes all events.
+         */
+        void Clear() {
+            chunks.clear();
+            num_events = 0;
+        }
+    };
+} // namespace DataCollection
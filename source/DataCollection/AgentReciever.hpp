@@ -1,7 +1,12 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "DataReceiver.hpp"
 #include "AgentData.hpp"
+#include "AgentEventLog.hpp"
 
 namespace DataCollection {
 
@@ -10,28 +15,64 @@ namespace DataCollection {
      *
      * This class extends DataReceiver class and provides specific functionality
      * for storing AgentData objects along with grid positions and last action IDs.
+     * Every sample is appended to an AgentEventLog, so storing one costs the same
+     * no matter how much history has already been collected.
      */
     class AgentReceiver : public DataReceiver<AgentData> {
     private:
         std::unordered_map<std::string, std::shared_ptr<AgentData>> agent_map;
+        std::unordered_map<std::string, size_t> agent_ids;  ///< IDs given to agents stored by name.
+        AgentEventLog event_log;  ///< Every sample stored, in order.
 
     public:
         /**
          * @brief Stores a grid position and last action ID associated with an agent.
          *
+         * Agents stored this way are given IDs in the order they first appear, and each
+         * sample's tick is the number of samples already stored for that agent.
+         * @param name The name of the agent.
          * @param pos The grid position to be stored.
          * @param last_action The last action ID associated with the agent.
          */
-        void StoreData(std::string name, cse491::GridPosition pos, [[maybe_unused]] int last_action) {
+        void StoreData(const std::string & name, cse491::GridPosition pos, int last_action) {
             std::shared_ptr<AgentData> agent = GetAgent(name);
+            const size_t tick = agent->GetPositionSize();
             agent->StorePositions(pos);
-//            agent->StoreAction(last_action);
-            StoreIntoStorage(*agent);
+            event_log.Append(agent_ids[name], tick, pos, static_cast<size_t>(last_action), 0);
+        }
+
+        /**
+         * @brief Stores a full sample for an agent, as collected by the world each tick.
+         * @param agent_id ID of the agent.
+         * @param tick When the sample was taken.
+         * @param pos The grid position of the agent.
+         * @param action The action the agent last took.
+         * @param result The result of that action.
+         */
+        void StoreEvent(size_t agent_id, size_t tick, cse491::GridPosition pos, size_t action, int result) {
+            event_log.Append(agent_id, tick, pos, action, result);
+        }
+
+        /**
+         * @brief Retrieves every sample stored so far.
+         * @return Reference to the event log.
+         */
+        const AgentEventLog & GetEventLog() const {
+            return event_log;
+        }
+
+        /**
+         * @brief Checks if any samples have been stored.
+         * @return True if no samples have been stored.
+         */
+        bool IsEmpty() override {
+            return event_log.IsEmpty();
         }
 
         void AddAgent(const std::string& name) {
             AgentData agent(name);
             agent_map[name] = std::make_shared<AgentData>(agent);
+            agent_ids.emplace(name, agent_ids.size());
         }
 
         std::shared_ptr<AgentData> GetAgent(const std::string& name)
@@ -45,8 +86,18 @@ namespace DataCollection {
             }
         }
 
+        /**
+         * @brief Gets the ID used in the event log for an agent stored by name.
+         * @param name The name of the agent.
+         * @return The agent's ID.
+         */
+        size_t GetAgentID(const std::string& name) {
+            GetAgent(name);
+            return agent_ids[name];
+        }
+
         AgentData GetAgentData(const std::string& name) {
             return *agent_map[name];
         }
     };
-} // namespace DataCollection
\ No newline at end of file
+} // namespace DataCollection
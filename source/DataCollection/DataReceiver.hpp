@@ -42,7 +42,7 @@ namespace DataCollection {
          * @brief Checks if the storage is empty.
          * @return True if the storage is empty, false otherwise.
          */
-        bool IsEmpty() {
+        virtual bool IsEmpty() {
             return storage.empty();
         }
 
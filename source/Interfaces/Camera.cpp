@@ -0,0 +1,95 @@
+/**
+ * @author : Team - 3
+ * @date: 12/06/2023
+ * Camera decides which part of the world is on screen, following the player and zooming
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "Camera.hpp"
+
+namespace i_2D {
+
+    /**
+     * @brief Zooms in (factor above 1) or out (below 1), within MIN_ZOOM and MAX_ZOOM
+     *
+     * @param factor how much larger cells should be drawn
+     */
+    void Camera::Zoom(float factor) {
+        mZoom = std::clamp(mZoom * factor, MIN_ZOOM, MAX_ZOOM);
+    }
+
+    /**
+     * @brief Keeps a center point from showing past the edges of the world
+     *
+     * @param center    wanted world position at the middle of the screen
+     * @param worldSize size of the world in cells
+     * @return the nearest center that keeps the world's edges off screen, or the world's middle
+     *         along any axis where the whole world fits on screen
+     */
+    sf::Vector2f Camera::Clamp(sf::Vector2f center, sf::Vector2f worldSize) const {
+        const float halfWidth = mViewSize.x / GetCellSize() / 2;
+        const float halfHeight = mViewSize.y / GetCellSize() / 2;
+        center.x = worldSize.x <= 2 * halfWidth ? worldSize.x / 2
+                                                : std::clamp(center.x, halfWidth, worldSize.x - halfWidth);
+        center.y = worldSize.y <= 2 * halfHeight ? worldSize.y / 2
+                                                 : std::clamp(center.y, halfHeight, worldSize.y - halfHeight);
+        return center;
+    }
+
+    /**
+     * @brief Eases the camera toward a world position
+     *
+     * @param target    world position to bring to the middle of the screen
+     * @param worldSize size of the world in cells
+     * @param seconds   time since the last call
+     */
+    void Camera::Follow(sf::Vector2f target, sf::Vector2f worldSize, float seconds) {
+        const sf::Vector2f offset = target - mCenter;
+        if (!mPlaced || std::abs(offset.x) > MAX_EASE_DISTANCE || std::abs(offset.y) > MAX_EASE_DISTANCE) {
+            JumpTo(target, worldSize);
+            return;
+        }
+        const float step = std::min(1.0f, mFollowRate * seconds);
+        mCenter = Clamp(mCenter + offset * step, worldSize);
+    }
+
+    /**
+     * @brief Moves the camera straight to a world position
+     *
+     * @param target    world position to bring to the middle of the screen
+     * @param worldSize size of the world in cells
+     */
+    void Camera::JumpTo(sf::Vector2f target, sf::Vector2f worldSize) {
+        mCenter = Clamp(target, worldSize);
+        mPlaced = true;
+    }
+
+    /**
+     * @brief Finds the cells that are at least partly on screen
+     *
+     * @param worldSize size of the world in cells
+     * @return the visible cells, never reaching outside the world
+     */
+    CellRect Camera::GetVisibleCells(sf::Vector2i worldSize) const {
+        const float halfWidth = mViewSize.x / GetCellSize() / 2;
+        const float halfHeight = mViewSize.y / GetCellSize() / 2;
+        const int left = std::max(0, static_cast<int>(std::floor(mCenter.x - halfWidth)));
+        const int top = std::max(0, static_cast<int>(std::floor(mCenter.y - halfHeight)));
+        const int right = std::min(worldSize.x, static_cast<int>(std::ceil(mCenter.x + halfWidth)));
+        const int bottom = std::min(worldSize.y, static_cast<int>(std::ceil(mCenter.y + halfHeight)));
+        return {left, top, std::max(0, right - left), std::max(0, bottom - top)};
+    }
+
+    /**
+     * @brief Converts a world position to a position on screen
+     *
+     * @param cell world position, in cells
+     * @return pixel position relative to the top-left of the screen
+     */
+    sf::Vector2f Camera::CellToScreen(sf::Vector2f cell) const {
+        return (cell - mCenter) * GetCellSize() + mViewSize / 2.0f;
+    }
+
+} // End of namespace i_2D
@@ -0,0 +1,79 @@
+/**
+ * @author : Team - 3
+ * @date: 12/06/2023
+ * Camera decides which part of the world is on screen, following the player and zooming
+ */
+
+#pragma once
+
+#include "SFML/Graphics.hpp"
+
+namespace i_2D {
+
+    /**
+     * @brief A block of whole grid cells: columns [left, left + width) and rows [top, top + height)
+     */
+    struct CellRect {
+        int left = 0;
+        int top = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    /**
+     * @class Camera
+     *
+     * @brief Tracks the point of the world at the middle of the screen and how large cells are drawn.
+     *
+     * Positions are in cells, with (0, 0) the top-left corner of the grid.  The camera eases
+     * toward the cell it follows and never shows past the edges of the world; a world smaller
+     * than the screen is centered instead.
+     */
+    class Camera {
+    private:
+        sf::Vector2f mCenter;          ///< world position at the middle of the screen
+        sf::Vector2f mViewSize;        ///< size of the screen in pixels
+        float mBaseCellSize = 32;      ///< pixels per cell before the player's zoom
+        float mZoom = 1;               ///< zoom chosen by the player
+        float mFollowRate = 12;        ///< fraction of the way to the target covered per second
+        bool mPlaced = false;          ///< has the camera been pointed anywhere yet?
+
+        sf::Vector2f Clamp(sf::Vector2f center, sf::Vector2f worldSize) const;
+
+    public:
+        static constexpr float MIN_ZOOM = 0.25f; ///< furthest the player may zoom out
+        static constexpr float MAX_ZOOM = 4.0f;  ///< furthest the player may zoom in
+        static constexpr float MAX_EASE_DISTANCE = 8; ///< cells; further jumps (e.g. teleports) snap
+
+        Camera() = default;
+
+        /// @param size size of the screen in pixels
+        void SetViewSize(sf::Vector2f size) { mViewSize = size; }
+
+        /// @param cellSize pixels per cell at a zoom of 1
+        void SetBaseCellSize(float cellSize) { mBaseCellSize = cellSize; }
+
+        void Zoom(float factor);
+
+        /// @brief Go back to the default zoom
+        void ResetZoom() { mZoom = 1; }
+
+        /// @return zoom chosen by the player
+        float GetZoom() const { return mZoom; }
+
+        /// @return pixels per cell on screen
+        float GetCellSize() const { return mBaseCellSize * mZoom; }
+
+        /// @return world position at the middle of the screen
+        sf::Vector2f GetCenter() const { return mCenter; }
+
+        void Follow(sf::Vector2f target, sf::Vector2f worldSize, float seconds);
+
+        void JumpTo(sf::Vector2f target, sf::Vector2f worldSize);
+
+        CellRect GetVisibleCells(sf::Vector2i worldSize) const;
+
+        sf::Vector2f CellToScreen(sf::Vector2f cell) const;
+    };
+
+} // End of namespace i_2D
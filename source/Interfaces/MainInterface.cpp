@@ -3,8 +3,11 @@
  * @date: 10/03/2023
  * MainInterface class creates a window and displays the default maze grid
  */
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include "MainInterface.hpp"
+#include "../core/WorldBase.hpp"
 
 namespace i_2D {
 
@@ -33,137 +36,201 @@ namespace i_2D {
     }
 
     /**
-     * @brief Creates a vector representation of the maze grid.
+     * @brief Calculates the size of each cell, before zoom, based on the window size and grid dimensions.
+     *
+     * The large view fits a 9x23 window of cells on screen; otherwise the whole grid is fitted, but
+     * cells never shrink below MIN_SIZE_CELL, so on a large world the camera shows only part of it.
+     *
+     * @param gridWidth  Number of columns in the grid.
+     * @param gridHeight Number of rows in the grid.
+     * @return sf::Vector2f The size of each cell as a 2D vector.
+     */
+    sf::Vector2f MainInterface::CalculateCellSize(size_t gridWidth, size_t gridHeight) {
+        float cellSizeWide, cellSizeTall;
+        if (mGridSizeLarge) {
+            cellSizeWide = mWindow.getSize().x / COL;
+            cellSizeTall = mWindow.getSize().y / ROW;
+        } else {
+            cellSizeWide = mWindow.getSize().x / std::max<size_t>(gridWidth, 1);
+            cellSizeTall = mWindow.getSize().y / std::max<size_t>(gridHeight, 1);
+        }
+
+        float cellSize = std::max(std::min(cellSizeWide, cellSizeTall), MIN_SIZE_CELL);
+        return sf::Vector2f(cellSize, cellSize);
+    }
+
+    /**
+     * @brief Fills mVisibleSymbols with the cells of a window of a snapshot.
+     *
+     * Only the grid is copied; agents and items are drawn separately, since they may be between cells.
+     *
+     * @param snapshot The world as last published.
+     * @param cells    The window of cells to copy.
+     */
+    void MainInterface::CreateVisibleSymbols(const RenderSnapshot &snapshot, const CellRect &cells) {
+        mVisibleSymbols.resize(static_cast<size_t>(cells.width) * cells.height);
+        for (int y = 0; y < cells.height; ++y) {
+            const auto row = snapshot.cells.begin() + (cells.top + y) * snapshot.width + cells.left;
+            std::copy(row, row + cells.width, mVisibleSymbols.begin() + y * cells.width);
+        }
+    }
+
+    /**
+     * @brief Publishes the world as it is now and starts the render thread.
+     *
+     * The snapshot buffer is given to the world too, so from here on the world publishes
+     * a new snapshot at the end of every tick.
      *
      * @param grid         The WorldGrid representing the maze.
      * @param type_options The type options for symbols.
      * @param item_map     The map of ids to items in the maze.
      * @param agent_map    The map of ids to agents in the maze.
-     *
-     * @return A vector of strings representing the maze grid.
      */
-    std::vector<std::string> MainInterface::CreateVectorMaze(
-
-            const WorldGrid &grid, const type_options_t &type_options,
-            const item_map_t &item_map, const agent_map_t &agent_map) {
-        std::vector<std::string> symbol_grid(grid.GetHeight());
-        mGridHeight = grid.GetHeight();
-        mGridWidth = grid.GetWidth();
-        // Load the world into the symbol_grid;
-        for (size_t y = 0; y < grid.GetHeight(); ++y) {
-            symbol_grid[y].resize(grid.GetWidth());
-            for (size_t x = 0; x < grid.GetWidth(); ++x) {
-                symbol_grid[y][x] = type_options[grid.At(x, y)].symbol;
-            }
+    void MainInterface::StartRendering(const WorldGrid &grid, const type_options_t &type_options,
+                                       const item_map_t &item_map, const agent_map_t &agent_map) {
+        mSnapshots = std::make_shared<RenderSnapshotBuffer>(GetID());
+        mSnapshots->Publish(grid, type_options, item_map, agent_map, nullptr);
+        if (HasWorld()) {
+            GetWorld().AddRenderSnapshots(mSnapshots);
         }
 
-        // Add in the entities
-        for (const auto &[id, item_ptr]: item_map) {
-            GridPosition pos = item_ptr->GetPosition();
-            char c = '+';
-            if (item_ptr->HasProperty("symbol")) {
-                c = item_ptr->GetProperty<char>("symbol");
-            }
-            symbol_grid[pos.CellY()][pos.CellX()] = c;
-        }
+        // The window can only be active on one thread at a time
+        mWindow.setActive(false);
+        mRendering = true;
+        mRenderThread = std::thread(&MainInterface::RenderLoop, this);
+    }
 
-        // Add in the agents
-        for (const auto &[id, agent_ptr]: agent_map) {
-            GridPosition pos = agent_ptr->GetPosition();
-            char c = '*';
-            if (agent_ptr->HasProperty("symbol")) {
-                c = agent_ptr->GetProperty<char>("symbol");
-            }
-            symbol_grid[pos.CellY()][pos.CellX()] = c;
+    /**
+     * @brief Stops the render thread, if it is running, and waits for its last frame.
+     */
+    void MainInterface::StopRendering() {
+        mRendering = false;
+        if (mRenderThread.joinable()) {
+            mRenderThread.join();
         }
-        return symbol_grid;
     }
 
     /**
-     * @brief Calculates the size of each cell based on the window size and grid dimensions.
-     *
-     * @param grid The WorldGrid representing the maze.
-     * @return sf::Vector2f The size of each cell as a 2D vector.
+     * @brief Draws frames at RENDER_RATE until StopRendering() is called (runs on the render thread).
      */
-    sf::Vector2f MainInterface::CalculateCellSize(const WorldGrid &grid) {
-        float cellSizeWide, cellSizeTall;
-        if (mGridSizeLarge) {
-            cellSizeWide = mWindow.getSize().x / COL;
-            cellSizeTall = mWindow.getSize().y / ROW;
-        } else {
-            cellSizeWide = mWindow.getSize().x / grid.GetWidth();
-            cellSizeTall = mWindow.getSize().y / grid.GetHeight();
-        }
+    void MainInterface::RenderLoop() {
+        mWindow.setActive(true);
+        mFrameClock.restart();
+        mFrameScheduler.ResetStats();
+        mFrameScheduler.Run([this]() { DrawFrame(); }, [this]() { return !mRendering; });
+        mWindow.setActive(false);
+    }
 
-        float cellSize = std::min(cellSizeWide, cellSizeTall);
-        return sf::Vector2f(cellSize, cellSize);
+    /**
+     * @brief Draws one frame from the newest snapshot, with the menu and messages over it.
+     */
+    void MainInterface::DrawFrame() {
+        // Smooth the frame time so the overlay is readable
+        float lastFrame = mFrameClock.restart().asSeconds();
+        mFrameTime = mFrameTime == 0 ? lastFrame : mFrameTime * 0.95f + lastFrame * 0.05f;
+
+        mSnapshots->Acquire();
+        const RenderSnapshot &snapshot = mSnapshots->Read();
+
+        {
+            std::lock_guard lock(mUiMutex);
+
+            // Clear old drawing
+            mWindow.clear(sf::Color::White);
+
+            DrawTimer();
+            DrawHealthInfo();
+            DrawGrid(snapshot, lastFrame);
+
+            // Display everything
+            mTextBox->DrawTo(mWindow);
+            mMessageBoard->DrawTo(mWindow);
+            mMenu.drawto(mWindow);
+            if (mShowFrameStats) {
+                DrawFrameStats();
+            }
+        }
+        mWindow.display();
     }
 
     /**
     * @brief Draws the maze grid and entities on the SFML window.
     *
-    * @param grid         The WorldGrid representing the maze.
-    * @param type_options The type options for symbols.
-    * @param item_map     The map of ids to items in the maze.
-    * @param agent_map    The map of ids to agents in t
+    * Only the cells and entities the camera shows are gathered, so the cost follows the window
+    * size rather than the world size, and the tile renderer rewrites just the cells that changed
+    * since the last frame before drawing them in one call per layer.  Agents and items are drawn
+    * part of the way from where they were in the previous snapshot to where they are now.
+    *
+    * @param snapshot The world as last published.
+    * @param seconds  Time since the last frame.
     */
-    void MainInterface::DrawGrid(const WorldGrid &grid, const type_options_t &type_options, const item_map_t &item_map,
-                                 const agent_map_t &agent_map) {
-        // Clear old drawing
-        mWindow.clear(sf::Color::White);
-
-        // Check player's position
-        mPlayerPosition = sf::Vector2i(this->position.GetX(), this->position.GetY());
-
-        // Create grid of symbols representing the world
-        std::vector<std::string> symbol_grid;
-        std::vector<std::string> default_grid = CreateVectorMaze(grid, type_options, item_map, agent_map);
+    void MainInterface::DrawGrid(const RenderSnapshot &snapshot, float seconds) {
+        if (snapshot.tick == 0 || snapshot.width == 0 || snapshot.height == 0) {
+            return;
+        }
+        const double progress = snapshot.Progress(RenderSnapshot::clock_t::now(), MAX_MOVE_TIME);
 
-        // Determine cell size
-        sf::Vector2f cellSize = CalculateCellSize(grid);
-        float drawSpaceWidth, drawSpaceHeight, drawCenterX, drawCenterY;
-        CalculateDrawSpace(grid, cellSize.x, drawSpaceWidth,
-                           drawSpaceHeight, drawCenterX, drawCenterY);
+        // Apply any zooming asked for since the last frame
+        int zoomSteps = mZoomSteps.exchange(0);
+        if (zoomSteps != 0) {
+            mCamera.Zoom(std::pow(ZOOM_STEP, static_cast<float>(zoomSteps)));
+        }
 
-        if (mGridSizeLarge) {
-            symbol_grid = LargeDisplayGrid(default_grid);
+        // Point the camera at the player and find the cells it shows
+        sf::Vector2f worldSize(static_cast<float>(snapshot.width), static_cast<float>(snapshot.height));
+        mCamera.SetViewSize(mWindow.getView().getSize());
+        mCamera.SetBaseCellSize(CalculateCellSize(snapshot.width, snapshot.height).x);
+        if (snapshot.has_focus) {
+            GridPosition focus = snapshot.focus.Interpolate(progress);
+            mCamera.Follow(sf::Vector2f(focus.GetX() + 0.5f, focus.GetY() + 0.5f), worldSize, seconds);
         } else {
-            symbol_grid = default_grid;
+            mCamera.Follow(worldSize / 2.0f, worldSize, seconds);
         }
+        CellRect cells = mCamera.GetVisibleCells(sf::Vector2i(static_cast<int>(snapshot.width),
+                                                              static_cast<int>(snapshot.height)));
+
+        CreateVisibleSymbols(snapshot, cells);
+        mTileRenderer.Update(mVisibleSymbols, cells.left, cells.top, cells.width, cells.height, mCamera.GetCellSize());
+
+        // Entities may be gliding in from just off screen, so look one cell past each edge
+        mTileRenderer.ClearEntities();
+        const size_t firstCol = cells.left > 0 ? cells.left - 1 : 0;
+        const size_t firstRow = cells.top > 0 ? cells.top - 1 : 0;
+        const size_t lastCol = static_cast<size_t>(cells.left + cells.width);
+        const size_t lastRow = static_cast<size_t>(cells.top + cells.height);
+        snapshot.ForEachEntityInCells(firstCol, firstRow, lastCol, lastRow, [&](const RenderEntity &entity) {
+            GridPosition pos = entity.Interpolate(progress);
+            float x = static_cast<float>(pos.GetX());
+            float y = static_cast<float>(pos.GetY());
+            if (x <= cells.left - 1 || y <= cells.top - 1 || x >= cells.left + cells.width ||
+                y >= cells.top + cells.height) return;
+            mTileRenderer.AddEntity(sf::Vector2f(x, y), entity.symbol);
+        });
+
+        mTileRenderer.setPosition(mCamera.CellToScreen(sf::Vector2f()));
+        mWindow.draw(mTileRenderer);
+    }
 
-        // Create a render texture to draw the grid
-        sf::RenderTexture renderTexture;
-        renderTexture.create({static_cast<unsigned int>(drawSpaceWidth), static_cast<unsigned int>(drawSpaceHeight)});
-        renderTexture.clear(sf::Color::White);
-
-        for (size_t iterY = 0; iterY < symbol_grid.size(); ++iterY) {
-            for (size_t iterX = 0; iterX < symbol_grid[0].size(); ++iterX) {
-                float cellPosX = static_cast<float>(iterX) * cellSize.x;
-                float cellPosY = static_cast<float>(iterY) * cellSize.y;
-                char symbol = symbol_grid[iterY][iterX];
-
-                sf::RectangleShape cellRect(sf::Vector2f(cellSize.x, cellSize.y));
-                cellRect.setPosition(sf::Vector2f(cellPosX, cellPosY));
-
-                sf::RectangleShape cell(sf::Vector2f(cellSize.x, cellSize.y));
-                cell.setPosition(sf::Vector2f(cellPosX, cellPosY));
-
-                SwitchCellSelect(renderTexture, cellRect, cell, symbol);
-            }
-        }
-        renderTexture.display();
-        DrawTimer();
-        DrawHealthInfo();
-        // Draw the texture to the window
-        sf::Sprite sprite(renderTexture.getTexture());
-        sprite.setPosition({drawCenterX, drawCenterY});
-        mWindow.draw(sprite);
-
-        // Display everything
-        mTextBox->DrawTo(mWindow);
-        mMessageBoard->DrawTo(mWindow);
-        mMenu.drawto(mWindow);
-        mWindow.display();
+    /**
+     * @brief Draws the frame time, frame rate, how long drawing takes, and how many cells the last frame rebuilt
+     */
+    void MainInterface::DrawFrameStats() {
+        using ms = std::chrono::duration<float, std::milli>;
+        TickScheduler::Stats drawStats = mFrameScheduler.GetStats();
+        std::ostringstream stats;
+        stats.precision(2);
+        stats << std::fixed << "Frame: " << mFrameTime * 1000.0f << " ms ("
+              << (mFrameTime > 0 ? 1.0f / mFrameTime : 0.0f) << " FPS)\n"
+              << "Draw p50/p99: " << ms(drawStats.p50).count() << " / " << ms(drawStats.p99).count() << " ms\n"
+              << "Snapshot: " << mSnapshots->Read().tick << "\n"
+              << "Cells rebuilt: " << mTileRenderer.GetCellsRebuilt() << " / " << mTileRenderer.GetCellCount();
+
+        sf::Text statsText(mFont);
+        statsText.setCharacterSize(18);
+        statsText.setPosition({10.0f, 10.0f});
+        statsText.setFillColor(sf::Color::Magenta);
+        statsText.setString(stats.str());
+        mWindow.draw(statsText);
     }
 
     /**
@@ -205,59 +272,6 @@ namespace i_2D {
 //        mWindow.draw(healthText);
     }
 
-    /**
-     * @brief Creates a 9x23 window of the symbol grid centered around the player's position.
-     *
-     * @param symbol_grid   The original symbol grid.
-     * @return              A new symbol grid representing the 9x23 window.
-     */
-    std::vector<std::string> MainInterface::LargeDisplayGrid(const std::vector<std::string> &symbol_grid) {
-        // Determine the top-left corner of the 9x23 window
-        int topLeftX = std::max(0,
-                                std::min(mPlayerPosition.x - COL / 2, static_cast<int>(symbol_grid[0].size()) - COL));
-        int topLeftY = std::max(0, std::min(mPlayerPosition.y - ROW / 2, static_cast<int>(symbol_grid.size()) - ROW));
-
-        // Create a new symbol grid for the 9x23 display window
-        std::vector<std::string> display_grid;
-        for (size_t iterY = 0; iterY < ROW; ++iterY) {
-            std::string row;
-            for (size_t iterX = 0; iterX < COL; ++iterX) {
-                int posX = topLeftX + iterX;
-                int posY = topLeftY + iterY;
-
-                // Copy the symbol from symbol_grid to display_grid
-                row.push_back(symbol_grid[posY][posX]);
-            }
-            display_grid.push_back(row);
-        }
-
-        return display_grid;
-    }
-
-    /**
-     * @brief Calculates the total drawing space based on the grid dimensions and cell size and also the center position of the drawing space.
-     *
-     * @param grid The WorldGrid representing the maze.
-     * @param cellSize The size of each cell in pixels.
-     * @param drawSpaceWidth Reference to the variable to store the total width of the drawing space.
-     * @param drawSpaceHeight Reference to the variable to store the total height of the drawing space.
-     * @param drawCenterX Reference to the variable to store the x-coordinate of the center of the drawing space.
-     * @param drawCenterY Reference to the variable to store the y-coordinate of the center of the drawing space.
-     */
-    void MainInterface::CalculateDrawSpace(const WorldGrid &grid, float cellSize, float &drawSpaceWidth,
-                                           float &drawSpaceHeight, float &drawCenterX, float &drawCenterY) {
-        if (mGridSizeLarge) {
-            drawSpaceWidth = static_cast<float>(COL) * cellSize;
-            drawSpaceHeight = static_cast<float>(ROW) * cellSize;
-        } else {
-            drawSpaceWidth = static_cast<float>(grid.GetWidth()) * cellSize;
-            drawSpaceHeight = static_cast<float>(grid.GetHeight()) * cellSize;
-        }
-
-        drawCenterX = (mWindow.getSize().x - drawSpaceWidth) / 2.0f;
-        drawCenterY = (mWindow.getSize().y - drawSpaceHeight) / 2.0f;
-    }
-
     /**
 
     * @brief Handles user input for selecting actions.
@@ -273,7 +287,21 @@ namespace i_2D {
                                        const agent_map_t &agent_map) {
         // Initialize action_id and timer
         size_t action_id = 0;
-        timer.restart();
+        mGridWidth = grid.GetWidth();
+        mGridHeight = grid.GetHeight();
+        {
+            std::lock_guard lock(mUiMutex);
+            timer.restart();
+        }
+
+        // The render thread draws from snapshots; if the world did not publish one since our
+        // last turn (it has none of its own loop's hooks, or there is no world), publish it here
+        if (!mRendering) {
+            StartRendering(grid, type_options, item_map, agent_map);
+        } else if (mSnapshots->GetPublishCount() == mSnapshotsSeen) {
+            mSnapshots->Publish(grid, type_options, item_map, agent_map, nullptr);
+        }
+        mSnapshotsSeen = mSnapshots->GetPublishCount();
 
         // While the timer is going
         while (mWindow.isOpen() && timer.getElapsedTime().asSeconds() < mInputWaitTime) {
@@ -282,10 +310,13 @@ namespace i_2D {
             // Check through all events generated in this frame
             while (mWindow.pollEvent(event)) {
                 if (event.type == sf::Event::Closed) {
+                    StopRendering();
                     mWindow.close();
                     exit(0);
+                }
 
-                } else if (event.type == sf::Event::TextEntered) {
+                std::lock_guard lock(mUiMutex);
+                if (event.type == sf::Event::TextEntered) {
                     if (mTextBox->IsSelected()) {
                         mTextBox->TypedOn(event);
                     }
@@ -294,7 +325,10 @@ namespace i_2D {
                     action_id = HandleKeyEvent(event);
 
                 } else if (event.type == sf::Event::Resized) {
-                    HandleResize(event, grid);
+                    HandleResize(event);
+
+                } else if (event.type == sf::Event::MouseWheelScrolled) {
+                    mZoomSteps += event.mouseWheelScroll.delta > 0 ? 1 : -1;
 
                 } else if (event.type == sf::Event::MouseMoved) {
                     mMenu.HandleMouseMove(mWindow);
@@ -311,8 +345,8 @@ namespace i_2D {
                 return action_id;
             }
 
-            // Otherwise update the screen drawing again...
-            DrawGrid(grid, type_options, item_map, agent_map);
+            // Otherwise leave the drawing to the render thread and check again shortly
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
         }
         // The timer has ended or the window has been closed
@@ -376,6 +410,19 @@ namespace i_2D {
             case sf::Keyboard::Right:
                 action_id = GetActionID("right");
                 break;
+            case sf::Keyboard::Equal:
+            case sf::Keyboard::Add:
+                if (mTextBox->IsSelected())break;
+                ++mZoomSteps;
+                return 0;
+            case sf::Keyboard::Hyphen:
+            case sf::Keyboard::Subtract:
+                if (mTextBox->IsSelected())break;
+                --mZoomSteps;
+                return 0;
+            case sf::Keyboard::F3:
+                mShowFrameStats = !mShowFrameStats.load();
+                return 0;
             default:
                 break; // The user pressed an unknown key.
         }
@@ -394,20 +441,14 @@ namespace i_2D {
      * Matches the window's view to the new size of the window.
      *
      * @param event The SFML event object containing the resize event information.
-     * @param grid The WorldGrid containing information on the world structure.
      */
-    void MainInterface::HandleResize(const sf::Event &event, const WorldGrid &grid) {
+    void MainInterface::HandleResize(const sf::Event &event) {
         // Check size limits of window
         float widthWindow = event.size.width;
         float heightWindow = event.size.height;
-        float widthMin, heightMin;
-        if (mGridSizeLarge) {
-            widthMin = COL * MIN_SIZE_CELL;
-            heightMin = ROW * MIN_SIZE_CELL;
-        } else {
-            widthMin = grid.GetWidth() * MIN_SIZE_CELL;
-            heightMin = grid.GetHeight() * MIN_SIZE_CELL;
-        }
+        // The camera shows part of a large world, so the window only has to fit the 9x23 view
+        float widthMin = COL * MIN_SIZE_CELL;
+        float heightMin = ROW * MIN_SIZE_CELL;
 
         widthWindow = std::max(widthWindow, widthMin);
         heightWindow = std::max(heightWindow, heightMin);
@@ -460,6 +501,11 @@ namespace i_2D {
             mTexturesCurrent = mTexturesGenerativeWorld;
         }
 
+        // Every world draws from the one atlas, so each grid layer is a single draw call
+        mTileRenderer.SetAtlas(mTextureHolder.GetAtlas(), mTexturesCurrent, mTextureHolder.GetBlankRegion());
+        if (GetName() == "Interface") {
+            mTileRenderer.SetTint('+', sf::Color::Green);
+        }
     }
 
     /**
@@ -491,57 +537,6 @@ namespace i_2D {
         }
     }
 
-    /**
-    * This is a helper function for DrawGrid. jsut using the switch statement to draw the grids
-    * @param cellRect - cell for texture
-    * @param cell  - cell for the solid
-    * @param symbol  - symbol of the cell
-    * @param renderTexture  - Texture for teh whole grid
-    */
-    void MainInterface::SwitchCellSelect(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect,
-                                         sf::RectangleShape &cell, char symbol) {
-        switch (symbol) {
-            case '#':
-                DrawWall(renderTexture, cellRect, mTexturesCurrent[symbol]);
-                break;
-            default:
-                DrawAgentCell(renderTexture, cellRect, cell, mTexturesCurrent[symbol]);
-                break;
-        }
-    }
-
-    /**
-     * @brief Draw the cell with Agent texture and specified color.
-     * @param cellRect The rectangle shape of the cell.
-     * @param cell The rectangle shape for the cell.
-     * @param agent The agent texture.
-     * @param renderTexture The Texture for the whole grid.
-     */
-    void MainInterface::DrawAgentCell(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect,
-                                      sf::RectangleShape &cell, sf::Texture &agent) {
-        cellRect.setTexture(&agent);
-        cell.setTexture(&mTexturesCurrent[' ']);
-        if (&agent == &mTexturesCurrent['+'] and GetName() == "Interface") {
-            cellRect.setFillColor(sf::Color::Green);
-        }
-        renderTexture.draw(cell);
-        renderTexture.draw(cellRect);
-    }
-
-    /**
-     * @brief Draw the wall texture based on the provided parameters.
-     *
-     * @param cellRect The rectangle shape of the cell.
-     * @param wallTexture The texture for the wall.
-     * @param renderTexture The Texture for the whole grid
-    */
-
-    void
-    MainInterface::DrawWall(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect, sf::Texture &wallTexture) {
-        cellRect.setTexture(&wallTexture);
-        renderTexture.draw(cellRect);
-    }
-
     void MainInterface::setMInputWaitTime(double waitTime) {
         MainInterface::mInputWaitTime = waitTime;
     }
@@ -13,11 +13,19 @@
 #include <sstream>
 #include "Button.hpp"
 #include "Menu.hpp"
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "../core/Data.hpp"
 #include "../core/InterfaceBase.hpp"
+#include "../core/RenderSnapshot.hpp"
+#include "../core/TickScheduler.hpp"
 #include "TextureHolder.hpp"
+#include "TileRenderer.hpp"
+#include "Camera.hpp"
 #include "TextBox.hpp"
 #include "MessageBoard.h"
 
@@ -35,6 +43,11 @@ namespace i_2D {
     * This class inherits from `InterfaceBase` and provides functionality
     * for creating and displaying a 2D maze game world, handling user input,
     * and updating the graphical representation of the game.
+    *
+    * The window is drawn by its own thread, from snapshots the world publishes
+    * at the end of each tick, so frames keep coming while the world waits on a
+    * turn and agents glide between cells instead of jumping.  The world's thread
+    * still polls the window's events, as SFML requires.
     */
     class MainInterface : public virtual InterfaceBase {
 
@@ -42,6 +55,17 @@ namespace i_2D {
 
         sf::RenderWindow mWindow; ///< render window
         float const MIN_SIZE_CELL = 16; ///< Pixels
+        float const ZOOM_STEP = 1.1f; ///< zoom factor per wheel notch or +/- key press
+        double const RENDER_RATE = 60; ///< frames per second drawn by the render thread
+        std::chrono::milliseconds const MAX_MOVE_TIME{150}; ///< longest an agent takes to glide one step
+
+        // Render thread vars
+        std::shared_ptr<RenderSnapshotBuffer> mSnapshots; ///< world state handed to the render thread
+        size_t mSnapshotsSeen = 0; ///< snapshots published by the time of the last SelectAction
+        std::thread mRenderThread; ///< draws the window
+        std::atomic<bool> mRendering = false; ///< should the render thread keep drawing?
+        std::mutex mUiMutex; ///< guards the menu, text box, message board, and view shared by both threads
+        TickScheduler mFrameScheduler{RENDER_RATE, TickScheduler::CatchUp::Skip}; ///< paces the render thread and times its frames
 
         // Menu and message vars
         Menu mMenu; ///< for menu class
@@ -51,15 +75,23 @@ namespace i_2D {
 
         // Texture vars
         TextureHolder mTextureHolder; ///< for the texture holder
-        std::map<char, sf::Texture> mTexturesDefault;
-        std::map<char, sf::Texture> mTexturesSecondWorld;
-        std::map<char, sf::Texture> mTexturesManualWorld;
-        std::map<char, sf::Texture> mTexturesGenerativeWorld;
-        std::map<char, sf::Texture> mTexturesCurrent;
+        std::map<char, TextureRegion> mTexturesDefault;
+        std::map<char, TextureRegion> mTexturesSecondWorld;
+        std::map<char, TextureRegion> mTexturesManualWorld;
+        std::map<char, TextureRegion> mTexturesGenerativeWorld;
+        std::map<char, TextureRegion> mTexturesCurrent; ///< regions of the shared atlas, by symbol
+
+        // Grid drawing vars
+        Camera mCamera; ///< which part of the world is on screen
+        TileRenderer mTileRenderer; ///< batches the visible cells into vertex arrays
+        std::vector<char> mVisibleSymbols; ///< symbols of the visible cells, row by row
+        sf::Clock mFrameClock; ///< time since the last frame
+        float mFrameTime = 0; ///< smoothed seconds per frame
+        std::atomic<bool> mShowFrameStats = false; ///< draw the frame-time overlay (toggled with F3)
+        std::atomic<int> mZoomSteps = 0; ///< zoom steps asked for since the last frame (negative zooms out)
 
         // Render range vars
-        sf::Vector2i mPlayerPosition = sf::Vector2i(0,0); ///< xy world grid location of the player
-        bool mGridSizeLarge = false;
+        std::atomic<bool> mGridSizeLarge = false;
         int const ROW = 9;
         int const COL = 23;
 
@@ -75,19 +107,22 @@ namespace i_2D {
         MainInterface(size_t id, const std::string &name) ;
 
         /**
-         * @brief Destructor for the `MainInterface` class.
+         * @brief Destructor for the `MainInterface` class; stops the render thread.
          */
-        ~MainInterface() = default;
+        ~MainInterface() { StopRendering(); }
+
+        void CreateVisibleSymbols(const RenderSnapshot &snapshot, const CellRect &cells);
+
+        void StartRendering(const WorldGrid &grid, const type_options_t &type_options,
+                            const item_map_t &item_map, const agent_map_t &agent_map);
 
+        void StopRendering();
 
-        std::vector<std::string> CreateVectorMaze(
-                const WorldGrid &grid,
-                const type_options_t &type_options,
-                const item_map_t &item_map,
-                const agent_map_t &agent_map) ;
+        void RenderLoop();
 
-        void DrawGrid(const WorldGrid &grid, const type_options_t &type_options,
-                      const item_map_t &item_map, const agent_map_t &agent_map);
+        void DrawFrame();
+
+        void DrawGrid(const RenderSnapshot &snapshot, float seconds);
 
         /**
          * @brief Initializes the main interface.
@@ -104,12 +139,9 @@ namespace i_2D {
 
         size_t HandleKeyEvent(const sf::Event &event);
 
-        void CalculateDrawSpace(const WorldGrid &grid, float cellSize, float &drawSpaceWidth, float &drawSpaceHeight,
-                                float &drawCenterX, float &drawCenterY);
-
-        sf::Vector2f CalculateCellSize(const WorldGrid &grid);
+        sf::Vector2f CalculateCellSize(size_t gridWidth, size_t gridHeight);
 
-        void HandleResize(const sf::Event &event, const WorldGrid &grid);
+        void HandleResize(const sf::Event &event);
 
         void ChooseTexture();
 
@@ -117,24 +149,16 @@ namespace i_2D {
                     const std::string & /*msg_type*/="none") override
         {
             std::cout << message << std::endl;
+            std::lock_guard lock(mUiMutex);
             mMessageBoard->Send(message);
         }
-        std::vector<std::string> LargeDisplayGrid(const std::vector<std::string> &symbol_grid);
-
         void MouseClickEvent(const sf::Event &event);
 
-        void DrawAgentCell(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect, sf::RectangleShape &cell,
-                           sf::Texture &agent);
-
-        void
-        SwitchCellSelect(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect, sf::RectangleShape &cell,
-                         char symbol);
-
-        void DrawWall(sf::RenderTexture &renderTexture, sf::RectangleShape &cellRect, sf::Texture &wallTexture);
-
         void DrawTimer();
 
         void DrawHealthInfo();
+
+        void DrawFrameStats();
     };
 
 } // End of namespace 2D
@@ -0,0 +1,110 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A small LZ77 byte compressor for payloads sent over the network
+ * @note Status: PROTOTYPE
+ *
+ * Stream layout (lengths and offsets are LEB128 varints):
+ *   repeated: literal count, the literal bytes, then (match length - MIN_MATCH + 1, offset back
+ *   into the output); a match length of zero ends the stream after its literals.
+ **/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace netWorth::compression {
+
+    constexpr size_t MIN_MATCH = 4;             ///Shortest repeat worth encoding as a match
+    constexpr size_t MAX_OFFSET = 1 << 16;      ///Furthest back a match may start
+    constexpr size_t HASH_BITS = 15;            ///Size of the table of recent positions
+
+    inline void appendVarint(std::string & out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline bool readVarint(std::string_view in, size_t & pos, uint64_t & value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            const auto byte = static_cast<uint8_t>(in[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * Compresses bytes; the result is only useful if it is shorter than the input
+     * @param in bytes to compress
+     * @return compressed stream
+     */
+    inline std::string compress(std::string_view in) {
+        std::string out;
+        out.reserve(in.size() / 2 + 16);
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);   // Position + 1 of the last occurrence; 0 if none
+        const auto hashAt = [&in](size_t pos) {
+            uint32_t word = 0;
+            std::memcpy(&word, in.data() + pos, sizeof(word));
+            return (word * 2654435761u) >> (32 - HASH_BITS);
+        };
+
+        size_t anchor = 0, pos = 0;
+        while (pos + MIN_MATCH <= in.size()) {
+            const uint32_t hash = hashAt(pos);
+            const size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET ||
+                std::memcmp(in.data() + candidate - 1, in.data() + pos, MIN_MATCH) != 0) {
+                ++pos;
+                continue;
+            }
+            const size_t from = candidate - 1;
+            size_t length = MIN_MATCH;
+            while (pos + length < in.size() && in[from + length] == in[pos + length]) ++length;
+
+            appendVarint(out, pos - anchor);
+            out.append(in.substr(anchor, pos - anchor));
+            appendVarint(out, length - MIN_MATCH + 1);
+            appendVarint(out, pos - from);
+            pos += length;
+            anchor = pos;
+        }
+        appendVarint(out, in.size() - anchor);
+        out.append(in.substr(anchor));
+        appendVarint(out, 0);
+        return out;
+    }
+
+    /**
+     * Restores bytes made by compress()
+     * @param in compressed stream
+     * @param size number of bytes the stream should expand to
+     * @param out set to the original bytes
+     * @return false if the stream is corrupt or does not expand to exactly size bytes
+     */
+    inline bool decompress(std::string_view in, size_t size, std::string & out) {
+        out.clear();
+        out.reserve(size);
+        size_t pos = 0;
+        uint64_t literals = 0, match = 0, offset = 0;
+        while (true) {
+            if (!readVarint(in, pos, literals) || literals > in.size() - pos || out.size() + literals > size) return false;
+            out.append(in.substr(pos, literals));
+            pos += literals;
+            if (!readVarint(in, pos, match)) return false;
+            if (match == 0) break;
+            const size_t length = match + MIN_MATCH - 1;
+            if (!readVarint(in, pos, offset) || offset == 0 || offset > out.size() || out.size() + length > size) return false;
+            const size_t from = out.size() - offset;
+            for (size_t i = 0; i < length; ++i) out.push_back(out[from + i]);   // Matches may overlap themselves
+        }
+        return pos == in.size() && out.size() == size;
+    }
+} // End of namespace netWorth::compression
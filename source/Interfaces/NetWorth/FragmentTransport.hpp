@@ -0,0 +1,451 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Sends payloads too large for one datagram (such as a whole world) as numbered fragments
+ * @note Status: PROTOTYPE
+ *
+ * Packet layout (fixed-width integers):
+ *   Fragment  kind byte (FRAGMENT), transfer ID (uint32), flags byte, round (uint32),
+ *             fragment index (uint32), fragment count (uint32), payload size before compression
+ *             (uint32), then the fragment's bytes.
+ *   Status    kind byte (STATUS), transfer ID, round being answered, count of fragments received
+ *             in order from the start, one past the last index this report covers, then a count
+ *             and the index of each missing fragment below that.
+ * The sender sends a window of fragments and flags the last one POLL; the receiver answers a POLL
+ * with a status, and the sender resends only the fragments that status lists as missing.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <SFML/Network/Packet.hpp>
+#include <SFML/Network/SocketSelector.hpp>
+#include <SFML/Network/UdpSocket.hpp>
+#include "Compression.hpp"
+
+namespace netWorth{
+
+    namespace transport {
+        constexpr uint8_t FRAGMENT = 3;      ///Kind byte of a packet holding one fragment
+        constexpr uint8_t STATUS = 4;        ///Kind byte of a packet reporting which fragments arrived
+
+        constexpr uint8_t COMPRESSED = 1;    ///Flag: the fragments join into a compressed stream
+        constexpr uint8_t POLL = 2;          ///Flag: the receiver should answer with a status now
+
+        constexpr size_t HEADER_SIZE = 22;   ///Bytes in a fragment packet before the fragment's bytes
+        constexpr size_t MAX_MISSING = 256;  ///Most missing fragments listed in one status
+    }
+
+    /**
+     * Settings shared by both ends of a transfer
+     */
+    struct TransportConfig {
+        size_t fragment_size = 1200;         ///Payload bytes per fragment; keeps each datagram under a 1280-byte MTU
+        size_t window = 64;                  ///Fragments sent between polls
+        bool compress = true;                ///Compress the payload when that makes it smaller
+        size_t max_payload = size_t(1) << 28; ///Largest payload a receiver will accept
+        std::chrono::milliseconds status_timeout{100};   ///How long the sender waits for a status before probing
+        size_t max_silent = 30;              ///Probes in a row with no answer before the sender gives up
+        std::chrono::milliseconds linger{400};           ///How long a finished receiver keeps answering repeats
+        std::chrono::milliseconds deadline{30000};       ///Longest a whole transfer may take
+    };
+
+    /**
+     * Sending end of one transfer: splits a payload into fragments and decides which to send next
+     * Knows nothing about sockets, so it can be driven by sendPayload() or by a test harness.
+     */
+    class FragmentSender {
+    private:
+        TransportConfig m_config;
+        uint32_t m_transfer_id;
+        uint8_t m_flags = 0;
+        uint32_t m_payload_size;            ///Size of the payload before compression
+        std::string m_body;                 ///Bytes actually sent (compressed or not)
+        uint32_t m_fragment_count;
+
+        std::vector<bool> m_acked;          ///Fragments the receiver has reported
+        std::vector<bool> m_queued;         ///Fragments waiting in m_resend
+        std::vector<uint32_t> m_resend;     ///Fragments reported missing, to send again
+        size_t m_num_acked = 0;
+        uint32_t m_next_new = 0;            ///First fragment never sent
+        uint32_t m_round = 0;               ///Number of the last burst sent
+        uint32_t m_answered_round = 0;      ///Newest round a status has answered
+        bool m_probe = false;               ///Did the last round go unanswered?
+        size_t m_silent = 0;                ///Unanswered rounds in a row
+        size_t m_fragments_sent = 0;
+        size_t m_resent = 0;
+
+        void markAcked(uint32_t index) {
+            if (index >= m_fragment_count || m_acked[index]) return;
+            m_acked[index] = true;
+            ++m_num_acked;
+        }
+
+        [[nodiscard]] sf::Packet fragmentPacket(uint32_t index, bool poll) const {
+            sf::Packet pkt;
+            pkt << transport::FRAGMENT << m_transfer_id << static_cast<uint8_t>(m_flags | (poll ? transport::POLL : 0));
+            pkt << m_round << index << m_fragment_count << m_payload_size;
+            const size_t begin = static_cast<size_t>(index) * m_config.fragment_size;
+            const size_t length = std::min(m_config.fragment_size, m_body.size() - begin);
+            pkt.append(m_body.data() + begin, length);
+            return pkt;
+        }
+
+    public:
+        /**
+         * Constructor
+         * @param transferID identifies this transfer to the receiver
+         * @param payload bytes to send
+         * @param config fragment size, window, and compression settings
+         */
+        FragmentSender(uint32_t transferID, std::string_view payload, const TransportConfig & config = {})
+            : m_config(config), m_transfer_id(transferID), m_payload_size(static_cast<uint32_t>(payload.size())) {
+            if (m_config.fragment_size == 0) m_config.fragment_size = 1;
+            if (m_config.window == 0) m_config.window = 1;
+            if (m_config.compress) {
+                std::string compressed = compression::compress(payload);
+                if (compressed.size() < payload.size()) {
+                    m_body = std::move(compressed);
+                    m_flags |= transport::COMPRESSED;
+                }
+            }
+            if (!(m_flags & transport::COMPRESSED)) m_body.assign(payload);
+            const size_t count = std::max<size_t>(1, (m_body.size() + m_config.fragment_size - 1) / m_config.fragment_size);
+            m_fragment_count = static_cast<uint32_t>(count);
+            m_acked.assign(count, false);
+            m_queued.assign(count, false);
+        }
+
+        /**
+         * Builds the next burst: fragments reported missing first, then ones never sent.  The last
+         * fragment of every burst asks for a status.  After an unanswered burst, only a probe is sent.
+         * @param burst cleared, then given the packets to send
+         */
+        void nextBurst(std::vector<sf::Packet> & burst) {
+            burst.clear();
+            if (isComplete()) return;
+            ++m_round;
+            std::vector<uint32_t> indices;
+            if (!m_probe) {
+                size_t taken = 0;
+                for (; taken < m_resend.size() && indices.size() < m_config.window; ++taken) {
+                    const uint32_t index = m_resend[taken];
+                    m_queued[index] = false;
+                    if (!m_acked[index]) indices.push_back(index);
+                }
+                m_resend.erase(m_resend.begin(), m_resend.begin() + static_cast<std::ptrdiff_t>(taken));
+                m_resent += indices.size();
+                while (indices.size() < m_config.window && m_next_new < m_fragment_count) indices.push_back(m_next_new++);
+            }
+            if (indices.empty()) {
+                // Nothing left to send, or the last status was lost: resend the first fragment not yet reported.
+                const auto first = static_cast<uint32_t>(std::find(m_acked.begin(), m_acked.end(), false) - m_acked.begin());
+                indices.push_back(first);
+                if (first < m_next_new) ++m_resent;
+                else m_next_new = first + 1;
+            }
+            for (size_t i = 0; i < indices.size(); ++i) burst.push_back(fragmentPacket(indices[i], i + 1 == indices.size()));
+            m_fragments_sent += burst.size();
+            m_probe = false;
+        }
+
+        /**
+         * Applies a status from the receiver
+         * @param pkt packet received; ignored unless it is a status for this transfer
+         * @return true if the packet was a status for this transfer
+         */
+        bool handleStatus(sf::Packet & pkt) {
+            uint8_t kind = 0;
+            uint32_t transferID = 0, round = 0, contiguous = 0, covered = 0, missingCount = 0;
+            if (!(pkt >> kind) || kind != transport::STATUS) return false;
+            if (!(pkt >> transferID >> round >> contiguous >> covered >> missingCount) || transferID != m_transfer_id) return false;
+            if (round < m_answered_round) return true;   // Older than a status already applied
+            m_answered_round = round;
+            m_silent = 0;
+            m_probe = false;
+
+            std::vector<uint32_t> missing;
+            uint32_t index = 0;
+            for (uint32_t i = 0; i < missingCount && i < transport::MAX_MISSING && (pkt >> index); ++i) missing.push_back(index);
+            std::sort(missing.begin(), missing.end());
+
+            for (uint32_t i = 0; i < std::min(contiguous, m_fragment_count); ++i) markAcked(i);
+            for (uint32_t i = contiguous; i < covered && i < m_fragment_count; ++i) {
+                if (std::binary_search(missing.begin(), missing.end(), i)) {
+                    if (!m_acked[i] && !m_queued[i]) {
+                        m_queued[i] = true;
+                        m_resend.push_back(i);
+                    }
+                }
+                else markAcked(i);
+            }
+            return true;
+        }
+
+        /**
+         * Notes that no status arrived in time, so the next burst is a probe
+         * @return false once too many bursts in a row have gone unanswered
+         */
+        bool handleTimeout() {
+            m_probe = true;
+            return ++m_silent <= m_config.max_silent;
+        }
+
+        [[nodiscard]] bool isComplete() const { return m_num_acked == m_fragment_count; }
+        [[nodiscard]] uint32_t getTransferID() const { return m_transfer_id; }
+        [[nodiscard]] uint32_t getFragmentCount() const { return m_fragment_count; }
+        [[nodiscard]] size_t getBodySize() const { return m_body.size(); }
+        [[nodiscard]] bool isCompressed() const { return m_flags & transport::COMPRESSED; }
+        [[nodiscard]] size_t getFragmentsSent() const { return m_fragments_sent; }
+        [[nodiscard]] size_t getFragmentsResent() const { return m_resent; }
+    }; // End of class FragmentSender
+
+    /**
+     * Receiving end of one transfer: collects fragments in any order and reports which are missing
+     */
+    class FragmentReceiver {
+    private:
+        TransportConfig m_config;
+        bool m_started = false;
+        uint32_t m_transfer_id = 0;
+        uint8_t m_flags = 0;
+        uint32_t m_payload_size = 0;
+        uint32_t m_fragment_count = 0;
+        uint32_t m_round = 0;                 ///Newest round seen
+
+        std::vector<std::string> m_fragments;
+        std::vector<bool> m_have;
+        size_t m_num_have = 0;
+        uint32_t m_contiguous = 0;            ///Fragments received in order from the start
+        uint32_t m_highest = 0;               ///One past the highest fragment received
+
+    public:
+        explicit FragmentReceiver(const TransportConfig & config = {}) : m_config(config) {}
+
+        /**
+         * Takes in a fragment
+         * @param pkt packet received; ignored unless it is a fragment of this transfer
+         * @param statusDue set to true if the sender is waiting for a status
+         * @return true if the packet was a fragment of this transfer
+         */
+        bool handleFragment(sf::Packet & pkt, bool & statusDue) {
+            statusDue = false;
+            uint8_t kind = 0, flags = 0;
+            uint32_t transferID = 0, round = 0, index = 0, count = 0, payloadSize = 0;
+            if (!(pkt >> kind) || kind != transport::FRAGMENT) return false;
+            if (!(pkt >> transferID >> flags >> round >> index >> count >> payloadSize)) return false;
+            if (!m_started) {
+                const size_t maxCount = m_config.max_payload / std::max<size_t>(1, m_config.fragment_size) + 1;
+                if (count == 0 || count > maxCount || payloadSize > m_config.max_payload) return false;
+                m_started = true;
+                m_transfer_id = transferID;
+                m_flags = flags & transport::COMPRESSED;
+                m_payload_size = payloadSize;
+                m_fragment_count = count;
+                m_fragments.assign(count, {});
+                m_have.assign(count, false);
+            }
+            if (transferID != m_transfer_id || count != m_fragment_count || index >= count) return false;
+
+            m_round = std::max(m_round, round);
+            statusDue = (flags & transport::POLL) != 0;
+            if (!m_have[index]) {
+                const auto * data = static_cast<const char *>(pkt.getData());
+                m_fragments[index].assign(data + pkt.getReadPosition(), pkt.getDataSize() - pkt.getReadPosition());
+                m_have[index] = true;
+                ++m_num_have;
+                m_highest = std::max(m_highest, index + 1);
+                while (m_contiguous < m_fragment_count && m_have[m_contiguous]) ++m_contiguous;
+                statusDue = statusDue || isComplete();
+            }
+            return true;
+        }
+
+        /**
+         * Builds a status listing the fragments still missing below the highest one received
+         * @return status packet for the sender
+         */
+        [[nodiscard]] sf::Packet statusPacket() const {
+            std::vector<uint32_t> missing;
+            uint32_t covered = m_highest;
+            for (uint32_t i = m_contiguous; i < m_highest; ++i) {
+                if (m_have[i]) continue;
+                if (missing.size() == transport::MAX_MISSING) { covered = i; break; }
+                missing.push_back(i);
+            }
+            sf::Packet pkt;
+            pkt << transport::STATUS << m_transfer_id << m_round << m_contiguous << covered;
+            pkt << static_cast<uint32_t>(missing.size());
+            for (uint32_t index : missing) pkt << index;
+            return pkt;
+        }
+
+        [[nodiscard]] bool hasStarted() const { return m_started; }
+        [[nodiscard]] bool isComplete() const { return m_started && m_num_have == m_fragment_count; }
+        [[nodiscard]] uint32_t getTransferID() const { return m_transfer_id; }
+
+        /**
+         * Joins the fragments and undoes any compression
+         * @param payload set to the bytes that were sent
+         * @return false if the transfer is incomplete or its bytes are corrupt
+         */
+        bool takePayload(std::string & payload) {
+            if (!isComplete()) return false;
+            std::string body;
+            for (auto & fragment : m_fragments) body += fragment;
+            m_fragments.clear();
+            if (m_flags & transport::COMPRESSED) return compression::decompress(body, m_payload_size, payload);
+            payload = std::move(body);
+            return payload.size() == m_payload_size;
+        }
+    }; // End of class FragmentReceiver
+
+    /**
+     * Returns the kind byte of a packet without reading from it
+     * @param pkt packet to check
+     * @return first byte of the packet (0 if it is empty)
+     */
+    inline uint8_t packetKind(const sf::Packet & pkt) {
+        return pkt.getDataSize() == 0 ? 0 : *static_cast<const uint8_t *>(pkt.getData());
+    }
+
+    /**
+     * Checks if a packet holds one fragment of a transfer, without reading from it
+     * @param pkt packet to check
+     * @return true if it was sent by sendPayload()
+     */
+    inline bool isFragment(const sf::Packet & pkt) { return packetKind(pkt) == transport::FRAGMENT; }
+
+    /**
+     * Picks an ID for a new transfer, different from recent ones
+     * @return transfer ID
+     */
+    inline uint32_t nextTransferID() {
+        static std::atomic<uint32_t> s_next{std::random_device{}()};
+        return s_next++;
+    }
+
+    /**
+     * Sends a payload of any size to one peer, resending lost fragments until all have arrived
+     * @param socket socket to send from, blocking or not (statuses are waited for with a selector)
+     * @param destAddr address of the receiver
+     * @param port port of the receiver
+     * @param payload bytes to send
+     * @param config transfer settings
+     * @param onOther if set, given every other packet that arrives meanwhile (e.g., from other peers)
+     * @return true if the receiver reported every fragment before the deadline
+     */
+    inline bool sendPayload(sf::UdpSocket & socket, sf::IpAddress destAddr, unsigned short port,
+                            std::string_view payload, const TransportConfig & config = {},
+                            const std::function<void(sf::Packet &, sf::IpAddress, unsigned short)> & onOther = {}) {
+        using clock_t = std::chrono::steady_clock;
+        const auto deadline = clock_t::now() + config.deadline;
+        FragmentSender sender(nextTransferID(), payload, config);
+        sf::SocketSelector selector;
+        selector.add(socket);
+
+        std::vector<sf::Packet> burst;
+        sf::Packet pkt;
+        std::optional<sf::IpAddress> from;
+        unsigned short fromPort = 0;
+        while (!sender.isComplete()) {
+            if (clock_t::now() > deadline) return false;
+            sender.nextBurst(burst);
+            for (auto & fragment : burst) {
+                if (socket.send(fragment, destAddr, port) != sf::Socket::Status::Done) {
+                    std::cerr << "Failed to send fragment to " << destAddr << " at port " << port << std::endl;
+                }
+            }
+            bool answered = false;
+            auto waitUntil = clock_t::now() + config.status_timeout;
+            while (!answered && clock_t::now() < waitUntil) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(waitUntil - clock_t::now());
+                if (!selector.wait(sf::milliseconds(static_cast<int32_t>(std::max<int64_t>(left.count(), 1))))) break;
+                if (socket.receive(pkt, from, fromPort) != sf::Socket::Status::Done || !from) continue;
+                if (from == destAddr && fromPort == port && packetKind(pkt) == transport::STATUS) answered = sender.handleStatus(pkt);
+                else if (onOther) onOther(pkt, from.value(), fromPort);
+            }
+            if (!answered && !sender.handleTimeout()) return false;
+        }
+        return true;
+    }
+
+    /**
+     * Receives the rest of a payload sent by sendPayload(), once its first fragment has been
+     * handed to a receiver (e.g., by a caller that was waiting for other kinds of packets)
+     * @param socket socket to receive on
+     * @param receiver receiver holding the fragments taken in so far
+     * @param statusDue true if one of those fragments asked for a status
+     * @param sender address the fragments came from; only packets from it are accepted
+     * @param port port the fragments came from; only packets from it are accepted
+     * @param payload set to the bytes that were sent
+     * @param config transfer settings
+     * @return true if the whole payload arrived intact before the deadline
+     */
+    inline bool receivePayload(sf::UdpSocket & socket, FragmentReceiver & receiver, bool statusDue,
+                               std::optional<sf::IpAddress> & sender, unsigned short & port,
+                               std::string & payload, const TransportConfig & config = {}) {
+        using clock_t = std::chrono::steady_clock;
+        const auto deadline = clock_t::now() + config.deadline;
+        sf::SocketSelector selector;
+        selector.add(socket);
+
+        sf::Packet pkt;
+        std::optional<sf::IpAddress> from;
+        unsigned short fromPort = 0;
+        const auto sendStatus = [&]{
+            sf::Packet status = receiver.statusPacket();
+            if (socket.send(status, sender.value(), port) != sf::Socket::Status::Done) {
+                std::cerr << "Failed to send transfer status" << std::endl;
+            }
+        };
+        bool statusPending = statusDue;   // A poll arrived; answer once the rest of its burst is in
+        while (clock_t::now() < deadline) {
+            const auto wait = statusPending ? std::chrono::milliseconds(1)
+                            : receiver.isComplete() ? config.linger : config.status_timeout;
+            if (!selector.wait(sf::milliseconds(static_cast<int32_t>(wait.count())))) {
+                if (statusPending) {
+                    sendStatus();
+                    statusPending = false;
+                    continue;
+                }
+                if (receiver.isComplete()) break;
+                if (receiver.hasStarted()) sendStatus();   // The poll may have been lost
+                continue;
+            }
+            if (socket.receive(pkt, from, fromPort) != sf::Socket::Status::Done) continue;
+            if ((sender && from != sender) || (port != 0 && fromPort != port)) continue;
+            bool pollDue = false;
+            if (!receiver.handleFragment(pkt, pollDue)) continue;
+            sender = from;
+            port = fromPort;
+            statusPending = statusPending || pollDue;
+        }
+        return receiver.takePayload(payload);
+    }
+
+    /**
+     * Receives a payload sent by sendPayload(), answering each poll once its burst has been drained
+     * and lingering briefly afterwards in case the sender missed the final status
+     * @param socket socket to receive on
+     * @param sender if set, only packets from this address are accepted; set to the sender otherwise
+     * @param port if non-zero, only packets from this port are accepted; set to the sender's port
+     * @param payload set to the bytes that were sent
+     * @param config transfer settings
+     * @return true if the whole payload arrived intact before the deadline
+     */
+    inline bool receivePayload(sf::UdpSocket & socket, std::optional<sf::IpAddress> & sender, unsigned short & port,
+                               std::string & payload, const TransportConfig & config = {}) {
+        FragmentReceiver receiver(config);
+        return receivePayload(socket, receiver, false, sender, port, payload, config);
+    }
+} // End of namespace netWorth
@@ -0,0 +1,75 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A lock-free queue carrying one client's inputs from the network thread to the world's tick
+ * @note Status: PROTOTYPE
+ **/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace netWorth{
+
+    /**
+     * Fixed-size ring buffer for exactly one producer thread and one consumer thread
+     * Pushing and popping never lock or wait; the consumer drains whatever has arrived once per tick.
+     * @tparam T type of each input
+     * @tparam CAPACITY most inputs held at once; must be a power of two
+     */
+    template <typename T, size_t CAPACITY = 64>
+    class InputQueue {
+    private:
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "InputQueue capacity must be a power of two");
+
+        std::array<T, CAPACITY> m_slots{};              ///Inputs, indexed by position modulo CAPACITY
+        alignas(64) std::atomic<size_t> m_head{0};      ///Position of the next input to pop (consumer only writes)
+        alignas(64) std::atomic<size_t> m_tail{0};      ///Position of the next input to push (producer only writes)
+        std::atomic<size_t> m_dropped{0};               ///Inputs discarded because the queue was full
+
+    public:
+        /**
+         * Adds an input (producer thread only)
+         * @param input value to add
+         * @return false if the queue was full and the input was dropped
+         */
+        bool push(const T & input) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == CAPACITY) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            m_slots[tail % CAPACITY] = input;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Removes the oldest input if there is one (consumer thread only)
+         * @param input set to the removed value
+         * @return true if an input was removed
+         */
+        bool tryPop(T & input) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) return false;
+            input = m_slots[head % CAPACITY];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Returns the number of inputs waiting (exact only on the consumer thread)
+         * @return number of inputs
+         */
+        [[nodiscard]] size_t size() const {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Returns how many inputs have been dropped because the queue was full
+         * @return number of dropped inputs
+         */
+        [[nodiscard]] size_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+    }; // End of class InputQueue
+} // End of namespace netWorth
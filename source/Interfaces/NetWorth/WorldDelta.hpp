@@ -0,0 +1,341 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Tick-numbered changes to a world's agents and grid, as sent from the server to each client
+ * @note Status: PROTOTYPE
+ *
+ * Packet layout (integers are LEB128 varints unless noted; signed values are zigzag encoded):
+ *   kind byte (WORLD_DELTA), tick, baseline tick (0 for a full state), flags byte
+ *   Grid     if GRID_FULL: width, height, then (state, run length) pairs covering every cell;
+ *            otherwise a count of changed cells, then for each run of neighbouring cells with the
+ *            same state (at most MAX_RUN cells): index minus the previous run's last index, times
+ *            two, plus one if the run is longer than one cell; the state; and if longer, the run
+ *            length minus two.
+ *            If GRID_SIZE, the grid's new width and height come before the count of cells.
+ *   Removed  a count, then the ID minus the previous ID for each agent that is gone.
+ *   Agents   a count, then for each agent: ID minus the previous ID, field bits, and only the
+ *            fields named by those bits (name; position; properties as in WorldSnapshot.hpp).
+ * An acknowledgement is the kind byte ACK followed by the tick the client now has.
+ **/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <SFML/Network/Packet.hpp>
+#include "../../core/GridPosition.hpp"
+#include "../../core/WorldSnapshot.hpp"
+
+namespace netWorth{
+
+    namespace delta {
+        constexpr uint8_t WORLD_DELTA = 1;   ///Kind byte of a packet holding a WorldDelta
+        constexpr uint8_t ACK = 2;           ///Kind byte of a packet acknowledging a tick
+
+        constexpr uint8_t FULL_STATE = 1;    ///Flag: agents not listed should be removed
+        constexpr uint8_t GRID_FULL = 2;     ///Flag: the whole grid is included
+        constexpr uint8_t GRID_SIZE = 4;     ///Flag: the grid was replaced; cells not included are unknown
+
+        constexpr uint8_t NAME = 1;          ///Field bit: agent name (sent for new agents)
+        constexpr uint8_t POSITION = 2;      ///Field bit: agent position
+        constexpr uint8_t PROPERTIES = 4;    ///Field bit: every typed property of the agent
+        constexpr uint8_t ALL_FIELDS = NAME | POSITION | PROPERTIES;
+
+        constexpr size_t MAX_CELLS = size_t(1) << 26;  ///Most grid cells a received delta may describe
+        constexpr size_t MAX_RUN = 64;                 ///Most changed cells one run may cover, so a delta's cells stay proportional to its size
+        constexpr size_t MAX_ID = cse491::snapshot::MAX_ID;  ///Largest agent ID a received delta may name
+
+        /// Bytes of a packet not yet read, which bounds how many entries it can still hold
+        inline size_t bytesLeft(const sf::Packet & pkt) { return pkt.getDataSize() - pkt.getReadPosition(); }
+
+        inline void writeVarint(sf::Packet & pkt, uint64_t value) {
+            while (value >= 0x80) {
+                pkt << static_cast<uint8_t>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            pkt << static_cast<uint8_t>(value);
+        }
+
+        inline uint64_t readVarint(sf::Packet & pkt) {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte = 0;
+                if (!(pkt >> byte)) return 0;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            return value;
+        }
+
+        inline void writeString(sf::Packet & pkt, const std::string & str) {
+            writeVarint(pkt, str.size());
+            pkt.append(str.data(), str.size());
+        }
+
+        /// Marks a packet as bad, as reading past its end does, so that the reader gives up on it
+        inline void invalidate(sf::Packet & pkt) {
+            uint8_t byte = 0;
+            while (pkt >> byte) { }
+        }
+
+        /// Reads a count of entries that each take at least min_bytes, rejecting counts the rest of the packet cannot hold
+        inline size_t readCount(sf::Packet & pkt, size_t min_bytes) {
+            const uint64_t count = readVarint(pkt);
+            if (count > bytesLeft(pkt) / min_bytes) {
+                invalidate(pkt);
+                return 0;
+            }
+            return static_cast<size_t>(count);
+        }
+
+        inline std::string readString(sf::Packet & pkt) {
+            std::string str(readCount(pkt, 1), '\0');
+            for (char & c : str) {
+                int8_t byte = 0;
+                if (!(pkt >> byte)) return "";
+                c = static_cast<char>(byte);
+            }
+            return str;
+        }
+
+        /// Positions are whole cells: zero if invalid, otherwise the X cell plus one, then the Y cell
+        inline void writePosition(sf::Packet & pkt, cse491::GridPosition pos) {
+            if (!pos.IsValid()) { writeVarint(pkt, 0); return; }
+            writeVarint(pkt, cse491::snapshot::ZigZag(static_cast<int64_t>(std::floor(pos.GetX()))) + 1);
+            writeVarint(pkt, cse491::snapshot::ZigZag(static_cast<int64_t>(std::floor(pos.GetY()))));
+        }
+
+        inline cse491::GridPosition readPosition(sf::Packet & pkt) {
+            const uint64_t x = readVarint(pkt);
+            if (x == 0) return cse491::GridPosition().MakeInvalid();
+            const int64_t y = cse491::snapshot::UnZigZag(readVarint(pkt));
+            return {static_cast<double>(cse491::snapshot::UnZigZag(x - 1)), static_cast<double>(y)};
+        }
+
+        inline void writeValue(sf::Packet & pkt, double value) { pkt << value; }
+        inline void writeValue(sf::Packet & pkt, int value) { writeVarint(pkt, cse491::snapshot::ZigZag(value)); }
+        inline void writeValue(sf::Packet & pkt, char value) { pkt << static_cast<int8_t>(value); }
+        inline void writeValue(sf::Packet & pkt, const std::string & value) { writeString(pkt, value); }
+
+        inline void writeProperties(sf::Packet & pkt,
+                                    const std::vector<std::pair<std::string, cse491::snapshot_value_t>> & properties) {
+            writeVarint(pkt, properties.size());
+            for (const auto & [name, value] : properties) {
+                writeString(pkt, name);
+                pkt << static_cast<uint8_t>(value.index());
+                std::visit([&pkt](const auto & v){ writeValue(pkt, v); }, value);
+            }
+        }
+
+        inline void readProperties(sf::Packet & pkt,
+                                   std::vector<std::pair<std::string, cse491::snapshot_value_t>> & properties) {
+            properties.resize(readCount(pkt, 2));   // A name length and a type byte at least
+            for (auto & [name, value] : properties) {
+                name = readString(pkt);
+                uint8_t type = 0;
+                pkt >> type;
+                switch (static_cast<cse491::PropertyType>(type)) {
+                    case cse491::PropertyType::t_double: { double v = 0.0; pkt >> v; value = v; break; }
+                    case cse491::PropertyType::t_int:
+                        value = static_cast<int>(cse491::snapshot::UnZigZag(readVarint(pkt))); break;
+                    case cse491::PropertyType::t_char: { int8_t v = 0; pkt >> v; value = static_cast<char>(v); break; }
+                    case cse491::PropertyType::t_string: value = readString(pkt); break;
+                    default: invalidate(pkt); return;   // Not a type writeProperties() sends
+                }
+            }
+        }
+    } // End of namespace delta
+
+    /**
+     * The changed fields of one agent; the fields not named in field_bits are left empty
+     */
+    struct AgentUpdate {
+        uint8_t field_bits = 0;          ///Which fields of the agent are included (see delta::NAME etc.)
+        cse491::SnapshotEntity agent;    ///ID and new values of the included fields
+    };
+
+    /**
+     * Everything that changed in a world between a baseline tick and a later tick
+     * Updates hold the values as of the later tick, so applying a delta to any state between
+     * the two ticks brings it up to the later one.
+     */
+    struct WorldDelta {
+        uint32_t tick = 0;               ///Tick this delta brings the world up to
+        uint32_t baseline = 0;           ///Tick it was built from (0 for a full state)
+        bool full_state = false;         ///Are all agents listed, so that others should be removed?
+
+        bool grid_full = false;          ///Is the whole grid included (rather than changed cells)?
+        bool grid_resized = false;       ///Was the grid replaced, so that only its size and the cells listed are known?
+        size_t grid_width = 0;           ///Width of the grid, if included (or resized)
+        size_t grid_height = 0;          ///Height of the grid, if included (or resized)
+        std::vector<size_t> grid_states; ///State of every cell in row order, if included
+
+        std::vector<std::pair<size_t, size_t>> cells;  ///Index and new state of changed cells, by index
+        std::vector<size_t> removed;                   ///IDs of removed agents, in increasing order
+        std::vector<AgentUpdate> agents;               ///New or changed agents, in increasing ID order
+
+        /**
+         * Writes this delta into a packet
+         * @param pkt packet to append to
+         */
+        void toPacket(sf::Packet & pkt) const {
+            pkt << delta::WORLD_DELTA;
+            delta::writeVarint(pkt, tick);
+            delta::writeVarint(pkt, baseline);
+            pkt << static_cast<uint8_t>((full_state ? delta::FULL_STATE : 0) | (grid_full ? delta::GRID_FULL : 0) |
+                                        (grid_resized && !grid_full ? delta::GRID_SIZE : 0));
+
+            if (grid_full) {
+                delta::writeVarint(pkt, grid_width);
+                delta::writeVarint(pkt, grid_height);
+                for (size_t i = 0; i < grid_states.size(); ) {
+                    size_t run = 1;
+                    while (i + run < grid_states.size() && grid_states[i + run] == grid_states[i]) ++run;
+                    delta::writeVarint(pkt, grid_states[i]);
+                    delta::writeVarint(pkt, run);
+                    i += run;
+                }
+            } else {
+                if (grid_resized) {
+                    delta::writeVarint(pkt, grid_width);
+                    delta::writeVarint(pkt, grid_height);
+                }
+                delta::writeVarint(pkt, cells.size());
+                size_t prev = 0;
+                for (size_t i = 0; i < cells.size(); ) {
+                    const auto [index, state] = cells[i];
+                    size_t run = 1;
+                    while (run < delta::MAX_RUN && i + run < cells.size() && cells[i + run].first == index + run &&
+                           cells[i + run].second == state) ++run;
+                    delta::writeVarint(pkt, (index - prev) * 2 + (run > 1));
+                    delta::writeVarint(pkt, state);
+                    if (run > 1) delta::writeVarint(pkt, run - 2);
+                    prev = index + run - 1;
+                    i += run;
+                }
+            }
+
+            delta::writeVarint(pkt, removed.size());
+            size_t prev_id = 0;
+            for (size_t id : removed) {
+                delta::writeVarint(pkt, id - prev_id);
+                prev_id = id;
+            }
+
+            delta::writeVarint(pkt, agents.size());
+            prev_id = 0;
+            for (const AgentUpdate & update : agents) {
+                delta::writeVarint(pkt, update.agent.id - prev_id);
+                prev_id = update.agent.id;
+                pkt << update.field_bits;
+                if (update.field_bits & delta::NAME) delta::writeString(pkt, update.agent.name);
+                if (update.field_bits & delta::POSITION) delta::writePosition(pkt, update.agent.position);
+                if (update.field_bits & delta::PROPERTIES) delta::writeProperties(pkt, update.agent.properties);
+            }
+        }
+
+        /**
+         * Reads a delta out of a packet; counts and sizes are checked against what the packet can
+         * hold, so a corrupt or hostile packet is rejected rather than allocating without bound
+         * @param pkt packet positioned at its kind byte
+         * @return true if the packet held a complete delta
+         */
+        bool fromPacket(sf::Packet & pkt) {
+            uint8_t kind = 0, flags = 0;
+            if (!(pkt >> kind) || kind != delta::WORLD_DELTA) return false;
+            tick = static_cast<uint32_t>(delta::readVarint(pkt));
+            baseline = static_cast<uint32_t>(delta::readVarint(pkt));
+            pkt >> flags;
+            full_state = flags & delta::FULL_STATE;
+            grid_full = flags & delta::GRID_FULL;
+            grid_resized = !grid_full && (flags & delta::GRID_SIZE);
+
+            grid_states.clear();
+            cells.clear();
+            if (grid_full) {
+                grid_width = delta::readVarint(pkt);
+                grid_height = delta::readVarint(pkt);
+                if (grid_width != 0 && grid_height > delta::MAX_CELLS / grid_width) return false;
+                const size_t num_cells = grid_width * grid_height;
+                while (grid_states.size() < num_cells && pkt) {
+                    const size_t state = delta::readVarint(pkt);
+                    const size_t run = delta::readVarint(pkt);
+                    if (run == 0 || run > num_cells - grid_states.size()) return false;
+                    grid_states.insert(grid_states.end(), run, state);
+                }
+            } else {
+                if (grid_resized) {
+                    grid_width = delta::readVarint(pkt);
+                    grid_height = delta::readVarint(pkt);
+                    if (grid_width != 0 && grid_height > delta::MAX_CELLS / grid_width) return false;
+                }
+                // Each run takes at least two bytes and covers at most MAX_RUN cells.
+                const size_t num_cells = delta::readVarint(pkt);
+                if (num_cells > delta::MAX_CELLS || num_cells > delta::bytesLeft(pkt) / 2 * delta::MAX_RUN) return false;
+                size_t prev = 0;
+                while (cells.size() < num_cells && pkt) {
+                    const uint64_t head = delta::readVarint(pkt);
+                    if (head / 2 > delta::MAX_CELLS) return false;
+                    const size_t index = prev + head / 2;
+                    const size_t state = delta::readVarint(pkt);
+                    const size_t run = (head & 1) ? delta::readVarint(pkt) + 2 : 1;
+                    if (run > delta::MAX_RUN || run > num_cells - cells.size()) return false;
+                    for (size_t i = 0; i < run; ++i) cells.emplace_back(index + i, state);
+                    prev = index + run - 1;
+                }
+            }
+
+            removed.resize(delta::readCount(pkt, 1));
+            size_t prev_id = 0;
+            for (size_t & id : removed) {
+                // IDs are in increasing order from 1, so a step of zero (or a huge ID) means a bad packet.
+                const uint64_t step = delta::readVarint(pkt);
+                if (step == 0 || step > delta::MAX_ID - prev_id) return false;
+                id = prev_id + step;
+                prev_id = id;
+            }
+
+            agents.resize(delta::readCount(pkt, 2));   // An ID and field bits at least
+            prev_id = 0;
+            for (AgentUpdate & update : agents) {
+                update.agent = cse491::SnapshotEntity{};
+                const uint64_t step = delta::readVarint(pkt);
+                if (step == 0 || step > delta::MAX_ID - prev_id) return false;
+                update.agent.id = prev_id + step;
+                prev_id = update.agent.id;
+                pkt >> update.field_bits;
+                if (update.field_bits & delta::NAME) update.agent.name = delta::readString(pkt);
+                if (update.field_bits & delta::POSITION) update.agent.position = delta::readPosition(pkt);
+                if (update.field_bits & delta::PROPERTIES) delta::readProperties(pkt, update.agent.properties);
+            }
+            return static_cast<bool>(pkt);
+        }
+    };
+
+    /**
+     * Makes the packet a client sends back once it has applied a delta
+     * @param tick the tick the client's world is now at
+     * @return packet holding the acknowledgement
+     */
+    inline sf::Packet ackToPacket(uint32_t tick) {
+        sf::Packet pkt;
+        pkt << delta::ACK;
+        delta::writeVarint(pkt, tick);
+        return pkt;
+    }
+
+    /**
+     * Reads an acknowledgement made by ackToPacket()
+     * @param pkt received packet
+     * @param tick set to the acknowledged tick
+     * @return true if the packet was an acknowledgement
+     */
+    inline bool packetToAck(sf::Packet & pkt, uint32_t & tick) {
+        uint8_t kind = 0;
+        if (!(pkt >> kind) || kind != delta::ACK) return false;
+        tick = static_cast<uint32_t>(delta::readVarint(pkt));
+        return static_cast<bool>(pkt);
+    }
+} // End of namespace netWorth
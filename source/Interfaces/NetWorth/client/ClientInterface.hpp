@@ -98,12 +98,18 @@ namespace netWorth{
 				sendPacket(sendPkt, m_ip.value(), m_port);
 
 				m_manager->clearActionMap();
-                DrawGrid(grid, typeOptions, itemMap, agentMap);
 
                 // await action map from server
 				receivePacket(recvPkt, m_ip, m_port);
 				m_manager->packetToActionMap(recvPkt);
 
+				// the server does not wait for slow clients, so catch up on any other maps already sent
+				m_socket.setBlocking(false);
+				while (m_socket.receive(recvPkt, m_ip, m_port) == Socket::Status::Done) {
+					m_manager->packetToActionMap(recvPkt);
+				}
+				m_socket.setBlocking(true);
+
                 // Do the action!
                 return actionID;
             }
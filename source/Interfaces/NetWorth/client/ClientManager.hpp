@@ -7,7 +7,10 @@
 #pragma once
 #include <map>
 #include <sstream>
+#include <string>
 #include <vector>
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
+#include "Interfaces/NetWorth/WorldDelta.hpp"
 
 namespace netWorth{
     using namespace sf;
@@ -23,7 +26,30 @@ namespace netWorth{
 		unsigned short m_update_port = 0; ///Port to update the game
         std::unordered_map<size_t, size_t> m_action_map;     ///Map of agent IDs to most recent action selected
         size_t m_client_id = 0;		///Id of client
-        bool temp = true;
+        uint32_t m_world_tick = 0;	///Server tick the client's world was last brought up to
+        std::optional<sf::IpAddress> m_update_ip;	///Address game updates come from (acknowledgements go back to it)
+        unsigned short m_update_sender_port = 0;	///Port game updates come from
+
+        /**
+         * Finishes receiving a delta too large for one datagram, which the server sends as fragments
+         * @param first fragment already received
+         * @param senderIP address the fragment came from
+         * @param senderPort port the fragment came from
+         * @param delta set to the received delta
+         * @return true if the whole delta arrived
+         */
+        bool receiveFragmentedDelta(sf::Packet & first, std::optional<sf::IpAddress> & senderIP,
+                                    unsigned short & senderPort, WorldDelta & delta) {
+            FragmentReceiver receiver;
+            bool statusDue = false;
+            if (!receiver.handleFragment(first, statusDue)) return false;
+            std::string payload;
+            if (!receivePayload(*m_game_update_socket, receiver, statusDue, senderIP, senderPort, payload)) return false;
+            sf::Packet deltaPkt;
+            deltaPkt.append(payload.data(), payload.size());
+            return delta.fromPacket(deltaPkt);
+        }
+
     protected:
 
     public:
@@ -99,25 +125,50 @@ namespace netWorth{
         }
 
         /**
-         * Receive serialized agent data for midgame updates
-         * @return serialized data (or empty if no update)
+         * Receive the next world delta sent by the server, if one is waiting (a delta too large
+         * for one datagram is received whole, waiting for the rest of its fragments)
+         * @param delta set to the received delta
+         * @return true if a delta was received
          */
-        std::string getSerializedAgents() {
+        bool receiveWorldDelta(WorldDelta & delta) {
             sf::Packet recvPkt;
-            std::optional<sf::IpAddress> tempIP;
-            unsigned short tempPort;
-            if (m_game_update_socket->receive(recvPkt, tempIP, tempPort) == sf::Socket::Status::Done) {
-                if (temp) {
-                    temp = false;
-                    return "";
+            std::optional<sf::IpAddress> senderIP;
+            unsigned short senderPort = 0;
+            while (m_game_update_socket->receive(recvPkt, senderIP, senderPort) == sf::Socket::Status::Done) {
+                if (isFragment(recvPkt)) {
+                    if (!receiveFragmentedDelta(recvPkt, senderIP, senderPort, delta)) continue;
                 }
-                std::string data;
-                recvPkt >> data;
-                return data;
+                else if (!delta.fromPacket(recvPkt)) continue;
+                m_update_ip = senderIP;
+                m_update_sender_port = senderPort;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Tell the server which tick the client's world is now at
+         */
+        void acknowledgeTick() {
+            if (!m_update_ip) return;
+            sf::Packet ackPkt = ackToPacket(m_world_tick);
+            if (m_game_update_socket->send(ackPkt, m_update_ip.value(), m_update_sender_port) != sf::Socket::Status::Done) {
+                std::cerr << "Failed to acknowledge game update" << std::endl;
             }
-            return "";
         }
 
+        /**
+         * Returns the server tick the client's world was last brought up to
+         * @return tick number (0 if no update has been applied)
+         */
+        [[nodiscard]] uint32_t getWorldTick() const { return m_world_tick; }
+
+        /**
+         * Sets the server tick the client's world is at
+         * @param tick tick number
+         */
+        void setWorldTick(uint32_t tick) { m_world_tick = tick; }
+
 		/**
 		 * Sets the id of the client
 		 * @param id id to set
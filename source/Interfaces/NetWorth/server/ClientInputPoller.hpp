@@ -0,0 +1,199 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Reads every client's input on one network thread, so no world tick waits on a socket
+ * @note Status: PROTOTYPE
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <SFML/Network/Packet.hpp>
+#include <SFML/Network/SocketSelector.hpp>
+#include <SFML/Network/UdpSocket.hpp>
+#include "../InputQueue.hpp"
+
+namespace netWorth{
+
+    /**
+     * Owns an I/O thread that waits on all client sockets at once with a SocketSelector and moves
+     * each action ID that arrives into that client's InputQueue.  Once per tick the world collects
+     * whatever is waiting in every queue without blocking, so one slow client cannot stall everyone else.
+     */
+    class ClientInputPoller {
+    private:
+        using queue_t = InputQueue<size_t>;
+
+        /**
+         * One client's socket and the inputs read from it
+         */
+        struct Channel {
+            size_t id = 0;                      ///ID of the client's interface agent
+            sf::UdpSocket * socket = nullptr;   ///Socket the client sends its actions to
+            queue_t inputs;                     ///Actions received, oldest first
+        };
+
+        std::chrono::milliseconds m_poll_interval;   ///Longest the I/O thread waits before checking for new sockets
+
+        std::mutex m_mutex;                          ///Guards everything below, except m_polled
+        std::condition_variable m_applied_cv;        ///Signalled each time pending changes are applied
+        std::map<size_t, std::shared_ptr<Channel>> m_channels;   ///Channels the tick can take inputs from
+        std::vector<std::shared_ptr<Channel>> m_to_add;          ///Channels to start polling
+        std::vector<std::shared_ptr<Channel>> m_to_remove;       ///Channels to stop polling
+        size_t m_generation = 0;                     ///Number of times pending changes were applied
+
+        std::map<size_t, std::shared_ptr<Channel>> m_polled;     ///Channels in the selector (I/O thread only)
+        sf::SocketSelector m_selector;               ///Sockets being waited on (I/O thread only)
+        std::atomic<bool> m_running{false};
+        std::thread m_thread;
+
+        /**
+         * Brings the selector up to date with the channels added and removed since the last call
+         */
+        void applyPending() {
+            std::lock_guard lock(m_mutex);
+            for (auto & channel : m_to_remove) {
+                m_selector.remove(*channel->socket);
+                m_polled.erase(channel->id);
+            }
+            for (auto & channel : m_to_add) {
+                m_selector.add(*channel->socket);
+                m_polled[channel->id] = channel;
+            }
+            m_to_remove.clear();
+            m_to_add.clear();
+            ++m_generation;
+            m_applied_cv.notify_all();
+        }
+
+        /**
+         * Body of the I/O thread
+         */
+        void run() {
+            sf::Packet pkt;
+            std::optional<sf::IpAddress> sender;
+            unsigned short port = 0;
+            while (m_running) {
+                applyPending();
+                if (m_polled.empty()) {
+                    std::unique_lock lock(m_mutex);
+                    m_applied_cv.wait_for(lock, m_poll_interval, [this]{ return !m_to_add.empty() || !m_running; });
+                    continue;
+                }
+                if (!m_selector.wait(sf::milliseconds(static_cast<int32_t>(m_poll_interval.count())))) continue;
+
+                for (auto & [id, channel] : m_polled) {
+                    if (!m_selector.isReady(*channel->socket)) continue;
+                    while (channel->socket->receive(pkt, sender, port) == sf::Socket::Status::Done) {
+                        size_t actionID = 0;
+                        if (!(pkt >> actionID)) continue;
+                        if (!channel->inputs.push(actionID)) {
+                            std::cerr << "Dropped input from client " << id << "; queue full ("
+                                      << channel->inputs.droppedCount() << " dropped so far)" << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        /**
+         * Constructor
+         * @param pollInterval longest the I/O thread waits on sockets before noticing new ones
+         */
+        explicit ClientInputPoller(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(20))
+            : m_poll_interval(pollInterval) {}
+
+        ClientInputPoller(const ClientInputPoller &) = delete;
+        ClientInputPoller & operator=(const ClientInputPoller &) = delete;
+
+        ~ClientInputPoller() { stop(); }
+
+        /**
+         * Starts the I/O thread (done automatically when the first client is added)
+         */
+        void start() {
+            if (m_running.exchange(true)) return;
+            m_thread = std::thread(&ClientInputPoller::run, this);
+        }
+
+        /**
+         * Stops the I/O thread and waits for it to finish
+         */
+        void stop() {
+            if (!m_running.exchange(false)) return;
+            { std::lock_guard lock(m_mutex); m_applied_cv.notify_all(); }
+            if (m_thread.joinable()) m_thread.join();
+        }
+
+        /**
+         * Starts reading a client's socket; the socket is made non-blocking
+         * @param id ID of the client's interface agent
+         * @param socket socket the client sends its actions to; must stay alive until removeClient()
+         */
+        void addClient(size_t id, sf::UdpSocket & socket) {
+            auto channel = std::make_shared<Channel>();
+            channel->id = id;
+            channel->socket = &socket;
+            socket.setBlocking(false);
+            {
+                std::lock_guard lock(m_mutex);
+                m_channels[id] = channel;
+                m_to_add.push_back(channel);
+                m_applied_cv.notify_all();
+            }
+            start();
+        }
+
+        /**
+         * Stops reading a client's socket, returning once the I/O thread no longer uses it
+         * @param id ID of the client's interface agent
+         */
+        void removeClient(size_t id) {
+            std::unique_lock lock(m_mutex);
+            auto it = m_channels.find(id);
+            if (it == m_channels.end()) return;
+            auto pending = std::find(m_to_add.begin(), m_to_add.end(), it->second);
+            const bool polled = pending == m_to_add.end();
+            if (polled) m_to_remove.push_back(it->second);
+            else m_to_add.erase(pending);
+            m_channels.erase(it);
+            if (!polled || !m_running) return;
+            // Changes are applied at the start of each pass, once any pass using the socket is over.
+            const size_t generation = m_generation;
+            m_applied_cv.wait(lock, [this, generation]{ return m_generation > generation || !m_running; });
+        }
+
+        /**
+         * Moves every input waiting from every client into a batch, without waiting for more
+         * @param batch cleared, then given the inputs of each client that sent any, oldest first
+         */
+        void collectInputs(std::map<size_t, std::vector<size_t>> & batch) {
+            std::vector<std::shared_ptr<Channel>> channels;
+            {
+                std::lock_guard lock(m_mutex);
+                for (auto & [id, channel] : m_channels) channels.push_back(channel);
+            }
+            batch.clear();
+            size_t actionID = 0;
+            for (auto & channel : channels) {
+                while (channel->inputs.tryPop(actionID)) batch[channel->id].push_back(actionID);
+            }
+        }
+
+        /**
+         * Returns whether the I/O thread is running
+         * @return true if running
+         */
+        [[nodiscard]] bool isRunning() const { return m_running; }
+    }; // End of class ClientInputPoller
+} // End of namespace netWorth
@@ -25,6 +25,9 @@ namespace netWorth
 		ServerManager* m_manager = nullptr; ///Manager to handle updates of the world
 
 		unsigned short m_world_update_port = 0;  ///Port used by server manager to handle world updates
+
+		static constexpr double DEFAULT_VIEW_WIDTH = 49.0;   ///Cells across the client is sent (covers its 23-cell view at any edge)
+		static constexpr double DEFAULT_VIEW_HEIGHT = 21.0;  ///Cells down the client is sent (covers its 9-cell view at any edge)
 	protected:
 
 	public:
@@ -40,6 +43,29 @@ namespace netWorth
 
 		}
 
+		/**
+		 * Destructor; stops the network thread from reading this interface's socket
+		 */
+		~ServerInterface() override
+		{
+			if (m_manager) m_manager->removeClientSocket(GetID());
+		}
+
+		/**
+		 * Returns the area around this interface's agent that its client is sent updates for,
+		 * set by the "view_radius" property (a circle) or "view_width" and "view_height" (a
+		 * rectangle), all doubles in cells
+		 * @return the client's area of interest
+		 */
+		[[nodiscard]] InterestArea GetViewArea() const
+		{
+			if (HasProperty("view_radius"))
+				return InterestArea::radius(GetID(), GetProperty<double>("view_radius"));
+			return InterestArea::rectangle(GetID(),
+				HasProperty("view_width") ? GetProperty<double>("view_width") : DEFAULT_VIEW_WIDTH,
+				HasProperty("view_height") ? GetProperty<double>("view_height") : DEFAULT_VIEW_HEIGHT);
+		}
+
 		/**
 		 * Function that initializes server interface
 		 * @return boolean stating whether initialization was successful or not
@@ -72,6 +98,12 @@ namespace netWorth
 			if (!receivePacket(recvPkt, m_ip, m_port))
 				return false;
 
+			// from here on the client's actions are read by the manager's network thread
+			m_manager->addClientSocket(GetID(), m_socket);
+
+			// and it is only sent what is near its agent
+			m_manager->setClientInterest(m_ip.value(), m_world_update_port, GetViewArea());
+
 			GetWorld().SetWorldRunning(true);
 			return true;
 		}
@@ -83,22 +115,36 @@ namespace netWorth
 		 * @param typeOptions different cell types of the world
 		 * @param itemMap the items that may be apart of the grid
 		 * @param agentMap the agents that may be apart of the grid
+		 * @param left first column to include
+		 * @param top first row to include
+		 * @param width number of columns to include (clipped to the grid)
+		 * @param height number of rows to include (clipped to the grid)
 		 * @return the grid that will be sent to the client
 		 */
 		static Packet gridToPacket(const cse491::WorldGrid& grid,
 			const cse491::type_options_t& typeOptions,
 			const cse491::item_map_t& itemMap,
-			const cse491::agent_map_t& agentMap)
+			const cse491::agent_map_t& agentMap,
+			size_t left = 0, size_t top = 0,
+			size_t width = SIZE_MAX, size_t height = SIZE_MAX)
 		{
-			std::vector<std::string> packetGrid(grid.GetHeight());
+			left = std::min(left, grid.GetWidth());
+			top = std::min(top, grid.GetHeight());
+			width = std::min(width, grid.GetWidth() - left);
+			height = std::min(height, grid.GetHeight() - top);
+			std::vector<std::string> packetGrid(height);
+			const auto inView = [=](cse491::GridPosition pos) {
+				return pos.IsValid() && pos.GetX() >= 0.0 && pos.GetY() >= 0.0 &&
+					pos.CellX() - left < width && pos.CellY() - top < height;
+			};
 
 			// Load the world into the symbol_grid;
-			for (size_t y = 0; y < grid.GetHeight(); ++y)
+			for (size_t y = 0; y < height; ++y)
 			{
-				packetGrid[y].resize(grid.GetWidth());
-				for (size_t x = 0; x < grid.GetWidth(); ++x)
+				packetGrid[y].resize(width);
+				for (size_t x = 0; x < width; ++x)
 				{
-					packetGrid[y][x] = typeOptions[grid.At(x, y)].symbol;
+					packetGrid[y][x] = typeOptions[grid.At(left + x, top + y)].symbol;
 				}
 			}
 
@@ -106,23 +152,25 @@ namespace netWorth
 			for (const auto& [id, entityPtr] : itemMap)
 			{
 				cse491::GridPosition pos = entityPtr->GetPosition();
-				packetGrid[pos.CellY()][pos.CellX()] = '+';
+				if (!inView(pos)) continue;
+				packetGrid[pos.CellY() - top][pos.CellX() - left] = '+';
 			}
 
 			for (const auto& [id, agent_ptr] : agentMap)
 			{
 				cse491::GridPosition pos = agent_ptr->GetPosition();
+				if (!inView(pos)) continue;
 				char c = '*';
 				if (agent_ptr->HasProperty("symbol"))
 				{
 					c = agent_ptr->GetProperty<char>("symbol");
 				}
-				packetGrid[pos.CellY()][pos.CellX()] = c;
+				packetGrid[pos.CellY() - top][pos.CellX() - left] = c;
 			}
 
 			// Print out the symbol_grid with a box around it.
 			std::ostringstream oss;
-			oss << '+' << std::string(grid.GetWidth(), '-') << "+\n";
+			oss << '+' << std::string(width, '-') << "+\n";
 			for (const auto& row : packetGrid)
 			{
 				oss << "|";
@@ -132,7 +180,7 @@ namespace netWorth
 				}
 				oss << "|\n";
 			}
-			oss << '+' << std::string(grid.GetWidth(), '-') << "+\n";
+			oss << '+' << std::string(width, '-') << "+\n";
 			std::string gridString = oss.str();
 
 			Packet gridPacket;
@@ -159,17 +207,22 @@ namespace netWorth
 			std::cout << "Sending action map to " << m_ip.value().toString() << " on port " << m_port << std::endl;
 			sendPacket(sendPkt, m_ip.value(), m_port);
 
-			// print server-side map (for test purposes)
-			sf::Packet mapPkt = gridToPacket(grid, typeOptions, itemMap, agentMap);
+			// print the server-side map around this client's agent (for test purposes)
+			const InterestArea view = GetViewArea();
+			const cse491::GridPosition pos = GetPosition();
+			const auto edge = [](double center, double half) {
+				return static_cast<size_t>(std::max(0.0, std::floor(center - half)));
+			};
+			sf::Packet mapPkt = gridToPacket(grid, typeOptions, itemMap, agentMap,
+				edge(pos.GetX(), view.half_width), edge(pos.GetY(), view.half_height),
+				static_cast<size_t>(2 * view.half_width) + 1, static_cast<size_t>(2 * view.half_height) + 1);
 			std::string map;
 			mapPkt >> map;
 			std::cout << map << std::endl;
 
-			// receive player input
-			sf::Packet recvPkt;
-			size_t actionID;
-			receivePacket(recvPkt, m_ip, m_port);
-			recvPkt >> actionID;
+			// take the player input batched for this tick; a client that sent nothing stays still
+			size_t actionID = 0;
+			m_manager->takeInput(GetID(), actionID);
 
 			// handle leaving client
 			if (actionID == 9999)
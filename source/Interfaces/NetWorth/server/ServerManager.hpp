@@ -5,12 +5,23 @@
  **/
 
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
 #include <thread>
 #include <map>
+#include <memory>
 #include <sstream>
+#include <string_view>
 #include <utility>
 #include <vector>
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
 #include "Interfaces/NetWorth/NetworkInterface.hpp"
+#include "Interfaces/NetWorth/server/ClientInputPoller.hpp"
+#include "Interfaces/NetWorth/server/WorldReplicator.hpp"
 
 namespace netWorth{
     using namespace sf;
@@ -27,13 +38,46 @@ namespace netWorth{
 
         std::map<size_t, size_t> m_action_map; ///Map of agent IDs to most recent action selected
 
-        std::string m_current_serialized_agents; ///String with all current serialized agents
+		using clock_t = std::chrono::steady_clock;
 
-		std::vector<std::pair<sf::IpAddress, unsigned short>> m_update_vec; ///IP Addresses and ports to send updates to
+		/**
+		 * A client being sent world updates, and the delta being sent to it as fragments, if any
+		 */
+		struct UpdateClient {
+			sf::IpAddress ip;                          ///Address to send updates to
+			unsigned short port = 0;                   ///Port to send updates to
+			clock_t::time_point last_heard;            ///When it last acknowledged a tick or answered a poll
+			std::unique_ptr<FragmentSender> transfer;  ///Delta too large for one datagram, still being sent
+			clock_t::time_point transfer_deadline;     ///When the transfer is given up
+			clock_t::time_point burst_time;            ///When the transfer's last burst was sent
+			bool answered = false;                     ///Has a status answered that burst?
+			uint32_t transfer_tick = 0;                ///Tick of the last delta sent as fragments
+			uint32_t acked_tick = 0;                   ///Newest tick the client has acknowledged
+		};
+
+		std::map<size_t, UpdateClient> m_update_clients; ///Clients to send updates to, by clientKey()
+
+		size_t m_last_served = 0; ///Key of the last client sent anything, so the next tick starts after it
+
+		TransportConfig m_transport; ///Fragment settings; its deadline also bounds how long a client may stay silent
+
+		std::chrono::milliseconds m_send_budget{5}; ///Longest one tick spends sending updates
+
+		std::vector<sf::Packet> m_burst; ///Fragments of the burst being sent
+
+		WorldReplicator m_replicator; ///Tracks the world state each client has acknowledged
+
+		std::mutex m_replicator_mutex; ///Guards m_replicator and m_update_clients, which the connection thread changes
+
+		std::atomic<bool> m_interfaces_present = false; ///Boolean that states if there are interfaces present on the server
 
-		bool m_has_new_agent = false; ///Boolean that states if this manager has gotten a new agent
+		std::mutex m_interface_mutex; ///Guards m_interface_set
 
-		bool m_interfaces_present = false; ///Boolean that states if there are interfaces present on the server
+		std::condition_variable m_interface_cv; ///Signalled when an interface joins
+
+		ClientInputPoller m_input_poller; ///Reads client inputs on its own thread
+
+		std::map<size_t, std::vector<size_t>> m_input_batch; ///Inputs each client sent since the last tick
 
     protected:
 
@@ -43,23 +87,29 @@ namespace netWorth{
         unsigned short m_max_client_port = 55000; ///Port that is incremented for client thread handoff
 
 		/**
-		 * Default constructor (AgentBase)
-		 * @param id agent ID
-		 * @param name agent name
+		 * Constructor
+		 * @param transport settings for deltas sent as fragments
 		 */
-        ServerManager() = default;
+        explicit ServerManager(const TransportConfig & transport = {}) : m_transport(transport) {
+            // acknowledgements are collected between ticks, so never wait on them
+            m_manager_socket.setBlocking(false);
+        }
 
 		/**
-		 * Returns the current serialized agents
-		 * @return a string of the current serialized agents
+		 * Returns the key the replicator knows a client by
+		 * @param ip IP address of client receiving updates
+		 * @param port port of client receiving updates
+		 * @return key combining the address and port
 		 */
-        std::string getSerializedAgents(){return m_current_serialized_agents;}
+		static size_t clientKey(sf::IpAddress ip, unsigned short port) {
+			return (static_cast<size_t>(ip.toInteger()) << 16) | port;
+		}
 
 		/**
-		 * Sets the current serialized agents of the server
-		 * @param serializedAgents string reference representing the serialized agents
+		 * Returns the replicator that tracks what each client has of the world
+		 * @return reference to the replicator
 		 */
-        void setSerializedAgents(std::string & serializedAgents) { m_current_serialized_agents = serializedAgents;}
+		WorldReplicator & getReplicator() {return m_replicator;}
 
 		/**
 		 * Returns if there are agents present on the server as a boolean
@@ -68,10 +118,56 @@ namespace netWorth{
 		[[nodiscard]] bool hasAgentsPresent() const {return m_interfaces_present;}
 
 		/**
-		 * Sets a boolean stating if the server has received a new agent
-		 * @param hasNewAgent boolean stating that a new agent has joined
+		 * Sleeps until an interface is present on the server or a timeout passes
+		 * @param timeout longest time to wait
+		 * @return boolean representing if there are agents present on the server
+		 */
+		bool waitForAgents(std::chrono::milliseconds timeout) {
+			std::unique_lock lock(m_interface_mutex);
+			return m_interface_cv.wait_for(lock, timeout, [this]{ return m_interfaces_present.load(); });
+		}
+
+		/**
+		 * Starts reading a client's actions on the network thread
+		 * @param id ID of the client's ServerInterface
+		 * @param socket socket the client sends its actions to
+		 */
+		void addClientSocket(size_t id, sf::UdpSocket & socket) {m_input_poller.addClient(id, socket);}
+
+		/**
+		 * Stops reading a client's actions, returning once its socket is no longer in use
+		 * @param id ID of the client's ServerInterface
 		 */
-		void setNewAgent(bool hasNewAgent){ m_has_new_agent = hasNewAgent;}
+		void removeClientSocket(size_t id) {m_input_poller.removeClient(id);}
+
+		/**
+		 * Gathers every action clients have sent since the last tick (call at the start of each tick)
+		 */
+		void collectInputs() {m_input_poller.collectInputs(m_input_batch);}
+
+		/**
+		 * Takes the action a client chose for this tick out of the batch collected for it
+		 * @param id ID of the client's ServerInterface
+		 * @param actionID set to the chosen action
+		 * @return true if the client sent anything since the last tick
+		 */
+		bool takeInput(size_t id, size_t & actionID) {
+			auto it = m_input_batch.find(id);
+			if (it == m_input_batch.end() || it->second.empty()) return false;
+			actionID = chooseInput(it->second);
+			m_input_batch.erase(it);
+			return true;
+		}
+
+		/**
+		 * Picks the one action to perform from everything a client sent during a tick
+		 * @param inputs actions received, oldest first (not empty)
+		 * @return the newest action, unless the client asked to leave (9999)
+		 */
+		static size_t chooseInput(const std::vector<size_t> & inputs) {
+			if (std::find(inputs.begin(), inputs.end(), 9999) != inputs.end()) return 9999;
+			return inputs.back();
+		}
 
         /**
          * Convert action map to packet to send to client
@@ -100,37 +196,169 @@ namespace netWorth{
 		 * @param id
 		 */
         void removeInterface(size_t id){
+            removeClientSocket(id);
+            std::lock_guard lock(m_interface_mutex);
             m_interface_set.erase(id);
             if (m_interface_set.empty()) m_interfaces_present = false;
         }
 
 		/**
-		 * Adds an IP and port to a vector for group update
+		 * Adds a client to the ones sent world updates
 		 * @param ip IP address of client receiving updates
 		 * @param port port of client receiving updates
 		 */
 		void addToUpdatePairs(sf::IpAddress ip, unsigned short port){
-			m_update_vec.emplace_back(ip, port);
+			std::lock_guard lock(m_replicator_mutex);
+			UpdateClient & client = m_update_clients.insert_or_assign(clientKey(ip, port), UpdateClient{ip}).first->second;
+			client.port = port;
+			client.last_heard = clock_t::now();
 		}
 
 		/**
-		 * Sends game updates to all clients when a new agent joins
-		 */
-		 void sendGameUpdates(){
-			if (m_has_new_agent)
-			{
-				sf::Packet serializedAgentPkt;
-				serializedAgentPkt << getSerializedAgents();
-				//Loops through all pairs of IP and port and sends serialized agents
-				for (auto client: m_update_vec){
-					std::cout << "sending game updates to IP: " << client.first.toString() << " with port " <<
-					client.second << std::endl;
-					if (m_manager_socket.send(serializedAgentPkt, client.first, client.second) != sf::Socket::Status::Done) {
-                        std::cerr << "Error sending updates to client at " << client.first.toString() << " port " << client.second << std::endl;
-                    }
+		 * Returns the number of clients being sent world updates
+		 * @return number of clients
+		 */
+		size_t getNumUpdateClients() {
+			std::lock_guard lock(m_replicator_mutex);
+			return m_update_clients.size();
+		}
+
+		/**
+		 * Records the world as a new tick and sends each client what changed since its last acknowledged tick
+		 * @param agents every agent in the world, in increasing ID order
+		 * @param grid the world's grid
+		 */
+		void replicateWorld(const cse491::AgentRegistry & agents, cse491::WorldGrid & grid){
+			std::lock_guard lock(m_replicator_mutex);
+			receiveAcks();
+			m_replicator.captureTick(agents, grid);
+			sendGameUpdates();
+		}
+
+		/**
+		 * Sends each client the changes since the last tick it acknowledged, without waiting on any of
+		 * them.  A delta too large for one datagram (such as a whole large grid) is sent as fragments,
+		 * one burst per tick once the client has answered the last; no new delta is built for that
+		 * client until it has every fragment and has acknowledged the delta.  Sending stops for the tick once m_send_budget is spent,
+		 * and the next tick carries on from there.  Clients that stop answering are dropped.
+		 */
+		void sendGameUpdates(){
+			const auto now = clock_t::now();
+			std::vector<size_t> dropped;
+			auto it = m_update_clients.upper_bound(m_last_served);
+			for (size_t served = 0; served < m_update_clients.size(); ++served, ++it) {
+				if (served > 0 && clock_t::now() - now > m_send_budget) break;
+				if (it == m_update_clients.end()) it = m_update_clients.begin();
+				m_last_served = it->first;
+				if (!updateClient(it->first, it->second, now)) dropped.push_back(it->first);
+			}
+			for (size_t key : dropped) {
+				const UpdateClient & client = m_update_clients.at(key);
+				std::cerr << "Dropping client at " << client.ip.toString() << " port " << client.port
+						  << "; it stopped answering" << std::endl;
+				m_replicator.removeClient(key);
+				m_update_clients.erase(key);
+			}
+		}
+
+		/**
+		 * Sends one client its next delta, or the next burst of the delta it is being sent
+		 * @param key key of the client
+		 * @param client the client
+		 * @param now time of this tick
+		 * @return false if the client has stopped answering and should be dropped
+		 */
+		bool updateClient(size_t key, UpdateClient & client, clock_t::time_point now){
+			if (client.transfer && client.transfer->isComplete()) client.transfer.reset();
+			if (now - client.last_heard > m_transport.deadline) return false;
+			if (client.transfer) {
+				if (now > client.transfer_deadline) return false;
+				if (!client.answered) {
+					if (now - client.burst_time < m_transport.status_timeout) return true;   // Still waiting for a status
+					if (!client.transfer->handleTimeout()) return false;
 				}
-				m_has_new_agent = false;
+				sendBurst(client, now);
+				return true;
+			}
+			// A client still taking in a transfer would miss the next one, so wait until it has applied it.
+			if (client.acked_tick < client.transfer_tick) return true;
+
+			const WorldDelta delta = m_replicator.buildDelta(key);
+			sf::Packet deltaPkt;
+			delta.toPacket(deltaPkt);
+			if (deltaPkt.getDataSize() > sf::UdpSocket::MaxDatagramSize) {
+				const std::string_view payload(static_cast<const char *>(deltaPkt.getData()), deltaPkt.getDataSize());
+				client.transfer = std::make_unique<FragmentSender>(nextTransferID(), payload, m_transport);
+				client.transfer_deadline = now + m_transport.deadline;
+				client.transfer_tick = delta.tick;
+				sendBurst(client, now);
+			}
+			else if (m_manager_socket.send(deltaPkt, client.ip, client.port) != sf::Socket::Status::Done) {
+				std::cerr << "Error sending updates to client at " << client.ip.toString() << " port " << client.port << std::endl;
+			}
+			return true;
+		}
+
+		/**
+		 * Sends the next burst of fragments of a client's transfer
+		 * @param client the client
+		 * @param now time of this tick
+		 */
+		void sendBurst(UpdateClient & client, clock_t::time_point now){
+			client.transfer->nextBurst(m_burst);
+			for (auto & fragment : m_burst) {
+				if (m_manager_socket.send(fragment, client.ip, client.port) != sf::Socket::Status::Done) {
+					std::cerr << "Failed to send fragment to " << client.ip.toString() << " at port " << client.port << std::endl;
+				}
+			}
+			client.burst_time = now;
+			client.answered = false;
+		}
+
+		/**
+		 * Limits the updates sent to a client to the area around its agent
+		 * @param ip IP address of client receiving updates
+		 * @param port port of client receiving updates
+		 * @param area part of the world the client should be sent
+		 */
+		void setClientInterest(sf::IpAddress ip, unsigned short port, const InterestArea & area){
+			std::lock_guard lock(m_replicator_mutex);
+			m_replicator.setInterest(clientKey(ip, port), area);
+		}
+
+		/**
+		 * Reads every acknowledgement and transfer status that clients have sent back since the last call
+		 */
+		void receiveAcks(){
+			sf::Packet ackPkt;
+			std::optional<sf::IpAddress> ip;
+			unsigned short port = 0;
+			while (m_manager_socket.receive(ackPkt, ip, port) == sf::Socket::Status::Done) {
+				if (ip) handleAck(ackPkt, ip.value(), port);
+			}
+		}
+
+		/**
+		 * Applies a packet from a client if it is an acknowledgement or a status for its transfer
+		 * @param pkt received packet
+		 * @param ip IP address of the client
+		 * @param port port of the client
+		 */
+		void handleAck(sf::Packet & pkt, sf::IpAddress ip, unsigned short port){
+			const size_t key = clientKey(ip, port);
+			auto it = m_update_clients.find(key);
+			if (packetKind(pkt) == transport::STATUS) {
+				if (it == m_update_clients.end() || !it->second.transfer || !it->second.transfer->handleStatus(pkt)) return;
+				it->second.answered = true;
+				it->second.last_heard = clock_t::now();
+				return;
 			}
+			uint32_t tick = 0;
+			if (!packetToAck(pkt, tick)) return;
+			m_replicator.acknowledge(key, tick);
+			if (it == m_update_clients.end()) return;
+			it->second.acked_tick = std::max(it->second.acked_tick, tick);
+			it->second.last_heard = clock_t::now();
 		}
 
 		/**
@@ -142,15 +370,14 @@ namespace netWorth{
         }
 
 		/**
-		 * Removes ip and port from the update vector
+		 * Stops sending world updates to a client
 		 * @param ip ip to remove
 		 * @param port port to remove
 		 */
 		void removeFromUpdatePairs(sf::IpAddress ip, unsigned short port){
-			m_update_vec.erase(std::remove_if(m_update_vec.begin(), m_update_vec.end(),
-				[ip, port](std::pair<sf::IpAddress, unsigned short> pair){
-				return (pair.first == ip && pair.second == port);
-			}), m_update_vec.end());
+			std::lock_guard lock(m_replicator_mutex);
+			m_update_clients.erase(clientKey(ip, port));
+			m_replicator.removeClient(clientKey(ip, port));
 		}
 
 		/**
@@ -167,8 +394,10 @@ namespace netWorth{
 		 * @param agent_id
 		 */
         void addToInterfaceSet(size_t agent_id){
+            std::lock_guard lock(m_interface_mutex);
             m_interface_set.insert(agent_id);
 			m_interfaces_present = true;
+			m_interface_cv.notify_all();
         }
 
     }; // End of class ServerManager
@@ -0,0 +1,540 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Tracks what each client has of the world so that only the changes are sent to it
+ * @note Status: PROTOTYPE
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "../../../core/AgentRegistry.hpp"
+#include "../../../core/SpatialIndex.hpp"
+#include "../../../core/WorldGrid.hpp"
+#include "../WorldDelta.hpp"
+
+namespace netWorth{
+
+    /**
+     * The part of the world one client is sent updates for: a rectangle or a circle centred on
+     * an agent (normally the client's own interface)
+     */
+    struct InterestArea {
+        size_t agent_id = 0;          ///Agent the area follows
+        double half_width = 0.0;      ///Cells visible to either side of the agent (the radius, if circular)
+        double half_height = 0.0;     ///Cells visible above and below the agent
+        bool circular = false;        ///Is the area a circle of radius half_width?
+
+        /**
+         * Makes a circular area
+         * @param agentID agent at the centre
+         * @param radius cells visible in every direction
+         * @return the area
+         */
+        static InterestArea radius(size_t agentID, double radius) { return {agentID, radius, radius, true}; }
+
+        /**
+         * Makes a rectangular area
+         * @param agentID agent at the centre
+         * @param width cells visible across
+         * @param height cells visible down
+         * @return the area
+         */
+        static InterestArea rectangle(size_t agentID, double width, double height) {
+            return {agentID, width / 2.0, height / 2.0, false};
+        }
+
+        /**
+         * Checks if a position lies in the area
+         * @param center position of the agent the area follows
+         * @param pos position to check
+         * @return true if pos is valid and inside the area
+         */
+        [[nodiscard]] bool contains(cse491::GridPosition center, cse491::GridPosition pos) const {
+            if (!pos.IsValid()) return false;
+            const double dx = pos.GetX() - center.GetX(), dy = pos.GetY() - center.GetY();
+            if (circular) return dx * dx + dy * dy <= half_width * half_width;
+            return std::abs(dx) <= half_width && std::abs(dy) <= half_height;
+        }
+    };
+
+    /**
+     * Numbers each server tick, remembers what changed in the most recent ticks, and builds
+     * for each client a WorldDelta from the last tick that client acknowledged.  A client that
+     * has acknowledged nothing, or whose last acknowledged tick is no longer remembered, is
+     * sent the full state instead.
+     *
+     * A client given an InterestArea is only sent the agents inside it and the grid regions it
+     * overlaps.  Agents that leave the area are sent as removed, and ones that enter it (or
+     * regions that come into view) are sent whole.  To do this the replicator remembers what
+     * each delta since the acknowledged one showed, since the client may have applied any of them.
+     */
+    class WorldReplicator {
+    public:
+        static constexpr size_t REGION_SIZE = 16;  ///Grid regions are squares this many cells wide
+
+    private:
+        static constexpr uint8_t REMOVED = 0x80;   ///Change bit: agent was removed this tick
+
+        /**
+         * What one delta showed a client with an area of interest
+         */
+        struct VisibleSet {
+            std::vector<size_t> agents;     ///IDs of the agents in the area, sorted
+            std::vector<size_t> regions;    ///Indices of the grid regions the area overlaps, sorted
+            size_t grid_version = 0;        ///Version of the grid whose size the client has
+        };
+
+        /**
+         * A client whose updates are limited to an area of interest
+         */
+        struct ClientView {
+            InterestArea area;
+            cse491::GridPosition center = cse491::GridPosition().MakeInvalid();  ///Centre of the area when last known
+            size_t grid_version = 0;                 ///Grid version when the area was set
+            std::map<uint32_t, VisibleSet> sent;     ///What each delta not yet superseded by an acknowledgement showed
+        };
+
+        /**
+         * What changed in one tick
+         */
+        struct TickRecord {
+            uint32_t tick = 0;
+            std::vector<std::pair<size_t, uint8_t>> agent_changes;  ///Agent IDs with their changed field bits
+            std::vector<size_t> cell_changes;                       ///Indices of changed cells
+            bool grid_replaced = false;                             ///Was the whole grid replaced?
+        };
+
+        uint32_t m_tick = 0;                                   ///Most recently captured tick
+        std::map<size_t, cse491::SnapshotEntity> m_agents;     ///State of each agent as of m_tick
+        std::deque<TickRecord> m_history;                      ///Changes in the most recent ticks
+        size_t m_history_size;                                 ///Number of ticks to remember
+        std::unordered_map<size_t, uint32_t> m_acked;          ///Last tick acknowledged by each client
+        const cse491::WorldGrid * m_grid = nullptr;            ///Grid captured with m_tick
+        size_t m_grid_version = 0;                             ///Number of times the whole grid was replaced
+        cse491::SpatialIndex m_agent_index{REGION_SIZE};       ///Agents by position as of m_tick
+        std::unordered_map<size_t, ClientView> m_views;        ///Clients with an area of interest
+
+        /**
+         * Copies an agent's typed properties, reporting whether they differ from a previous copy
+         * @param agent agent to copy from
+         * @param properties previous copy, replaced only if it differs
+         * @return true if the properties changed
+         */
+        static bool updateProperties(const cse491::AgentBase & agent,
+                                     std::vector<std::pair<std::string, cse491::snapshot_value_t>> & properties) {
+            bool same = agent.GetNumTypedProperties() == properties.size();
+            size_t i = 0;
+            agent.ForEachTypedProperty([&same, &i, &properties](const std::string & name, const auto & value){
+                if (!same) return;
+                using value_t = std::decay_t<decltype(value)>;
+                const auto * old_value = std::get_if<value_t>(&properties[i].second);
+                same = properties[i].first == name && old_value && *old_value == value;
+                ++i;
+            });
+            if (same) return false;
+
+            properties.clear();
+            agent.ForEachTypedProperty([&properties](const std::string & name, const auto & value){
+                properties.emplace_back(name, value);
+            });
+            return true;
+        }
+
+        /**
+         * Fills in a delta holding the whole state of the world
+         * @param delta delta to fill in
+         */
+        void fullDelta(WorldDelta & delta) const {
+            delta.full_state = true;
+            wholeGrid(delta);
+            for (const auto & [id, agent] : m_agents) delta.agents.push_back({delta::ALL_FIELDS, agent});
+        }
+
+        /**
+         * Puts every cell of the grid into a delta
+         * @param delta delta to fill in
+         */
+        void wholeGrid(WorldDelta & delta) const {
+            delta.grid_full = true;
+            delta.grid_width = m_grid->GetWidth();
+            delta.grid_height = m_grid->GetHeight();
+            delta.grid_states.reserve(m_grid->GetNumCells());
+            for (size_t y = 0; y < delta.grid_height; ++y) {
+                for (size_t x = 0; x < delta.grid_width; ++x) delta.grid_states.push_back(m_grid->At(x, y));
+            }
+        }
+
+        /**
+         * Puts the grid's size and every cell of some of its regions into a delta, for a client
+         * whose grid may be from before the grid was replaced; other cells become unknown to it
+         * @param delta delta to fill in
+         * @param regions indices of the regions to include
+         */
+        void resizedGrid(WorldDelta & delta, const std::vector<size_t> & regions) const {
+            delta.grid_resized = true;
+            delta.grid_width = m_grid->GetWidth();
+            delta.grid_height = m_grid->GetHeight();
+            for (size_t region : regions) addRegion(delta, region);
+            std::sort(delta.cells.begin(), delta.cells.end());
+        }
+
+        /**
+         * Puts every cell of one grid region into a delta
+         * @param delta delta to add the cells to
+         * @param region index of the region
+         */
+        void addRegion(WorldDelta & delta, size_t region) const {
+            const size_t width = m_grid->GetWidth();
+            const size_t regionsWide = (width + REGION_SIZE - 1) / REGION_SIZE;
+            const size_t left = region % regionsWide * REGION_SIZE, top = region / regionsWide * REGION_SIZE;
+            for (size_t y = top; y < std::min(top + REGION_SIZE, m_grid->GetHeight()); ++y) {
+                for (size_t x = left; x < std::min(left + REGION_SIZE, width); ++x) {
+                    delta.cells.emplace_back(y * width + x, m_grid->At(x, y));
+                }
+            }
+        }
+
+        /**
+         * Returns the grid region a cell is in
+         * @param index index of the cell (y * width + x)
+         * @return index of the region
+         */
+        [[nodiscard]] size_t regionOf(size_t index) const {
+            const size_t width = m_grid->GetWidth();
+            const size_t regionsWide = (width + REGION_SIZE - 1) / REGION_SIZE;
+            return index / width / REGION_SIZE * regionsWide + index % width / REGION_SIZE;
+        }
+
+        /**
+         * Combines the changes of every tick after a baseline
+         * @param baseline tick the client already has
+         * @param changedAgents given the IDs of changed agents with the union of their change bits
+         * @param changedCells given the indices of changed cells (sorted, without repeats)
+         * @return true if the whole grid was replaced since the baseline
+         */
+        bool changesSince(uint32_t baseline, std::map<size_t, uint8_t> & changedAgents,
+                          std::vector<size_t> & changedCells) const {
+            bool gridReplaced = false;
+            for (auto it = m_history.rbegin(); it != m_history.rend() && it->tick > baseline; ++it) {
+                for (auto [id, fields] : it->agent_changes) changedAgents[id] |= fields;
+                gridReplaced = gridReplaced || it->grid_replaced;
+                if (!gridReplaced) changedCells.insert(changedCells.end(), it->cell_changes.begin(), it->cell_changes.end());
+            }
+            std::sort(changedCells.begin(), changedCells.end());
+            changedCells.erase(std::unique(changedCells.begin(), changedCells.end()), changedCells.end());
+            return gridReplaced;
+        }
+
+        /**
+         * Adds an agent's changed fields to a delta
+         * @param delta delta to add to
+         * @param id ID of the agent, which must exist as of m_tick
+         * @param fields change bits since the client's baseline
+         */
+        void addAgent(WorldDelta & delta, size_t id, uint8_t fields) const {
+            const cse491::SnapshotEntity & state = m_agents.at(id);
+            // Agents added (or re-added) since the baseline are sent whole.
+            if (fields & (delta::NAME | REMOVED)) fields = delta::ALL_FIELDS;
+            AgentUpdate & update = delta.agents.emplace_back();
+            update.field_bits = fields;
+            update.agent.id = id;
+            if (fields & delta::NAME) update.agent.name = state.name;
+            if (fields & delta::POSITION) update.agent.position = state.position;
+            if (fields & delta::PROPERTIES) update.agent.properties = state.properties;
+        }
+
+        /**
+         * Works out which agents and grid regions are in a client's area of interest
+         * @param view the client's area, with its centre up to date
+         * @return what the client should now be shown
+         */
+        [[nodiscard]] VisibleSet visibleSet(const ClientView & view) const {
+            VisibleSet visible;
+            visible.grid_version = m_grid_version;
+            const InterestArea & area = view.area;
+            const cse491::GridPosition center = view.center;
+            m_agent_index.ForEachNear(center, std::max(area.half_width, area.half_height), [&](size_t id){
+                auto it = m_agents.find(id);
+                if (it != m_agents.end() && area.contains(center, it->second.position)) visible.agents.push_back(id);
+            });
+            if (m_agents.count(area.agent_id)) visible.agents.push_back(area.agent_id);   // A client always sees its own agent
+            std::sort(visible.agents.begin(), visible.agents.end());
+            visible.agents.erase(std::unique(visible.agents.begin(), visible.agents.end()), visible.agents.end());
+
+            if (m_grid == nullptr || m_grid->GetNumCells() == 0) return visible;
+            const auto regionRange = [](double low, double high, size_t cells) {
+                const double last = static_cast<double>((cells - 1) / REGION_SIZE);
+                const double first = std::clamp(std::floor(low / REGION_SIZE), 0.0, last);
+                return std::make_pair(static_cast<size_t>(first), static_cast<size_t>(std::clamp(std::floor(high / REGION_SIZE), first, last)));
+            };
+            const auto [minX, maxX] = regionRange(center.GetX() - area.half_width, center.GetX() + area.half_width, m_grid->GetWidth());
+            const auto [minY, maxY] = regionRange(center.GetY() - area.half_height, center.GetY() + area.half_height, m_grid->GetHeight());
+            const size_t regionsWide = (m_grid->GetWidth() + REGION_SIZE - 1) / REGION_SIZE;
+            for (size_t y = minY; y <= maxY; ++y) {
+                for (size_t x = minX; x <= maxX; ++x) visible.regions.push_back(y * regionsWide + x);
+            }
+            return visible;
+        }
+
+        /**
+         * Builds a delta limited to a client's area of interest, and remembers what it showed
+         * @param view the client's area
+         * @param acked last tick the client acknowledged (0 if none)
+         * @return delta for the client
+         */
+        WorldDelta buildAreaDelta(ClientView & view, uint32_t acked) {
+            WorldDelta delta;
+            delta.tick = m_tick;
+            VisibleSet now = visibleSet(view);
+
+            // Deltas older than the acknowledged one are no longer needed as baselines.
+            view.sent.erase(view.sent.begin(), view.sent.lower_bound(acked));
+            while (view.sent.size() > m_history_size) view.sent.erase(view.sent.begin());
+            auto known_it = view.sent.find(acked);
+            const bool usable = acked != 0 && acked + 1 >= m_history.front().tick && known_it != view.sent.end();
+
+            if (!usable) {
+                delta.full_state = true;
+                if (view.grid_version != m_grid_version) resizedGrid(delta, now.regions);
+                else {
+                    for (size_t region : now.regions) addRegion(delta, region);
+                    std::sort(delta.cells.begin(), delta.cells.end());
+                }
+                for (size_t id : now.agents) delta.agents.push_back({delta::ALL_FIELDS, m_agents.at(id)});
+            }
+            else {
+                const VisibleSet & known = known_it->second;
+                delta.baseline = acked;
+                std::map<size_t, uint8_t> changedAgents;
+                std::vector<size_t> changedCells;
+                const bool gridReplaced = changesSince(acked, changedAgents, changedCells);
+
+                if (gridReplaced || known.grid_version != m_grid_version) resizedGrid(delta, now.regions);
+                else {
+                    // Changes in regions the client already had, and every cell of regions new to it.
+                    const size_t width = m_grid->GetWidth();
+                    for (size_t index : changedCells) {
+                        const size_t region = regionOf(index);
+                        if (std::binary_search(now.regions.begin(), now.regions.end(), region) &&
+                            std::binary_search(known.regions.begin(), known.regions.end(), region)) {
+                            delta.cells.emplace_back(index, m_grid->At(index % width, index / width));
+                        }
+                    }
+                    for (size_t region : now.regions) {
+                        if (!std::binary_search(known.regions.begin(), known.regions.end(), region)) addRegion(delta, region);
+                    }
+                    std::sort(delta.cells.begin(), delta.cells.end());
+                }
+
+                // The client may have applied any delta sent since the baseline, so it might hold any
+                // agent one of them showed, but only surely holds those that all of them showed.
+                std::vector<size_t> mightHold = known.agents, surelyHolds = known.agents, merged;
+                for (auto it = std::next(known_it); it != view.sent.end(); ++it) {
+                    merged.clear();
+                    std::set_union(mightHold.begin(), mightHold.end(), it->second.agents.begin(), it->second.agents.end(),
+                                   std::back_inserter(merged));
+                    mightHold.swap(merged);
+                    merged.clear();
+                    std::set_intersection(surelyHolds.begin(), surelyHolds.end(), it->second.agents.begin(), it->second.agents.end(),
+                                          std::back_inserter(merged));
+                    surelyHolds.swap(merged);
+                }
+                std::set_difference(mightHold.begin(), mightHold.end(), now.agents.begin(), now.agents.end(),
+                                    std::back_inserter(delta.removed));
+                for (size_t id : now.agents) {
+                    if (!std::binary_search(surelyHolds.begin(), surelyHolds.end(), id)) addAgent(delta, id, delta::ALL_FIELDS);
+                    else if (auto it = changedAgents.find(id); it != changedAgents.end()) addAgent(delta, id, it->second);
+                }
+            }
+            view.sent[m_tick] = std::move(now);
+            return delta;
+        }
+
+    public:
+        /**
+         * Constructor
+         * @param history_size number of ticks of changes to keep; clients further behind get the full state
+         */
+        explicit WorldReplicator(size_t history_size = 64) : m_history_size(history_size) {}
+
+        /**
+         * Returns the most recently captured tick
+         * @return tick number (0 before the first capture)
+         */
+        [[nodiscard]] uint32_t getTick() const { return m_tick; }
+
+        /**
+         * Records the state of the world as a new tick, noting what changed since the last one
+         * @param agents every agent in the world, in increasing ID order
+         * @param grid the world's grid; its changes are tracked from the first capture on
+         * @return the new tick number
+         */
+        uint32_t captureTick(const cse491::AgentRegistry & agents, cse491::WorldGrid & grid) {
+            TickRecord record;
+            record.tick = ++m_tick;
+
+            // Walk the agents and the previous states together; both are in order of ID.
+            auto old_it = m_agents.begin();
+            for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+                const size_t id = agents.GetID(i);
+                while (old_it != m_agents.end() && old_it->first < id) {
+                    record.agent_changes.emplace_back(old_it->first, REMOVED);
+                    m_agent_index.Remove(old_it->first);
+                    old_it = m_agents.erase(old_it);
+                }
+
+                const cse491::AgentBase & agent = agents.GetAgent(i);
+                if (old_it == m_agents.end() || old_it->first != id) {
+                    cse491::SnapshotEntity & state = m_agents.emplace_hint(old_it, id, cse491::SnapshotEntity{})->second;
+                    state.id = id;
+                    state.name = agent.GetName();
+                    state.position = agent.GetPosition();
+                    updateProperties(agent, state.properties);
+                    m_agent_index.Update(id, state.position);
+                    record.agent_changes.emplace_back(id, delta::ALL_FIELDS);
+                    continue;
+                }
+
+                cse491::SnapshotEntity & state = old_it->second;
+                uint8_t fields = 0;
+                if (state.position != agent.GetPosition()) {
+                    state.position = agent.GetPosition();
+                    m_agent_index.Update(id, state.position);
+                    fields |= delta::POSITION;
+                }
+                if (updateProperties(agent, state.properties)) fields |= delta::PROPERTIES;
+                if (fields) record.agent_changes.emplace_back(id, fields);
+                ++old_it;
+            }
+            while (old_it != m_agents.end()) {
+                record.agent_changes.emplace_back(old_it->first, REMOVED);
+                m_agent_index.Remove(old_it->first);
+                old_it = m_agents.erase(old_it);
+            }
+
+            if (m_grid != &grid) {
+                grid.TrackChanges();
+                record.grid_replaced = true;
+            } else {
+                record.grid_replaced = !grid.TakeChangedCells(record.cell_changes);
+            }
+            m_grid = &grid;
+            if (record.grid_replaced) ++m_grid_version;
+
+            m_history.push_back(std::move(record));
+            if (m_history.size() > m_history_size) m_history.pop_front();
+            return m_tick;
+        }
+
+        /**
+         * Builds the delta that brings a client from its last acknowledged tick to the current one
+         * @param client key identifying the client
+         * @return delta for the client (a full state if nothing usable was acknowledged)
+         */
+        [[nodiscard]] WorldDelta buildDelta(size_t client) {
+            auto ack_it = m_acked.find(client);
+            const uint32_t acked = ack_it == m_acked.end() ? 0 : ack_it->second;
+            auto view_it = m_views.find(client);
+            if (m_tick == 0 || view_it == m_views.end()) return buildWorldDelta(acked);
+
+            ClientView & view = view_it->second;
+            auto agent_it = m_agents.find(view.area.agent_id);
+            if (agent_it != m_agents.end() && agent_it->second.position.IsValid()) view.center = agent_it->second.position;
+            if (!view.center.IsValid()) {
+                // Nowhere to centre the area yet; send nothing rather than the whole world.
+                WorldDelta delta;
+                delta.tick = m_tick;
+                delta.full_state = true;
+                view.sent[m_tick].grid_version = view.grid_version;
+                return delta;
+            }
+            return buildAreaDelta(view, acked);
+        }
+
+        /**
+         * Builds the delta that brings a client without an area of interest up to the current tick
+         * @param acked last tick the client acknowledged (0 if none)
+         * @return delta holding every change since that tick (a full state if it is unusable)
+         */
+        [[nodiscard]] WorldDelta buildWorldDelta(uint32_t acked) const {
+            WorldDelta delta;
+            delta.tick = m_tick;
+            if (m_tick == 0) return delta;
+
+            if (acked == 0 || acked + 1 < m_history.front().tick) {
+                fullDelta(delta);
+                return delta;
+            }
+            delta.baseline = acked;
+            if (acked == m_tick) return delta;
+
+            std::map<size_t, uint8_t> changedAgents;
+            std::vector<size_t> changedCells;
+            if (changesSince(acked, changedAgents, changedCells)) wholeGrid(delta);
+            else {
+                const size_t width = m_grid->GetWidth();
+                for (size_t index : changedCells) delta.cells.emplace_back(index, m_grid->At(index % width, index / width));
+            }
+
+            for (auto [id, fields] : changedAgents) {
+                if (m_agents.count(id)) addAgent(delta, id, fields);
+                else delta.removed.push_back(id);
+            }
+            return delta;
+        }
+
+        /**
+         * Limits a client's updates to an area of interest (replacing any area it had)
+         * @param client key identifying the client
+         * @param area part of the world the client should be sent
+         */
+        void setInterest(size_t client, const InterestArea & area) {
+            auto [it, added] = m_views.try_emplace(client);
+            it->second.area = area;
+            if (!added) return;
+            it->second.grid_version = m_grid_version;
+            m_acked.erase(client);   // Nothing records what its acknowledged deltas showed
+        }
+
+        /**
+         * Sends a client the whole world again, rather than just its area of interest
+         * @param client key identifying the client
+         */
+        void clearInterest(size_t client) {
+            if (m_views.erase(client)) m_acked.erase(client);   // The client is missing what was outside its area
+        }
+
+        /**
+         * Checks if a client's updates are limited to an area of interest
+         * @param client key identifying the client
+         * @return true if the client has an area
+         */
+        [[nodiscard]] bool hasInterest(size_t client) const { return m_views.count(client); }
+
+        /**
+         * Records that a client has applied the world up to a tick
+         * @param client key identifying the client
+         * @param tick tick the client acknowledged
+         */
+        void acknowledge(size_t client, uint32_t tick) {
+            if (tick > m_tick) return;
+            uint32_t & acked = m_acked[client];
+            acked = std::max(acked, tick);
+        }
+
+        /**
+         * Forgets a client, so that it is sent the full state if it returns
+         * @param client key identifying the client
+         */
+        void removeClient(size_t client) {
+            m_acked.erase(client);
+            m_views.erase(client);
+        }
+    }; // End of class WorldReplicator
+} // End of namespace netWorth
@@ -2,6 +2,14 @@
 // Created by Vincenzo on 10/18/2023.
 //
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
 #include "TextureHolder.hpp"
 
 namespace i_2D
@@ -38,134 +46,331 @@ namespace i_2D
         return *got->second;
     }
 
+    namespace {
+        constexpr int ATLAS_CACHE_VERSION = 1;
+        constexpr unsigned ATLAS_PADDING = 1; ///< empty pixels between images, so none bleed into another
+        constexpr unsigned BLANK_SIZE = 4;    ///< side of the white block in the atlas corner
+
+        /**
+         * @brief Shrinks an image to fit in a square, averaging the pixels that fall on each new pixel
+         *
+         * @param image Image to shrink.
+         * @param max_size Largest width or height allowed.
+         * @return The image itself if it already fits, otherwise the smaller copy.
+         */
+        sf::Image ShrinkToFit(const sf::Image &image, unsigned max_size) {
+            const sf::Vector2u size = image.getSize();
+            if (size.x <= max_size && size.y <= max_size) return image;
+
+            const double scale = static_cast<double>(max_size) / std::max(size.x, size.y);
+            const sf::Vector2u target(std::max(1u, static_cast<unsigned>(size.x * scale)),
+                                      std::max(1u, static_cast<unsigned>(size.y * scale)));
+            // Colors are weighted by alpha, so transparent pixels do not darken the edges.
+            std::vector<double> sums(target.x * target.y * 4, 0.0);
+            std::vector<unsigned> counts(target.x * target.y, 0);
+            for (unsigned y = 0; y < size.y; ++y) {
+                const unsigned ty = static_cast<unsigned>(static_cast<unsigned long long>(y) * target.y / size.y);
+                for (unsigned x = 0; x < size.x; ++x) {
+                    const unsigned tx = static_cast<unsigned>(static_cast<unsigned long long>(x) * target.x / size.x);
+                    const sf::Color color = image.getPixel(sf::Vector2u(x, y));
+                    double *sum = &sums[(ty * target.x + tx) * 4];
+                    sum[0] += color.r * color.a;
+                    sum[1] += color.g * color.a;
+                    sum[2] += color.b * color.a;
+                    sum[3] += color.a;
+                    ++counts[ty * target.x + tx];
+                }
+            }
+
+            sf::Image shrunk;
+            shrunk.create(target, sf::Color::Transparent);
+            for (unsigned y = 0; y < target.y; ++y) {
+                for (unsigned x = 0; x < target.x; ++x) {
+                    const double *sum = &sums[(y * target.x + x) * 4];
+                    const unsigned count = counts[y * target.x + x];
+                    if (count == 0 || sum[3] == 0) continue;
+                    shrunk.setPixel(sf::Vector2u(x, y), sf::Color(static_cast<std::uint8_t>(sum[0] / sum[3]),
+                                                                  static_cast<std::uint8_t>(sum[1] / sum[3]),
+                                                                  static_cast<std::uint8_t>(sum[2] / sum[3]),
+                                                                  static_cast<std::uint8_t>(sum[3] / count)));
+                }
+            }
+            return shrunk;
+        }
+    }
+
+    /**
+     * @brief Lists every image under the asset folder, with when it was last changed
+     *
+     * @param asset_dir Folder holding the assets.
+     * @return One entry per image, sorted by path; regions are not yet set.
+     */
+    std::vector<TextureHolder::AtlasEntry> TextureHolder::FindAssets(const std::string &asset_dir) {
+        namespace fs = std::filesystem;
+        std::vector<AtlasEntry> entries;
+        std::error_code error;
+        for (auto it = fs::recursive_directory_iterator(asset_dir, error); !error && it != fs::end(it);
+             it.increment(error)) {
+            std::string extension = it->path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+            if (!it->is_regular_file() || (extension != ".png" && extension != ".jpg")) continue;
+
+            AtlasEntry entry;
+            entry.asset = fs::relative(it->path(), asset_dir).generic_string();
+            entry.mtime = static_cast<long long>(fs::last_write_time(it->path()).time_since_epoch().count());
+            entries.push_back(entry);
+        }
+        if (error) {
+            std::cout << "Error reading assets from " << asset_dir << ": " << error.message() << std::endl;
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const AtlasEntry &a, const AtlasEntry &b) { return a.asset < b.asset; });
+        return entries;
+    }
+
+    /**
+     * @brief Loads the atlas saved by an earlier run, if it was made from the same asset files
+     *
+     * @param cache_file Path of the cache, without extension.
+     * @param entries Current assets; on success, their regions are filled in.
+     * @return True if the cache matched every asset's path and write time and was loaded.
+     */
+    bool TextureHolder::LoadAtlasCache(const std::string &cache_file, std::vector<AtlasEntry> &entries) {
+        std::ifstream index(cache_file + ".txt");
+        std::string magic;
+        int version = 0;
+        unsigned max_size = 0, width = 0;
+        size_t count = 0;
+        if (!(index >> magic >> version >> max_size >> width >> count) || magic != "atlas" ||
+            version != ATLAS_CACHE_VERSION || max_size != MAX_REGION_SIZE || width != ATLAS_WIDTH ||
+            count != entries.size()) {
+            return false;
+        }
+
+        std::vector<AtlasEntry> cached(count);
+        for (auto &entry: cached) {
+            // The path goes last, as it may contain spaces.
+            if (!(index >> entry.mtime >> entry.region.position.x >> entry.region.position.y
+                        >> entry.region.size.x >> entry.region.size.y)) {
+                return false;
+            }
+            index.ignore(1);
+            std::getline(index, entry.asset);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (cached[i].asset != entries[i].asset || cached[i].mtime != entries[i].mtime) return false;
+        }
+        if (!atlas_.loadFromFile(cache_file + ".png")) return false;
+        entries = std::move(cached);
+        return true;
+    }
+
+    /**
+     * @brief Packs every asset image into one atlas image, tallest first, in rows
+     *
+     * @param asset_dir Folder holding the assets.
+     * @param entries Assets to pack; their regions are filled in, empty for files that fail to load.
+     * @param image Set to the atlas.
+     * @return True if any image was packed.
+     */
+    bool TextureHolder::PackAtlas(const std::string &asset_dir, std::vector<AtlasEntry> &entries, sf::Image &image) {
+        std::vector<sf::Image> images(entries.size());
+        std::vector<size_t> order;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            sf::Image loaded;
+            if (!loaded.loadFromFile(asset_dir + "/" + entries[i].asset)) {
+                std::cout << "Skipping unreadable texture: " << entries[i].asset << std::endl;
+                continue;
+            }
+            images[i] = ShrinkToFit(loaded, MAX_REGION_SIZE);
+            order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&images](size_t a, size_t b) {
+            return images[a].getSize().y > images[b].getSize().y;
+        });
+
+        // The white block takes the first spot; then each image goes right of the last, on a new row if full.
+        unsigned x = BLANK_SIZE + ATLAS_PADDING, y = 0, row_height = BLANK_SIZE;
+        for (size_t i: order) {
+            const sf::Vector2u size = images[i].getSize();
+            if (x + size.x > ATLAS_WIDTH) {
+                x = 0;
+                y += row_height + ATLAS_PADDING;
+                row_height = 0;
+            }
+            entries[i].region = {sf::Vector2f(static_cast<float>(x), static_cast<float>(y)), sf::Vector2f(size)};
+            x += size.x + ATLAS_PADDING;
+            row_height = std::max(row_height, size.y);
+        }
+
+        image.create(sf::Vector2u(ATLAS_WIDTH, y + row_height), sf::Color::Transparent);
+        for (unsigned i = 0; i < BLANK_SIZE; ++i) {
+            for (unsigned j = 0; j < BLANK_SIZE; ++j) image.setPixel(sf::Vector2u(i, j), sf::Color::White);
+        }
+        for (size_t i: order) {
+            image.copy(images[i], sf::Vector2u(entries[i].region.position));
+        }
+        return !order.empty();
+    }
+
+    /**
+     * @brief Saves the atlas and where each asset is in it, keyed by the assets' write times
+     *
+     * @param cache_file Path of the cache, without extension.
+     * @param entries Packed assets.
+     * @param image The atlas.
+     */
+    void TextureHolder::SaveAtlasCache(const std::string &cache_file, const std::vector<AtlasEntry> &entries,
+                                       const sf::Image &image) {
+        std::ofstream index(cache_file + ".txt");
+        if (!index || !image.saveToFile(cache_file + ".png")) {
+            std::cout << "Could not save the texture atlas cache to " << cache_file << std::endl;
+            return;
+        }
+        index << "atlas " << ATLAS_CACHE_VERSION << ' ' << MAX_REGION_SIZE << ' ' << ATLAS_WIDTH << ' '
+              << entries.size() << '\n';
+        for (const auto &entry: entries) {
+            index << entry.mtime << ' ' << entry.region.position.x << ' ' << entry.region.position.y << ' '
+                  << entry.region.size.x << ' ' << entry.region.size.y << ' ' << entry.asset << '\n';
+        }
+    }
+
+    /**
+     * @brief Builds the atlas of every image under the asset folder, or loads it from the cache
+     *
+     * Packing shrinks and copies every image, so the result is saved next to the program and
+     * reused until an asset file is added, removed, or changed.
+     *
+     * @param asset_dir Folder holding the assets.
+     * @param cache_file Path of the cache, without extension.
+     * @return True if the atlas is ready.
+     */
+    bool TextureHolder::LoadAtlas(const std::string &asset_dir, const std::string &cache_file) {
+        std::vector<AtlasEntry> entries = FindAssets(asset_dir);
+        if (!LoadAtlasCache(cache_file, entries)) {
+            sf::Image image;
+            if (!PackAtlas(asset_dir, entries, image) || !atlas_.loadFromImage(image)) {
+                std::cout << "Error building the texture atlas from " << asset_dir << std::endl;
+                atlas_loaded_ = true;   // Lookups fall back to the blank region rather than retrying
+                return false;
+            }
+            SaveAtlasCache(cache_file, entries, image);
+        }
+
+        regions_.clear();
+        for (const auto &entry: entries) {
+            if (entry.region.size.x > 0) regions_[entry.asset] = entry.region;
+        }
+        // Sample inside the white block, so its edges never blend in.
+        blank_ = {sf::Vector2f(1, 1), sf::Vector2f(BLANK_SIZE - 2, BLANK_SIZE - 2)};
+        atlas_loaded_ = true;
+        return true;
+    }
+
+    /**
+     * @brief Returns where an asset's image is in the atlas, building the atlas on first use
+     *
+     * @param asset Path of the image under the asset folder, e.g. "walls/wall.png".
+     * @return Its region, or the blank region if there is no such image.
+     */
+    TextureRegion TextureHolder::GetRegion(const std::string &asset) {
+        if (!atlas_loaded_) LoadAtlas();
+        auto found = regions_.find(asset);
+        if (found == regions_.end()) {
+            std::cout << "Missing texture: " << asset << std::endl;
+            return blank_;
+        }
+        return found->second;
+    }
+
     /**
      * @brief This function loads texture for the maze world images - Default maze
-     * @return std::map< name, texture> returns the map, key is the name of the texture and values is the actual texture
+     * @return std::map< symbol, region> returns the map, key is the symbol and value is its region of the atlas
      */
-    std::map<char, sf::Texture> TextureHolder::MazeTexture()
+    std::map<char, TextureRegion> TextureHolder::MazeTexture()
     {
 
-        std::map<char, sf::Texture> textures;
-
-        // Load textures
+        std::map<char, TextureRegion> textures;
 
-        LoadTexture("wallTexture", "../assets/walls/wall.png");
-        LoadTexture("trollTexture", "../assets/agents/troll.png");
-        LoadTexture("agentTexture", "../assets/agents/default-the-first.png");
-        textures['#'] = GetTexture("wallTexture");
-        textures['*'] = GetTexture("trollTexture");
-        textures['@'] = GetTexture("agentTexture");
+        // Look up each symbol's image in the shared atlas
+        textures['#'] = GetRegion("walls/wall.png");
+        textures['*'] = GetRegion("agents/troll.png");
+        textures['@'] = GetRegion("agents/default-the-first.png");
         return textures;
     }
     /**
      * @brief This function loads texture for the second world images group 4
-     * @return std::map< name, texture> returns the map, key is the name of the texture and values is the actual texture
+     * @return std::map< symbol, region> returns the map, key is the symbol and value is its region of the atlas
      */
-    std::map<char, sf::Texture> TextureHolder::SecondWorldTexture()
+    std::map<char, TextureRegion> TextureHolder::SecondWorldTexture()
     {
 
-        std::map<char, sf::Texture> textures;
-
-        // Load textures
-        LoadTexture("wallTexture", "../assets/walls/wall.png");
-        LoadTexture("trollTexture", "../assets/agents/troll.png");
-        LoadTexture("agentTexture", "../assets/agents/witch-girl.png");
-        LoadTexture("armourTexture", "../assets/weapons/leather_armor.png");
-        LoadTexture("swordTexture", "../assets/weapons/longsword.png");
-        LoadTexture("axeTexture", "../assets/weapons/w_axe_war.png");
-        LoadTexture("daggerTexture", "../assets/weapons/dagger.png");
-        LoadTexture("chestTexture", "../assets/weapons/chest_closed.png");
-        LoadTexture("flagTexture", "../assets/weapons/flag.png");
-        LoadTexture("pathTexture", "../assets/Ground_tiles/Grass2.png");
-
-        textures['#'] = GetTexture("wallTexture");
-        textures['*'] = GetTexture("trollTexture");
-        textures['@'] = GetTexture("agentTexture");
-        textures['+'] = GetTexture("armourTexture");
-        textures['S'] = GetTexture("swordTexture");
-        textures['A'] = GetTexture("axeTexture");
-        textures['D'] = GetTexture("daggerTexture");
-        textures['C'] = GetTexture("chestTexture");
-        textures['g'] = GetTexture("flagTexture");
-        textures[' '] = GetTexture("pathTexture");
+        std::map<char, TextureRegion> textures;
+
+        // Look up each symbol's image in the shared atlas
+        textures['#'] = GetRegion("walls/wall.png");
+        textures['*'] = GetRegion("agents/troll.png");
+        textures['@'] = GetRegion("agents/witch-girl.png");
+        textures['+'] = GetRegion("weapons/leather_armor.png");
+        textures['S'] = GetRegion("weapons/longsword.png");
+        textures['A'] = GetRegion("weapons/w_axe_war.png");
+        textures['D'] = GetRegion("weapons/dagger.png");
+        textures['C'] = GetRegion("weapons/chest_closed.png");
+        textures['g'] = GetRegion("weapons/flag.png");
+        textures[' '] = GetRegion("Ground_tiles/Grass2.png");
 
         return textures;
     }
     /**
      * @brief This function loads texture for the manual world images group 8
-     * @return std::map< name, texture> returns the map, key is the name of the texture and values is the actual texture
+     * @return std::map< symbol, region> returns the map, key is the symbol and value is its region of the atlas
      */
-    std::map<char, sf::Texture> TextureHolder::ManualWorldTexture()
+    std::map<char, TextureRegion> TextureHolder::ManualWorldTexture()
     {
 
-        std::map<char, sf::Texture> textures;
-
-        // Load textures
-        LoadTexture("wallTexture", "../assets/walls/brick_wall.png");
-        LoadTexture("trollTexture", "../assets/agents/troll.png");
-        LoadTexture("agentTexture", "../assets/agents/witch-girl.png");
-        LoadTexture("treeTexture", "../assets/trees/tree1.png");
-        LoadTexture("waterTexture", "../assets/Ground_tiles/water.jpg");
-        LoadTexture("axeTexture", "../assets/weapons/w_axe_war_steel.png");
-        LoadTexture("boatTexture", "../assets/weapons/Boat_color1_2.png");
-        LoadTexture("pathTexture", "../assets/Ground_tiles/Sand1.png");
-        LoadTexture("portal1Texture", "../assets/walls/portal1.png");
-        LoadTexture("portal2Texture", "../assets/walls/portal2.png");
-        textures['P'] = GetTexture("axeTexture");
-        textures['U'] = GetTexture("boatTexture");
-        textures['#'] = GetTexture("wallTexture");
-        textures['*'] = GetTexture("trollTexture");
-        textures['@'] = GetTexture("agentTexture");
-        textures['^'] = GetTexture("treeTexture");
-        textures['~'] = GetTexture("waterTexture");
-        textures[' '] = GetTexture("pathTexture");
-        textures['{'] = GetTexture("portal1Texture");
-        textures['}'] = GetTexture("portal2Texture");
+        std::map<char, TextureRegion> textures;
+
+        // Look up each symbol's image in the shared atlas
+        textures['P'] = GetRegion("weapons/w_axe_war_steel.png");
+        textures['U'] = GetRegion("weapons/Boat_color1_2.png");
+        textures['#'] = GetRegion("walls/brick_wall.png");
+        textures['*'] = GetRegion("agents/troll.png");
+        textures['@'] = GetRegion("agents/witch-girl.png");
+        textures['^'] = GetRegion("trees/tree1.png");
+        textures['~'] = GetRegion("Ground_tiles/water.jpg");
+        textures[' '] = GetRegion("Ground_tiles/Sand1.png");
+        textures['{'] = GetRegion("walls/portal1.png");
+        textures['}'] = GetRegion("walls/portal2.png");
 
         return textures;
     }
     /**
      * @brief This function loads texture for the generative world images group 6
-     * @return std::map< name, texture> returns the map, key is the name of the texture and values is the actual texture
+     * @return std::map< symbol, region> returns the map, key is the symbol and value is its region of the atlas
      */
-    std::map<char, sf::Texture> TextureHolder::GenerativeWorldTexture()
+    std::map<char, TextureRegion> TextureHolder::GenerativeWorldTexture()
     {
 
-        std::map<char, sf::Texture> textures;
-
-        // Load textures
-        LoadTexture("wallTexture", "../assets/walls/stone_wall02.png");
-        LoadTexture("trollTexture", "../assets/agents/troll.png");
-        LoadTexture("agentTexture", "../assets/agents/Character_03_Front.png");
-        LoadTexture("tarTexture", "../assets/Ground_tiles/tar.jpg");
-        LoadTexture("doorTexture", "../assets/walls/castledoors.png");
-        LoadTexture("spikeTexture", "../assets/weapons/Individual_Spike.png");
-        LoadTexture("keyTexture", "../assets/weapons/key.png");
-        LoadTexture("pathTexture", "../assets/Ground_tiles/Dirt1.png");
-        LoadTexture("bootTexture", "../assets/weapons/2.png");
-        LoadTexture("shieldTexture", "../assets/weapons/shield.png");
-        LoadTexture("teleportTexture", "../assets/walls/teleport.png");
-        LoadTexture("armoryTexture", "../assets/weapons/steel_armor.png");
-        LoadTexture("waterTexture", "../assets/Ground_tiles/water.jpg");
-        LoadTexture("sandTexture", "../assets/Ground_tiles/Sand1.png");
-        LoadTexture("grassTexture", "../assets/Ground_tiles/Grass2.png");
-        LoadTexture("dirtTexture", "../assets/Ground_tiles/Dirt1.png");
-        textures['~'] = GetTexture("dirtTexture");
-        textures['M'] = GetTexture("grassTexture");
-        textures['-'] = GetTexture("sandTexture");
-        textures['W'] = GetTexture("waterTexture");
-        textures['B'] = GetTexture("bootTexture");
-        textures['X'] = GetTexture("spikeTexture");
-        textures['O'] = GetTexture("tarTexture");
-        textures['#'] = GetTexture("wallTexture");
-        textures['*'] = GetTexture("trollTexture");
-        textures['@'] = GetTexture("agentTexture");
-        textures['D'] = GetTexture("doorTexture");
-        textures['K'] = GetTexture("keyTexture");
-        textures[' '] = GetTexture("pathTexture");
-        textures['S'] = GetTexture("shieldTexture");
-        textures['T'] = GetTexture("teleportTexture");
-        textures['A'] = GetTexture("armoryTexture");
+        std::map<char, TextureRegion> textures;
+
+        // Look up each symbol's image in the shared atlas
+        textures['~'] = GetRegion("Ground_tiles/Dirt1.png");
+        textures['M'] = GetRegion("Ground_tiles/Grass2.png");
+        textures['-'] = GetRegion("Ground_tiles/Sand1.png");
+        textures['W'] = GetRegion("Ground_tiles/water.jpg");
+        textures['B'] = GetRegion("weapons/2.png");
+        textures['X'] = GetRegion("weapons/Individual_Spike.png");
+        textures['O'] = GetRegion("Ground_tiles/tar.jpg");
+        textures['#'] = GetRegion("walls/stone_wall02.png");
+        textures['*'] = GetRegion("agents/troll.png");
+        textures['@'] = GetRegion("agents/Character_03_Front.png");
+        textures['D'] = GetRegion("walls/castledoors.png");
+        textures['K'] = GetRegion("weapons/key.png");
+        textures[' '] = GetRegion("Ground_tiles/Dirt1.png");
+        textures['S'] = GetRegion("weapons/shield.png");
+        textures['T'] = GetRegion("walls/teleport.png");
+        textures['A'] = GetRegion("weapons/steel_armor.png");
 
         return textures;
     }
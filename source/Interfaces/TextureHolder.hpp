@@ -5,6 +5,10 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "SFML/Graphics.hpp"
 #include "../core/Data.hpp"
 #include "../core/InterfaceBase.hpp"
@@ -12,21 +16,61 @@
 namespace i_2D
 {
     using namespace cse491;
+
+    /**
+     * @brief Handle to one image inside the shared atlas texture, in atlas pixels
+     */
+    struct TextureRegion {
+        sf::Vector2f position; ///< top-left corner in the atlas
+        sf::Vector2f size;     ///< width and height in the atlas
+    };
+
     class TextureHolder {
 
     private:
         std::unordered_map<std::string, std::unique_ptr<sf::Texture>> textures_;
 
+        // Atlas of every asset image, shared by all worlds
+        sf::Texture atlas_;
+        std::unordered_map<std::string, TextureRegion> regions_; ///< by path under the asset folder
+        TextureRegion blank_;                                     ///< plain white block
+        bool atlas_loaded_ = false;
+
+        struct AtlasEntry {
+            std::string asset;     ///< path under the asset folder
+            long long mtime = 0;   ///< last write time of the file when it was packed
+            TextureRegion region;  ///< where it is in the atlas
+        };
+
+        static std::vector<AtlasEntry> FindAssets(const std::string &asset_dir);
+        bool LoadAtlasCache(const std::string &cache_file, std::vector<AtlasEntry> &entries);
+        bool PackAtlas(const std::string &asset_dir, std::vector<AtlasEntry> &entries, sf::Image &image);
+        void SaveAtlasCache(const std::string &cache_file, const std::vector<AtlasEntry> &entries,
+                            const sf::Image &image);
+
     public:
+        static constexpr unsigned MAX_REGION_SIZE = 128; ///< larger images are shrunk to fit when packed
+        static constexpr unsigned ATLAS_WIDTH = 2048;    ///< width of the packed atlas
+
         TextureHolder() = default;
         ~TextureHolder() = default;
         void LoadTexture(std::string id, std::string file_name);
         const sf::Texture& GetTexture(std::string id);
-        std::map<char, sf::Texture> MazeTexture();
-        std::map<char, sf::Texture> SecondWorldTexture();
-        std::map<char, sf::Texture> ManualWorldTexture();
-        std::map<char, sf::Texture> GenerativeWorldTexture();
+
+        bool LoadAtlas(const std::string &asset_dir = "../assets", const std::string &cache_file = "texture_atlas");
+
+        /// @return the texture every region points into
+        const sf::Texture &GetAtlas() const { return atlas_; }
+
+        /// @return a plain white region, for symbols without an image
+        TextureRegion GetBlankRegion() const { return blank_; }
+
+        TextureRegion GetRegion(const std::string &asset);
+
+        std::map<char, TextureRegion> MazeTexture();
+        std::map<char, TextureRegion> SecondWorldTexture();
+        std::map<char, TextureRegion> ManualWorldTexture();
+        std::map<char, TextureRegion> GenerativeWorldTexture();
 
     };
 }
-
@@ -0,0 +1,178 @@
+/**
+ * @author : Team - 3
+ * @date: 12/04/2023
+ * TileRenderer batches the visible grid into one vertex array per layer, drawn with one atlas texture
+ */
+
+#include "TileRenderer.hpp"
+
+namespace i_2D {
+
+    /**
+     * @brief Sets the atlas that all vertices take their texture coordinates from
+     *
+     * @param atlas   texture holding every image; must outlive this renderer's draws
+     * @param regions where each symbol's image is in the atlas
+     * @param blank   a plain white region, used for symbols without an image
+     */
+    void TileRenderer::SetAtlas(const sf::Texture &atlas, std::map<char, TextureRegion> regions, TextureRegion blank) {
+        mAtlas = &atlas;
+        mRegions = std::move(regions);
+        mBlank = blank;
+        Invalidate();
+    }
+
+    /**
+     * @brief Colors a symbol's image, e.g. to mark items of a given kind
+     *
+     * @param symbol symbol to tint
+     * @param color  color multiplied into its image
+     */
+    void TileRenderer::SetTint(char symbol, sf::Color color) {
+        mTints[symbol] = color;
+        Invalidate();
+    }
+
+    /**
+     * @brief Finds the atlas region of a symbol
+     *
+     * @param symbol symbol to look up
+     * @return its region, or the blank region if it has no image
+     */
+    const TextureRegion &TileRenderer::FindRegion(char symbol) const {
+        auto found = mRegions.find(symbol);
+        return found == mRegions.end() ? mBlank : found->second;
+    }
+
+    /**
+     * @brief Writes the two triangles of a cell-sized square
+     *
+     * @param quad    first of the six vertices to write
+     * @param topLeft pixel position of the square's top-left corner
+     * @param region  image to show
+     * @param color   color multiplied into the image
+     */
+    void TileRenderer::SetQuadAt(sf::Vertex *quad, sf::Vector2f topLeft, const TextureRegion &region,
+                                 sf::Color color) const {
+        const float left = topLeft.x;
+        const float top = topLeft.y;
+        const sf::Vector2f corners[4] = {{left, top}, {left + mCellSize, top},
+                                         {left + mCellSize, top + mCellSize}, {left, top + mCellSize}};
+        const sf::Vector2f &from = region.position;
+        const sf::Vector2f to = region.position + region.size;
+        const sf::Vector2f uvs[4] = {{from.x, from.y}, {to.x, from.y}, {to.x, to.y}, {from.x, to.y}};
+
+        constexpr size_t ORDER[VERTICES_PER_CELL] = {0, 1, 2, 0, 2, 3};
+        for (size_t i = 0; i < VERTICES_PER_CELL; ++i) {
+            quad[i].position = corners[ORDER[i]];
+            quad[i].texCoords = uvs[ORDER[i]];
+            quad[i].color = color;
+        }
+    }
+
+    /**
+     * @brief Writes the two triangles of one world cell into its slot of a layer
+     *
+     * @param layer  vertex array to write into
+     * @param x      world column of the cell
+     * @param y      world row of the cell
+     * @param region image to show, or nullptr to leave the cell empty in this layer
+     * @param color  color multiplied into the image
+     */
+    void TileRenderer::SetQuad(sf::VertexArray &layer, size_t x, size_t y, const TextureRegion *region,
+                               sf::Color color) {
+        sf::Vertex *quad = &layer[SlotOf(x, y) * VERTICES_PER_CELL];
+        if (region == nullptr) {
+            // A zero-area quad draws nothing, and keeps every slot at a fixed offset.
+            for (size_t i = 0; i < VERTICES_PER_CELL; ++i) quad[i].position = sf::Vector2f();
+            return;
+        }
+        SetQuadAt(quad, sf::Vector2f(static_cast<float>(x) * mCellSize, static_cast<float>(y) * mCellSize),
+                  *region, color);
+    }
+
+    /**
+     * @brief Adds an agent or item to the entity layer, at the cell size of the last update
+     *
+     * @param cell   position in world cells; may fall between cells
+     * @param symbol symbol whose image to draw
+     */
+    void TileRenderer::AddEntity(sf::Vector2f cell, char symbol) {
+        const size_t first = mEntities.getVertexCount();
+        mEntities.resize(first + VERTICES_PER_CELL);
+        auto tint = mTints.find(symbol);
+        SetQuadAt(&mEntities[first], cell * mCellSize, FindRegion(symbol),
+                  tint == mTints.end() ? sf::Color::White : tint->second);
+    }
+
+    /**
+     * @brief Brings the vertices up to date with a window of symbols
+     *
+     * Only cells that just came into view or whose symbol differs from the last update are
+     * written, unless the window's size or the cell size changed, in which case every cell is.
+     *
+     * @param symbols  symbols of the window, row by row
+     * @param left     world column of the window's first column
+     * @param top      world row of the window's first row
+     * @param width    cells per row
+     * @param height   number of rows
+     * @param cellSize pixels per cell
+     */
+    void TileRenderer::Update(const std::vector<char> &symbols, size_t left, size_t top, size_t width, size_t height,
+                              float cellSize) {
+        const size_t cellCount = width * height;
+        const bool rebuildAll = width != mWidth || height != mHeight || cellSize != mCellSize ||
+                                mSymbols.size() != cellCount;
+        if (rebuildAll) {
+            mWidth = width;
+            mHeight = height;
+            mCellSize = cellSize;
+            mSymbols.assign(cellCount, '\0');
+            mGround.resize(cellCount * VERTICES_PER_CELL);
+            mTiles.resize(cellCount * VERTICES_PER_CELL);
+        }
+        const size_t lastLeft = mLeft;
+        const size_t lastTop = mTop;
+        mLeft = left;
+        mTop = top;
+
+        mCellsRebuilt = 0;
+        const TextureRegion &floor = FindRegion(mFloorSymbol);
+        for (size_t row = 0; row < height; ++row) {
+            const size_t y = top + row;
+            const bool rowWasShown = y >= lastTop && y < lastTop + height;
+            for (size_t col = 0; col < width; ++col) {
+                const size_t x = left + col;
+                const char symbol = symbols[row * width + col];
+                char &last = mSymbols[SlotOf(x, y)];
+                // A slot still holds this cell only if the cell was in the last window too.
+                const bool wasShown = rowWasShown && x >= lastLeft && x < lastLeft + width;
+                if (!rebuildAll && wasShown && symbol == last) continue;
+                last = symbol;
+                ++mCellsRebuilt;
+
+                // Walls cover the whole cell; everything else stands on the floor.
+                const bool isWall = symbol == mWallSymbol;
+                SetQuad(mGround, x, y, isWall ? nullptr : &floor, sf::Color::White);
+                auto tint = mTints.find(symbol);
+                SetQuad(mTiles, x, y, symbol == mFloorSymbol ? nullptr : &FindRegion(symbol),
+                        tint == mTints.end() ? sf::Color::White : tint->second);
+            }
+        }
+    }
+
+    /**
+     * @brief Draws every layer, one draw call each
+     *
+     * @param target where to draw
+     * @param states render states of the parent
+     */
+    void TileRenderer::draw(sf::RenderTarget &target, sf::RenderStates states) const {
+        states.transform *= getTransform();
+        states.texture = mAtlas;
+        target.draw(mGround, states);
+        target.draw(mTiles, states);
+        target.draw(mEntities, states);
+    }
+
+} // End of namespace i_2D
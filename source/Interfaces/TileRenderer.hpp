@@ -0,0 +1,92 @@
+/**
+ * @author : Team - 3
+ * @date: 12/04/2023
+ * TileRenderer batches the visible grid into one vertex array per layer, drawn with one atlas texture
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+#include "TextureHolder.hpp"
+
+namespace i_2D {
+
+    /**
+     * @class TileRenderer
+     *
+     * @brief Draws a window of grid symbols as textured quads.
+     *
+     * Each cell is two triangles in the ground layer (the floor under it) and two in the tile
+     * layer (its own symbol), so the whole grid costs one draw call per layer.  Vertices are kept
+     * by world cell: cell (x, y) always lives in slot (x mod width, y mod height) and is placed in
+     * world pixels, so when the window scrolls only the cells coming into view are written, along
+     * with those whose symbol changed.  This object's transform puts the world's corner on screen.
+     * Agents and items go in a third layer, rebuilt every frame, since they may stand between cells.
+     */
+    class TileRenderer : public sf::Drawable, public sf::Transformable {
+    private:
+        static constexpr size_t VERTICES_PER_CELL = 6;
+
+        sf::VertexArray mGround{sf::PrimitiveType::Triangles}; ///< floor under each open cell
+        sf::VertexArray mTiles{sf::PrimitiveType::Triangles};  ///< symbol of each cell
+        sf::VertexArray mEntities{sf::PrimitiveType::Triangles}; ///< agents and items, drawn on top
+
+        const sf::Texture *mAtlas = nullptr;     ///< texture all regions point into
+        std::map<char, TextureRegion> mRegions;  ///< where each symbol's image is in the atlas
+        TextureRegion mBlank;                    ///< plain white region, for symbols with no image
+        std::map<char, sf::Color> mTints;        ///< colors multiplied into some symbols
+        char mFloorSymbol = ' ';                 ///< symbol whose image is laid under open cells
+        char mWallSymbol = '#';                  ///< symbol drawn without any floor under it
+
+        std::vector<char> mSymbols;              ///< symbols of the last update, by slot
+        size_t mLeft = 0;                        ///< first world column of the last update
+        size_t mTop = 0;                         ///< first world row of the last update
+        size_t mWidth = 0;                       ///< cells per row of the last update
+        size_t mHeight = 0;                      ///< rows of the last update
+        float mCellSize = 0;                     ///< pixels per cell of the last update
+        size_t mCellsRebuilt = 0;                ///< cells written by the last update
+
+        /// @return slot holding the vertices of a world cell
+        size_t SlotOf(size_t x, size_t y) const { return (y % mHeight) * mWidth + x % mWidth; }
+
+        void SetQuad(sf::VertexArray &layer, size_t x, size_t y, const TextureRegion *region, sf::Color color);
+
+        void SetQuadAt(sf::Vertex *quad, sf::Vector2f topLeft, const TextureRegion &region, sf::Color color) const;
+
+        const TextureRegion &FindRegion(char symbol) const;
+
+        void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+
+    public:
+        TileRenderer() = default;
+
+        void SetAtlas(const sf::Texture &atlas, std::map<char, TextureRegion> regions, TextureRegion blank);
+
+        void SetTint(char symbol, sf::Color color);
+
+        void Update(const std::vector<char> &symbols, size_t left, size_t top, size_t width, size_t height,
+                    float cellSize);
+
+        /**
+         * @brief Remove every agent and item, before adding those of a new frame
+         */
+        void ClearEntities() { mEntities.clear(); }
+
+        void AddEntity(sf::Vector2f cell, char symbol);
+
+        /**
+         * @brief Forget the last update, so the next one writes every cell
+         */
+        void Invalidate() { mSymbols.clear(); }
+
+        /// @return number of cells whose vertices the last update wrote
+        size_t GetCellsRebuilt() const { return mCellsRebuilt; }
+
+        /// @return number of cells in the last update
+        size_t GetCellCount() const { return mSymbols.size(); }
+    };
+
+} // End of namespace i_2D
@@ -3,11 +3,13 @@
  * @author Paul Schulte, Milan Mihailovic, ChatGPT
  */
 
+#include <algorithm>
 #include <fstream>
 #include <cmath>
 #include <set>
 #include <tuple>
 #include <random>
+#include <thread>
 #include "BiomeGenerator.hpp"
 
 using std::vector;
@@ -31,7 +33,7 @@ BiomeGenerator::BiomeGenerator(BiomeType biome, unsigned int width, unsigned int
     }
 
     perlinNoise = PerlinNoise(seed);
-    grid = vector<vector<char>>(height, vector<char>(width));
+    grid = vector<char>(static_cast<size_t>(width) * height);
 }
 
 /**
@@ -40,14 +42,8 @@ BiomeGenerator::BiomeGenerator(BiomeType biome, unsigned int width, unsigned int
 void BiomeGenerator::generate() {
 
     char tile1 = tiles[0];
-    char tile2 = tiles[1];
 
-    for (unsigned int y = 0; y < height; y++) {
-        for (unsigned int x = 0; x < width; x++) {
-            const double val = perlinNoise.noise2D(x * frequency / width, y * frequency / height);
-            grid.at(y).at(x) = val < 0 ? tile1 : tile2;
-        }
-    }
+    fillNoise(std::max(1u, std::thread::hardware_concurrency()));
 
 
     if (biome == BiomeType::Maze)
@@ -59,6 +55,78 @@ void BiomeGenerator::generate() {
     }
 }
 
+/**
+ * Fills the grid with the two tiles, one row of noise at a time, with the rows split into
+ * bands across threads.  The result is the same as fillNoiseScalar() for any thread count.
+ * @param threadCount Most threads to use; small grids use fewer, so each has at least MIN_BAND_ROWS rows
+ */
+void BiomeGenerator::fillNoise(unsigned int threadCount) {
+    // Every row samples the same x coordinates
+    vector<double> xs(width);
+    for (unsigned int x = 0; x < width; x++) {
+        xs[x] = x * frequency / width;
+    }
+
+    const unsigned int bands = std::max(1u, std::min(threadCount, height / MIN_BAND_ROWS));
+    if (bands == 1) {
+        fillNoiseRows(xs, 0, height);
+        return;
+    }
+
+    vector<std::thread> threads;
+    for (unsigned int band = 0; band < bands; band++) {
+        const unsigned int firstRow = static_cast<unsigned int>(static_cast<size_t>(height) * band / bands);
+        const unsigned int lastRow = static_cast<unsigned int>(static_cast<size_t>(height) * (band + 1) / bands);
+        threads.emplace_back([this, &xs, firstRow, lastRow]() { fillNoiseRows(xs, firstRow, lastRow); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Fills a band of rows with the two tiles
+ * @param xs       Noise x coordinate of each column
+ * @param firstRow First row to fill
+ * @param lastRow  One past the last row to fill
+ */
+void BiomeGenerator::fillNoiseRows(const vector<double> &xs, unsigned int firstRow, unsigned int lastRow) {
+    char tile1 = tiles[0];
+    char tile2 = tiles[1];
+
+    vector<double> values(width);
+    for (unsigned int y = firstRow; y < lastRow; y++) {
+        const double noiseY = y * frequency / height;
+        if (octaves == 1) {
+            perlinNoise.noise2DRow(xs.data(), noiseY, values.data(), width);
+        } else {
+            perlinNoise.octave2DRow(xs.data(), noiseY, values.data(), width, octaves, persistence);
+        }
+
+        char *row = &grid[static_cast<size_t>(y) * width];
+        for (unsigned int x = 0; x < width; x++) {
+            row[x] = values[x] < 0 ? tile1 : tile2;
+        }
+    }
+}
+
+/**
+ * Fills the grid with the two tiles one cell at a time (the reference for fillNoise())
+ */
+void BiomeGenerator::fillNoiseScalar() {
+    char tile1 = tiles[0];
+    char tile2 = tiles[1];
+
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+            const double val = octaves == 1
+                    ? perlinNoise.noise2D(x * frequency / width, y * frequency / height)
+                    : perlinNoise.octave2D(x * frequency / width, y * frequency / height, octaves, persistence);
+            at(x, y) = val < 0 ? tile1 : tile2;
+        }
+    }
+}
+
 /**
  * Generates random coordinate to place Key tile
  * @param keyTile  Door Tile
@@ -76,9 +144,9 @@ void BiomeGenerator::generate() {
          int random_x = x_distribution(gen);
          int random_y = y_distribution(gen);
 
-         if( grid[random_y][random_x] == ' ' )
+         if( at(random_x, random_y) == ' ' )
          {
-             grid[random_y][random_x] = keyTile;
+             at(random_x, random_y) = keyTile;
              counter = true;
          }
      }
@@ -90,7 +158,7 @@ void BiomeGenerator::generate() {
  */
 void BiomeGenerator::placeDoorTile(const char &doorTile)
 {
-    grid[1][1] = doorTile;
+    at(1, 1) = doorTile;
 }
 
 /**
@@ -103,7 +171,7 @@ void BiomeGenerator::placeSpecialTiles(const char &genericTile, const char &spec
     std::vector<std::pair<int, int>> floorPositions;
     for (int i = 0; i < height; ++i) {
         for (int j = 0; j < width; ++j) {
-            if (grid[i][j] == genericTile) {
+            if (at(j, i) == genericTile) {
                 floorPositions.push_back({j, i});
             }
         }
@@ -116,7 +184,7 @@ void BiomeGenerator::placeSpecialTiles(const char &genericTile, const char &spec
 
     // Convert some generic floor tiles to special tiles
     for (int i = 0; i < numSpikes; ++i) {
-        grid[floorPositions[i].second][floorPositions[i].first] = specialTile;
+        at(floorPositions[i].first, floorPositions[i].second) = specialTile;
     }
 }
 
@@ -170,7 +238,7 @@ std::vector<Point> BiomeGenerator::clearPath() const {
  */
 void BiomeGenerator::applyPathToGrid(const std::vector<Point>& path) {
     for (const Point& p : path) {
-        grid[p.y][p.x] = ' ';
+        at(p.x, p.y) = ' ';
     }
 }
 
@@ -180,10 +248,8 @@ void BiomeGenerator::applyPathToGrid(const std::vector<Point>& path) {
  */
 void BiomeGenerator::saveToFile(const std::string &filename) const {
     std::ofstream out(filename);
-    for (const auto &row : grid) {
-        for (const auto &cell : row) {
-            out << cell;
-        }
+    for (unsigned int y = 0; y < height; y++) {
+        out.write(&grid[static_cast<size_t>(y) * width], width);
         out << "\n";
     }
     out.close();
@@ -201,3 +267,13 @@ void BiomeGenerator::setTiles(const char& firstTile, const char& secondTile)
     tiles.push_back(secondTile);
 }
 
+/**
+ * Sets how many octaves of noise are summed for each tile
+ * @param octaveCount Number of octaves, [1, 16]
+ * @param octavePersistence How much each octave is scaled from the one before
+ */
+void BiomeGenerator::setOctaves(int octaveCount, double octavePersistence)
+{
+    octaves = std::clamp(octaveCount, 1, 16);
+    persistence = octavePersistence;
+}
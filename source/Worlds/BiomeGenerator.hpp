@@ -58,7 +58,8 @@ struct Point {
 class BiomeGenerator {
 private:
     const double frequency = 8.0;         ///< [0.1, 64.0]
-    // const int octaves = 8;                ///< [1, 16]
+    int octaves = 1;                      ///< [1, 16]
+    double persistence = 0.5;             ///< How much each octave is scaled from the one before
 
     PerlinNoise perlinNoise;              ///< The Perlin Noise procedural generation algorithm
 
@@ -67,18 +68,30 @@ private:
 
     unsigned int width;                   ///< Width of the grid
     unsigned int height;                  ///< Height of the grid
-    std::vector<std::vector<char>> grid;  ///< Grid of all tiles
+    std::vector<char> grid;               ///< Grid of all tiles, row by row
+
+    /// Tile at (x, y)
+    char& at(int x, int y) { return grid[static_cast<size_t>(y) * width + x]; }
+
+    void fillNoiseRows(const std::vector<double>& xs, unsigned int firstRow, unsigned int lastRow);
 
 public:
+    static constexpr unsigned int MIN_BAND_ROWS = 64; ///< Fewest rows worth handing to a thread of their own
+
     BiomeGenerator(BiomeType biome, unsigned int width, unsigned int height, unsigned int seed);
     ~BiomeGenerator() = default;
 
     void generate();
+    void fillNoise(unsigned int threadCount = 1);
+    void fillNoiseScalar();
     void saveToFile(const std::string &filename) const;
     void placeSpecialTiles(const char& genericTile, const char& specialTile, double percentage);
 
     void setTiles(const char &firstTile, const char &secondTile);
+    void setOctaves(int octaveCount, double octavePersistence = 0.5);
     [[nodiscard]] BiomeType getBiome() const { return biome; }
+    [[nodiscard]] const std::vector<char>& getGrid() const { return grid; }
+    [[nodiscard]] char getTile(int x, int y) const { return grid[static_cast<size_t>(y) * width + x]; }
 
     void placeDoorTile(const char &doorTile);
     void placeKeyTile(const char &keyTile);
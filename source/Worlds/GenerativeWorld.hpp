@@ -27,14 +27,17 @@ class GenerativeWorld : public WorldBase {
   size_t grass_id;
   size_t dirt_id;
 
+  static inline const PropertyKey<double> KEY_PROPERTY{"key_property"}; ///< 1.0 once the agent holds the key
+  static inline const PropertyKey<double> TAR_PROPERTY{"tar_property"}; ///< 6.0 while the agent is stuck in tar
+
   /// Provide the agent with movement actions.
   void ConfigAgent(AgentBase & agent) override {
     agent.AddAction("up", MOVE_UP);
     agent.AddAction("down", MOVE_DOWN);
     agent.AddAction("left", MOVE_LEFT);
     agent.AddAction("right", MOVE_RIGHT);
-    agent.SetProperty("key_property", 0.0); //if key is set to 0, agent does not have possession of key. If it is 1, agent has possession of key and can exit through door
-    agent.SetProperty("tar_property", 5.0); //if it is set to 5.0, agent is free to move. if it is set to 6.0, agent is stuck
+    agent.SetProperty(KEY_PROPERTY, 0.0); //if key is set to 0, agent does not have possession of key. If it is 1, agent has possession of key and can exit through door
+    agent.SetProperty(TAR_PROPERTY, 5.0); //if it is set to 5.0, agent is free to move. if it is set to 6.0, agent is stuck
   }
 
  public:
@@ -84,12 +87,12 @@ class GenerativeWorld : public WorldBase {
     // agent is moving onto a key tile and picking it up
     if( main_grid.At(new_position) == key_id )
     {
-        agent.SetProperty("key_property", 1.0);
+        agent.SetProperty(KEY_PROPERTY, 1.0);
         main_grid.At(new_position) = floor_id;
     }
 
     // player is exiting through door with key and ending game
-    if( main_grid.At(new_position) == door_id && agent.GetProperty("key_property") == 1.0 )
+    if( main_grid.At(new_position) == door_id && agent.GetProperty(KEY_PROPERTY) == 1.0 )
     {
         std::cout << "You successfully exited maze!" << std::endl;
         exit(0);
@@ -98,15 +101,15 @@ class GenerativeWorld : public WorldBase {
     // player is on tar tile and trying to move to a tar tile
     if( main_grid.At(new_position) == tar_id && main_grid.At(currentPosition) == tar_id)
     {
-        if( agent.GetProperty("tar_property") == 6.0 ) //player is stuck on tar
+        if( agent.GetProperty(TAR_PROPERTY) == 6.0 ) //player is stuck on tar
         {
-            agent.SetProperty("tar_property", 5.0);
+            agent.SetProperty(TAR_PROPERTY, 5.0);
             new_position = currentPosition;
             return false;
         }
         else
         {
-            agent.SetProperty("tar_property", 6.0);
+            agent.SetProperty(TAR_PROPERTY, 6.0);
             agent.SetPosition(new_position);
             return true;
         }
@@ -114,15 +117,15 @@ class GenerativeWorld : public WorldBase {
     // determining if player is moving onto a tar tile and setting tar property to 6.0 if so
     if( main_grid.At(new_position) == tar_id )
     {
-        agent.SetProperty("tar_property", 6.0);
+        agent.SetProperty(TAR_PROPERTY, 6.0);
     }
 
     //Determining if agent is stuck on tar or not
     if( main_grid.At(currentPosition) == tar_id )
     {
-        if( agent.GetProperty("tar_property") == 6.0 ) //player is stuck on tar
+        if( agent.GetProperty(TAR_PROPERTY) == 6.0 ) //player is stuck on tar
         {
-            agent.SetProperty("tar_property", 5.0);
+            agent.SetProperty(TAR_PROPERTY, 5.0);
             new_position = currentPosition;
             return false;
         }
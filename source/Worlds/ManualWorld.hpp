@@ -34,6 +34,11 @@ namespace cse491_team8 {
     size_t portal_id_c; ///< Easy access to third portal CellType ID.
     size_t portal_id_d; ///< Easy access to fourth portal CellType ID.
 
+    static inline const cse491::PropertyKey<int> HEALTH_KEY{"Health"};       ///< Health left.
+    static inline const cse491::PropertyKey<int> STRENGTH_KEY{"Strength"};   ///< Damage dealt in battle.
+    static inline const cse491::PropertyKey<bool> BATTLING_KEY{"Battling"};  ///< Is the agent in a battle?
+    static inline const cse491::PropertyKey<bool> DELETED_KEY{"Deleted"};    ///< Was the agent defeated?
+
     /// Provide the agent with movement actions.
     void ConfigAgent(cse491::AgentBase & agent) override {
       agent.AddAction("up", MOVE_UP);
@@ -75,7 +80,7 @@ namespace cse491_team8 {
     {
         for (auto & [id, agent_ptr] : agent_map)
         {
-            auto agent_strength = agent_ptr->GetProperty<int>("Strength");
+            auto agent_strength = agent_ptr->GetProperty(STRENGTH_KEY);
             if (agent_ptr->GetName() == "Interface")
             {
                 std::map<std::string, std::tuple<char, double>> move_set = {
@@ -151,18 +156,18 @@ namespace cse491_team8 {
     {
       size_t can_heal = FindItem(agent, "Health Potion");
       if (can_heal != SIZE_MAX) {
-        int healing_req = agent.GetProperty<int>("Max_Health") - agent.GetProperty<int>("Health");
+        int healing_req = agent.GetProperty<int>("Max_Health") - agent.GetProperty(HEALTH_KEY);
         int healing = item_map[can_heal]->GetProperty<int>("Healing");
         if (healing_req >= healing) {
           agent.Notify("You healed " + std::to_string(healing) + " health!\n");
-          agent.SetProperty("Health", agent.GetProperty<int>("Health") + healing);
+          agent.SetProperty(HEALTH_KEY, agent.GetProperty(HEALTH_KEY) + healing);
           RemoveItem(can_heal);
         } 
         else if (healing_req == 0) {
           agent.Notify("You already have max health");
         } else {
           agent.Notify("You healed " + std::to_string(healing_req) + " health!\n");
-          agent.SetProperty("Health", agent.GetProperty<int>("Health") + healing_req);
+          agent.SetProperty(HEALTH_KEY, agent.GetProperty(HEALTH_KEY) + healing_req);
           item_map[can_heal]->SetProperty("Healing", healing - healing_req);
         }
       }
@@ -179,7 +184,7 @@ namespace cse491_team8 {
         {
             if (item->IsOwnedBy(agent.GetID()))
             {
-                for (const auto & [name, entity] : item->GetProprtyMap())
+                for (const auto & name : item->GetPropertyNames())
                 {
                     if (name == "Uses" || name == "Strength" || name == "Healing")
                     {
@@ -190,7 +195,7 @@ namespace cse491_team8 {
             }
         }
         output += "\nProperties of the player:\n";
-        for (const auto & [name, entity] : agent.GetProprtyMap())
+        for (const auto & name : agent.GetPropertyNames())
         {
             if (name == "Strength" || name == "Health" || name == "Max_Health")
             {
@@ -263,11 +268,11 @@ namespace cse491_team8 {
         {
             if (item->IsOwnedBy(other_agent.GetID()))
             {
-                if (item->HasProperty("Strength") && other_agent.HasProperty("Strength"))
+                if (item->HasProperty(STRENGTH_KEY) && other_agent.HasProperty(STRENGTH_KEY))
                 {
-                    auto agent_health = other_agent.GetProperty<int>("Strength");
-                    auto item_strength = item->GetProperty<int>("Strength");
-                    other_agent.SetProperty<int>("Strength", (int)(agent_health - item_strength));
+                    auto agent_health = other_agent.GetProperty(STRENGTH_KEY);
+                    auto item_strength = item->GetProperty(STRENGTH_KEY);
+                    other_agent.SetProperty(STRENGTH_KEY, (int)(agent_health - item_strength));
                 }
                 item->SetUnowned();
                 item->SetPosition(other_agent.GetPosition());
@@ -294,21 +299,21 @@ namespace cse491_team8 {
         char stat_char = std::get<0>(move_info);
         double stat_modification = std::get<1>(move_info);
         if (stat_char == 'd') {
-            other_damage = static_cast<int>(other_agent.GetProperty<int>("Strength") * stat_modification);
+            other_damage = static_cast<int>(other_agent.GetProperty(STRENGTH_KEY) * stat_modification);
         }
         if (stat_char == 'h') {
             HealAction(other_agent);
         }
         if (stat_char == 's') {
           if (stat_modification < 0) {
-            int agent_strength = agent.GetProperty<int>("Strength");
+            int agent_strength = agent.GetProperty(STRENGTH_KEY);
             int new_strength = static_cast<int>(agent_strength - abs(stat_modification) * agent_strength);
-            agent.SetProperty<int>("Strength", new_strength);
+            agent.SetProperty(STRENGTH_KEY, new_strength);
           }
           else {
-            int other_agent_strength = other_agent.GetProperty<int>("Strength");
+            int other_agent_strength = other_agent.GetProperty(STRENGTH_KEY);
             int new_strength_other = static_cast<int>(other_agent_strength + abs(stat_modification) * other_agent_strength);
-            other_agent.SetProperty<int>("Strength", new_strength_other);
+            other_agent.SetProperty(STRENGTH_KEY, new_strength_other);
           }
         }
         return other_damage;
@@ -321,7 +326,7 @@ namespace cse491_team8 {
     {
         for (auto & [id, agent_ptr] : agent_map)
         {
-            agent_ptr->SetProperty<bool>("Battling", false);
+            agent_ptr->SetProperty(BATTLING_KEY, false);
         }
     }
 
@@ -338,10 +343,10 @@ namespace cse491_team8 {
         bool run = false;
         int damage = 0;
         switch (attack_type) {
-        case 'a': case 'A': damage = agent.GetProperty<int>("Strength");    break;
-        case 's': case 'S': damage = static_cast<int>(agent.GetProperty<int>("Strength") * 1.5);  break;
+        case 'a': case 'A': damage = agent.GetProperty(STRENGTH_KEY);    break;
+        case 's': case 'S': damage = static_cast<int>(agent.GetProperty(STRENGTH_KEY) * 1.5);  break;
         case 'r': case 'R': won = false; run = true; break;
-        case 'b': case 'B': agent.SetProperty<int>("Strength", static_cast<int>(1.5 * agent.GetProperty<int>("Strength"))); break;
+        case 'b': case 'B': agent.SetProperty(STRENGTH_KEY, static_cast<int>(1.5 * agent.GetProperty(STRENGTH_KEY))); break;
         case 'h': case 'H': HealAction(agent); break;
         default: break;
         }
@@ -352,27 +357,27 @@ namespace cse491_team8 {
         // Process the Player's Move and the Agent's Move
         if (run)
         {
-            agent.SetProperty<int>("Health", agent.GetProperty<int>("Health") - other_damage);
+            agent.SetProperty(HEALTH_KEY, agent.GetProperty(HEALTH_KEY) - other_damage);
         }
         else
         {
-            other_agent.SetProperty<int>("Health", other_agent.GetProperty<int>("Health") - damage);
-            if (other_agent.GetProperty<int>("Health") <= 0)
+            other_agent.SetProperty(HEALTH_KEY, other_agent.GetProperty(HEALTH_KEY) - damage);
+            if (other_agent.GetProperty(HEALTH_KEY) <= 0)
             {
                 won = true;
                 other_damage = 0;
             }
-            agent.SetProperty<int>("Health", agent.GetProperty<int>("Health") - other_damage);
-            if (agent.GetProperty<int>("Health") <= 0)
+            agent.SetProperty(HEALTH_KEY, agent.GetProperty(HEALTH_KEY) - other_damage);
+            if (agent.GetProperty(HEALTH_KEY) <= 0)
             {
                 won = false;
             }
         }
 
-        agent.Notify("Player Health: " + std::to_string(agent.GetProperty<int>("Health"))+"\n"+
-                "Player Strength: " + std::to_string(agent.GetProperty<int>("Strength"))+"\n"+
-                "Enemy Health: " + std::to_string(other_agent.GetProperty<int>("Health"))+"\n"+
-                "Enemy Strength: " + std::to_string(other_agent.GetProperty<int>("Strength")));
+        agent.Notify("Player Health: " + std::to_string(agent.GetProperty(HEALTH_KEY))+"\n"+
+                "Player Strength: " + std::to_string(agent.GetProperty(STRENGTH_KEY))+"\n"+
+                "Enemy Health: " + std::to_string(other_agent.GetProperty(HEALTH_KEY))+"\n"+
+                "Enemy Strength: " + std::to_string(other_agent.GetProperty(STRENGTH_KEY)));
 
         std::string other_agent_name = other_agent.GetName();
 
@@ -381,7 +386,7 @@ namespace cse491_team8 {
           {
             agent.Notify("You ran away, this means you don't gain health or strength and any battle damage stays!\n");
           }
-          if (agent.GetName() == "Interface" && agent.GetProperty<int>("Health") <= 0)
+          if (agent.GetName() == "Interface" && agent.GetProperty(HEALTH_KEY) <= 0)
           {
             agent.Notify(other_agent_name + " has beat " + agent.GetName() + "\nYou Lost...\n");
             while (true)
@@ -398,11 +403,11 @@ namespace cse491_team8 {
               {
                 DropItems(agent, agent);
 
-                agent.SetProperty<int>("Health", 100);
+                agent.SetProperty(HEALTH_KEY, 100);
                 agent.SetProperty<int>("Direction", 0);
                 
-                agent.SetProperty<bool>("Battling", false);
-                other_agent.SetProperty<bool>("Battling", false);
+                agent.SetProperty(BATTLING_KEY, false);
+                other_agent.SetProperty(BATTLING_KEY, false);
 
                 agent.SetPosition(40, 3);
                 break;
@@ -418,10 +423,10 @@ namespace cse491_team8 {
         else
         {
           agent.Notify(agent.GetName() + " has beat " + other_agent.GetName());
-          agent.SetProperty<bool>("Battling", false);
-          other_agent.SetProperty<bool>("Battling", false);
+          agent.SetProperty(BATTLING_KEY, false);
+          other_agent.SetProperty(BATTLING_KEY, false);
           DropItems(agent, other_agent);
-          other_agent.SetProperty<bool>("Deleted", true);
+          other_agent.SetProperty(DELETED_KEY, true);
         }
     }
 
@@ -438,18 +443,18 @@ namespace cse491_team8 {
       while (!run_over) {
         RunAgents();
         UpdateWorld();
+        PublishRenderSnapshots();
       }
     }
 
       void RunAgents() override {
         for (auto & [id, agent_ptr] : agent_map) {
-          if (agent_ptr->HasProperty("Deleted")) {
+          if (agent_ptr->HasProperty(DELETED_KEY)) {
             continue;
           }
           size_t action_id = agent_ptr->SelectAction(main_grid, type_options, item_map, agent_map);
-          agent_ptr->storeActionMap(agent_ptr->GetName());
           int result = DoAction(*agent_ptr, action_id);
-          agent_ptr->SetActionResult(result);
+          FinishAction(*agent_ptr, action_id, result);
         }
       }
 
@@ -499,7 +504,7 @@ namespace cse491_team8 {
         cse491::GridPosition new_position, look_position;
         char move = ' ';
 
-        bool battling = agent.GetProperty<bool>("Battling");
+        bool battling = agent.GetProperty(BATTLING_KEY);
         if (battling)
         {
             agent.Notify("You are in a battle! Use Y and choose battling moves!");
@@ -611,7 +616,7 @@ namespace cse491_team8 {
             else
             {
                 HealAction(agent);
-                agent.Notify("You have healed!\nYour health is now: " + std::to_string(agent.GetProperty<int>("Health")));
+                agent.Notify("You have healed!\nYour health is now: " + std::to_string(agent.GetProperty(HEALTH_KEY)));
             }
             break;
         }
@@ -623,15 +628,15 @@ namespace cse491_team8 {
                 break;
             }
             new_position = agent.GetPosition();
-            agent.SetProperty<bool>("Battling", false);
+            agent.SetProperty(BATTLING_KEY, false);
             
             auto agents = FindAgentsNear(agent.GetPosition(), 1);
             for (auto agent_id : agents)
             {
-                if (!agent_map[agent_id]->IsInterface() && !agent_map[agent_id]->HasProperty("Deleted"))
+                if (!agent_map[agent_id]->IsInterface() && !agent_map[agent_id]->HasProperty(DELETED_KEY))
                 {
                     agent.Notify("You are running away");
-                    agent_map[agent_id]->SetProperty<bool>("Battling", false);
+                    agent_map[agent_id]->SetProperty(BATTLING_KEY, false);
                     DoBattle(*agent_map[agent_id], agent, 'r');
                 }
             }
@@ -666,10 +671,10 @@ namespace cse491_team8 {
           for (auto agent_id : agents)
           {
               // Battle other agent near the player
-              if (!agent_map[agent_id]->IsInterface() && !agent_map[agent_id]->HasProperty("Deleted"))
+              if (!agent_map[agent_id]->IsInterface() && !agent_map[agent_id]->HasProperty(DELETED_KEY))
               {
-                  agent.SetProperty<bool>("Battling", true);
-                  agent_map[agent_id]->SetProperty<bool>("Battling", true);
+                  agent.SetProperty(BATTLING_KEY, true);
+                  agent_map[agent_id]->SetProperty(BATTLING_KEY, true);
                   DoBattle(*agent_map[agent_id], agent, move);
                   break;
               }
@@ -35,7 +35,8 @@ class MazeWorld : public WorldBase {
     wall_id = AddCellType(
         "wall", "Impenetrable wall that you must find a way around.", '#');
     // Set cell type properties
-    type_options.at(floor_id).SetProperty(CellType::CELL_WALL);
+    type_options.at(wall_id).SetProperty(CellType::CELL_WALL);
+    UseCellFlagsForTraversal();
     // Load map
     main_grid.Read("../assets/grids/default_maze.grid", type_options);
   }
@@ -86,12 +87,6 @@ class MazeWorld : public WorldBase {
       return true;
   }
 
-
-  [[nodiscard]] bool IsTraversable(const AgentBase & /*agent*/, cse491::GridPosition pos) const override {
-    //return !GetCellTypes().at(main_grid.At(pos)).HasProperty(CellType::CELL_WALL);
-    // ^ This doesn't work because we're not assigning any properties to the cell types, so a band-aid solution is to use name
-    return !(GetCellTypes().at(main_grid.At(pos)).name == CellType::CELL_WALL);
-  }
 };
 
 } // End of namespace cse491
@@ -34,10 +34,21 @@
 # include <random>
 # include <type_traits>
 
+# include <cmath>
+# include <cstddef>
+
 # if __has_include(<concepts>) && defined(__cpp_concepts)
 #	include <concepts>
 # endif
 
+// AVX2 row kernels, chosen at run time on CPUs that support them (define SIVPERLIN_NO_SIMD to turn off)
+# if !defined(SIVPERLIN_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	define SIVPERLIN_AVX2 1
+#	include <immintrin.h>
+# else
+#	define SIVPERLIN_AVX2 0
+# endif
+
 
 // Library major version
 # define SIVPERLIN_VERSION_MAJOR			3
@@ -236,6 +247,15 @@ namespace siv
         [[nodiscard]]
         value_type normalizedOctave3D_01(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
 
+        ///////////////////////////////////////
+        //
+        //	Row noise (out[i] is exactly noise2D(xs[i], y) or octave2D(xs[i], y, ...))
+        //
+
+        void noise2DRow(const value_type* xs, value_type y, value_type* out, std::size_t count) const noexcept;
+
+        void octave2DRow(const value_type* xs, value_type y, value_type* out, std::size_t count, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
     private:
 
         state_type m_permutation;
@@ -403,6 +423,132 @@ namespace siv
 
             return result;
         }
+
+        // Cells along one row share y and z, so their eight corner hashes depend only on ix.
+        // Entry ix packs the hashes of corners 0-7 (in noise3D's order) into bytes 0-7.
+        inline void RowHashes(const std::uint8_t* p, const std::int32_t iy, const std::int32_t iz, std::uint64_t* table) noexcept
+        {
+            for (std::int32_t ix = 0; ix < 256; ++ix)
+            {
+                const std::uint8_t A = (p[ix & 255] + iy) & 255;
+                const std::uint8_t B = (p[(ix + 1) & 255] + iy) & 255;
+                const std::uint8_t AA = (p[A] + iz) & 255;
+                const std::uint8_t AB = (p[(A + 1) & 255] + iz) & 255;
+                const std::uint8_t BA = (p[B] + iz) & 255;
+                const std::uint8_t BB = (p[(B + 1) & 255] + iz) & 255;
+                const std::uint8_t corners[8] = { p[AA], p[BA], p[AB], p[BB],
+                                                  p[(AA + 1) & 255], p[(BA + 1) & 255], p[(AB + 1) & 255], p[(BB + 1) & 255] };
+
+                std::uint64_t packed = 0;
+                for (int c = 7; c >= 0; --c)
+                {
+                    packed = (packed << 8) | corners[c];
+                }
+                table[ix] = packed;
+            }
+        }
+
+# if SIVPERLIN_AVX2
+
+        [[nodiscard]]
+        inline bool HasAVX2() noexcept
+        {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+
+        // Grad() for four lanes.  Every step is the same IEEE operation as the scalar version, so the results match bit for bit.
+        __attribute__((target("avx2")))
+        inline __m256d Grad4(__m256i hash, const __m256d x, const __m256d y, const __m256d z) noexcept
+        {
+            const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi64x(15));
+            const __m256i below8 = _mm256_cmpgt_epi64(_mm256_set1_epi64x(8), h);
+            const __m256i below4 = _mm256_cmpgt_epi64(_mm256_set1_epi64x(4), h);
+            const __m256i is12or14 = _mm256_or_si256(_mm256_cmpeq_epi64(h, _mm256_set1_epi64x(12)),
+                                                     _mm256_cmpeq_epi64(h, _mm256_set1_epi64x(14)));
+
+            __m256d u = _mm256_blendv_pd(y, x, _mm256_castsi256_pd(below8));
+            __m256d v = _mm256_blendv_pd(z, x, _mm256_castsi256_pd(is12or14));
+            v = _mm256_blendv_pd(v, y, _mm256_castsi256_pd(below4));
+
+            // Negate by flipping the sign bit: bit 0 of h for u, bit 1 for v
+            const __m256i one = _mm256_set1_epi64x(1);
+            u = _mm256_xor_pd(u, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(h, one), 63)));
+            v = _mm256_xor_pd(v, _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_srli_epi64(h, 1), one), 63)));
+            return _mm256_add_pd(u, v);
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256d Fade4(const __m256d t) noexcept
+        {
+            const __m256d t3 = _mm256_mul_pd(_mm256_mul_pd(t, t), t);
+            const __m256d inner = _mm256_sub_pd(_mm256_mul_pd(t, _mm256_set1_pd(6)), _mm256_set1_pd(15));
+            return _mm256_mul_pd(t3, _mm256_add_pd(_mm256_mul_pd(t, inner), _mm256_set1_pd(10)));
+        }
+
+        __attribute__((target("avx2")))
+        inline __m256d Lerp4(const __m256d a, const __m256d b, const __m256d t) noexcept
+        {
+            return _mm256_add_pd(a, _mm256_mul_pd(_mm256_sub_pd(b, a), t));
+        }
+
+        // noise3D(xs[i], y, z) for the first count - count % 4 points, four at a time.
+        // Returns how many points were filled.
+        __attribute__((target("avx2")))
+        inline std::size_t Noise3DRowAVX2(const std::uint8_t* p, const double* xs, const double y, const double z, double* out, const std::size_t count) noexcept
+        {
+            const double _y = std::floor(y);
+            const double _z = std::floor(z);
+            const double fy = (y - _y);
+            const double fz = (z - _z);
+
+            alignas(32) std::uint64_t table[256];
+            RowHashes(p, static_cast<std::int32_t>(_y) & 255, static_cast<std::int32_t>(_z) & 255, table);
+
+            const __m256d FY = _mm256_set1_pd(fy);
+            const __m256d FY1 = _mm256_set1_pd(fy - 1);
+            const __m256d FZ = _mm256_set1_pd(fz);
+            const __m256d FZ1 = _mm256_set1_pd(fz - 1);
+            const __m256d V = _mm256_set1_pd(Fade(fy));
+            const __m256d W = _mm256_set1_pd(Fade(fz));
+            const __m256d ONE = _mm256_set1_pd(1);
+            const __m128i MASK = _mm_set1_epi32(255);
+            const long long* hashes = reinterpret_cast<const long long*>(table);
+
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+            {
+                const __m256d X = _mm256_loadu_pd(xs + i);
+                const __m256d _x = _mm256_floor_pd(X);
+                const __m128i ix = _mm_and_si128(_mm256_cvttpd_epi32(_x), MASK);
+                const __m256i H = _mm256_i64gather_epi64(hashes, _mm256_cvtepi32_epi64(ix), 8);
+
+                const __m256d fx = _mm256_sub_pd(X, _x);
+                const __m256d fx1 = _mm256_sub_pd(fx, ONE);
+                const __m256d u = Fade4(fx);
+
+                const __m256d p0 = Grad4(H, fx, FY, FZ);
+                const __m256d p1 = Grad4(_mm256_srli_epi64(H, 8), fx1, FY, FZ);
+                const __m256d p2 = Grad4(_mm256_srli_epi64(H, 16), fx, FY1, FZ);
+                const __m256d p3 = Grad4(_mm256_srli_epi64(H, 24), fx1, FY1, FZ);
+                const __m256d p4 = Grad4(_mm256_srli_epi64(H, 32), fx, FY, FZ1);
+                const __m256d p5 = Grad4(_mm256_srli_epi64(H, 40), fx1, FY, FZ1);
+                const __m256d p6 = Grad4(_mm256_srli_epi64(H, 48), fx, FY1, FZ1);
+                const __m256d p7 = Grad4(_mm256_srli_epi64(H, 56), fx1, FY1, FZ1);
+
+                const __m256d q0 = Lerp4(p0, p1, u);
+                const __m256d q1 = Lerp4(p2, p3, u);
+                const __m256d q2 = Lerp4(p4, p5, u);
+                const __m256d q3 = Lerp4(p6, p7, u);
+                const __m256d r0 = Lerp4(q0, q1, V);
+                const __m256d r1 = Lerp4(q2, q3, V);
+                _mm256_storeu_pd(out + i, Lerp4(r0, r1, W));
+            }
+
+            return i;
+        }
+
+# endif
     }
 
     ///////////////////////////////////////
@@ -652,8 +798,64 @@ namespace siv
     {
         return perlin_detail::Remap_01(normalizedOctave3D(x, y, z, octaves, persistence));
     }
+
+    ///////////////////////////////////////
+
+    template <class Float>
+    inline void BasicPerlinNoise<Float>::noise2DRow(const value_type* xs, const value_type y, value_type* out, const std::size_t count) const noexcept
+    {
+        std::size_t i = 0;
+
+# if SIVPERLIN_AVX2
+        // Building the row's hash table costs about as much as 256 points, so short rows skip it
+        if constexpr (std::is_same_v<Float, double>)
+        {
+            if (count >= 256 && perlin_detail::HasAVX2())
+            {
+                i = perlin_detail::Noise3DRowAVX2(m_permutation.data(), xs, y, static_cast<value_type>(SIVPERLIN_DEFAULT_Z), out, count);
+            }
+        }
+# endif
+
+        for (; i < count; ++i)
+        {
+            out[i] = noise2D(xs[i], y);
+        }
+    }
+
+    template <class Float>
+    inline void BasicPerlinNoise<Float>::octave2DRow(const value_type* xs, value_type y, value_type* out, const std::size_t count, const std::int32_t octaves, const value_type persistence) const noexcept
+    {
+        // Work through the row in chunks, so the scaled coordinates fit on the stack
+        constexpr std::size_t ChunkSize = 1024;
+        value_type scaled[ChunkSize];
+        value_type layer[ChunkSize];
+
+        for (std::size_t begin = 0; begin < count; begin += ChunkSize)
+        {
+            const std::size_t n = std::min(ChunkSize, count - begin);
+            std::copy(xs + begin, xs + begin + n, scaled);
+            std::fill(out + begin, out + begin + n, value_type(0));
+
+            // Same steps as Octave2D(): doubling is exact, so each point sees the coordinates it would alone
+            value_type sy = y;
+            value_type amplitude = 1;
+            for (std::int32_t octave = 0; octave < octaves; ++octave)
+            {
+                noise2DRow(scaled, sy, layer, n);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    out[begin + i] += (layer[i] * amplitude);
+                    scaled[i] *= 2;
+                }
+                sy *= 2;
+                amplitude *= persistence;
+            }
+        }
+    }
 }
 
+# undef SIVPERLIN_AVX2
 # undef SIVPERLIN_NODISCARD_CXX20
 # undef SIVPERLIN_CONCEPT_URBG
 # undef SIVPERLIN_CONCEPT_URBG_
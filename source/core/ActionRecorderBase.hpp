@@ -0,0 +1,31 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A base class for recording the actions agents take in a world.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <cstddef>
+
+namespace cse491 {
+
+  class AgentBase;
+
+  /// @class ActionRecorderBase
+  /// @brief Receives every action an agent takes once a world has carried it out.
+  /// Worlds have no recorder by default, so nothing is recorded (or paid for) unless one is
+  /// attached with WorldBase::SetActionRecorder().
+  class ActionRecorderBase {
+  public:
+    virtual ~ActionRecorderBase() = default;
+
+    /// @brief Record an action that has just been carried out.
+    /// @param agent The agent that took the action.
+    /// @param action_id The ID of the action taken.
+    /// @param result The result of the action, as returned by DoAction().
+    /// @note Called from several threads at once while a world is running independent agents.
+    virtual void RecordAction(const AgentBase & agent, size_t action_id, int result) = 0;
+  };
+
+} // End of namespace cse491
@@ -15,7 +15,6 @@
 #include "Entity.hpp"
 #include "GridPosition.hpp"
 #include "WorldGrid.hpp"
-#include "../DataCollection/AgentData.hpp"
 
 namespace cse491 {
 
@@ -35,11 +34,14 @@ namespace cse491 {
     std::unordered_map<std::string, size_t> action_map;
     int action_result=0;  ///< Usually a one (success) or zero (failure).
 
-    int action; // The action that the agent is currently performing
+    size_t last_action=0;  ///< ID of the most recent action taken (zero is "no action").
 
     State agent_state = Healthy;  /// Default value upon initialization
 
   public:
+    static inline const PropertyKey<int> HEALTH_KEY{"Health"};          ///< Current health, if tracked
+    static inline const PropertyKey<int> MAX_HEALTH_KEY{"Max_Health"};  ///< Upper limit on health
+
     AgentBase(size_t id, const std::string & name) : Entity(id, name) {}
     ~AgentBase() = default; // Already virtual from Entity
 
@@ -71,15 +73,15 @@ namespace cse491 {
     /// @see TakeDamage
     /// @return None
     void UpdateAgentState(cse491::AgentBase & agent) {
-      if(agent.HasProperty("Health")){
-        if(agent.GetProperty<int>("Health") <= agent.GetProperty<int>("Max_Health")
-        && agent.GetProperty<int>("Health") > 3){
+      if(agent.HasProperty(HEALTH_KEY)){
+        const int health = agent.GetProperty(HEALTH_KEY);
+        if(health <= agent.GetProperty(MAX_HEALTH_KEY) && health > 3){
           agent.agent_state = Healthy;
         }
-        else if(agent.GetProperty<int>("Health") <= 3 && agent.GetProperty<int>("Health") > 0){
+        else if(health <= 3 && health > 0){
           agent.agent_state = Dying;
         }
-        else if(agent.GetProperty<int>("Health") <= 0){
+        else if(health <= 0){
           agent.agent_state = Deceased;
         }
       }
@@ -93,7 +95,7 @@ namespace cse491 {
     /// @brief If the agent is in State::Taking_Damage, decrease the health
     /// by the damage factor once per timestep.
     void TakeDamage(cse491::AgentBase & agent){
-        agent.SetProperty<int>("Health", agent.GetProperty<int>("Health") -
+        agent.SetProperty(HEALTH_KEY, agent.GetProperty(HEALTH_KEY) -
         agent.GetProperty<int>("Taking_Damage"));
         UpdateAgentState(agent);
     }
@@ -112,10 +114,8 @@ namespace cse491 {
       return it->second;
     }
 
-    void storeActionMap(std::string name) {
-        DataCollection::AgentData data(name);
-        data.StoreAction(action_map);
-    }
+    /// Return the map of action names to IDs available to this agent.
+    [[nodiscard]] const std::unordered_map<std::string, size_t> & GetActionMap() const { return action_map; }
 
     /// Allow derived agents to provide an arbitrary next position for the world to move the agent to
     [[nodiscard]] virtual GridPosition GetNextPosition() { return Entity::GetPosition(); }
@@ -144,6 +144,12 @@ namespace cse491 {
     /// Update the result from the most recent action.
     void SetActionResult(int result) { action_result = result; }
 
+    /// Retrieve the ID of the most recent action.
+    [[nodiscard]] size_t GetLastAction() const { return last_action; }
+
+    /// Update the ID of the most recent action.
+    void SetLastAction(size_t action_id) { last_action = action_id; }
+
     /// @brief Send a notification to this agent, typically from the world.
     /// @param message Contents of the notification
     /// @param msg_type Category of message, such as "item_alert", "damage", or "enemy"
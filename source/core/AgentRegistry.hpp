@@ -0,0 +1,164 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Dense, structure-of-arrays storage of the agents in a world.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+#include "AgentBase.hpp"
+#include "GridPosition.hpp"
+
+namespace cse491 {
+
+  /// @class AgentRegistry
+  /// @brief Keeps the agents of a world in parallel arrays (ID, agent, position, grid) sorted by ID.
+  /// A world's per-tick loops walk these arrays in order instead of chasing the nodes of agent_map,
+  /// and a sparse table from ID to array index makes finding an agent by ID a single lookup.
+  /// IDs far above the number of agents (e.g., sent by a server) go in a hash map instead, so
+  /// that one large ID cannot make the table huge.
+  /// Agent IDs are the stable handles; an agent's index may shift when other agents are removed.
+  /// The registry does not own the agents; the world's agent_map still does.
+  class AgentRegistry {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t MIN_SPARSE_SIZE = 1024;   ///< IDs below this always fit in the sparse table
+
+  private:
+    std::vector<size_t> ids;              ///< ID of each agent, in increasing order
+    std::vector<AgentBase *> agents;      ///< The agent with each ID
+    std::vector<GridPosition> positions;  ///< Last known position of each agent
+    std::vector<size_t> grid_ids;         ///< Grid each agent is on
+    std::vector<size_t> sparse;           ///< Index of each ID in the arrays above (npos if absent)
+    std::unordered_map<size_t, size_t> far_ids;  ///< Index of each ID too large for the sparse table
+
+    /// Record where in the arrays the agent with an ID is.
+    void SetIndex(size_t id, size_t index) {
+      if (id < sparse.size()) sparse[id] = index;
+      else far_ids[id] = index;
+    }
+
+    /// Point the sparse table at every agent from a given index onward.
+    void Reindex(size_t first_index) {
+      for (size_t i = first_index; i < ids.size(); ++i) SetIndex(ids[i], i);
+    }
+
+    /// Grow the sparse table to hold an ID, unless that would leave it mostly empty.
+    void GrowSparse(size_t id) {
+      if (id < sparse.size() || id >= std::max(MIN_SPARSE_SIZE, 4 * (ids.size() + 1))) return;
+      sparse.resize(std::max(id + 1, sparse.size() * 2), npos);
+      // Move over any large IDs the table now reaches.
+      for (auto it = far_ids.begin(); it != far_ids.end(); ) {
+        if (it->first >= sparse.size()) { ++it; continue; }
+        sparse[it->first] = it->second;
+        it = far_ids.erase(it);
+      }
+    }
+
+  public:
+    // -- Accessors --
+
+    [[nodiscard]] size_t GetNumAgents() const { return ids.size(); }
+
+    /// Is there an agent with the provided ID?
+    [[nodiscard]] bool Has(size_t id) const { return IndexOf(id) != npos; }
+
+    /// Return where in the arrays the agent with an ID is (npos if it is not here).
+    [[nodiscard]] size_t IndexOf(size_t id) const {
+      if (id < sparse.size()) return sparse[id];
+      if (far_ids.empty()) return npos;
+      auto it = far_ids.find(id);
+      return it == far_ids.end() ? npos : it->second;
+    }
+
+    [[nodiscard]] size_t GetID(size_t index) const { return ids[index]; }
+    [[nodiscard]] AgentBase & GetAgent(size_t index) const { return *agents[index]; }
+    [[nodiscard]] GridPosition GetPosition(size_t index) const { return positions[index]; }
+    [[nodiscard]] size_t GetGridID(size_t index) const { return grid_ids[index]; }
+
+    /// Return the agent with an ID, or nullptr if it is not here.
+    [[nodiscard]] AgentBase * Find(size_t id) const {
+      const size_t index = IndexOf(id);
+      return index == npos ? nullptr : agents[index];
+    }
+
+    // -- Modifiers --
+
+    /// @brief Add an agent, keeping the arrays in order of ID.
+    /// @param agent The agent to add; it must not already be here.
+    void Add(AgentBase & agent) {
+      const size_t id = agent.GetID();
+      assert(!Has(id));
+      GrowSparse(id);
+
+      // New agents almost always have the largest ID, so this is usually an append.
+      const size_t index = std::lower_bound(ids.begin(), ids.end(), id) - ids.begin();
+      ids.insert(ids.begin() + index, id);
+      agents.insert(agents.begin() + index, &agent);
+      positions.insert(positions.begin() + index, agent.GetPosition());
+      grid_ids.insert(grid_ids.begin() + index, agent.GetGridID());
+      Reindex(index);
+    }
+
+    /// @brief Remove the agent with an ID (if it is here).
+    void Remove(size_t id) {
+      const size_t index = IndexOf(id);
+      if (index == npos) return;
+      ids.erase(ids.begin() + index);
+      agents.erase(agents.begin() + index);
+      positions.erase(positions.begin() + index);
+      grid_ids.erase(grid_ids.begin() + index);
+      if (id < sparse.size()) sparse[id] = npos;
+      else far_ids.erase(id);
+      Reindex(index);
+    }
+
+    /// @brief Remove the agents with any of several IDs, shifting the others along only once.
+    /// @param remove_ids IDs to remove; any that are not here are ignored.
+    template <typename CONTAINER_T>
+    void RemoveAll(const CONTAINER_T & remove_ids) {
+      size_t first_index = ids.size();
+      for (size_t id : remove_ids) {
+        const size_t index = IndexOf(id);
+        if (index == npos) continue;
+        agents[index] = nullptr;    // Marks the agent to be dropped below.
+        first_index = std::min(first_index, index);
+        if (id < sparse.size()) sparse[id] = npos;
+        else far_ids.erase(id);
+      }
+      size_t kept = first_index;
+      for (size_t i = first_index; i < ids.size(); ++i) {
+        if (agents[i] == nullptr) continue;
+        ids[kept] = ids[i];
+        agents[kept] = agents[i];
+        positions[kept] = positions[i];
+        grid_ids[kept] = grid_ids[i];
+        ++kept;
+      }
+      ids.resize(kept);
+      agents.resize(kept);
+      positions.resize(kept);
+      grid_ids.resize(kept);
+      Reindex(first_index);
+    }
+
+    /// Remove all agents.
+    void Clear() {
+      ids.clear();
+      agents.clear();
+      positions.clear();
+      grid_ids.clear();
+      sparse.clear();
+      far_ids.clear();
+    }
+
+    /// Record a new position for the agent at an index.
+    void SetPosition(size_t index, GridPosition pos) { positions[index] = pos; }
+  };
+
+} // End of namespace cse491
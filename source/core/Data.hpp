@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -40,6 +41,21 @@ namespace cse491 {
     
     constexpr static char CELL_WALL[] = "wall";
     constexpr static char CELL_WATER[] = "water";
+
+    /// Bit flags summarizing the standard properties, for fast per-cell lookups in a grid.
+    using flags_t = uint8_t;
+    constexpr static flags_t FLAG_WALL = 1;      ///< Cell has the CELL_WALL property
+    constexpr static flags_t FLAG_WATER = 2;     ///< Cell has the CELL_WATER property
+    constexpr static flags_t FLAG_WALKABLE = 4;  ///< Cell can be walked on (is not a wall)
+
+    /// Collapse the standard properties of this CellType into a set of bit flags.
+    [[nodiscard]] flags_t GetFlags() const {
+      flags_t flags = 0;
+      if (HasProperty(CELL_WALL)) flags |= FLAG_WALL;
+      else flags |= FLAG_WALKABLE;
+      if (HasProperty(CELL_WATER)) flags |= FLAG_WATER;
+      return flags;
+    }
   };
 
   /// @brief Available CellTypes will be passed around as a vector of options.
@@ -9,13 +9,22 @@ namespace cse491 {
       auto & item = static_cast<ItemBase&>(*this);
       item.SetGrid(grid_id);
     }
+    if (world_ptr) world_ptr->UpdateEntityPosition(*this);
+    return *this;
+  }
+
+  Entity & Entity::SetPosition(double x, double y) {
+    position = GridPosition{x,y};
+    if (world_ptr) world_ptr->UpdateEntityPosition(*this);
     return *this;
   }
 
   Entity & Entity::AddItem(size_t id) {
     assert(!HasItem(id));
     inventory.push_back(id);
-    world_ptr->GetItem(id).SetOwner(*this);
+    auto & item = world_ptr->GetItem(id);
+    item.SetOwner(*this);
+    world_ptr->UpdateEntityPosition(item);  // Owned items are no longer on the grid.
     return *this;
   }
 
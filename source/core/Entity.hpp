@@ -12,8 +12,14 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include "GridPosition.hpp"
 #include "Data.hpp"
+#include "PropertyKey.hpp"
 
 namespace cse491 {
 
@@ -41,19 +47,97 @@ class Entity {
         Property(T && in) : value(in) { }
     };
 
+    /// Values small and simple enough to be stored directly in a PropertySlot.
+    template <typename T>
+    static constexpr bool is_inline_property = std::is_trivially_copyable_v<T> &&
+        sizeof(T) <= sizeof(uint64_t) && alignof(T) <= alignof(uint64_t);
+
+    /// A distinct address for each value type, to check properties are read as the type they hold.
+    template <typename T>
+    static inline const char type_tag = 0;
+
+    /// A single property: its name's interned ID and its value.
+    struct PropertySlot {
+        size_t key_id = 0;                    ///< ID of the name, from PropertyRegistry
+        PropertyType type = PropertyType::t_other; ///< Category of the value, for serialization
+        const void * value_type = nullptr;    ///< type_tag of the value's exact type
+        alignas(uint64_t) unsigned char inline_value[sizeof(uint64_t)] = {}; ///< Holds small values
+        std::unique_ptr<PropertyBase> boxed;  ///< Holds all other values
+    };
+
     /// Every entity can have a simple set of properties (with values) associated with it.
-    std::unordered_map<std::string, std::unique_ptr<PropertyBase>> property_map;
-    std::unordered_map<std::string, PropertyType> property_type_map;
+    /// Entities have few properties, so they are kept in a flat table searched by ID.
+    std::vector<PropertySlot> properties;
 
     // -- Helper Functions --
 
+    [[nodiscard]] const PropertySlot * FindSlot(size_t key_id) const {
+        for (const PropertySlot & slot : properties) {
+            if (slot.key_id == key_id) return &slot;
+        }
+        return nullptr;
+    }
+    [[nodiscard]] PropertySlot * FindSlot(size_t key_id) {
+        return const_cast<PropertySlot *>(std::as_const(*this).FindSlot(key_id));
+    }
+
+    [[nodiscard]] const PropertySlot * FindSlot(const std::string & name) const {
+        const size_t key_id = PropertyRegistry::Find(name);
+        return key_id == PropertyRegistry::npos ? nullptr : FindSlot(key_id);
+    }
+
+    /// Find a property that must exist.
+    [[nodiscard]] const PropertySlot & GetSlot(size_t key_id) const {
+        auto it = std::find_if(properties.begin(), properties.end(),
+                               [key_id](const PropertySlot & slot){ return slot.key_id == key_id; });
+        assert(it != properties.end());   // Break if property does not already exist.
+        if (it == properties.end()) throw std::out_of_range("Entity has no such property");
+        return *it;
+    }
+
     template <typename T>
-    Property<T> & AsProperty(const std::string & name) const {
-        assert( HasProperty(name) );
-        PropertyBase * raw_ptr = property_map.at(name).get();
-        assert( dynamic_cast<Property<T> *>(raw_ptr) );
-        auto property_ptr = static_cast<Property<T> *>(raw_ptr);
-        return *property_ptr;
+    static const T & SlotValue(const PropertySlot & slot) {
+        assert(slot.value_type == &type_tag<T>);  // Break if property holds a different type.
+        if constexpr (is_inline_property<T>) {
+            return *std::launder(reinterpret_cast<const T *>(slot.inline_value));
+        } else {
+            return static_cast<const Property<T> *>(slot.boxed.get())->value;
+        }
+    }
+    template <typename T>
+    static T & SlotValue(PropertySlot & slot) {
+        return const_cast<T &>(SlotValue<T>(std::as_const(slot)));
+    }
+
+    template <typename T>
+    static constexpr PropertyType ToPropertyType() {
+        if (std::is_same<T, double>::value) return PropertyType::t_double;
+        else if (std::is_same<T, int>::value) return PropertyType::t_int;
+        else if (std::is_same<T, char>::value) return PropertyType::t_char;
+        else if (std::is_same<T, std::string>::value) return PropertyType::t_string;
+        else return PropertyType::t_other;
+    }
+
+    template <typename T>
+    Entity & SetPropertyByID(size_t key_id, const T & value) {
+        if (PropertySlot * slot = FindSlot(key_id)) {
+            SlotValue<T>(*slot) = value;
+            return *this;
+        }
+        PropertySlot & slot = properties.emplace_back();
+        slot.key_id = key_id;
+        slot.type = ToPropertyType<T>();
+        slot.value_type = &type_tag<T>;
+        if constexpr (is_inline_property<T>) new (slot.inline_value) T(value);
+        else slot.boxed = std::make_unique<Property<T>>(value);
+        return *this;
+    }
+
+    Entity & RemovePropertyByID(size_t key_id) {
+        auto it = std::find_if(properties.begin(), properties.end(),
+                               [key_id](const PropertySlot & slot){ return slot.key_id == key_id; });
+        if (it != properties.end()) properties.erase(it);
+        return *this;
     }
 
  public:
@@ -74,7 +158,7 @@ class Entity {
     [[nodiscard]] bool HasWorld() const { return world_ptr != nullptr;}
     Entity & SetName(const std::string in_name) { name = in_name; return *this; }
     Entity & SetPosition(GridPosition in_pos, size_t grid_id=0);
-    Entity & SetPosition(double x, double y) { position = GridPosition{x,y}; return *this; }
+    Entity & SetPosition(double x, double y);
     virtual Entity & SetWorld(WorldBase & in_world) { world_ptr = &in_world; return *this; }
 
     virtual bool IsAgent() const { return false; }     ///< Is Entity an autonomous agent?
@@ -83,42 +167,43 @@ class Entity {
 
 
     // -- Property Management --
+    // Properties can be named with a string or, more quickly, with a PropertyKey made once
+    // for that name.  References to property values are invalidated when properties are added or removed.
 
     /// Does this agent have a property with the specified name?
     [[nodiscard]] bool HasProperty(const std::string & name) const {
-        return property_map.count(name);
+        return FindSlot(name) != nullptr;
+    }
+
+    template <typename T>
+    [[nodiscard]] bool HasProperty(const PropertyKey<T> & key) const {
+        return FindSlot(key.GetID()) != nullptr;
     }
 
     /// Return the current value of the specified property.
     template <typename T=double>
     [[nodiscard]] const T & GetProperty(const std::string & name) const {
-        assert(HasProperty(name));   // Break if property does not already exist.
-        return AsProperty<T>(name).value;
+        return SlotValue<T>(GetSlot(PropertyRegistry::Find(name)));
     }
 
-    [[nodiscard]] PropertyType GetPropertyType(const std::string &key) const {
-      return property_type_map.at(key);
+    template <typename T>
+    [[nodiscard]] const T & GetProperty(const PropertyKey<T> & key) const {
+        return SlotValue<T>(GetSlot(key.GetID()));
     }
 
-    template <typename T>
-    void SetPropertyType(const std::string & name) {
-        if (std::is_same<T, double>::value) property_type_map[name] = PropertyType::t_double;
-        else if (std::is_same<T, int>::value) property_type_map[name] = PropertyType::t_int;
-        else if (std::is_same<T, char>::value) property_type_map[name] = PropertyType::t_char;
-        else if (std::is_same<T, std::string>::value) property_type_map[name] = PropertyType::t_string;
-        else property_type_map[name] = PropertyType::t_other;
+    [[nodiscard]] PropertyType GetPropertyType(const std::string &key) const {
+      return GetSlot(PropertyRegistry::Find(key)).type;
     }
 
     /// Change the value of the specified property (will create if needed)
     template <typename T>
     Entity & SetProperty(const std::string & name, const T & value) {
-        if (HasProperty(name)) {
-            AsProperty<T>(name).value = value;
-        } else {
-            property_map[name] = std::make_unique<Property<T>>(value);
-            SetPropertyType<T>(name);
-        }
-        return *this;
+        return SetPropertyByID(PropertyRegistry::Intern(name), value);
+    }
+
+    template <typename T>
+    Entity & SetProperty(const PropertyKey<T> & key, const std::type_identity_t<T> & value) {
+        return SetPropertyByID<T>(key.GetID(), value);
     }
 
     /// Allow for setting multiple properties at once.
@@ -132,14 +217,44 @@ class Entity {
 
     /// Completely remove a property from an Entity.
     Entity & RemoveProperty(const std::string & name) {
-      property_map.erase(name);
-      property_type_map.erase(name);
+      const size_t key_id = PropertyRegistry::Find(name);
+      if (key_id != PropertyRegistry::npos) RemovePropertyByID(key_id);
       return *this;
-    }    
+    }
+
+    template <typename T>
+    Entity & RemoveProperty(const PropertyKey<T> & key) { return RemovePropertyByID(key.GetID()); }
 
+    /// Return how many properties the entity has.
+    [[nodiscard]] size_t GetNumProperties() const { return properties.size(); }
 
-    /// return the property map for the entity
-    std::unordered_map<std::string, std::unique_ptr<cse491::Entity::PropertyBase>> & GetProprtyMap() { return property_map; }
+    /// Return the names of all of the entity's properties, in the order they were added.
+    [[nodiscard]] std::vector<std::string> GetPropertyNames() const {
+      std::vector<std::string> names;
+      for (const PropertySlot & slot : properties) names.push_back(PropertyRegistry::GetName(slot.key_id));
+      return names;
+    }
+
+    /// Return how many properties hold a double, int, char, or std::string (the types that can be serialized).
+    [[nodiscard]] size_t GetNumTypedProperties() const {
+      return std::count_if(properties.begin(), properties.end(),
+                           [](const PropertySlot & slot){ return slot.type != PropertyType::t_other; });
+    }
+
+    /// Call fun(name, value) on each property that holds a double, int, char, or std::string.
+    template <typename FUN_T>
+    void ForEachTypedProperty(FUN_T && fun) const {
+      for (const PropertySlot & slot : properties) {
+        const std::string & name = PropertyRegistry::GetName(slot.key_id);
+        switch (slot.type) {
+          case PropertyType::t_double: fun(name, SlotValue<double>(slot)); break;
+          case PropertyType::t_int: fun(name, SlotValue<int>(slot)); break;
+          case PropertyType::t_char: fun(name, SlotValue<char>(slot)); break;
+          case PropertyType::t_string: fun(name, SlotValue<std::string>(slot)); break;
+          case PropertyType::t_other: break;
+        }
+      }
+    }
 
 
     /// Inventory Management
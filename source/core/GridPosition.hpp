@@ -105,6 +105,11 @@ class GridPosition {
         const double dist2 = y - pos2.y;
         return (dist1*dist1 + dist2*dist2) <= (max_dist * max_dist);
     }
+
+    /// Is this position inside the rectangle from min_pos (included) to max_pos (excluded)?
+    [[nodiscard]] bool IsInRect(GridPosition min_pos, GridPosition max_pos) const {
+        return x >= min_pos.x && y >= min_pos.y && x < max_pos.x && y < max_pos.y;
+    }
 };
 
 } // End of namespace cse491
@@ -73,23 +73,23 @@ namespace cse491 {
       os << name << '\n';
       os << position.GetX() << '\n';
       os << position.GetY() << '\n';
-      os << property_map.size() << '\n';
-      for (const auto & property : property_map) {
-        os << property.first << '\n';
+      os << properties.size() << '\n';
+      for (const auto & property : properties) {
+        os << PropertyRegistry::GetName(property.key_id) << '\n';
 
         // Get property type
-        PropertyType type = GetPropertyType(property.first);
+        PropertyType type = property.type;
         os << static_cast<int>(type) << '\n';
 
         // serialize property value
         if (type == PropertyType::t_double) {
-          os << AsProperty<double>(property.first).value << '\n';
+          os << SlotValue<double>(property) << '\n';
         } else if (type == PropertyType::t_int) {
-          os << AsProperty<int>(property.first).value << '\n';
+          os << SlotValue<int>(property) << '\n';
         } else if (type == PropertyType::t_char) {
-          os << AsProperty<char>(property.first).value << '\n';
+          os << SlotValue<char>(property) << '\n';
         } else if (type == PropertyType::t_string) {
-          os << AsProperty<std::string>(property.first).value << '\n';
+          os << SlotValue<std::string>(property) << '\n';
         } else {
           // unknown type, do nothing
           os << '\n';
@@ -0,0 +1,84 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Read-only access to the bytes of a file, memory-mapped where the platform allows.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cse491 {
+
+  /// @class MappedFile
+  /// @brief Maps a whole file into memory so it can be read without copying it into a buffer first.
+  /// The operating system pages the file in as it is read.  On platforms without mmap(), the file
+  /// is read into memory instead.
+  class MappedFile {
+  private:
+    const char * data = nullptr;  ///< Start of the file's bytes
+    size_t size = 0;              ///< Number of bytes in the file
+    bool is_open = false;         ///< Was the file opened successfully?
+#ifdef _WIN32
+    std::string buffer;           ///< Contents of the file
+#else
+    void * mapping = nullptr;     ///< Mapping to release (null for an empty file)
+#endif
+
+  public:
+    explicit MappedFile(const std::string & filename) {
+#ifdef _WIN32
+      std::ifstream is(filename, std::ios::binary);
+      if (!is.is_open()) return;
+      buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+      data = buffer.data();
+      size = buffer.size();
+      is_open = true;
+#else
+      const int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0) return;
+      struct stat info;
+      if (::fstat(fd, &info) == 0) {
+        size = static_cast<size_t>(info.st_size);
+        if (size == 0) is_open = true;   // Nothing to map.
+        else {
+          mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (mapping == MAP_FAILED) { mapping = nullptr; size = 0; }
+          else {
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapping);
+            is_open = true;
+          }
+        }
+      }
+      ::close(fd);   // The mapping stays valid after the file is closed.
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+      if (mapping) ::munmap(mapping, size);
+#endif
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] bool IsOpen() const { return is_open; }
+    [[nodiscard]] const char * GetData() const { return data; }
+    [[nodiscard]] size_t GetSize() const { return size; }
+    [[nodiscard]] std::string_view GetView() const { return {data, size}; }
+  };
+
+} // End of namespace cse491
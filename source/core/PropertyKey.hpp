@@ -0,0 +1,100 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Interned IDs for entity property names, and typed handles to look properties up by.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace cse491 {
+
+  /// @class PropertyRegistry
+  /// @brief Gives every property name used by any entity a small, permanent ID.
+  /// Looking a name up still means hashing it, so code that touches a property often should
+  /// look its ID up once, through a PropertyKey, rather than passing the name each time.
+  class PropertyRegistry {
+  public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+  private:
+    struct Table {
+      std::shared_mutex mutex;
+      std::unordered_map<std::string, size_t> ids;
+      std::deque<std::string> names;  ///< Indexed by ID; a deque so names never move.
+    };
+
+    static Table & GetTable() {
+      static Table table;
+      return table;
+    }
+
+    /// IDs never change once given, so each thread keeps the ones it has seen and only locks on a miss.
+    static std::unordered_map<std::string, size_t> & GetThreadCache() {
+      thread_local std::unordered_map<std::string, size_t> cache;
+      return cache;
+    }
+
+  public:
+    /// @brief Get the ID of a property name, giving it one if it does not have one yet.
+    static size_t Intern(const std::string & name) {
+      auto & cache = GetThreadCache();
+      auto cache_it = cache.find(name);
+      if (cache_it != cache.end()) return cache_it->second;
+
+      Table & table = GetTable();
+      std::unique_lock lock(table.mutex);
+      auto [it, inserted] = table.ids.emplace(name, table.names.size());
+      if (inserted) table.names.push_back(name);
+      cache.emplace(name, it->second);
+      return it->second;
+    }
+
+    /// @brief Get the ID of a property name, or npos if no entity has used that name.
+    [[nodiscard]] static size_t Find(const std::string & name) {
+      auto & cache = GetThreadCache();
+      auto cache_it = cache.find(name);
+      if (cache_it != cache.end()) return cache_it->second;
+
+      Table & table = GetTable();
+      std::shared_lock lock(table.mutex);
+      auto it = table.ids.find(name);
+      if (it == table.ids.end()) return npos;
+      cache.emplace(name, it->second);
+      return it->second;
+    }
+
+    /// @brief Get the name that was given an ID.
+    [[nodiscard]] static const std::string & GetName(size_t id) {
+      Table & table = GetTable();
+      std::shared_lock lock(table.mutex);
+      return table.names.at(id);
+    }
+  };
+
+  /// @class PropertyKey
+  /// @brief A handle for one property name, holding its interned ID and the type of its value.
+  /// Make one for each property that is used often (usually as a static const) and pass it in
+  /// place of the name to Entity::GetProperty() and friends.
+  /// @tparam T The type of the property's value.
+  template <typename T>
+  class PropertyKey {
+  private:
+    size_t id;
+
+  public:
+    using value_t = T;
+
+    explicit PropertyKey(const std::string & name) : id(PropertyRegistry::Intern(name)) { }
+
+    [[nodiscard]] size_t GetID() const { return id; }
+    [[nodiscard]] const std::string & GetName() const { return PropertyRegistry::GetName(id); }
+  };
+
+} // End of namespace cse491
@@ -0,0 +1,250 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Snapshots of what a world looks like, handed from the simulation to a render thread.
+ * @note Status: PROPOSAL
+ *
+ * The world publishes a snapshot at the end of each tick and a renderer takes the newest one
+ * whenever it draws a frame, so each side runs at its own rate.  A snapshot is never changed
+ * while the renderer holds it.  The two sides swap snapshots through one atomic slot index:
+ * the world fills a back snapshot while the renderer reads the front one, and a third spare
+ * snapshot sits between them so that publishing never waits for a frame to finish (and taking
+ * the newest never waits for a tick to finish).
+ *
+ * Refilling a back snapshot only copies the cells that changed since that snapshot was last
+ * published, using the grid's change list for each recent tick.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AgentBase.hpp"
+#include "Data.hpp"
+#include "GridPosition.hpp"
+#include "ItemBase.hpp"
+#include "WorldGrid.hpp"
+
+namespace cse491 {
+
+  /// @brief One agent or item as it appears in a RenderSnapshot.
+  struct RenderEntity {
+    size_t id = 0;
+    bool is_agent = false;
+    char symbol = '*';
+    GridPosition from;   ///< Position in the previous snapshot (the same as `to` if it just appeared)
+    GridPosition to;     ///< Position when this snapshot was published
+
+    /// Position part of the way from `from` (progress 0) to `to` (progress 1).
+    [[nodiscard]] GridPosition Interpolate(double progress) const {
+      return GridPosition(from.GetX() + (to.GetX() - from.GetX()) * progress,
+                          from.GetY() + (to.GetY() - from.GetY()) * progress);
+    }
+  };
+
+  /// @brief What a world looked like at the end of one tick.
+  struct RenderSnapshot {
+    using clock_t = std::chrono::steady_clock;
+
+    size_t tick = 0;                    ///< Number of this snapshot (the first published is 1; 0 is empty)
+    clock_t::time_point time{};         ///< When it was published
+    clock_t::duration interval{};       ///< Time since the snapshot before it was published
+
+    size_t width = 0;                   ///< Cells in each row of the grid
+    size_t height = 0;                  ///< Rows in the grid
+    std::vector<char> cells;            ///< Symbol of every cell, row by row
+
+    std::vector<RenderEntity> entities; ///< Items and agents on the grid, by the cell of `to` (row, then column)
+    RenderEntity focus;                 ///< The entity the buffer follows (e.g., the player)
+    bool has_focus = false;             ///< Was the followed entity on the grid?
+
+    /// @brief How far through the move from the previous snapshot to this one a renderer should be.
+    /// @param now The time being drawn.
+    /// @param longest Moves never take longer than this, however long the tick was.
+    /// @return Between 0 (just published) and 1 (the move is over).
+    [[nodiscard]] double Progress(clock_t::time_point now, clock_t::duration longest) const {
+      const auto span = std::min(interval, longest);
+      if (span <= clock_t::duration::zero()) return 1.0;
+      return std::clamp(std::chrono::duration<double>(now - time) / span, 0.0, 1.0);
+    }
+
+    /// @brief Call a function on every entity that ends this tick in a rectangle of cells.
+    /// Each row in the rectangle takes one binary search, so the cost follows the rectangle's
+    /// height and the entities in it rather than the number of entities in the world.
+    /// @param first_col First column to include.
+    /// @param first_row First row to include.
+    /// @param last_col Last column to include.
+    /// @param last_row Last row to include.
+    /// @param fun Function to call on each RenderEntity, in row order and then column order.
+    template <typename FUN_T>
+    void ForEachEntityInCells(size_t first_col, size_t first_row, size_t last_col, size_t last_row,
+                              FUN_T && fun) const {
+      using cell_t = std::pair<size_t, size_t>;   // Row, then column
+      auto before = [](const RenderEntity & entity, cell_t cell) {
+        return cell_t{entity.to.CellY(), entity.to.CellX()} < cell;
+      };
+      auto it = entities.begin();
+      for (size_t row = first_row; row <= last_row; ) {
+        it = std::lower_bound(it, entities.end(), cell_t{row, first_col}, before);
+        if (it == entities.end() || it->to.CellY() > last_row) return;
+        if (it->to.CellY() > row) { row = it->to.CellY(); continue; }   // Skip rows with nothing in range.
+        for (; it != entities.end() && it->to.CellY() == row && it->to.CellX() <= last_col; ++it) fun(*it);
+        if (row == last_row) return;
+        ++row;
+      }
+    }
+  };
+
+  /// @class RenderSnapshotBuffer
+  /// @brief Passes RenderSnapshots from one publishing thread to one reading thread without locks.
+  /// Publish() must only ever be called from one thread, and Acquire() and Read() from one other.
+  class RenderSnapshotBuffer {
+  public:
+    using clock_t = RenderSnapshot::clock_t;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t HISTORY_SIZE = 8;   ///< Ticks of cell changes kept to refill old snapshots
+
+  private:
+    static constexpr uint8_t INDEX_MASK = 3;    ///< Bits of spare_slot holding the slot index
+    static constexpr uint8_t FRESH = 4;         ///< Bit of spare_slot set when it holds an unread snapshot
+
+    std::array<RenderSnapshot, 3> slots;
+    std::atomic<uint8_t> spare_slot{1};         ///< The slot between the two sides, and the FRESH bit
+    uint8_t write_slot = 0;                     ///< Slot being filled (publisher only)
+    uint8_t read_slot = 2;                      ///< Slot being drawn (reader only)
+
+    // -- Publisher state --
+    size_t focus_id;                            ///< Agent whose RenderEntity is copied into `focus`
+    size_t num_published = 0;
+    clock_t::time_point last_time{};
+    /// Cells changed by one published tick.
+    struct TickChanges {
+      size_t tick = 0;
+      bool replaced = false;
+      std::vector<size_t> cells;
+    };
+    std::deque<TickChanges> history;
+    std::unordered_map<size_t, GridPosition> agent_positions;   ///< Where each agent was last published
+    std::unordered_map<size_t, GridPosition> item_positions;    ///< Where each item was last published
+
+    static char SymbolOf(const type_options_t & types, size_t state) {
+      if (state < types.size()) return types[state].symbol;
+      return types.empty() ? ' ' : types[0].symbol;
+    }
+
+    /// Bring the cells of a slot up to date, patching only what changed if history reaches back far enough.
+    void UpdateCells(RenderSnapshot & slot, const WorldGrid & grid, const type_options_t & types) const {
+      const size_t width = grid.GetWidth();
+      bool patch = slot.tick != 0 && slot.width == width && slot.height == grid.GetHeight() &&
+                   !history.empty() && history.front().tick <= slot.tick + 1;
+      for (const auto & changes : history) {
+        if (changes.tick > slot.tick && changes.replaced) patch = false;
+      }
+
+      if (!patch) {
+        slot.width = width;
+        slot.height = grid.GetHeight();
+        slot.cells.resize(grid.GetNumCells());
+        for (size_t y = 0; y < slot.height; ++y) {
+          for (size_t x = 0; x < width; ++x) slot.cells[y * width + x] = SymbolOf(types, grid.At(x, y));
+        }
+        return;
+      }
+      for (const auto & changes : history) {
+        if (changes.tick <= slot.tick) continue;
+        for (size_t cell : changes.cells) slot.cells[cell] = SymbolOf(types, grid.At(cell % width, cell / width));
+      }
+    }
+
+    /// Add an entity to a snapshot, remembering where it was for the next one.
+    static void AddEntity(RenderSnapshot & slot, std::unordered_map<size_t, GridPosition> & last_positions,
+                          std::unordered_map<size_t, GridPosition> & positions,
+                          size_t id, bool is_agent, char symbol, GridPosition pos) {
+      auto last = last_positions.find(id);
+      const GridPosition from = last == last_positions.end() ? pos : last->second;
+      slot.entities.push_back(RenderEntity{id, is_agent, symbol, from, pos});
+      positions[id] = pos;
+    }
+
+  public:
+    /// @param focus_id ID of the agent to follow (e.g., the player's interface), or npos for none.
+    explicit RenderSnapshotBuffer(size_t focus_id = npos) : focus_id(focus_id) { }
+
+    /// @return Number of snapshots published so far (publisher only).
+    [[nodiscard]] size_t GetPublishCount() const { return num_published; }
+
+    /// @brief Record the world as it is now and make it the newest snapshot.
+    /// @param grid The grid to copy.
+    /// @param types Cell types, for the symbol of each cell.
+    /// @param items Items; those with a valid position and no owner are included.
+    /// @param agents Agents; those with a valid position on grid 0 are included.
+    /// @param changed_cells Cells that changed since the last call, or nullptr if any may have.
+    /// @param now Time to stamp the snapshot with.
+    void Publish(const WorldGrid & grid, const type_options_t & types, const item_map_t & items,
+                 const agent_map_t & agents, const std::vector<size_t> * changed_cells,
+                 clock_t::time_point now = clock_t::now()) {
+      const size_t tick = ++num_published;
+      history.push_back(TickChanges{tick, changed_cells == nullptr, {}});
+      if (changed_cells) history.back().cells = *changed_cells;
+      if (history.size() > HISTORY_SIZE) history.pop_front();
+
+      RenderSnapshot & slot = slots[write_slot];
+      UpdateCells(slot, grid, types);
+
+      slot.entities.clear();
+      std::unordered_map<size_t, GridPosition> new_item_positions, new_agent_positions;
+      for (const auto & [id, item_ptr] : items) {
+        const GridPosition pos = item_ptr->GetPosition();
+        if (item_ptr->IsOwned() || !pos.IsValid() || !grid.IsValid(pos)) continue;
+        const char symbol = item_ptr->HasProperty("symbol") ? item_ptr->GetProperty<char>("symbol") : '+';
+        AddEntity(slot, item_positions, new_item_positions, id, false, symbol, pos);
+      }
+      slot.has_focus = false;
+      for (const auto & [id, agent_ptr] : agents) {
+        const GridPosition pos = agent_ptr->GetPosition();
+        if (!agent_ptr->IsOnGrid(0) || !pos.IsValid() || !grid.IsValid(pos)) continue;
+        const char symbol = agent_ptr->HasProperty("symbol") ? agent_ptr->GetProperty<char>("symbol") : '*';
+        AddEntity(slot, agent_positions, new_agent_positions, id, true, symbol, pos);
+        if (id == focus_id) {
+          slot.focus = slot.entities.back();
+          slot.has_focus = true;
+        }
+      }
+      // Agents are drawn over items in the same cell, so keep them after items within each cell.
+      std::sort(slot.entities.begin(), slot.entities.end(), [](const RenderEntity & a, const RenderEntity & b) {
+        return std::make_tuple(a.to.CellY(), a.to.CellX(), a.is_agent, a.id) <
+               std::make_tuple(b.to.CellY(), b.to.CellX(), b.is_agent, b.id);
+      });
+      item_positions.swap(new_item_positions);
+      agent_positions.swap(new_agent_positions);
+
+      slot.tick = tick;
+      slot.interval = num_published == 1 ? clock_t::duration::zero() : now - last_time;
+      slot.time = now;
+      last_time = now;
+
+      // Hand the filled slot over and take back whichever one was spare.
+      write_slot = spare_slot.exchange(write_slot | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /// @brief Move to the newest published snapshot, if there is one the reader has not seen.
+    /// @return true if Read() now returns a new snapshot.
+    bool Acquire() {
+      if (!(spare_slot.load(std::memory_order_relaxed) & FRESH)) return false;
+      read_slot = spare_slot.exchange(read_slot, std::memory_order_acq_rel) & INDEX_MASK;
+      return true;
+    }
+
+    /// @return The snapshot taken by the last Acquire() (empty, with tick 0, before the first).
+    [[nodiscard]] const RenderSnapshot & Read() const { return slots[read_slot]; }
+  };
+
+} // End of namespace cse491
@@ -0,0 +1,228 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A uniform bucket grid to quickly find entities by position.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "GridPosition.hpp"
+
+namespace cse491 {
+
+  /// @class SpatialIndex
+  /// @brief Groups entity IDs into buckets based on the grid cells they occupy.
+  /// Each bucket covers a square of bucket_size x bucket_size cells, so looking up what is
+  /// at or near a position only needs to examine a few buckets rather than every entity.
+  /// The index only provides candidates; callers should still apply their exact test
+  /// (such as matching grid IDs or distances) to each ID returned.
+  /// IDs far above the number of entities (e.g., sent by a server) are filed in a hash map
+  /// instead of the table by ID, so that one large ID cannot make the table huge.
+  class SpatialIndex {
+  public:
+    static constexpr size_t MIN_DENSE_SIZE = 1024;   ///< IDs below this always fit in entity_keys
+
+  private:
+    using key_t = uint64_t;
+
+    double bucket_size = 1.0;  ///< Width (and height) of each bucket, in cells.
+    std::unordered_map<key_t, std::vector<size_t>> buckets;  ///< Entity IDs in each bucket
+    /// Where an entity is filed; most entity IDs are small and dense, so these are kept in a vector by ID.
+    struct EntityEntry {
+      key_t key = 0;         ///< Bucket the entity is in
+      bool present = false;  ///< Is the entity in the index at all?
+    };
+    std::vector<EntityEntry> entity_keys;  ///< Bucket each entity is in, indexed by ID
+    std::unordered_map<size_t, key_t> far_keys;  ///< Bucket of each entity with an ID too large for entity_keys
+    size_t num_entities = 0;               ///< Number of entities in the index
+
+    // -- Helper functions --
+
+    /// Convert a single coordinate into the bucket coordinate that contains it.
+    [[nodiscard]] int64_t ToBucket(double coord) const {
+      return static_cast<int64_t>(std::floor(coord / bucket_size));
+    }
+
+    /// Pack a pair of bucket coordinates into a single key.
+    [[nodiscard]] static key_t ToKey(int64_t bucket_x, int64_t bucket_y) {
+      return (static_cast<key_t>(static_cast<uint32_t>(bucket_x)) << 32)
+             | static_cast<uint32_t>(bucket_y);
+    }
+
+    /// Find the key for the bucket containing a given position.
+    [[nodiscard]] key_t ToKey(GridPosition pos) const {
+      return ToKey(ToBucket(pos.GetX()), ToBucket(pos.GetY()));
+    }
+
+    /// Grow entity_keys to hold an ID, unless that would leave it mostly empty.
+    void GrowDense(size_t id) {
+      if (id < entity_keys.size() || id >= std::max(MIN_DENSE_SIZE, 4 * (num_entities + 1))) return;
+      entity_keys.resize(std::max(id + 1, entity_keys.size() * 2));
+      // Move over any large IDs the table now reaches.
+      for (auto it = far_keys.begin(); it != far_keys.end(); ) {
+        if (it->first >= entity_keys.size()) { ++it; continue; }
+        entity_keys[it->first] = EntityEntry{it->second, true};
+        it = far_keys.erase(it);
+      }
+    }
+
+    /// Remove an ID from a bucket, cleaning up the bucket if it is now empty.
+    void EraseFromBucket(key_t key, size_t id) {
+      auto bucket_it = buckets.find(key);
+      assert(bucket_it != buckets.end());
+      auto & ids = bucket_it->second;
+      auto id_it = std::find(ids.begin(), ids.end(), id);
+      assert(id_it != ids.end());
+      *id_it = ids.back();   // Order within a bucket does not matter; swap and pop.
+      ids.pop_back();
+      if (ids.empty()) buckets.erase(bucket_it);
+    }
+
+  public:
+    SpatialIndex(double bucket_size=1.0) : bucket_size(bucket_size) { assert(bucket_size > 0.0); }
+
+    // -- Accessors --
+
+    [[nodiscard]] double GetBucketSize() const { return bucket_size; }
+    [[nodiscard]] size_t GetNumEntities() const { return num_entities; }
+    [[nodiscard]] size_t GetNumBuckets() const { return buckets.size(); }
+
+    /// Is the entity with the provided ID currently in this index?
+    [[nodiscard]] bool Has(size_t id) const {
+      if (id < entity_keys.size()) return entity_keys[id].present;
+      return !far_keys.empty() && far_keys.count(id);
+    }
+
+    /// @brief Determine how many buckets a query of a given radius would have to visit.
+    /// @param dist Maximum distance from the query position.
+    /// @return The number of buckets that overlap the query square (SIZE_MAX if too many to count).
+    [[nodiscard]] size_t CountBucketsNear(double dist) const {
+      const double buckets_wide = std::floor(2.0 * std::abs(dist) / bucket_size) + 2.0;
+      // Squaring more than 2^32 buckets a side would overflow (and casting infinity or NaN is undefined).
+      if (!(buckets_wide < 4294967296.0)) return SIZE_MAX;
+      return static_cast<size_t>(buckets_wide) * static_cast<size_t>(buckets_wide);
+    }
+
+    // -- Modifiers --
+
+    /// Remove all entities from the index.
+    void Clear() {
+      buckets.clear();
+      entity_keys.clear();
+      far_keys.clear();
+      num_entities = 0;
+    }
+
+    /// @brief Place an entity in the index, or move it if it is already there.
+    /// @param id Unique ID of the entity.
+    /// @param pos The entity's current position; invalid positions remove it from the index.
+    void Update(size_t id, GridPosition pos) {
+      if (!pos.IsValid()) { Remove(id); return; }
+
+      const key_t new_key = ToKey(pos);
+      if (!Has(id)) GrowDense(id);
+      bool present = false;
+      key_t * entry_key = nullptr;
+      if (id < entity_keys.size()) {
+        EntityEntry & entry = entity_keys[id];
+        present = entry.present;
+        entry.present = true;
+        entry_key = &entry.key;
+      } else {
+        auto [it, inserted] = far_keys.try_emplace(id, new_key);
+        present = !inserted;
+        entry_key = &it->second;
+      }
+      if (present) {
+        if (*entry_key == new_key) return;   // Still in the same bucket; nothing to do.
+        const key_t old_key = *entry_key;
+        *entry_key = new_key;
+
+        // A lone entity moving to an empty bucket takes its old bucket along, to save reallocating it.
+        auto old_it = buckets.find(old_key);
+        assert(old_it != buckets.end());
+        if (old_it->second.size() == 1 && !buckets.count(new_key)) {
+          auto node = buckets.extract(old_it);
+          node.key() = new_key;
+          buckets.insert(std::move(node));
+          return;
+        }
+        EraseFromBucket(old_key, id);
+      } else {
+        *entry_key = new_key;
+        ++num_entities;
+      }
+      buckets[new_key].push_back(id);
+    }
+
+    /// @brief Remove an entity from the index (if it is there).
+    /// @param id Unique ID of the entity.
+    void Remove(size_t id) {
+      if (id < entity_keys.size()) {
+        if (!entity_keys[id].present) return;
+        EraseFromBucket(entity_keys[id].key, id);
+        entity_keys[id].present = false;
+      } else {
+        auto it = far_keys.find(id);
+        if (it == far_keys.end()) return;
+        EraseFromBucket(it->second, id);
+        far_keys.erase(it);
+      }
+      --num_entities;
+    }
+
+    // -- Queries --
+
+    /// @brief Call a function on the ID of every entity in the same bucket as a position.
+    /// @param pos Position to look up.
+    /// @param fun Function to call on each candidate ID.
+    template <typename FUN_T>
+    void ForEachAt(GridPosition pos, FUN_T && fun) const {
+      if (!pos.IsValid()) return;
+      auto it = buckets.find(ToKey(pos));
+      if (it == buckets.end()) return;
+      for (size_t id : it->second) fun(id);
+    }
+
+    /// @brief Call a function on the ID of every entity in any bucket within dist of a position.
+    /// @param pos Position at the center of the query.
+    /// @param dist Maximum distance away from pos to search.
+    /// @param fun Function to call on each candidate ID.
+    template <typename FUN_T>
+    void ForEachNear(GridPosition pos, double dist, FUN_T && fun) const {
+      if (!pos.IsValid()) return;
+      dist = std::abs(dist);
+      ForEachInRect(GridPosition(pos.GetX() - dist, pos.GetY() - dist),
+                    GridPosition(pos.GetX() + dist, pos.GetY() + dist), std::forward<FUN_T>(fun));
+    }
+
+    /// @brief Call a function on the ID of every entity in any bucket overlapping a rectangle.
+    /// @param min_pos Corner of the rectangle with the smallest coordinates.
+    /// @param max_pos Corner of the rectangle with the largest coordinates.
+    /// @param fun Function to call on each candidate ID.
+    template <typename FUN_T>
+    void ForEachInRect(GridPosition min_pos, GridPosition max_pos, FUN_T && fun) const {
+      if (!min_pos.IsValid() || !max_pos.IsValid()) return;
+      const int64_t min_x = ToBucket(min_pos.GetX());
+      const int64_t max_x = ToBucket(max_pos.GetX());
+      const int64_t min_y = ToBucket(min_pos.GetY());
+      const int64_t max_y = ToBucket(max_pos.GetY());
+      for (int64_t bucket_y = min_y; bucket_y <= max_y; ++bucket_y) {
+        for (int64_t bucket_x = min_x; bucket_x <= max_x; ++bucket_x) {
+          auto it = buckets.find(ToKey(bucket_x, bucket_y));
+          if (it == buckets.end()) continue;
+          for (size_t id : it->second) fun(id);
+        }
+      }
+    }
+  };
+
+} // End of namespace cse491
@@ -0,0 +1,175 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Paces a world's ticks at a fixed rate and keeps statistics on how long they take.
+ * @note Status: PROPOSAL
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace cse491 {
+
+  /// @class TickScheduler
+  /// @brief Decides when each tick of a fixed-rate loop should run.
+  /// Ticks are due at whole multiples of the period after Start().  When the loop falls behind,
+  /// the catch-up policy decides whether the missed ticks are run back to back (Burst, up to a
+  /// limit) or dropped (Skip); either way the schedule keeps its phase.  Every tick's duration is
+  /// recorded so that overruns and percentiles can be reported.
+  class TickScheduler {
+  public:
+    using clock_t = std::chrono::steady_clock;
+    using duration_t = std::chrono::nanoseconds;
+
+    /// What to do with ticks whose time has already passed.
+    enum class CatchUp {
+      Burst,   ///< Run missed ticks back to back, up to the burst limit; drop any beyond it.
+      Skip     ///< Run one tick and drop the rest.
+    };
+
+    /// Summary of the recorded ticks.
+    struct Stats {
+      size_t ticks = 0;        ///< Ticks run
+      size_t overruns = 0;     ///< Ticks that took longer than one period
+      size_t skipped = 0;      ///< Ticks dropped to catch up
+      duration_t p50{0};       ///< Median tick duration (of the recent samples)
+      duration_t p90{0};
+      duration_t p99{0};
+      duration_t max{0};       ///< Longest tick (of the recent samples)
+    };
+
+  private:
+    duration_t period;                  ///< Time between ticks
+    CatchUp catch_up;                   ///< How to handle missed ticks
+    size_t max_burst;                   ///< Most ticks run back to back when catching up
+    clock_t::time_point next_tick{};    ///< When the next tick is due
+
+    size_t num_ticks = 0;               ///< Ticks recorded
+    size_t num_overruns = 0;            ///< Ticks longer than a period
+    size_t num_skipped = 0;             ///< Ticks dropped
+    std::vector<duration_t> samples;    ///< Most recent tick durations (a ring buffer)
+    size_t max_samples;                 ///< Size of the ring buffer
+
+  public:
+    /// @param hz Ticks per second.
+    /// @param policy How to handle missed ticks.
+    /// @param burst Most ticks run back to back when catching up (Burst only).
+    /// @param sample_count Number of recent tick durations kept for percentiles.
+    explicit TickScheduler(double hz = 10.0, CatchUp policy = CatchUp::Burst, size_t burst = 5,
+                           size_t sample_count = 4096)
+      : catch_up(policy), max_burst(std::max<size_t>(burst, 1)), max_samples(std::max<size_t>(sample_count, 1))
+    {
+      SetRate(hz);
+    }
+
+    // -- Configuration --
+
+    /// Set the number of ticks per second.
+    TickScheduler & SetRate(double hz) {
+      assert(hz > 0.0);
+      period = std::chrono::duration_cast<duration_t>(std::chrono::duration<double>(1.0 / hz));
+      return *this;
+    }
+
+    /// Set how missed ticks are handled, and how many may be run back to back.
+    TickScheduler & SetCatchUp(CatchUp policy, size_t burst = 5) {
+      catch_up = policy;
+      max_burst = std::max<size_t>(burst, 1);
+      return *this;
+    }
+
+    [[nodiscard]] double GetRate() const { return 1.0 / std::chrono::duration<double>(period).count(); }
+    [[nodiscard]] duration_t GetPeriod() const { return period; }
+    [[nodiscard]] CatchUp GetCatchUp() const { return catch_up; }
+    [[nodiscard]] clock_t::time_point GetNextTickTime() const { return next_tick; }
+
+    // -- Scheduling --
+
+    /// @brief Make the first tick due at the given time (restart after a pause so no ticks are owed).
+    void Start(clock_t::time_point now = clock_t::now()) { next_tick = now; }
+
+    /// @brief Work out how many ticks should run now, and move the schedule past them.
+    /// @param now The current time.
+    /// @return Ticks to run (zero if the next tick is not yet due).
+    size_t TicksDue(clock_t::time_point now) {
+      if (now < next_tick) return 0;
+      const size_t behind = static_cast<size_t>((now - next_tick) / period) + 1;
+      const size_t due = (catch_up == CatchUp::Burst) ? std::min(behind, max_burst) : 1;
+      num_skipped += behind - due;
+      next_tick += period * behind;
+      return due;
+    }
+
+    /// @brief Sleep until the next tick is due.
+    /// @return Ticks to run now (at least one).
+    size_t WaitForTicks() {
+      size_t due = 0;
+      while ((due = TicksDue(clock_t::now())) == 0) std::this_thread::sleep_until(next_tick);
+      return due;
+    }
+
+    /// @brief Note how long a tick took.
+    void RecordTick(duration_t duration) {
+      if (samples.size() < max_samples) samples.push_back(duration);
+      else samples[num_ticks % max_samples] = duration;
+      ++num_ticks;
+      if (duration > period) ++num_overruns;
+    }
+
+    /// @brief Run a function at the scheduled rate until a stop condition holds.
+    /// @param tick Called once per tick.
+    /// @param stop Checked before each tick; the loop ends when it returns true.
+    template <typename TICK_T, typename STOP_T>
+    void Run(TICK_T && tick, STOP_T && stop) {
+      Start();
+      while (!stop()) {
+        const size_t due = WaitForTicks();
+        for (size_t i = 0; i < due && !stop(); ++i) {
+          const auto begin = clock_t::now();
+          tick();
+          RecordTick(clock_t::now() - begin);
+        }
+      }
+    }
+
+    // -- Statistics --
+
+    [[nodiscard]] size_t GetTickCount() const { return num_ticks; }
+    [[nodiscard]] size_t GetOverrunCount() const { return num_overruns; }
+    [[nodiscard]] size_t GetSkippedCount() const { return num_skipped; }
+
+    /// @brief Tick duration below which a fraction of the recent ticks fall.
+    /// @param fraction Between 0 and 1 (e.g., 0.99 for the 99th percentile).
+    [[nodiscard]] duration_t GetPercentile(double fraction) const {
+      if (samples.empty()) return duration_t{0};
+      std::vector<duration_t> sorted(samples);
+      const size_t rank = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+      std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+      return sorted[rank];
+    }
+
+    [[nodiscard]] Stats GetStats() const {
+      Stats stats;
+      stats.ticks = num_ticks;
+      stats.overruns = num_overruns;
+      stats.skipped = num_skipped;
+      stats.p50 = GetPercentile(0.5);
+      stats.p90 = GetPercentile(0.9);
+      stats.p99 = GetPercentile(0.99);
+      if (!samples.empty()) stats.max = *std::max_element(samples.begin(), samples.end());
+      return stats;
+    }
+
+    /// Forget all recorded ticks.
+    void ResetStats() {
+      num_ticks = num_overruns = num_skipped = 0;
+      samples.clear();
+    }
+  };
+
+} // End of namespace cse491
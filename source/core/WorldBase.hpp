@@ -7,8 +7,13 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <string>
@@ -16,11 +21,16 @@
 #include <sstream>
 
 #include "../DataCollection/AgentReciever.hpp"
+#include "ActionRecorderBase.hpp"
 #include "AgentBase.hpp"
+#include "AgentRegistry.hpp"
 #include "Data.hpp"
 #include "ItemBase.hpp"
+#include "RenderSnapshot.hpp"
+#include "SpatialIndex.hpp"
+#include "TickScheduler.hpp"
 #include "WorldGrid.hpp"
-#include "../DataCollection/AgentReciever.hpp"
+#include "WorldSnapshot.hpp"
 #include "Interfaces/NetWorth/server/ServerManager.hpp"
 #include "Interfaces/NetWorth/client/ClientManager.hpp"
 #include "Interfaces/NetWorth/client/ControlledAgent.hpp"
@@ -50,14 +60,26 @@ protected:
 
   item_map_t item_map;          ///< Map of IDs to pointers to non-agent entities
   agent_map_t agent_map;        ///< Map of IDs to pointers to agent entities
+  mutable AgentRegistry agent_registry; ///< Dense arrays of the agents in agent_map; see GetAgentRegistry()
+  SpatialIndex item_index;      ///< Lookup of item IDs by position (kept in sync with item_map)
+  SpatialIndex agent_index;     ///< Lookup of agent IDs by position (kept in sync with agent_map)
   size_t last_entity_id = 0;     ///< The last Entity ID used; increment at each creation
 
   bool run_over = false;        ///< Should the run end?
+  bool traverse_by_flags = false; ///< Should IsTraversable() only check for walkable cells?
+  bool independent_agents = false; ///< Are agents taking turns on several threads (agent_index on hold)?
 
-  bool world_running = true; ///< Is the world currently running?
+  std::atomic<bool> world_running = true; ///< Is the world currently running?
+  std::mutex running_mutex;                ///< Lets threads sleep until world_running is set
+  std::condition_variable running_cv;      ///< Signalled whenever world_running changes
+  TickScheduler tick_scheduler;            ///< Paces RunServer() (10 ticks per second by default)
 
   std::string action;           ///< The action that the agent is currently performing
   std::shared_ptr<DataCollection::AgentReceiver> agent_receiver;
+  size_t data_tick = 0;         ///< Number of times CollectData() has stored agent data
+  std::shared_ptr<ActionRecorderBase> action_recorder; ///< Told about every action taken (null to record nothing)
+  std::vector<std::weak_ptr<RenderSnapshotBuffer>> render_buffers; ///< Given a snapshot at the end of each tick
+  std::vector<size_t> render_changes; ///< Cells changed on the main grid since the last snapshot
 
   unsigned int seed;            ///< Seed used for generator
   std::mt19937 random_gen;      ///< Random number generator
@@ -81,9 +103,19 @@ protected:
   size_t AddCellType(const std::string &name, const std::string &desc = "",
                      char symbol = '\0') {
     type_options.push_back(CellType{name, desc, symbol});
+    for (auto & [grid_id, grid] : grids) grid.ReserveStates(type_options.size() - 1);
+    if (traverse_by_flags) main_grid.SetCellTypes(type_options);
     return type_options.size() - 1;
   }
 
+  /// @brief Have IsTraversable() treat every non-wall cell on the main grid as walkable.
+  /// This turns the default traversal test into a single flag lookup; call it after all
+  /// CellType properties are set (and again if they change).
+  void UseCellFlagsForTraversal() {
+    main_grid.SetCellTypes(type_options);
+    traverse_by_flags = true;
+  }
+
 public:
   /// Initializes world with cell types and random generator
   /// @param seed Seed used for RNG. Use 0 for a non-deterministic result.
@@ -106,6 +138,9 @@ public:
   virtual void Reset() {
     item_map.clear();
     agent_map.clear();
+    agent_registry.Clear();
+    item_index.Clear();
+    agent_index.Clear();
     last_entity_id = 0;
     run_over = false;
   }
@@ -121,8 +156,22 @@ public:
   /// Does an item with the provided ID exist?
   [[nodiscard]] bool HasItem(size_t id) const { return item_map.count(id); }
 
+  /// @brief Get the dense arrays of agents, rebuilding them first if agent_map was changed directly.
+  /// @note A world that replaces an agent in agent_map (rather than adding or removing one) should
+  /// call RebuildAgentRegistry() afterward.
+  AgentRegistry & GetAgentRegistry() const {
+    if (agent_registry.GetNumAgents() != agent_map.size()) RebuildAgentRegistry();
+    return agent_registry;
+  }
+
+  /// Refill the agent registry from agent_map.
+  void RebuildAgentRegistry() const {
+    agent_registry.Clear();
+    for (const auto & [id, agent_ptr] : agent_map) agent_registry.Add(*agent_ptr);
+  }
+
   /// Does an agent with the provided ID exist?
-  [[nodiscard]] bool HasAgent(size_t id) const { return agent_map.count(id); }
+  [[nodiscard]] bool HasAgent(size_t id) const { return GetAgentRegistry().Has(id); }
 
   /// Return a reference to an agent with a given ID.
   [[nodiscard]] ItemBase & GetItem(size_t id) {
@@ -133,7 +182,8 @@ public:
   /// Return a reference to an agent with a given ID.
   [[nodiscard]] AgentBase & GetAgent(size_t id) {
     assert(HasAgent(id));
-    return *agent_map[id];
+    const AgentRegistry & agents = GetAgentRegistry();
+    return agents.GetAgent(agents.IndexOf(id));
   }
 
   /// Return the ID of an item with a given name.
@@ -211,8 +261,11 @@ public:
       std::cerr << "Failed to initialize agent '" << agent_name << "'."
                 << std::endl;
     }
+    AgentRegistry & agents = GetAgentRegistry();  // Bring up to date before agent_map grows.
     agent_map[agent_id] = std::move(agent_ptr);
       AgentBase & agentReturn = *agent_map[agent_id];
+      agents.Add(agentReturn);
+      agent_index.Update(agent_id, agentReturn.GetPosition());
       agent_map_lock.unlock();
     return agentReturn;
   }
@@ -221,6 +274,41 @@ public:
     agent_receiver = std::make_shared<DataCollection::AgentReceiver>(r);
   }
 
+  /// @brief Attach a recorder to be told about every action an agent takes.
+  /// @param recorder The recorder to use, or nullptr to stop recording.
+  void SetActionRecorder(std::shared_ptr<ActionRecorderBase> recorder) {
+    action_recorder = std::move(recorder);
+  }
+
+  /// @brief Get the recorder being told about actions (null if none is attached).
+  [[nodiscard]] std::shared_ptr<ActionRecorderBase> GetActionRecorder() const { return action_recorder; }
+
+  /// @brief Have a snapshot of the main grid and its entities published to a buffer after every tick.
+  /// The world only keeps a weak pointer, so a renderer stops receiving snapshots by dropping the buffer.
+  /// @note Snapshots are sent from Run() and RunClient(); RunServer() leaves the grid's change list
+  /// to the replicator instead.
+  void AddRenderSnapshots(std::shared_ptr<RenderSnapshotBuffer> buffer) {
+    render_buffers.push_back(std::move(buffer));
+  }
+
+  /// @brief Publish the current state of the world to every render snapshot buffer.
+  void PublishRenderSnapshots() {
+    std::erase_if(render_buffers, [](const auto & buffer) { return buffer.expired(); });
+    if (render_buffers.empty()) return;
+
+    // Only the cells changed since the last tick are passed on, once the grid is tracking them.
+    const bool listed = main_grid.IsTrackingChanges() && main_grid.TakeChangedCells(render_changes);
+    if (!main_grid.IsTrackingChanges()) main_grid.TrackChanges();
+    for (const auto & weak_buffer : render_buffers) {
+      if (auto buffer = weak_buffer.lock()) {
+        buffer->Publish(main_grid, type_options, item_map, agent_map, listed ? &render_changes : nullptr);
+      }
+    }
+  }
+
+  /// @brief Get the receiver that CollectData() stores into (null if none was set).
+  [[nodiscard]] std::shared_ptr<DataCollection::AgentReceiver> GetAgentReceiver() const { return agent_receiver; }
+
   /// @brief Add a new, already-built item
   /// @return A reference to the newly created item
   ItemBase & AddItem(std::unique_ptr<ItemBase> item_ptr) {
@@ -228,6 +316,7 @@ public:
     assert(item_ptr->GetID() != 0);  // item_ptr must have had a non-zero ID assigned.
     item_ptr->SetWorld(*this);
     size_t item_id = item_ptr->GetID();
+    item_index.Update(item_id, item_ptr->GetPosition());
     item_map[item_id] = std::move(item_ptr);
     return *item_map[item_id];
   }
@@ -248,7 +337,22 @@ public:
   /// @param agent_id The unique ID this agent
   /// @return A reference to this world.
   WorldBase & RemoveAgent(size_t agent_id) {
+    GetAgentRegistry().Remove(agent_id);
     agent_map.erase(agent_id);
+    agent_index.Remove(agent_id);
+    return *this;
+  }
+
+  /// @brief Remove several agents at once, which is faster than removing them one at a time.
+  /// @param agent_ids The unique IDs of the agents; any that are not here are ignored.
+  /// @return A reference to this world.
+  template <typename CONTAINER_T>
+  WorldBase & RemoveAgents(const CONTAINER_T & agent_ids) {
+    GetAgentRegistry().RemoveAll(agent_ids);
+    for (size_t agent_id : agent_ids) {
+      agent_map.erase(agent_id);
+      agent_index.Remove(agent_id);
+    }
     return *this;
   }
 
@@ -257,6 +361,7 @@ public:
   /// @return A reference to this world.
   WorldBase & RemoveItem(size_t item_id) {
     item_map.erase(item_id);
+    item_index.Remove(item_id);
     return *this;
   }
   
@@ -280,6 +385,21 @@ public:
     return *this;
   }
 
+  /// @brief Keep position lookups current after an entity moves.
+  /// @param entity The agent or item whose position has changed.
+  /// @note Called automatically by Entity::SetPosition(); entities not in this world are ignored.
+  void UpdateEntityPosition(const Entity & entity) {
+    const size_t id = entity.GetID();
+    if (entity.IsAgent()) {
+      AgentRegistry & agents = GetAgentRegistry();
+      const size_t index = agents.IndexOf(id);
+      if (index == AgentRegistry::npos || agents.GetPosition(index) == entity.GetPosition()) return;
+      agents.SetPosition(index, entity.GetPosition());
+      if (!independent_agents) agent_index.Update(id, entity.GetPosition());
+    }
+    else if (entity.IsItem() && HasItem(id)) item_index.Update(id, entity.GetPosition());
+  }
+
   // -- Action Management --
 
   /// @brief Central function for an agent to take any action
@@ -293,29 +413,62 @@ public:
   /// @note Override this function if you want to control which grid the agents
   /// receive.
   virtual void RunAgents() {
-    for (auto & [id, agent_ptr] : agent_map) {
-      size_t action_id = agent_ptr->SelectAction(main_grid, type_options, item_map, agent_map);
-      agent_ptr->storeActionMap(agent_ptr->GetName());
-      int result = DoAction(*agent_ptr, action_id);
-      agent_ptr->SetActionResult(result);
+    // Agents run in order of ID, as they would iterating agent_map.
+    const AgentRegistry & agents = GetAgentRegistry();
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+      RunAgent(agents.GetAgent(i));
     }
   }
 
+  /// @brief Give a single agent the chance to take an action, as RunAgents() does for each agent.
+  void RunAgent(AgentBase & agent) {
+    size_t action_id = agent.SelectAction(main_grid, type_options, item_map, agent_map);
+    int result = DoAction(agent, action_id);
+    FinishAction(agent, action_id, result);
+  }
+
+  /// @brief Store the outcome of an action on the agent and pass it to the action recorder, if any.
+  /// @param agent The agent that took the action
+  /// @param action_id The id of the action taken
+  /// @param result The result returned by DoAction()
+  void FinishAction(AgentBase & agent, size_t action_id, int result) {
+    agent.SetLastAction(action_id);
+    agent.SetActionResult(result);
+    if (action_recorder) action_recorder->RecordAction(agent, action_id, result);
+  }
+
+  /// @brief Allow RunAgent() to be called from several threads at once, each with its own agents.
+  /// Agent moves stop updating the position index (so Find*Agents*() results are stale), and
+  /// cached cell flags are brought up to date so that the grid is only ever read.
+  /// @note Only valid for worlds where DoAction() changes nothing but the acting agent.
+  void BeginIndependentAgents() {
+    independent_agents = true;
+    main_grid.RefreshFlags();
+  }
+
+  /// @brief Return to normal, single-threaded turns, re-indexing every agent's position.
+  void EndIndependentAgents() {
+    independent_agents = false;
+    agent_index.Clear();
+    for (const auto & [id, agent_ptr] : agent_map) agent_index.Update(id, agent_ptr->GetPosition());
+  }
+
   /// @brief RunAgents, but with extra features for client-side
   /// @note Override this function if you want to control which grid the agents receive.
   virtual void RunClientAgents() {
-    // Deserialize agents
-    std::string data = client_manager->getSerializedAgents();
-    if (data.substr(0, 18) == ":::START agent_set") {
-      std::istringstream is(data);
-      DeserializeAgentSet(is, client_manager);
+    // Patch in every change the server has sent, then tell it how far we got
+    netWorth::WorldDelta delta;
+    bool received = false;
+    while (client_manager->receiveWorldDelta(delta)) {
+      ApplyWorldDelta(delta, client_manager);
+      received = true;
     }
+    if (received) client_manager->acknowledgeTick();
 
     for (auto & [id, agent_ptr] : agent_map) {
       size_t action_id = agent_ptr->SelectAction(main_grid, type_options, item_map, agent_map);
-      agent_ptr->storeActionMap(agent_ptr->GetName());
       int result = DoAction(*agent_ptr, action_id);
-      agent_ptr->SetActionResult(result);
+      FinishAction(*agent_ptr, action_id, result);
     }
   }
 
@@ -325,44 +478,39 @@ public:
     std::set<size_t> to_delete;
 
     for (auto & [id, agent_ptr] : agent_map) {
-      // wait until clients have connected to run
-      while (!server_manager->hasAgentsPresent()|| !world_running) {}
+      // sleep until clients have connected and the world is running
+      while (!server_manager->hasAgentsPresent() || !world_running) {
+        server_manager->waitForAgents(std::chrono::milliseconds(100));
+        WaitUntilRunning(std::chrono::milliseconds(100));
+      }
 
       // select action and send to client
       size_t action_id = agent_ptr->SelectAction(main_grid, type_options, item_map, agent_map);
 		server_manager->writeToActionMap(id, action_id);
-      agent_ptr->storeActionMap(agent_ptr->GetName());
       int result = DoAction(*agent_ptr, action_id);
-      agent_ptr->SetActionResult(result);
+      FinishAction(*agent_ptr, action_id, result);
 
       // mark agent for deletion if client disconnects
       if (action_id == 9999) to_delete.insert(id);
     }
 
     // delete agents
-    for (size_t id : to_delete) {
-        RemoveAgent(id);
-    }
+    RemoveAgents(to_delete);
 
-    // send updates to client for deleted agents
-    if (!to_delete.empty()) {
-        std::ostringstream os;
-        SerializeAgentSet(os);
-        std::string data = os.str();
-		server_manager->setSerializedAgents(data);
-		server_manager->setNewAgent(true);
-		server_manager->sendGameUpdates();
-    }
+    // send each client what changed since the last tick it acknowledged
+    server_manager->replicateWorld(GetAgentRegistry(), main_grid);
   }
 
+  /// @brief Store a sample of every agent's position and last action in the agent receiver, if one is set.
   void CollectData() {
     if (agent_receiver != nullptr) {
-      for (const auto & [id, agent_ptr] : agent_map) {
-        agent_receiver->StoreData(
-          agent_ptr->GetName(), 
-          agent_ptr->GetPosition(), agent_ptr->GetActionResult()
-        );
+      const AgentRegistry & agents = GetAgentRegistry();
+      for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+        const AgentBase & agent = agents.GetAgent(i);
+        agent_receiver->StoreEvent(agents.GetID(i), data_tick, agents.GetPosition(i),
+                                   agent.GetLastAction(), agent.GetActionResult());
       }
+      ++data_tick;
     }
   }
 
@@ -377,6 +525,7 @@ public:
       RunAgents();
       CollectData();
       UpdateWorld();
+      PublishRenderSnapshots();
     }
   }
 
@@ -385,30 +534,57 @@ public:
     run_over = false;
     client_manager = manager;
     while (!run_over) {
-      if (world_running){
+      if (WaitUntilRunning(std::chrono::milliseconds(100))){
         RunClientAgents();
         CollectData();
         UpdateWorld();
+        PublishRenderSnapshots();
       }
     }
   }
 
-  /// @brief Run, but for server-side
+  /// @brief Run, but for server-side, one tick at a time at the rate set in GetTickScheduler()
+  /// Each tick first gathers every action clients sent since the last one.  While the world is
+  /// paused or no clients are connected no ticks are owed, so none are run to catch up afterward.
   virtual void RunServer(netWorth::ServerManager *manager) {
     run_over = false;
     server_manager = manager;
+    tick_scheduler.Start();
     while (!run_over) {
-      if (world_running){
+      if (!server_manager->hasAgentsPresent() || !WaitUntilRunning(std::chrono::milliseconds(100))) {
+        server_manager->waitForAgents(std::chrono::milliseconds(100));
+        tick_scheduler.Start();
+        continue;
+      }
+      const size_t due = tick_scheduler.WaitForTicks();
+      for (size_t i = 0; i < due && !run_over; ++i) {
+        const auto begin = TickScheduler::clock_t::now();
+        server_manager->collectInputs();
         RunServerAgents();
         CollectData();
         UpdateWorld();
+        tick_scheduler.RecordTick(TickScheduler::clock_t::now() - begin);
       }
     }
   }
 
+  /// @brief The scheduler that paces RunServer(); use it to set the tick rate and read tick statistics.
+  TickScheduler & GetTickScheduler() { return tick_scheduler; }
+
   /// @brief Set if world is running or not for concurrency purposes
   virtual void SetWorldRunning(bool running){
-	  world_running = running;
+    std::lock_guard lock(running_mutex);
+    world_running = running;
+    running_cv.notify_all();
+  }
+
+  /// @brief Sleep until the world is set running or a timeout passes
+  /// @param timeout longest time to wait
+  /// @return Is the world running?
+  bool WaitUntilRunning(std::chrono::milliseconds timeout) {
+    if (world_running) return true;
+    std::unique_lock lock(running_mutex);
+    return running_cv.wait_for(lock, timeout, [this]{ return world_running.load(); });
   }
 
   // CellType management.
@@ -450,9 +626,11 @@ public:
   /// @return A vector of item IDs at the target position.
   [[nodiscard]] virtual std::vector<size_t> FindItemsAt(GridPosition pos, size_t grid_id=0) const {
     std::vector<size_t> item_ids;
-    for (const auto & [id, item_ptr] : item_map) {
+    item_index.ForEachAt(pos, [&](size_t id) {
+      const auto & item_ptr = item_map.at(id);
       if (item_ptr->IsOnGrid(grid_id) && item_ptr->GetPosition() == pos) item_ids.push_back(id);
-    }
+    });
+    std::sort(item_ids.begin(), item_ids.end());
     return item_ids;
   }
 
@@ -461,9 +639,14 @@ public:
   /// @return A vector of agent IDs at the target position.
   [[nodiscard]] virtual std::vector<size_t> FindAgentsAt(GridPosition pos, size_t grid_id=0) const {
     std::vector<size_t> agent_ids;
-    for (const auto & [id, agent_ptr] : agent_map) {
-      if (agent_ptr->IsOnGrid(grid_id) && agent_ptr->GetPosition() == pos) agent_ids.push_back(id);
-    }
+    const AgentRegistry & agents = GetAgentRegistry();
+    agent_index.ForEachAt(pos, [&](size_t id) {
+      const size_t index = agents.IndexOf(id);
+      if (agents.GetGridID(index) == grid_id && agents.GetPosition(index) == pos) {
+        agent_ids.push_back(id);
+      }
+    });
+    std::sort(agent_ids.begin(), agent_ids.end());
     return agent_ids;
   }
 
@@ -473,11 +656,16 @@ public:
   /// @return A vector of item IDs within dist of the target position.
   [[nodiscard]] virtual std::vector<size_t> FindItemsNear(GridPosition pos, double dist=1.0, size_t grid_id=0) const {
     std::vector<size_t> item_ids;
-    for (const auto & [id, item_ptr] : item_map) {
-      if (item_ptr->IsOnGrid(grid_id) && item_ptr->GetPosition().IsNear(pos, dist)) {
-        item_ids.push_back(id);
-      }
+    auto test_item = [&](size_t id, const ItemBase & item) {
+      if (item.IsOnGrid(grid_id) && item.GetPosition().IsNear(pos, dist)) item_ids.push_back(id);
+    };
+    // For very large radii, visiting every bucket would be slower than a plain scan.
+    if (item_index.CountBucketsNear(dist) > item_map.size()) {
+      for (const auto & [id, item_ptr] : item_map) test_item(id, *item_ptr);
+      return item_ids;
     }
+    item_index.ForEachNear(pos, dist, [&](size_t id) { test_item(id, *item_map.at(id)); });
+    std::sort(item_ids.begin(), item_ids.end());
     return item_ids;
   }
 
@@ -487,20 +675,30 @@ public:
   /// @return A vector of agent IDs within dist of the target position.
   [[nodiscard]] virtual std::vector<size_t> FindAgentsNear(GridPosition pos, double dist=1.0, size_t grid_id=0) const {
     std::vector<size_t> agent_ids;
-    for (const auto & [id, agent_ptr] : agent_map) {
-      if (agent_ptr->IsOnGrid(grid_id) && agent_ptr->GetPosition().IsNear(pos, dist)) {
-        agent_ids.push_back(id);
+    const AgentRegistry & agents = GetAgentRegistry();
+    auto test_agent = [&](size_t index) {
+      if (agents.GetGridID(index) == grid_id && agents.GetPosition(index).IsNear(pos, dist)) {
+        agent_ids.push_back(agents.GetID(index));
       }
+    };
+    // For very large radii, visiting every bucket would be slower than a plain scan.
+    if (agent_index.CountBucketsNear(dist) > agents.GetNumAgents()) {
+      for (size_t i = 0; i < agents.GetNumAgents(); ++i) test_agent(i);
+      return agent_ids;
     }
+    agent_index.ForEachNear(pos, dist, [&](size_t id) { test_agent(agents.IndexOf(id)); });
+    std::sort(agent_ids.begin(), agent_ids.end());
     return agent_ids;
   }
 
   /// @brief Determine if this tile can be walked on, defaults to every tile is walkable
+  /// (or, after UseCellFlagsForTraversal(), every tile that is not a wall)
   /// @author @mdkdoc15
   /// @param pos The grid position we are checking
   /// @return If an agent should be allowed on this square
-  [[nodiscard]] virtual bool IsTraversable(const AgentBase & /*agent*/, cse491::GridPosition /*pos*/) const {
-    return true;
+  [[nodiscard]] virtual bool IsTraversable(const AgentBase & /*agent*/, cse491::GridPosition pos) const {
+    if (!traverse_by_flags) return true;
+    return main_grid.GetFlags(pos) & CellType::FLAG_WALKABLE;
   }
 
   // -- Network Serialization and Deserialization --
@@ -539,9 +737,7 @@ public:
       if (pair.first != client_id) to_delete.insert(pair.first);
     }
 
-    for (size_t agent_id : to_delete) {
-      RemoveAgent(agent_id);
-    }
+    RemoveAgents(to_delete);
 
     // reset last_entity_id; start from the beginning
     last_entity_id = 0;
@@ -651,6 +847,153 @@ public:
     DeserializeItemSet(is);
   }
 
+  /// @brief Serialize world, agents, and items into ostream as a binary snapshot (see WorldSnapshot.hpp)
+  /// Unlike Serialize(), every double, int, char, and string property of each agent is kept.
+  /// @param os ostream
+  void SerializeBinary(std::ostream &os) {
+    SnapshotWriter writer(os);
+    writer.WriteGrid(main_grid);
+
+    const AgentRegistry & agents = GetAgentRegistry();   // Already in order of ID.
+    writer.BeginAgents(last_entity_id);
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) writer.WriteAgent(agents.GetAgent(i));
+    writer.EndAgents();
+
+    writer.BeginItems(item_map.size());
+    for (const auto &item : item_map) writer.WriteItem(*item.second);
+    writer.Finish();
+  }
+
+  /// @brief Add a ControlledAgent standing in for an agent on the server, with the server's ID
+  /// @param entity the agent's ID, name, position, and properties
+  /// @param manager ClientManager for the ControlledAgent
+  /// @return the new agent
+  AgentBase & AddServerAgent(const SnapshotEntity & entity, netWorth::ClientManager *manager) {
+    const size_t next_id = std::max(last_entity_id, entity.id);
+    last_entity_id = entity.id - 1;         // so the new agent is given the server's ID
+    AgentBase & agent = AddAgent<netWorth::ControlledAgent>(entity.name, "manager", manager);
+    last_entity_id = next_id;
+    agent.SetPosition(entity.position);
+    entity.ApplyProperties(agent);
+    if (!agent.HasProperty("symbol")) agent.SetProperty("symbol", '*');
+    return agent;
+  }
+
+  /// @brief Bring this client's world up to a later server tick by patching in the changes in a delta
+  /// Agents are moved, updated, added, and removed in place; this client's interface is left alone.
+  /// A delta is skipped if the world is already past its tick, or if it was built from a tick
+  /// this world never reached (a full state always applies).  Deltas come off the network, so
+  /// one whose grid does not fit its stated size, that names a cell outside the grid, or that
+  /// names an agent ID of zero or above delta::MAX_ID, is rejected before anything is changed.
+  /// @param delta changes received from the server
+  /// @param manager ClientManager for ControlledAgents; it holds the tick this world is at
+  /// @return Was the delta applied?
+  bool ApplyWorldDelta(const netWorth::WorldDelta &delta, netWorth::ClientManager *manager) {
+    const uint32_t tick = manager->getWorldTick();
+    if (delta.tick <= tick || (!delta.full_state && delta.baseline > tick)) return false;
+
+    const bool new_size = delta.grid_full || delta.grid_resized;
+    const size_t new_width = new_size ? delta.grid_width : main_grid.GetWidth();
+    const size_t new_height = new_size ? delta.grid_height : main_grid.GetHeight();
+    if (new_width != 0 && new_height > std::numeric_limits<size_t>::max() / new_width) return false;
+    const size_t num_cells = new_width * new_height;
+    if (delta.grid_full && delta.grid_states.size() != num_cells) return false;
+    for (auto [index, state] : delta.cells) {
+      if (index >= num_cells) return false;
+    }
+    for (const netWorth::AgentUpdate &update : delta.agents) {
+      if (update.agent.id == 0 || update.agent.id > netWorth::delta::MAX_ID) return false;
+    }
+
+    if (delta.grid_full) {
+      if (main_grid.GetWidth() != delta.grid_width || main_grid.GetHeight() != delta.grid_height) {
+        main_grid.Resize(delta.grid_width, delta.grid_height);
+      }
+      for (size_t i = 0; i < delta.grid_states.size(); ++i) {
+        main_grid.At(i % delta.grid_width, i / delta.grid_width) = delta.grid_states[i];
+      }
+    }
+    else if (delta.grid_resized) {
+      // Only the cells listed are known; emptying the grid first leaves the rest unknown (state 0).
+      main_grid.Resize(0, 0);
+      main_grid.Resize(new_width, new_height);
+    }
+    const size_t width = main_grid.GetWidth();
+    for (auto [index, state] : delta.cells) main_grid.At(index % width, index / width) = state;
+
+    const size_t client_id = manager->getClientID();
+    if (delta.full_state) {
+      // remove all agents that are NOT the interface or in the new state
+      std::vector<size_t> to_delete;
+      auto update_it = delta.agents.begin();
+      for (auto &pair : agent_map) {
+        while (update_it != delta.agents.end() && update_it->agent.id < pair.first) ++update_it;
+        const bool listed = update_it != delta.agents.end() && update_it->agent.id == pair.first;
+        if (pair.first != client_id && !listed) to_delete.push_back(pair.first);
+      }
+      RemoveAgents(to_delete);
+    }
+    if (!delta.removed.empty()) {
+      std::vector<size_t> to_delete(delta.removed);
+      to_delete.erase(std::remove(to_delete.begin(), to_delete.end(), client_id), to_delete.end());
+      RemoveAgents(to_delete);
+    }
+
+    for (const netWorth::AgentUpdate &update : delta.agents) {
+      const SnapshotEntity &entity = update.agent;
+      if (entity.id == client_id) continue;
+      AgentBase * agent = GetAgentRegistry().Find(entity.id);
+      if (agent == nullptr) {
+        if (update.field_bits & netWorth::delta::NAME) AddServerAgent(entity, manager);
+        continue;
+      }
+      if (update.field_bits & netWorth::delta::POSITION) agent->SetPosition(entity.position);
+      if (update.field_bits & netWorth::delta::PROPERTIES) entity.ApplyProperties(*agent);
+    }
+
+    manager->setWorldTick(delta.tick);
+    return true;
+  }
+
+  /// @brief Deserialize world, agents, and items from a binary snapshot made by SerializeBinary()
+  /// Agents other than this client's interface are replaced with ControlledAgents that keep their
+  /// IDs from the server, as in Deserialize().  Throws std::runtime_error if the snapshot is malformed.
+  /// @param manager ClientManager for ControlledAgents
+  void DeserializeBinary(std::istream &is, netWorth::ClientManager *manager) {
+    SnapshotReader reader(is);
+    reader.ReadGrid(main_grid);
+
+    // remove all agents that are NOT the interface
+    size_t client_id = manager->getClientID();
+    std::vector<size_t> to_delete;
+    for (auto &pair : agent_map) {
+      if (pair.first != client_id) to_delete.push_back(pair.first);
+    }
+    RemoveAgents(to_delete);
+
+    // client id NOT in agent map yet if ID = 0; it will be the next ID the server gives out
+    const size_t server_last_id = reader.BeginAgents();
+    if (client_id == 0) client_id = server_last_id + 1;
+
+    SnapshotEntity entity;
+    while (reader.ReadAgent(entity)) {
+      if (entity.id == client_id) continue;  // client interface still exists; do nothing
+      AddServerAgent(entity, manager);
+    }
+    last_entity_id = server_last_id;
+
+    // items are numbered after the agents (IDs start at 1; zero means "no ID")
+    const size_t num_items = reader.BeginItems();
+    for (size_t i = 0; i < num_items; i++) {
+      reader.ReadItem(entity);
+      auto item = std::make_unique<ItemBase>(agent_map.size() + i + 1, entity.name);
+      if (entity.position.IsValid()) item->SetPosition(entity.position);
+      entity.ApplyProperties(*item);
+      AddItem(std::move(item));
+    }
+    reader.Finish();
+  }
+
 };
 
 } // End of namespace cse491
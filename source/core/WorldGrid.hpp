@@ -7,15 +7,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
-#include <unordered_map>
+#include <limits>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include "CoreObject.hpp"
 #include "GridPosition.hpp"
 #include "Data.hpp"
+#include "MappedFile.hpp"
 
 namespace cse491 {
 
@@ -26,7 +33,26 @@ namespace cse491 {
   protected:
     size_t width = 0;           ///< Number of cells in each row of the grid.
     size_t height = 0;          ///< Number of rows of cells in the grid.
-    std::vector<size_t> cells;  ///< All cells, grouped by full rows, top to bottom
+
+    // All cells, grouped by full rows, top to bottom.  Cells are stored in 1, 2, or 8 bytes each;
+    // only the vector for the current width holds anything.  Grids start with one byte per cell
+    // and widen automatically when a larger state is stored (see also ReserveStates()).
+    size_t cell_bytes = 1;               ///< Bytes used to store each cell.
+    std::vector<uint8_t> cells8;         ///< Cells, if stored in one byte each.
+    std::vector<uint16_t> cells16;       ///< Cells, if stored in two bytes each.
+    std::vector<size_t> cells;           ///< Cells, if stored in a full size_t each.
+
+    // Flags for each cell are cached, derived from the properties of each cell's type.
+    // Writes through At() mark just that cell as stale; bulk changes mark them all.
+    std::vector<CellType::flags_t> type_flags;             ///< Flags for each cell type
+    mutable std::vector<CellType::flags_t> cell_flags;     ///< Cached flags for each cell
+    mutable std::vector<size_t> stale_cells;               ///< Cells changed since last refresh
+    mutable bool all_flags_stale = true;                   ///< Must every cell be refreshed?
+
+    // Cells whose state has changed, kept only while change tracking is on (see TrackChanges()).
+    bool track_changes = false;           ///< Record which cells change?
+    std::vector<size_t> changed_cells;    ///< Cells changed since the last TakeChangedCells()
+    bool all_cells_changed = false;       ///< Was the whole grid replaced since then?
 
     // -- Helper functions --
 
@@ -35,6 +61,67 @@ namespace cse491 {
       return x + y * width;
     }
 
+    /// Call a function on the vector that currently holds the cells.
+    template <typename FUN_T>
+    decltype(auto) VisitCells(FUN_T && fun) {
+      if (cell_bytes == 1) return fun(cells8);
+      if (cell_bytes == 2) return fun(cells16);
+      return fun(cells);
+    }
+    template <typename FUN_T>
+    decltype(auto) VisitCells(FUN_T && fun) const {
+      if (cell_bytes == 1) return fun(cells8);
+      if (cell_bytes == 2) return fun(cells16);
+      return fun(cells);
+    }
+
+    /// @return The state of the cell at an index.
+    [[nodiscard]] size_t GetCell(size_t id) const {
+      if (cell_bytes == 1) return cells8[id];
+      if (cell_bytes == 2) return cells16[id];
+      return cells[id];
+    }
+
+    /// Change the state of the cell at an index.
+    void SetCell(size_t id, size_t state) {
+      if (state > MaxState()) SetCellBytes(CellBytesFor(state));
+      MarkStale(id);
+      if (track_changes && !all_cells_changed && GetCell(id) != state) {
+        changed_cells.push_back(id);
+        if (changed_cells.size() >= GetNumCells()) MarkAllChanged();   // Past the point of listing.
+      }
+      if (cell_bytes == 1) cells8[id] = static_cast<uint8_t>(state);
+      else if (cell_bytes == 2) cells16[id] = static_cast<uint16_t>(state);
+      else cells[id] = state;
+    }
+
+    /// Look up the flags for a cell type (types without known flags have none).
+    [[nodiscard]] CellType::flags_t TypeFlags(size_t type_id) const {
+      return type_id < type_flags.size() ? type_flags[type_id] : 0;
+    }
+
+    /// Note that a cell is about to be changed through a writable reference.
+    void MarkStale(size_t id) {
+      if (type_flags.empty() || all_flags_stale) return;   // Nothing to keep in sync.
+      // Past a point, it is cheaper to rebuild everything than to track cells one by one.
+      if (stale_cells.size() >= GetNumCells() / 8) { MarkAllStale(); return; }
+      stale_cells.push_back(id);
+    }
+
+    /// Note that all cells may have changed.
+    void MarkAllStale() {
+      all_flags_stale = true;
+      stale_cells.clear();
+    }
+
+    /// Note that the whole grid has been replaced (for change tracking).
+    void MarkAllChanged() {
+      if (!track_changes) return;
+      all_cells_changed = true;
+      changed_cells.clear();
+    }
+
+
     // -- Serialize and Deserialize functions --
     // Mechanisms to efficiently save and load the exact state of the grid.
     // File format is width and height followed by all
@@ -45,15 +132,20 @@ namespace cse491 {
     /// Write the current state of this grid into the provided stream.
     void Serialize_impl(std::ostream & os) const override {
       os << width << " " << height;
-      for (size_t state : cells) os << ' ' << state;
+      VisitCells([&os](const auto & states){ for (size_t state : states) os << ' ' << state; });
       os << std::endl;
     }
 
     /// Read the state of the grid out of the provided stream. 
     void Deserialize_impl(std::istream & is) override {
       is >> width >> height;
-      cells.resize(width * height);
-      for (size_t & state : cells) is >> state;
+      std::vector<size_t> states(width * height);
+      for (size_t & state : states) is >> state;
+      const size_t max_state = states.empty() ? 0 : *std::max_element(states.begin(), states.end());
+      ReserveStates(max_state);
+      VisitCells([&states](auto & cells){ cells.assign(states.begin(), states.end()); });
+      MarkAllStale();
+      MarkAllChanged();
 
       // add one to the position
       // EndDeserialize seems to be getting the end of the current line
@@ -62,10 +154,70 @@ namespace cse491 {
       is.seekg(curr_pos + 1);
     }
 
+    /// Convert text (one row of symbols per line) into cells, using a lookup table from symbol to state.
+    /// Rows are converted in bands, one per thread.
+    void ReadSymbols(std::string_view text, const type_options_t & types, size_t num_threads) {
+      // Later types with the same symbol win; unknown symbols become state 0.
+      std::array<size_t, 256> lut{};
+      for (size_t i = 0; i < types.size(); ++i) lut[static_cast<unsigned char>(types[i].symbol)] = i;
+
+      // Find where each row starts; a final newline does not start another row.
+      std::vector<std::string_view> rows;
+      size_t row_start = 0;
+      while (row_start < text.size()) {
+        const char * end = static_cast<const char *>(std::memchr(text.data() + row_start, '\n', text.size() - row_start));
+        const size_t row_end = end ? static_cast<size_t>(end - text.data()) : text.size();
+        rows.push_back(text.substr(row_start, row_end - row_start));
+        row_start = row_end + 1;
+      }
+
+      height = rows.size();
+      width = 0;
+      for (auto row : rows) width = std::max(width, row.size());
+      ReserveStates(types.empty() ? 0 : types.size() - 1);
+      VisitCells([this](auto & cells){ cells.assign(width * height, 0); });
+      MarkAllStale();
+      MarkAllChanged();
+
+      VisitCells([&](auto & cells){
+        using cell_t = typename std::decay_t<decltype(cells)>::value_type;
+        auto convert_rows = [&](size_t first_row, size_t end_row) {
+          for (size_t y = first_row; y < end_row; ++y) {
+            cell_t * out = cells.data() + y * width;
+            for (unsigned char symbol : rows[y]) *out++ = static_cast<cell_t>(lut[symbol]);
+          }
+        };
+
+        num_threads = std::clamp<size_t>(num_threads, 1, std::max<size_t>(height, 1));
+        if (num_threads == 1) { convert_rows(0, height); return; }
+        std::vector<std::thread> threads;
+        const size_t band = (height + num_threads - 1) / num_threads;
+        for (size_t first = 0; first < height; first += band) {
+          threads.emplace_back(convert_rows, first, std::min(height, first + band));
+        }
+        for (auto & thread : threads) thread.join();
+      });
+    }
+
   public:
+    /// A writable reference to one cell, as returned by the non-const At().
+    class CellRef {
+    private:
+      WorldGrid & grid;
+      size_t id;
+    public:
+      CellRef(WorldGrid & grid, size_t id) : grid(grid), id(id) { }
+      CellRef(const CellRef &) = default;
+      operator size_t() const { return grid.GetCell(id); }
+      CellRef & operator=(size_t state) { grid.SetCell(id, state); return *this; }
+      CellRef & operator=(const CellRef & other) { return *this = static_cast<size_t>(other); }
+    };
+
     WorldGrid() = default;
     WorldGrid(size_t width, size_t height, size_t default_type=0)
-      : width(width), height(height), cells(width*height, default_type) { }
+      : width(width), height(height), cell_bytes(CellBytesFor(default_type)) {
+      VisitCells([=](auto & cells){ cells.assign(width * height, default_type); });
+    }
     WorldGrid(const WorldGrid &) = default;
     WorldGrid(WorldGrid &&) = default;
     
@@ -75,7 +227,73 @@ namespace cse491 {
     // -- Accessors --
     [[nodiscard]] size_t GetWidth() const { return width; }
     [[nodiscard]] size_t GetHeight() const { return height; }
-    [[nodiscard]] size_t GetNumCells() const { return cells.size(); }
+    [[nodiscard]] size_t GetNumCells() const { return width * height; }
+
+    /// @return The number of bytes used to store each cell (1, 2, or sizeof(size_t)).
+    [[nodiscard]] size_t GetCellBytes() const { return cell_bytes; }
+
+    /// @return The largest state that a cell can currently hold.
+    [[nodiscard]] size_t MaxState() const {
+      return cell_bytes == 1 ? UINT8_MAX : (cell_bytes == 2 ? UINT16_MAX : SIZE_MAX);
+    }
+
+    /// @return The fewest bytes per cell that can hold every state up to max_state.
+    [[nodiscard]] static size_t CellBytesFor(size_t max_state) {
+      return max_state <= UINT8_MAX ? 1 : (max_state <= UINT16_MAX ? 2 : sizeof(size_t));
+    }
+
+    /// @brief Make sure cells can hold every state up to max_state, widening them if needed.
+    /// Worlds call this as cell types are added, so each cell is never wider than the types require.
+    void ReserveStates(size_t max_state) {
+      if (max_state > MaxState()) SetCellBytes(CellBytesFor(max_state));
+    }
+
+    /// @brief Start (or stop) recording which cells change, for code that passes on only the changes.
+    void TrackChanges(bool track=true) {
+      track_changes = track;
+      changed_cells.clear();
+      all_cells_changed = false;
+    }
+
+    /// @return Is this grid recording which cells change?
+    [[nodiscard]] bool IsTrackingChanges() const { return track_changes; }
+
+    /// @brief Collect the cells whose state has changed since tracking began or this was last called.
+    /// @param out Set to the index of each changed cell, in increasing order.
+    /// @return false if the whole grid was replaced (resized or reloaded) instead; `out` is then empty.
+    bool TakeChangedCells(std::vector<size_t> & out) {
+      const bool listed = !all_cells_changed;
+      out.swap(changed_cells);
+      changed_cells.clear();
+      all_cells_changed = false;
+      std::sort(out.begin(), out.end());
+      out.erase(std::unique(out.begin(), out.end()), out.end());
+      return listed;
+    }
+
+    /// @brief Change how many bytes are used to store each cell, keeping every cell's state.
+    /// Narrow cells use less memory and make scanning the grid faster.
+    /// @param bytes 1, 2, or sizeof(size_t); must be wide enough for every state in the grid.
+    void SetCellBytes(size_t bytes) {
+      assert(bytes == 1 || bytes == 2 || bytes == sizeof(size_t));
+      if (bytes == cell_bytes) return;
+      const size_t old_bytes = cell_bytes;
+      cell_bytes = bytes;
+      VisitCells([this, old_bytes](auto & new_cells){
+        using cell_t = typename std::decay_t<decltype(new_cells)>::value_type;
+        auto convert = [&new_cells](auto & old_cells) {
+          new_cells.resize(old_cells.size());
+          for (size_t id = 0; id < old_cells.size(); ++id) {
+            assert(old_cells[id] <= std::numeric_limits<cell_t>::max());   // Cell state too large for new width.
+            new_cells[id] = static_cast<cell_t>(old_cells[id]);
+          }
+          old_cells = {};
+        };
+        if (old_bytes == 1) convert(cells8);
+        else if (old_bytes == 2) convert(cells16);
+        else convert(cells);
+      });
+    }
 
     /// Test if specific coordinates are in range for this GridWorld.
     [[nodiscard]] bool IsValid(double x, double y) const {
@@ -90,43 +308,98 @@ namespace cse491 {
     /// @return The grid state at the provided x and y coordinates
     [[nodiscard]] size_t At(size_t x, size_t y) const {
       assert(IsValid(x,y));
-      return cells[ToIndex(x,y)];
+      return GetCell(ToIndex(x,y));
     }
 
     /// @return A reference to the grid state at the provided x and y coordinates
-    [[nodiscard]] size_t & At(size_t x, size_t y) {
+    [[nodiscard]] CellRef At(size_t x, size_t y) {
       assert(IsValid(x,y));
-      return cells[ToIndex(x,y)];
+      return CellRef(*this, ToIndex(x,y));
     }
 
     /// @return The state at a given GridPosition.
     [[nodiscard]] size_t At(GridPosition p) const { return At(p.CellX(), p.CellY()); }
 
     /// @return A reference to the state at a given GridPosition.
-    [[nodiscard]] size_t & At(GridPosition p) { return At(p.CellX(), p.CellY()); }
+    [[nodiscard]] CellRef At(GridPosition p) { return At(p.CellX(), p.CellY()); }
 
     [[nodiscard]] size_t operator[](GridPosition p) const { return At(p); }
-    [[nodiscard]] size_t & operator[](GridPosition p) { return At(p); }
+    [[nodiscard]] CellRef operator[](GridPosition p) { return At(p); }
+
+    // -- Cell flags --
+
+    /// @brief Provide the cell types used in this grid so that per-cell flags can be tracked.
+    /// @param types The CellTypes that cell states refer to.
+    /// @note Call again if the properties of any cell type change.
+    void SetCellTypes(const type_options_t & types) {
+      type_flags.resize(types.size());
+      for (size_t i = 0; i < types.size(); ++i) type_flags[i] = types[i].GetFlags();
+      MarkAllStale();
+    }
+
+    /// @return Have cell types been provided so that flags are meaningful?
+    [[nodiscard]] bool HasCellTypes() const { return !type_flags.empty(); }
+
+    /// Bring the cached cell flags up to date.  Flags are otherwise refreshed lazily on lookup,
+    /// so call this first if several threads will be reading flags at once.
+    void RefreshFlags() const {
+      if (all_flags_stale) {
+        cell_flags.resize(GetNumCells());
+        VisitCells([this](const auto & cells){
+          for (size_t id = 0; id < cells.size(); ++id) cell_flags[id] = TypeFlags(cells[id]);
+        });
+        all_flags_stale = false;
+      } else {
+        for (size_t id : stale_cells) cell_flags[id] = TypeFlags(GetCell(id));
+      }
+      stale_cells.clear();
+    }
+
+    /// @return The CellType flags for the cell at the provided x and y coordinates
+    /// @note Flags are lazily refreshed, so this should not be called from multiple threads at once
+    /// unless RefreshFlags() has been called since the grid last changed.
+    [[nodiscard]] CellType::flags_t GetFlags(size_t x, size_t y) const {
+      assert(IsValid(x,y));
+      if (all_flags_stale || !stale_cells.empty()) RefreshFlags();
+      return cell_flags[ToIndex(x,y)];
+    }
+
+    /// @return The CellType flags for the cell at a given GridPosition.
+    [[nodiscard]] CellType::flags_t GetFlags(GridPosition p) const {
+      return GetFlags(p.CellX(), p.CellY());
+    }
+
+    /// @return Does the cell at a given GridPosition have all of the provided flags?
+    [[nodiscard]] bool HasFlags(GridPosition p, CellType::flags_t flags) const {
+      return (GetFlags(p) & flags) == flags;
+    }
 
 
     // Size adjustments.
     void Resize(size_t new_width, size_t new_height, size_t default_type=0) {
-      // Create a new vector of the correct size.
-      std::vector<size_t> new_cells(new_width*new_height, default_type);
-
-      // Copy the overlapping portions of the two grids.
-      size_t min_width = std::min(width, new_width);
-      size_t min_height = std::min(height, new_height);
-      for (size_t x = 0; x < min_width; ++x) {
-        for (size_t y = 0; y < min_height; ++y) {
-          new_cells[x+y*new_width] = cells[ToIndex(x,y)];
+      if (default_type > MaxState()) SetCellBytes(CellBytesFor(default_type));
+      VisitCells([&](auto & cells){
+        using cell_t = typename std::decay_t<decltype(cells)>::value_type;
+
+        // Create a new vector of the correct size.
+        std::vector<cell_t> new_cells(new_width*new_height, static_cast<cell_t>(default_type));
+
+        // Copy the overlapping portions of the two grids.
+        size_t min_width = std::min(width, new_width);
+        size_t min_height = std::min(height, new_height);
+        for (size_t x = 0; x < min_width; ++x) {
+          for (size_t y = 0; y < min_height; ++y) {
+            new_cells[x+y*new_width] = cells[ToIndex(x,y)];
+          }
         }
-      }
 
-      // Swap the new grid in; let the old grid be deallocated in its place.
-      std::swap(cells, new_cells);
+        // Swap the new grid in; let the old grid be deallocated in its place.
+        std::swap(cells, new_cells);
+      });
       width = new_width;
       height = new_height;
+      MarkAllStale();
+      MarkAllChanged();
     }
 
     // -- Read and Write functions --
@@ -140,7 +413,7 @@ namespace cse491 {
       size_t cell_id = 0;
       for (size_t y=0; y < height; ++y) {
         for (size_t x=0; x < width; ++x) {
-          os << types[ cells[cell_id++] ].symbol;
+          os << types[ GetCell(cell_id++) ].symbol;
         }
         os << '\n';
       }
@@ -158,43 +431,27 @@ namespace cse491 {
       return true;
     }
 
-    void Read(std::istream & is, const type_options_t & types) {
-      // Build a symbol chart for conversions back.
-      std::unordered_map<char, size_t> symbol_map;
-      for (size_t i=0; i < types.size(); ++i) {
-        symbol_map[types[i].symbol] = i;
-      }
-
-      // Load the file into memory.
-      std::vector<std::string> char_grid;
-      std::string line;
-      width = 0;
-      while (std::getline(is, line)) {
-        char_grid.push_back(line);
-        if (line.size() > width) width = line.size();
-      }
-      height = char_grid.size();
-
-      // Convert each symbol to the appropriate value.
-      cells.resize(width * height);
-      size_t cell_id = 0;
-      for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-          // Use the cell values provided, or zero if a cell position is missing.
-          cells[cell_id++] =
-            (x < char_grid[y].size()) ? symbol_map[char_grid[y][x]] : 0;
-        }
-      }
+    /// @brief Load a human-readable grid, with one row of symbols per line.
+    /// Unknown symbols become the first cell type; short rows are padded with it.
+    /// @param is Stream to read from
+    /// @param types A vector of CellTypes for symbol identification
+    /// @param num_threads Number of threads to convert rows with
+    void Read(std::istream & is, const type_options_t & types, size_t num_threads=1) {
+      std::string text;
+      char buffer[4096];
+      while (is.read(buffer, sizeof(buffer)) || is.gcount() > 0) text.append(buffer, is.gcount());
+      ReadSymbols(text, types, num_threads);
     }
 
     /// Helper function to specify a file name to read the grid state from.
-    bool Read(std::string filename, const type_options_t & types) {
-      std::ifstream is(filename);
-      if (!is.is_open()) {
-        std::cerr << "Could not open file '" << filename << "' to write grid." << std::endl;
+    /// The file is memory-mapped and converted in place, without an intermediate copy.
+    bool Read(std::string filename, const type_options_t & types, size_t num_threads=1) {
+      MappedFile file(filename);
+      if (!file.IsOpen()) {
+        std::cerr << "Could not open file '" << filename << "' to read grid." << std::endl;
         return false;
       }
-      Read(is, types);
+      ReadSymbols(file.GetView(), types, num_threads);
       return true;
     }
     
@@ -0,0 +1,650 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief A compact, versioned binary format for snapshots of a world (grid, agents, and items).
+ * @note Status: PROPOSAL
+ *
+ * Layout (all integers are LEB128 varints unless noted; signed values are zigzag encoded):
+ *   Header   "W491" magic (4 bytes), format version.
+ *   Grid     'G', width, height, then (cell state, run length) pairs covering every cell in row order.
+ *   Agents   'A', last entity ID, then for each agent in increasing ID order: ID minus the previous
+ *            agent's ID, name, position, properties; a zero ID step ends the section.
+ *   Items    'I', item count, then for each item: name, position, properties.
+ *   End      'E'.
+ * Strings are a length followed by their bytes.  Positions are stored as whole cells: zero for an
+ * invalid position, otherwise the X cell plus one followed by the Y cell.  Properties are a count
+ * followed by (name, type byte, value) for each double, int, char, or string property; a property
+ * name is written out the first time it appears and referred to by its index after that.
+ *
+ * The writer and reader work directly on a stream, one section and record at a time, so a
+ * snapshot never has to be held in memory as a whole.
+ **/
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "AgentBase.hpp"
+#include "Data.hpp"
+#include "GridPosition.hpp"
+#include "ItemBase.hpp"
+#include "WorldGrid.hpp"
+
+namespace cse491 {
+
+  /// Values a property can hold in a snapshot; the index of each matches its PropertyType.
+  using snapshot_value_t = std::variant<double, int, char, std::string>;
+
+  /// @brief One agent or item, as read back out of a snapshot.
+  struct SnapshotEntity {
+    size_t id = 0;              ///< Agent ID (items are not stored with IDs, so always 0 for them)
+    std::string name;
+    GridPosition position;
+    std::vector<std::pair<std::string, snapshot_value_t>> properties;
+
+    /// Return the value of a property, or nullptr if there is no property of that name and type.
+    template <typename T>
+    [[nodiscard]] const T * FindProperty(const std::string & prop_name) const {
+      for (const auto & [name, value] : properties) {
+        if (name == prop_name) return std::get_if<T>(&value);
+      }
+      return nullptr;
+    }
+
+    /// Copy every property onto an entity.
+    void ApplyProperties(Entity & entity) const {
+      for (const auto & [name, value] : properties) {
+        std::visit([&entity, &name = name](const auto & v){ entity.SetProperty(name, v); }, value);
+      }
+    }
+  };
+
+  namespace snapshot {
+    constexpr char MAGIC[4] = {'W', '4', '9', '1'};
+    constexpr uint64_t VERSION = 1;    ///< Increase whenever the layout changes.
+
+    constexpr char GRID_SECTION = 'G';
+    constexpr char AGENT_SECTION = 'A';
+    constexpr char ITEM_SECTION = 'I';
+    constexpr char END_SECTION = 'E';
+
+    // Limits on what a reader accepts, so a corrupt length fails cleanly instead of allocating without bound.
+    constexpr size_t MAX_CELLS = size_t(1) << 28;        ///< Most cells in a grid
+    constexpr size_t MAX_STRING = size_t(1) << 20;       ///< Longest name or string value, in bytes
+    constexpr size_t MAX_PROPERTIES = size_t(1) << 16;   ///< Most properties on one entity
+    constexpr size_t MAX_ID = size_t(1) << 48;           ///< Largest entity ID
+    constexpr size_t MAX_ITEMS = size_t(1) << 24;        ///< Most items in a world
+
+    /// The type byte written for a property value.
+    template <typename T>
+    constexpr char TypeCode() {
+      if constexpr (std::is_same_v<T, double>) return static_cast<char>(PropertyType::t_double);
+      else if constexpr (std::is_same_v<T, int>) return static_cast<char>(PropertyType::t_int);
+      else if constexpr (std::is_same_v<T, char>) return static_cast<char>(PropertyType::t_char);
+      else return static_cast<char>(PropertyType::t_string);
+    }
+    static_assert(std::is_same_v<std::variant_alternative_t<TypeCode<int>(), snapshot_value_t>, int> &&
+                  std::is_same_v<std::variant_alternative_t<TypeCode<std::string>(), snapshot_value_t>, std::string>,
+                  "snapshot_value_t alternatives must be in PropertyType order");
+
+    [[nodiscard]] inline uint64_t ZigZag(int64_t value) {
+      return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+    [[nodiscard]] inline int64_t UnZigZag(uint64_t value) {
+      return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+  }
+
+  /// @class SnapshotWriter
+  /// @brief Writes a binary snapshot to a stream, section by section.
+  /// Call WriteGrid() (or BeginGrid(), WriteCell() for every cell, EndGrid()), then BeginAgents(),
+  /// WriteAgent() for each agent in increasing ID order, EndAgents(), then BeginItems(), WriteItem()
+  /// for each item, and finally Finish().
+  class SnapshotWriter {
+  private:
+    std::streambuf & out;
+    std::unordered_map<std::string, size_t> property_names;  ///< Names written so far, by index
+
+    size_t cells_left = 0;         ///< Cells in the grid not yet passed to WriteCell()
+    size_t run_state = 0;          ///< State of the current run of cells
+    size_t run_length = 0;         ///< Length of the current run of cells (0 if none started)
+    size_t last_agent_id = 0;      ///< ID of the previous agent written
+    size_t items_left = 0;         ///< Items promised by BeginItems() not yet written
+
+    void Put(char c) {
+      if (out.sputc(c) == std::char_traits<char>::eof()) throw std::runtime_error("Snapshot write failed");
+    }
+
+    void PutBytes(const char * data, size_t count) {
+      if (static_cast<size_t>(out.sputn(data, static_cast<std::streamsize>(count))) != count) {
+        throw std::runtime_error("Snapshot write failed");
+      }
+    }
+
+    /// Agents are stored as gaps between IDs, so each must be larger than the one before.
+    void PutAgentID(size_t id) {
+      if (id <= last_agent_id) throw std::runtime_error("Snapshot agents must be written in increasing ID order");
+      PutVarint(id - last_agent_id);
+      last_agent_id = id;
+    }
+
+    void PutVarint(uint64_t value) {
+      char bytes[10];
+      size_t count = 0;
+      while (value >= 0x80) {
+        bytes[count++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+      }
+      bytes[count++] = static_cast<char>(value);
+      PutBytes(bytes, count);
+    }
+
+    void PutString(const std::string & str) {
+      PutVarint(str.size());
+      PutBytes(str.data(), str.size());
+    }
+
+    void PutPosition(GridPosition pos) {
+      if (!pos.IsValid()) { PutVarint(0); return; }
+      PutVarint(snapshot::ZigZag(static_cast<int64_t>(std::floor(pos.GetX()))) + 1);
+      PutVarint(snapshot::ZigZag(static_cast<int64_t>(std::floor(pos.GetY()))));
+    }
+
+    void PutPropertyName(const std::string & name) {
+      auto [it, inserted] = property_names.emplace(name, property_names.size());
+      PutVarint(it->second);
+      if (inserted) PutString(name);
+    }
+
+    void PutValue(double value) {
+      const uint64_t bits = std::bit_cast<uint64_t>(value);
+      char bytes[8];
+      for (size_t i = 0; i < 8; ++i) bytes[i] = static_cast<char>(bits >> (8 * i));
+      PutBytes(bytes, 8);
+    }
+    void PutValue(int value) { PutVarint(snapshot::ZigZag(value)); }
+    void PutValue(char value) { Put(value); }
+    void PutValue(const std::string & value) { PutString(value); }
+
+    template <typename T>
+    void PutProperty(const std::string & name, const T & value) {
+      PutPropertyName(name);
+      Put(snapshot::TypeCode<T>());
+      PutValue(value);
+    }
+
+    void PutProperties(const Entity & entity) {
+      PutVarint(entity.GetNumTypedProperties());
+      entity.ForEachTypedProperty([this](const std::string & name, const auto & value){ PutProperty(name, value); });
+    }
+
+    void PutProperties(const SnapshotEntity & entity) {
+      PutVarint(entity.properties.size());
+      for (const auto & [name, value] : entity.properties) {
+        std::visit([this, &name = name](const auto & v){ PutProperty(name, v); }, value);
+      }
+    }
+
+    void FlushRun() {
+      if (run_length == 0) return;
+      PutVarint(run_state);
+      PutVarint(run_length);
+      run_length = 0;
+    }
+
+  public:
+    /// Start a snapshot by writing its header to a stream.
+    explicit SnapshotWriter(std::ostream & os) : out(*os.rdbuf()) {
+      PutBytes(snapshot::MAGIC, sizeof(snapshot::MAGIC));
+      PutVarint(snapshot::VERSION);
+    }
+
+    // -- Grid section --
+
+    void BeginGrid(size_t width, size_t height) {
+      Put(snapshot::GRID_SECTION);
+      PutVarint(width);
+      PutVarint(height);
+      cells_left = width * height;
+    }
+
+    /// Add the next cell of the grid, in row order; runs of equal cells are stored once.
+    void WriteCell(size_t state) {
+      assert(cells_left > 0);
+      --cells_left;
+      if (run_length > 0 && state == run_state) { ++run_length; return; }
+      FlushRun();
+      run_state = state;
+      run_length = 1;
+    }
+
+    void EndGrid() {
+      assert(cells_left == 0);   // Every cell must be written.
+      FlushRun();
+    }
+
+    void WriteGrid(const WorldGrid & grid) {
+      BeginGrid(grid.GetWidth(), grid.GetHeight());
+      for (size_t y = 0; y < grid.GetHeight(); ++y) {
+        for (size_t x = 0; x < grid.GetWidth(); ++x) WriteCell(grid.At(x, y));
+      }
+      EndGrid();
+    }
+
+    // -- Agent section --
+
+    void BeginAgents(size_t last_entity_id) {
+      Put(snapshot::AGENT_SECTION);
+      PutVarint(last_entity_id);
+      last_agent_id = 0;
+    }
+
+    /// Add an agent with its double, int, char, and string properties.
+    void WriteAgent(const AgentBase & agent) {
+      PutAgentID(agent.GetID());
+      PutString(agent.GetName());
+      PutPosition(agent.GetPosition());
+      PutProperties(agent);
+    }
+
+    /// Add an agent from its parts.
+    void WriteAgent(const SnapshotEntity & agent) {
+      PutAgentID(agent.id);
+      PutString(agent.name);
+      PutPosition(agent.position);
+      PutProperties(agent);
+    }
+
+    void EndAgents() { PutVarint(0); }
+
+    // -- Item section --
+
+    void BeginItems(size_t num_items) {
+      Put(snapshot::ITEM_SECTION);
+      PutVarint(num_items);
+      items_left = num_items;
+    }
+
+    void WriteItem(const ItemBase & item) {
+      assert(items_left > 0);
+      --items_left;
+      PutString(item.GetName());
+      PutPosition(item.GetPosition());
+      PutProperties(item);
+    }
+
+    void WriteItem(const SnapshotEntity & item) {
+      assert(items_left > 0);
+      --items_left;
+      PutString(item.name);
+      PutPosition(item.position);
+      PutProperties(item);
+    }
+
+    /// End the snapshot.
+    void Finish() {
+      assert(items_left == 0);   // Every item promised by BeginItems() must be written.
+      Put(snapshot::END_SECTION);
+    }
+  };
+
+  /// @class SnapshotReader
+  /// @brief Reads a binary snapshot from a stream, in the same order SnapshotWriter writes it.
+  /// Malformed or truncated snapshots throw std::runtime_error.
+  class SnapshotReader {
+  private:
+    std::streambuf & in;
+    uint64_t version = 0;
+    std::vector<std::string> property_names;  ///< Names seen so far, by index
+    size_t last_agent_id = 0;
+    size_t max_agent_id = 0;   ///< Last entity ID the world gave out; no agent may be above it
+    bool agents_done = false;
+
+    [[noreturn]] static void Fail(const std::string & msg) {
+      throw std::runtime_error("Bad world snapshot: " + msg);
+    }
+
+    char Get() {
+      const auto c = in.sbumpc();
+      if (c == std::char_traits<char>::eof()) Fail("unexpected end of stream");
+      return static_cast<char>(c);
+    }
+
+    void GetBytes(char * data, size_t count) {
+      if (static_cast<size_t>(in.sgetn(data, static_cast<std::streamsize>(count))) != count) {
+        Fail("unexpected end of stream");
+      }
+    }
+
+    uint64_t GetVarint() {
+      uint64_t value = 0;
+      for (size_t shift = 0; shift < 64; shift += 7) {
+        const auto byte = static_cast<unsigned char>(Get());
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return value;
+      }
+      Fail("varint too long");
+    }
+
+    /// Read a length or count, failing if it is above a limit.
+    size_t GetSize(size_t limit, const char * what) {
+      const uint64_t size = GetVarint();
+      if (size > limit) Fail(std::string(what) + " too large");
+      return static_cast<size_t>(size);
+    }
+
+    std::string GetString() {
+      std::string str(GetSize(snapshot::MAX_STRING, "string"), '\0');
+      GetBytes(str.data(), str.size());
+      return str;
+    }
+
+    GridPosition GetPosition() {
+      const uint64_t x = GetVarint();
+      if (x == 0) return GridPosition().MakeInvalid();
+      const int64_t y = snapshot::UnZigZag(GetVarint());
+      return GridPosition(static_cast<double>(snapshot::UnZigZag(x - 1)), static_cast<double>(y));
+    }
+
+    snapshot_value_t GetValue(PropertyType type) {
+      switch (type) {
+        case PropertyType::t_double: {
+          char bytes[8];
+          GetBytes(bytes, 8);
+          uint64_t bits = 0;
+          for (size_t i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+          return std::bit_cast<double>(bits);
+        }
+        case PropertyType::t_int: return static_cast<int>(snapshot::UnZigZag(GetVarint()));
+        case PropertyType::t_char: return Get();
+        case PropertyType::t_string: return GetString();
+        default: Fail("unknown property type");
+      }
+    }
+
+    void GetEntity(SnapshotEntity & entity) {
+      entity.name = GetString();
+      entity.position = GetPosition();
+      entity.properties.resize(GetSize(snapshot::MAX_PROPERTIES, "property count"));
+      for (auto & [name, value] : entity.properties) {
+        const size_t name_id = GetVarint();
+        if (name_id == property_names.size()) property_names.push_back(GetString());
+        else if (name_id > property_names.size()) Fail("bad property name reference");
+        name = property_names[name_id];
+        value = GetValue(static_cast<PropertyType>(Get()));
+      }
+    }
+
+    void ExpectSection(char section) {
+      if (Get() != section) Fail(std::string("expected section '") + section + "'");
+    }
+
+  public:
+    /// Start reading a snapshot by checking its header.
+    explicit SnapshotReader(std::istream & is) : in(*is.rdbuf()) {
+      char magic[sizeof(snapshot::MAGIC)];
+      GetBytes(magic, sizeof(magic));
+      if (!std::equal(magic, magic + sizeof(magic), snapshot::MAGIC)) Fail("not a world snapshot");
+      version = GetVarint();
+      if (version == 0 || version > snapshot::VERSION) Fail("unsupported version " + std::to_string(version));
+    }
+
+    [[nodiscard]] uint64_t GetVersion() const { return version; }
+
+    // -- Grid section --
+
+    /// @brief Read the grid section, calling size_fun(width, height) once the size is known and then
+    /// fun(state, count) for each run of equal cells in row order.
+    /// @return The width and height of the grid.
+    template <typename SIZE_FUN_T, typename FUN_T>
+    std::pair<size_t, size_t> ReadGridRuns(SIZE_FUN_T && size_fun, FUN_T && fun) {
+      ExpectSection(snapshot::GRID_SECTION);
+      const size_t width = GetVarint();
+      const size_t height = GetVarint();
+      if (width != 0 && height > snapshot::MAX_CELLS / width) Fail("grid too large");
+      size_fun(width, height);
+      size_t cells_left = width * height;
+      while (cells_left > 0) {
+        const size_t state = GetVarint();
+        const size_t count = GetVarint();
+        if (count == 0 || count > cells_left) Fail("bad grid run");
+        fun(state, count);
+        cells_left -= count;
+      }
+      return {width, height};
+    }
+
+    /// @brief Read the grid section, calling fun(state, count) for each run of equal cells in row order.
+    /// @return The width and height of the grid.
+    template <typename FUN_T>
+    std::pair<size_t, size_t> ReadGridRuns(FUN_T && fun) {
+      return ReadGridRuns([](size_t, size_t){}, std::forward<FUN_T>(fun));
+    }
+
+    /// Read the grid section into a grid, replacing its size and contents.
+    void ReadGrid(WorldGrid & grid) {
+      size_t x = 0, y = 0;
+      ReadGridRuns([&grid](size_t width, size_t height){ grid.Resize(width, height); },
+                   [&grid, &x, &y](size_t state, size_t count){
+        for (; count > 0; --count) {
+          grid.At(x, y) = state;
+          if (++x == grid.GetWidth()) { x = 0; ++y; }
+        }
+      });
+    }
+
+    // -- Agent section --
+
+    /// @return The last entity ID given out by the world the snapshot came from.
+    size_t BeginAgents() {
+      ExpectSection(snapshot::AGENT_SECTION);
+      last_agent_id = 0;
+      agents_done = false;
+      max_agent_id = GetSize(snapshot::MAX_ID, "last entity ID");
+      return max_agent_id;
+    }
+
+    /// @brief Read the next agent.
+    /// @return False (leaving the agent unchanged) once every agent has been read.
+    bool ReadAgent(SnapshotEntity & agent) {
+      if (agents_done) return false;
+      const size_t id_step = GetVarint();
+      if (id_step == 0) { agents_done = true; return false; }
+      if (id_step > max_agent_id - last_agent_id) Fail("agent ID above the last entity ID");
+      last_agent_id += id_step;
+      agent.id = last_agent_id;
+      GetEntity(agent);
+      return true;
+    }
+
+    // -- Item section --
+
+    /// @return The number of items to read with ReadItem().
+    size_t BeginItems() {
+      ExpectSection(snapshot::ITEM_SECTION);
+      return GetSize(snapshot::MAX_ITEMS, "item count");
+    }
+
+    void ReadItem(SnapshotEntity & item) {
+      item.id = 0;
+      GetEntity(item);
+    }
+
+    /// Check that the snapshot ends where expected.
+    void Finish() { ExpectSection(snapshot::END_SECTION); }
+  };
+
+
+  // -- Conversion to and from the text format of WorldBase::Serialize() --
+
+  namespace snapshot {
+    inline void ExpectLine(std::istream & is, const std::string & expected) {
+      std::string line;
+      std::getline(is, line);
+      if (line != expected) {
+        throw std::runtime_error("Bad text world snapshot: expected '" + expected + "', found '" + line + "'");
+      }
+    }
+
+    inline std::string ReadLine(std::istream & is) {
+      std::string line;
+      if (!std::getline(is, line)) throw std::runtime_error("Bad text world snapshot: unexpected end of stream");
+      return line;
+    }
+
+    /// Parse a number from one line of the text format.
+    template <typename T>
+    T ParseNumber(const std::string & text) {
+      try {
+        if constexpr (std::is_same_v<T, double>) return std::stod(text);
+        else if constexpr (std::is_same_v<T, int>) return std::stoi(text);
+        else return static_cast<T>(std::stoull(text));
+      } catch (const std::logic_error &) {
+        throw std::runtime_error("Bad text world snapshot: expected a number, found '" + text + "'");
+      }
+    }
+
+    /// Read a whitespace-separated number from the text format.
+    template <typename T>
+    T ReadNumber(std::istream & is) {
+      T value{};
+      if (!(is >> value)) throw std::runtime_error("Bad text world snapshot: expected a number");
+      return value;
+    }
+
+    /// Format a cell coordinate the way the text format does.
+    inline void WriteTextCoord(std::ostream & os, GridPosition pos, double coord) {
+      if (pos.IsValid()) os << static_cast<int64_t>(coord) << '\n';
+      else os << "nan\n";
+    }
+  }
+
+  /// @brief Convert a world from the text format written by WorldBase::Serialize() to a binary snapshot.
+  /// @param is Stream holding the text format
+  /// @param os Stream to write the binary snapshot to
+  inline void ConvertTextSnapshotToBinary(std::istream & is, std::ostream & os) {
+    SnapshotWriter writer(os);
+
+    // Grid: width, height, and every cell on one line.
+    snapshot::ExpectLine(is, ":::START cse491::WorldGrid");
+    const auto width = snapshot::ReadNumber<size_t>(is);
+    const auto height = snapshot::ReadNumber<size_t>(is);
+    if (width != 0 && height > snapshot::MAX_CELLS / width) {
+      throw std::runtime_error("Bad text world snapshot: grid too large");
+    }
+    writer.BeginGrid(width, height);
+    for (size_t i = 0; i < width * height; ++i) writer.WriteCell(snapshot::ReadNumber<size_t>(is));
+    writer.EndGrid();
+    std::string rest_of_line;
+    std::getline(is, rest_of_line);
+    snapshot::ExpectLine(is, ":::END cse491::WorldGrid");
+
+    // Agents: name, id, x, y, and symbol for each.
+    snapshot::ExpectLine(is, ":::START agent_set");
+    writer.BeginAgents(snapshot::ParseNumber<size_t>(snapshot::ReadLine(is)));
+    SnapshotEntity agent;
+    for (std::string name = snapshot::ReadLine(is); name != ":::END agent_set"; name = snapshot::ReadLine(is)) {
+      agent.name = name;
+      agent.id = snapshot::ParseNumber<size_t>(snapshot::ReadLine(is));
+      const double x = snapshot::ParseNumber<double>(snapshot::ReadLine(is));
+      const double y = snapshot::ParseNumber<double>(snapshot::ReadLine(is));
+      agent.position = GridPosition(x, y);
+      const std::string symbol = snapshot::ReadLine(is);
+      if (symbol.empty()) throw std::runtime_error("Bad text world snapshot: agent '" + name + "' has no symbol");
+      agent.properties.assign(1, {"symbol", symbol[0]});
+      writer.WriteAgent(agent);
+    }
+    writer.EndAgents();
+
+    // Items: count, then name, x, y, and typed properties for each.
+    snapshot::ExpectLine(is, ":::START item_set");
+    const auto num_items = snapshot::ParseNumber<size_t>(snapshot::ReadLine(is));
+    if (num_items > snapshot::MAX_ITEMS) throw std::runtime_error("Bad text world snapshot: too many items");
+    writer.BeginItems(num_items);
+    SnapshotEntity item;
+    for (size_t i = 0; i < num_items; ++i) {
+      item.name = snapshot::ReadLine(is);
+      const double x = snapshot::ParseNumber<double>(snapshot::ReadLine(is));
+      const double y = snapshot::ParseNumber<double>(snapshot::ReadLine(is));
+      item.position = GridPosition(x, y);
+      item.properties.clear();
+      const auto num_properties = snapshot::ParseNumber<size_t>(snapshot::ReadLine(is));
+      if (num_properties > snapshot::MAX_PROPERTIES) {
+        throw std::runtime_error("Bad text world snapshot: too many properties on '" + item.name + "'");
+      }
+      for (size_t p = 0; p < num_properties; ++p) {
+        std::string name = snapshot::ReadLine(is);
+        const auto type = static_cast<PropertyType>(snapshot::ParseNumber<int>(snapshot::ReadLine(is)));
+        const std::string value = snapshot::ReadLine(is);
+        if (type == PropertyType::t_double) item.properties.emplace_back(name, snapshot::ParseNumber<double>(value));
+        else if (type == PropertyType::t_int) item.properties.emplace_back(name, snapshot::ParseNumber<int>(value));
+        else if (type == PropertyType::t_char) item.properties.emplace_back(name, value.empty() ? '\0' : value[0]);
+        else if (type == PropertyType::t_string) item.properties.emplace_back(name, value);
+        else throw std::runtime_error("Bad text world snapshot: unknown property type for '" + name + "'");
+      }
+      writer.WriteItem(item);
+    }
+    snapshot::ExpectLine(is, ":::END item_set");
+    writer.Finish();
+  }
+
+  /// @brief Convert a binary snapshot to the text format read by WorldBase::Deserialize().
+  /// The text format only keeps the "symbol" property of agents; item properties are all kept.
+  /// @param is Stream holding the binary snapshot
+  /// @param os Stream to write the text format to
+  inline void ConvertBinarySnapshotToText(std::istream & is, std::ostream & os) {
+    SnapshotReader reader(is);
+
+    os << ":::START cse491::WorldGrid\n";
+    std::string cells;
+    auto [width, height] = reader.ReadGridRuns([&cells](size_t state, size_t count){
+      const std::string cell = ' ' + std::to_string(state);
+      for (size_t i = 0; i < count; ++i) cells += cell;
+    });
+    os << width << " " << height << cells << '\n';
+    os << ":::END cse491::WorldGrid\n";
+
+    os << ":::START agent_set\n";
+    os << reader.BeginAgents() << '\n';
+    SnapshotEntity agent;
+    while (reader.ReadAgent(agent)) {
+      os << agent.name << '\n' << agent.id << '\n';
+      snapshot::WriteTextCoord(os, agent.position, agent.position.GetX());
+      snapshot::WriteTextCoord(os, agent.position, agent.position.GetY());
+      const char * symbol = agent.FindProperty<char>("symbol");
+      os << (symbol ? *symbol : '*') << '\n';
+    }
+    os << ":::END agent_set\n";
+
+    os << ":::START item_set\n";
+    const size_t num_items = reader.BeginItems();
+    os << num_items << '\n';
+    SnapshotEntity item;
+    for (size_t i = 0; i < num_items; ++i) {
+      reader.ReadItem(item);
+      os << item.name << '\n';
+      snapshot::WriteTextCoord(os, item.position, item.position.GetX());
+      snapshot::WriteTextCoord(os, item.position, item.position.GetY());
+      os << item.properties.size() << '\n';
+      for (const auto & [name, value] : item.properties) {
+        os << name << '\n' << value.index() << '\n';
+        std::visit([&os](const auto & v){ os << v << '\n'; }, value);
+      }
+    }
+    os << ":::END item_set\n";
+    reader.Finish();
+  }
+
+} // End of namespace cse491
@@ -4,6 +4,8 @@
 # Here, add one .cpp per line. Only the strings should
 add_source_to_target(${EXE_NAME} "source/Interfaces/MainInterface.cpp")
 add_source_to_target(${EXE_NAME} "source/Interfaces/TextureHolder.cpp")
+add_source_to_target(${EXE_NAME} "source/Interfaces/TileRenderer.cpp")
+add_source_to_target(${EXE_NAME} "source/Interfaces/Camera.cpp")
 add_source_to_target(${EXE_NAME} "source/Interfaces/Component.cpp")
 add_source_to_target(${EXE_NAME} "source/Interfaces/Component.hpp")
 add_source_to_target(${EXE_NAME} "source/Interfaces/Container.cpp")
@@ -6,6 +6,7 @@
 
 // Include the modules that we will be using.
 
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
 #include "Interfaces/NetWorth/client/ClientInterface.hpp"
 #include "Interfaces/NetWorth/client/ClientManager.hpp"
 #include "Worlds/MazeWorld.hpp"
@@ -44,7 +45,7 @@ bool runMazeWorldDemo(std::istream &is, const std::string &ipString, unsigned sh
 	manager.setupGameUpdateSocket(socket);
     std::string interfaceName = "Interface1";
     cse491::MazeWorld world;
-    world.Deserialize(is, &manager);
+    world.DeserializeBinary(is, &manager);
     clientKillPort = port;
     clientKillIP = ipString;
     cse491::Entity & interface = world.AddAgent<netWorth::ClientInterface>(interfaceName, "server_ip", ipString,
@@ -75,7 +76,7 @@ bool runSecondWorldDemo(std::istream &is, const std::string &ipString, unsigned
 	manager.setupGameUpdateSocket(socket);
 	std::string interfaceName = "Interface";
 	group4::SecondWorld world;;
-	world.Deserialize(is, &manager);
+	world.DeserializeBinary(is, &manager);
 	clientKillPort = port;
 	clientKillIP = ipString;
 	cse491::Entity & interface = world.AddAgent<netWorth::ClientInterface>(interfaceName, "server_ip", ipString,
@@ -106,7 +107,7 @@ bool runGenerativeWorldDemo(std::istream &is, const std::string &ipString, unsig
 	manager.setupGameUpdateSocket(socket);
 	std::string interfaceName = "Interface2";
 	cse491::GenerativeWorld world;
-	world.Deserialize(is, &manager);
+	world.DeserializeBinary(is, &manager);
 	clientKillPort = port;
 	clientKillIP = ipString;
 	cse491::Entity & interface = world.AddAgent<netWorth::ClientInterface>(interfaceName, "server_ip", ipString,
@@ -137,7 +138,7 @@ bool runManualWorldDemo(std::istream &is, const std::string &ipString, unsigned
 	manager.setupGameUpdateSocket(socket);
 	std::string interface_name = "Interface3";
 	cse491_team8::ManualWorld world;
-	world.Deserialize(is, &manager);
+	world.DeserializeBinary(is, &manager);
 	clientKillPort = port;
 	clientKillIP = ipString;
 	cse491::Entity & interface = world.AddAgent<netWorth::ClientInterface>(interface_name, "server_ip", ipString,
@@ -180,11 +181,13 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    // Receive world and deserialize
-    if (socket.receive(recvPkt, ipAddr, port) !=  sf::Socket::Status::Done) {
+    // Receive world (sent in fragments, since it rarely fits in one datagram) and deserialize
+    std::string payload;
+    if (!netWorth::receivePayload(socket, ipAddr, port, payload)) {
         std::cerr << "Failed to receive" << std::endl;
         return 1;
     }
+    recvPkt.append(payload.data(), payload.size());
 
 	unsigned short initPort = socket.getLocalPort();
 
@@ -9,6 +9,7 @@
 #include <mutex>
 #include <SFML/Network.hpp>
 #include "Agents/PacingAgent.hpp"
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
 #include "Interfaces/NetWorth/server/ServerInterface.hpp"
 #include "Interfaces/NetWorth/server/ServerManager.hpp"
 #include "Worlds/MazeWorld.hpp"
@@ -56,21 +57,24 @@ void handleConnection(netWorth::ServerManager &serverManager, cse491::WorldBase
         pkt >> str;
         std::cout << str << std::endl;
 
-        // Serialize world into string
+        // Serialize world into a binary snapshot
         std::ostringstream os;
-        world.Serialize(os);
+        world.SerializeBinary(os);
         std::string serialized = os.str();
-        std::cout << serialized << std::endl;
+        std::cout << "World snapshot: " << serialized.size() << " bytes" << std::endl;
 
 		serverManager.increasePort();
 
-        // send port of server interface, world type, x, y, and world data
+        // send port of server interface, world type, x, y, and world data; the world may be far
+        // larger than one datagram, so it goes out as fragments that are resent until all arrive
         pkt.clear();
         pkt << serverManager.m_max_client_port << static_cast<int>(worldType);
         pkt << startX << startY << serialized;
-        if (socket.send(pkt, sender.value(), port) != sf::Socket::Status::Done) {
-            std::cerr << "Failed to send" << std::endl;
-            exit(0);
+        std::string_view payload(static_cast<const char *>(pkt.getData()), pkt.getDataSize());
+        if (!netWorth::sendPayload(socket, sender.value(), port, payload)) {
+            std::cerr << "Failed to send world to " << sender->toString() << std::endl;
+            world.SetWorldRunning(true);
+            continue;
         }
 
         // add ServerInterface[port number] to world
@@ -86,14 +90,7 @@ void handleConnection(netWorth::ServerManager &serverManager, cse491::WorldBase
 		serverManager.writeToActionMap(serverInterface.GetID(), 0);
 		serverManager.addToUpdatePairs(sender.value(), port);
 		serverManager.addToInterfaceSet(serverInterface.GetID());
-		serverManager.setNewAgent(true);
-
-		// serialize agents and send game updates to all clients
-		std::ostringstream agent_os;
-		world.SerializeAgentSet(agent_os);
-		std::string serialized_agents = agent_os.str();
-		serverManager.setSerializedAgents(serialized_agents);
-		serverManager.sendGameUpdates();
+		// the new agent reaches every client in the next tick's world delta
 
         std::cout << "Added thread" << std::endl;
     }
@@ -7,12 +7,55 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
 
+// Std
+#include <deque>
+#include <limits>
+
 // class project
 #include "Agents/AStarAgent.hpp"
 #include "Worlds/MazeWorld.hpp"
 
 using namespace walle;
 
+namespace {
+
+    /// Breadth-first search distance, used to check that A* paths are shortest.
+    size_t BFSDistance(const cse491::WorldBase &world, const cse491::AgentBase &agent,
+                       cse491::GridPosition start, cse491::GridPosition end) {
+        const auto &grid = world.GetGrid();
+        const size_t width = grid.GetWidth();
+        std::vector<size_t> dist(grid.GetNumCells(), std::numeric_limits<size_t>::max());
+        std::deque<cse491::GridPosition> open{start};
+        dist[start.CellY() * width + start.CellX()] = 0;
+        while (!open.empty()) {
+            auto pos = open.front();
+            open.pop_front();
+            const size_t cur_dist = dist[pos.CellY() * width + pos.CellX()];
+            if (pos == end) return cur_dist;
+            for (auto next : {pos.Above(), pos.Below(), pos.ToLeft(), pos.ToRight()}) {
+                if (!grid.IsValid(next) || !world.IsTraversable(agent, next)) continue;
+                size_t &next_dist = dist[next.CellY() * width + next.CellX()];
+                if (next_dist <= cur_dist + 1) continue;
+                next_dist = cur_dist + 1;
+                open.push_back(next);
+            }
+        }
+        return std::numeric_limits<size_t>::max();
+    }
+
+    /// World using team8_grid_v2.grid, for benchmarking searches on a larger map.
+    class Team8World : public cse491::WorldBase {
+    public:
+        Team8World() {
+            AddCellType("floor", "Open ground.", ' ');
+            AddCellType("tree", "A tree.", '^');
+            main_grid.Read("../assets/grids/team8_grid_v2.grid", type_options);
+        }
+        int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+    };
+
+}
+
 TEST_CASE("AStar Agent Initialization", "[Agents]") {
 
     // create a star agent
@@ -184,5 +227,82 @@ TEST_CASE("Agent State"){
     }
 }
 
+TEST_CASE("GetShortestPath returns shortest routes", "[Agents]") {
+    cse491::MazeWorld world;
+    AStarAgent agent(1, "TestAgent");
+    agent.SetWorld(world);
+    const cse491::GridPosition start(0, 0);
 
+    SECTION("Start and end are the same") {
+        auto path = GetShortestPath(start, start, world, agent);
+        REQUIRE(path.size() == 1);
+        CHECK(path[0] == start);
+    }
 
+    SECTION("Path lengths match breadth-first search") {
+        const auto &grid = world.GetGrid();
+        for (size_t y = 0; y < grid.GetHeight(); ++y) {
+            for (size_t x = 0; x < grid.GetWidth(); ++x) {
+                const cse491::GridPosition end(x, y);
+                auto path = GetShortestPath(start, end, world, agent);
+                const size_t expected = BFSDistance(world, agent, start, end);
+                if (expected == std::numeric_limits<size_t>::max()) {
+                    CHECK(path.empty());
+                    continue;
+                }
+                REQUIRE(path.size() == expected + 1);
+                CHECK(path.front() == end);
+                CHECK(path.back() == start);
+                for (size_t i = 1; i < path.size(); ++i) {
+                    CHECK(path[i].IsNear(path[i - 1], 1.0));
+                    CHECK(world.IsTraversable(agent, path[i]));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("GetShortestPath workspace reuse", "[Agents]") {
+    cse491::MazeWorld world;
+    AStarAgent agent(1, "TestAgent");
+    agent.SetWorld(world);
+    PathWorkspace workspace;
+    CHECK(workspace.GetCapacity() == 0);
+
+    const cse491::GridPosition start(0, 0);
+    const cse491::GridPosition end(22, 8);
+    auto first = GetShortestPath(start, end, world, agent, workspace);
+    CHECK(workspace.GetCapacity() == world.GetGrid().GetNumCells());
+    REQUIRE(!first.empty());
+
+    // Searches in between must not leak into later ones.
+    CHECK(GetShortestPath(end, start, world, agent, workspace).size() == first.size());
+    CHECK(GetShortestPath(start, cse491::GridPosition(0, -5), world, agent, workspace).empty());
+    CHECK(GetShortestPath(start, end, world, agent, workspace) == first);
+    CHECK(GetShortestPath(start, end, world, agent) == first);
+}
+
+TEST_CASE("GetShortestPath benchmark", "[.][benchmark][Agents]") {
+    Team8World world;
+    AStarAgent agent(1, "TestAgent");
+    agent.SetWorld(world);
+    const auto &grid = world.GetGrid();
+    const cse491::GridPosition corner(0, 0);
+    const cse491::GridPosition far_corner(grid.GetWidth() - 1, grid.GetHeight() - 1);
+    const cse491::GridPosition center(grid.GetWidth() / 2, grid.GetHeight() / 2);
+    PathWorkspace workspace;
+
+    BENCHMARK("Corner to corner (thread workspace)") {
+        return GetShortestPath(corner, far_corner, world, agent);
+    };
+    BENCHMARK("Corner to corner (explicit workspace)") {
+        return GetShortestPath(corner, far_corner, world, agent, workspace);
+    };
+    BENCHMARK("Center to corner, 100 searches") {
+        size_t total = 0;
+        for (int i = 0; i < 100; ++i) {
+            total += GetShortestPath(center, corner, world, agent, workspace).size();
+        }
+        return total;
+    };
+}
@@ -10,6 +10,7 @@
 #include "Agents/GP/CGPGenotype.hpp"
 #include "Agents/GP/CGPAgent.hpp"
 #include <ranges>
+#include <sstream>
 
 using namespace cowboys;
 
@@ -45,24 +46,25 @@ TEST_CASE("Genotype iterators", "[group7][genotype]") {
     CGPGenotype genotype({8, 4, 2, 10, 2});
     auto it = genotype.begin();
     // We ignore the input nodes, so the first node should have 8 input connections
-    CHECK(it->input_connections.size() == 8);
+    CHECK(genotype.GetConnections(0).size() == 8);
 
     // Iterate through all nodes, checking input connections to differentiate them
     it = genotype.begin();
+    size_t node_idx = 0;
     // Layer 1
     for (size_t i = 0; i < 10; ++i) {
-      CHECK(it->input_connections.size() == 8);
+      CHECK(genotype.GetConnections(node_idx++).size() == 8);
       ++it;
     }
     // Layer 2
     for (size_t i = 0; i < 10; ++i) {
-      CHECK(it->input_connections.size() == 18);
+      CHECK(genotype.GetConnections(node_idx++).size() == 18);
       CHECK(it->function_idx == 0);
       ++it;
     }
     // Output layer
     for (size_t i = 0; i < 4; ++i) {
-      CHECK(it->input_connections.size() == 20);
+      CHECK(genotype.GetConnections(node_idx++).size() == 20);
       CHECK(it->function_idx == 0);
       ++it;
     }
@@ -250,12 +252,12 @@ TEST_CASE("Genotype configuration", "[group7][genotype]") {
     genotype2.begin()->function_idx = 1;
     CHECK(genotype == genotype2);
 
-    genotype.begin()->input_connections = std::vector<char>(8, '1');
+    genotype.SetConnections(0, true);
     CHECK_FALSE(genotype == genotype2);
-    genotype2.begin()->input_connections = std::vector<char>(8, '1');
+    genotype2.SetConnections(0, true);
     CHECK(genotype == genotype2);
 
-    genotype.begin()->input_connections = std::vector<char>(8, '0');
+    genotype.SetConnections(0, false);
     CHECK_FALSE(genotype == genotype2);
     genotype2 = CGPGenotype().Configure(genotype.Export());
     CHECK(genotype == genotype2);
@@ -288,4 +290,155 @@ TEST_CASE("Genotype configuration", "[group7][genotype]") {
     CGPGenotype genotype2(genotype);
     CHECK(genotype == genotype2);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Genotype connections", "[group7][genotype]") {
+  // Second layer and output nodes have more than one word of connections
+  CGPGenotype genotype({100, 4, 2, 30, 2});
+  REQUIRE(genotype.GetConnections(0).size() == 100);
+  REQUIRE(genotype.GetConnections(30).size() == 130);
+  REQUIRE(genotype.GetConnections(60).size() == 60);
+
+  SECTION("Setting single connections") {
+    genotype.SetConnection(30, 0);
+    genotype.SetConnection(30, 63);
+    genotype.SetConnection(30, 64);
+    genotype.SetConnection(30, 129);
+    auto connections = genotype.GetConnections(30);
+    CHECK(connections[0]);
+    CHECK_FALSE(connections[1]);
+    CHECK(connections[63]);
+    CHECK(connections[64]);
+    CHECK(connections[129]);
+    CHECK(connections.Count() == 4);
+    CHECK(genotype.GetNumConnections() == 4);
+    CHECK_FALSE(genotype.GetConnections(29).Any());
+    CHECK_FALSE(genotype.GetConnections(31).Any());
+
+    std::vector<size_t> connected;
+    connections.ForEachConnected([&connected](size_t idx) { connected.push_back(idx); });
+    CHECK(connected == std::vector<size_t>{0, 63, 64, 129});
+
+    std::string expected(130, '0');
+    expected[0] = expected[63] = expected[64] = expected[129] = '1';
+    CHECK(connections.ToString() == expected);
+
+    genotype.SetConnection(30, 63, false);
+    CHECK_FALSE(genotype.GetConnections(30)[63]);
+    CHECK(genotype.GetNumConnections() == 3);
+  }
+  SECTION("Setting all connections") {
+    genotype.SetConnections(30, true);
+    CHECK(genotype.GetConnections(30).Count() == 130);
+    CHECK(genotype.GetNumConnections() == 130);
+    genotype.SetConnections(30, false);
+    CHECK(genotype.GetNumConnections() == 0);
+  }
+  SECTION("Mutation only sets valid connections") {
+    genotype.MutateConnections(1, mock_agent);
+    CHECK(genotype.GetNumConnections() > 0);
+    CHECK(genotype.GetNumConnections() < genotype.GetNumPossibleConnections());
+    size_t total = 0;
+    for (size_t i = 0; i < genotype.GetNumFunctionalNodes(); ++i)
+      total += genotype.GetConnections(i).ToString().find_first_not_of('0') != std::string::npos ? 1 : 0;
+    CHECK(total > 0);
+
+    // Connections survive export, including those past the first word
+    CHECK(CGPGenotype().Configure(genotype.Export()) == genotype);
+  }
+  SECTION("Header mutation keeps connections") {
+    genotype.SetConnection(30, 129);
+    genotype.SetConnection(60, 0);
+    genotype.MutateHeader(1, mock_agent);
+    REQUIRE(genotype.GetNumNodesPerLayer() == 31);
+    REQUIRE(genotype.GetLayersBack() == 3);
+    CHECK(genotype.GetNumConnections() == 2);
+    CHECK(genotype.GetConnections(31).size() == 131);
+    CHECK(genotype.GetConnections(31).Count() == 1);
+    // Output nodes can now reach the inputs, so their connections grow
+    CHECK(genotype.GetConnections(62).size() == 162);
+    CHECK(genotype.GetConnections(62).Count() == 1);
+    CHECK(CGPGenotype().Configure(genotype.Export()) == genotype);
+  }
+}
+
+TEST_CASE("Genotype binary format", "[group7][genotype]") {
+  CGPGenotype genotype({8, 4, 10, 10, 2});
+  genotype.SetSeed(5);
+  genotype.MutateDefault(1, mock_agent);
+  genotype.begin()->default_output = 1.0 / 3.0;
+
+  SECTION("Round trip") {
+    std::stringstream ss;
+    genotype.SaveBinary(ss);
+    CGPGenotype genotype2;
+    genotype2.LoadBinary(ss);
+    CHECK(genotype == genotype2);
+    CHECK(genotype2.GetNumConnections() == genotype.GetNumConnections());
+
+    // Default outputs are restored exactly, not just to printed precision
+    auto it2 = genotype2.cbegin();
+    for (auto it = genotype.cbegin(); it != genotype.cend(); ++it, ++it2)
+      CHECK(it->default_output == it2->default_output);
+  }
+  SECTION("Invalid data") {
+    std::stringstream ss;
+    genotype.SaveBinary(ss);
+    std::string data = ss.str();
+
+    std::stringstream truncated(data.substr(0, data.size() - 1));
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(truncated), std::runtime_error);
+
+    std::stringstream bad_header("XXXX" + data.substr(4));
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(bad_header), std::runtime_error);
+
+    std::stringstream empty;
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(empty), std::runtime_error);
+
+    // Parameters too large to allocate are rejected before anything is allocated
+    auto set_param = [](std::string bytes, size_t param_idx, uint64_t value) {
+      for (size_t i = 0; i < 8; ++i)
+        bytes[5 + 8 * param_idx + i] = static_cast<char>(value >> (8 * i));
+      return bytes;
+    };
+    std::stringstream huge_inputs(set_param(data, 0, uint64_t(1) << 40));
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(huge_inputs), std::runtime_error);
+    std::stringstream too_many_nodes(set_param(set_param(data, 2, uint64_t(1) << 20), 3, uint64_t(1) << 20));
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(too_many_nodes), std::runtime_error);
+    std::stringstream too_many_connections(set_param(set_param(data, 0, uint64_t(1) << 24), 3, 1000));
+    CHECK_THROWS_AS(CGPGenotype().LoadBinary(too_many_connections), std::runtime_error);
+  }
+}
+
+TEST_CASE("Genotype copy", "[group7][genotype]") {
+  CGPGenotype genotype({8, 4, 5, 5, 2});
+  genotype.SetSeed(11);
+  genotype.MutateDefault(1, mock_agent);
+  // Copies keep default outputs exactly, without a round trip through a string
+  genotype.begin()->default_output = 1.0 / 3.0;
+
+  CGPGenotype copy(genotype);
+  CHECK(copy == genotype);
+  CGPGenotype assigned({2, 2, 1, 1, 1});
+  assigned = genotype;
+  CHECK(assigned == genotype);
+  auto it2 = assigned.cbegin();
+  for (auto it = genotype.cbegin(); it != genotype.cend(); ++it, ++it2)
+    CHECK(it->default_output == it2->default_output);
+}
+
+TEST_CASE("Genotype copy benchmark", "[.][benchmark][group7][genotype]") {
+  for (size_t size : {10, 50, 100}) {
+    CGPGenotype genotype({6, 4, size, size, 2});
+    genotype.SetSeed(3);
+    genotype.MutateDefault(0.5, mock_agent);
+    const std::string suffix = " (" + std::to_string(size) + "x" + std::to_string(size) + ")";
+
+    BENCHMARK("Copy constructor" + suffix) { return CGPGenotype(genotype); };
+    BENCHMARK("Export and Configure" + suffix) { return CGPGenotype().Configure(genotype.Export()); };
+    BENCHMARK("SaveBinary and LoadBinary" + suffix) {
+      std::stringstream ss;
+      genotype.SaveBinary(ss);
+      return CGPGenotype().LoadBinary(ss);
+    };
+  }
+}
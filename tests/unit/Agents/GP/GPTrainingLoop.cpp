@@ -0,0 +1,44 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for GPTrainingLoop.hpp in source/Agents/GP
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+#include <cstdlib>
+#include <set>
+
+#include "Agents/GP/CGPAgent.hpp"
+#include "Agents/GP/GPTrainingLoop.hpp"
+#include "Worlds/MazeWorld.hpp"
+
+using namespace cowboys;
+
+namespace {
+  /// Score one generation of a fresh, identically seeded population.
+  std::vector<std::vector<double>> ScoreGeneration(bool independent, size_t num_threads) {
+    std::srand(7); // Agents seed their genotypes with rand()
+    GPTrainingLoop<CGPAgent, cse491::MazeWorld> loop;
+    loop.Initialize(2, 30, 5);
+    loop.SetIndependentAgents(independent, 4);
+    loop.InitTEMPAgentFitness();
+    loop.ThreadTrainLoop(num_threads, 40);
+    return loop.GetAgentFitness();
+  }
+}
+
+TEST_CASE("Independent agents mode", "[group7][training]") {
+  auto sequential = ScoreGeneration(false, 1);
+  REQUIRE(sequential.size() == 2);
+  REQUIRE(sequential[0].size() == 30);
+
+  // Agents should not all score the same, or the comparison proves little
+  std::set<double> distinct(sequential[0].cbegin(), sequential[0].cend());
+  CHECK(distinct.size() > 1);
+
+  CHECK(ScoreGeneration(false, 4) == sequential);
+  CHECK(ScoreGeneration(true, 1) == sequential);
+  CHECK(ScoreGeneration(true, 4) == sequential);
+}
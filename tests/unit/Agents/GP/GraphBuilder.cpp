@@ -7,14 +7,33 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
 
+#include <cmath>
+#include <random>
+
 #include "Agents/GP/CGPGenotype.hpp"
 #include "Agents/GP/GraphBuilder.hpp"
 #include "Agents/GP/CGPAgent.hpp"
+#include "Worlds/MazeWorld.hpp"
 
 using namespace cowboys;
 
 CGPAgent mock_agent(0, "mock");
 
+/// Check that two doubles are bit-for-bit the same (treating all NaNs as equal).
+bool SameValue(double a, double b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+/// Check that a graph and its compiled version currently produce the same output values.
+bool SameOutputs(const Graph &graph, const CompiledGraph &compiled) {
+  auto nodes = graph.GetNodes();
+  if (nodes.size() != compiled.GetNodeCount())
+    return false;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i]->IsCacheValid() && !SameValue(nodes[i]->GetOutput(), compiled.GetNodeOutput(i)))
+      return false;
+  }
+  return true;
+}
+
 TEST_CASE("Cartesian Graph", "[group7][graph][cartesian]") {
   constexpr size_t INPUT_SIZE = 10;
   constexpr size_t NUM_OUTPUTS = 10;
@@ -85,4 +104,87 @@ TEST_CASE("Cartesian Graph", "[group7][graph][cartesian]") {
     // Could fail, but should be very unlikely
     CHECK(choose_same_action);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Compiled Cartesian Graph", "[group7][graph][cartesian]") {
+  constexpr size_t INPUT_SIZE = 6;
+  constexpr size_t NUM_OUTPUTS = 4;
+  constexpr size_t NUM_LAYERS = 3;
+  constexpr size_t NUM_NODES_PER_LAYER = 5;
+  constexpr size_t LAYERS_BACK = 2;
+  std::vector<size_t> actions{1, 2, 3, 4};
+  GraphBuilder builder;
+
+  SECTION("Same decisions as the Cartesian graph") {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> input_dist(-3, 3);
+    for (size_t i = 0; i < 50; ++i) {
+      CGPGenotype genotype({INPUT_SIZE, NUM_OUTPUTS, NUM_LAYERS, NUM_NODES_PER_LAYER, LAYERS_BACK});
+      genotype.SetSeed(i).MutateDefault(1, mock_agent, NODE_FUNCTION_SET.size());
+      auto graph = builder.CartesianGraph(genotype, NODE_FUNCTION_SET);
+      auto compiled = builder.CompiledCartesianGraph(genotype, NODE_FUNCTION_SET);
+      CHECK(compiled->GetNodeCount() == graph->GetNodeCount());
+
+      std::vector<double> inputs(INPUT_SIZE, 0);
+      for (size_t step = 0; step < 20; ++step) {
+        // Change only some inputs each step, so that caching is exercised.
+        if (step % 3 != 0)
+          inputs[step % INPUT_SIZE] = input_dist(gen);
+        CHECK(compiled->MakeDecision(inputs, actions) == graph->MakeDecision(inputs, actions));
+        CHECK(SameOutputs(*graph, *compiled));
+      }
+    }
+  }
+
+  SECTION("Same decisions with sensors as the agent moves") {
+    cse491::MazeWorld world;
+    auto &agent = static_cast<CGPAgent &>(world.AddAgent<CGPAgent>("Agent"));
+    const auto &grid = world.GetGrid();
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<size_t> x_dist(0, grid.GetWidth() - 1);
+    std::uniform_int_distribution<size_t> y_dist(0, grid.GetHeight() - 1);
+    for (size_t i = 0; i < 20; ++i) {
+      CGPGenotype genotype({INPUT_SIZE, NUM_OUTPUTS, NUM_LAYERS, NUM_NODES_PER_LAYER, LAYERS_BACK});
+      genotype.SetSeed(i + 100).MutateDefault(1, agent);
+      auto graph = builder.CartesianGraph(genotype, FUNCTION_SET, &agent);
+      auto compiled = builder.CompiledCartesianGraph(genotype, FUNCTION_SET, &agent);
+
+      std::vector<double> inputs(INPUT_SIZE, 0);
+      for (size_t step = 0; step < 20; ++step) {
+        // Sensors read the agent's position, even when the graph inputs do not change.
+        agent.SetPosition(cse491::GridPosition(x_dist(gen), y_dist(gen)));
+        if (step % 2 == 0)
+          inputs[step % INPUT_SIZE] = static_cast<double>(step % 4);
+        CHECK(compiled->MakeDecision(inputs, actions) == graph->MakeDecision(inputs, actions));
+        CHECK(SameOutputs(*graph, *compiled));
+      }
+    }
+  }
+}
+
+TEST_CASE("Compiled Cartesian Graph benchmark", "[.][benchmark][group7][graph][cartesian]") {
+  GraphBuilder builder;
+  CGPGenotype genotype({INPUT_SIZE, 4, NUM_LAYERS, NUM_NODES_PER_LAYER, LAYERS_BACK});
+  genotype.SetSeed(3).MutateDefault(1, mock_agent, NODE_FUNCTION_SET.size());
+  auto graph = builder.CartesianGraph(genotype, NODE_FUNCTION_SET);
+  auto compiled = builder.CompiledCartesianGraph(genotype, NODE_FUNCTION_SET);
+  std::vector<size_t> actions{1, 2, 3, 4};
+  std::vector<double> inputs(INPUT_SIZE, 0);
+
+  BENCHMARK("Graph::MakeDecision, 1000 decisions") {
+    size_t total = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+      inputs[i % INPUT_SIZE] = static_cast<double>(i % 7);
+      total += graph->MakeDecision(inputs, actions);
+    }
+    return total;
+  };
+  BENCHMARK("CompiledGraph::MakeDecision, 1000 decisions") {
+    size_t total = 0;
+    for (size_t i = 0; i < 1000; ++i) {
+      inputs[i % INPUT_SIZE] = static_cast<double>(i % 7);
+      total += compiled->MakeDecision(inputs, actions);
+    }
+    return total;
+  };
+}
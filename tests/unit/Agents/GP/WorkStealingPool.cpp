@@ -0,0 +1,119 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for WorkStealingPool.hpp in source/Agents/GP
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Class project
+#include "Agents/GP/WorkStealingPool.hpp"
+
+using namespace cowboys;
+
+TEST_CASE("WorkStealingPool runs every task", "[group7][pool]") {
+  WorkStealingPool pool(4);
+  CHECK(pool.GetNumThreads() == 4);
+
+  std::vector<int> results(1000, 0);
+  for (size_t i = 0; i < results.size(); ++i) {
+    pool.Submit([&results, i]() { results[i] = static_cast<int>(i) * 2; });
+  }
+  pool.Wait();
+  for (size_t i = 0; i < results.size(); ++i) {
+    CHECK(results[i] == static_cast<int>(i) * 2);
+  }
+
+  SECTION("The pool can be reused") {
+    std::atomic<int> count = 0;
+    pool.ParallelFor(0, 500, [&count](size_t) { ++count; }, 7);
+    CHECK(count == 500);
+    pool.ParallelFor(10, 10, [&count](size_t) { ++count; });
+    CHECK(count == 500);
+  }
+  SECTION("Tasks can submit more tasks") {
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 10; ++i) {
+      pool.Submit([&pool, &count]() {
+        for (int j = 0; j < 10; ++j) pool.Submit([&count]() { ++count; });
+      });
+    }
+    pool.Wait();
+    CHECK(count == 100);
+  }
+}
+
+TEST_CASE("WorkStealingPool keeps threads busy with uneven tasks", "[group7][pool]") {
+  WorkStealingPool pool(4);
+  std::mutex latch_mutex;
+  std::condition_variable latch_cv;
+  int fast_done = 0;
+  bool released = false;
+
+  // One slow task must not hold up the quick ones queued behind it: it blocks until they have
+  // all run, which only happens if other threads take them.  The timeout only guards against a hang.
+  pool.Submit([&]() {
+    std::unique_lock lock(latch_mutex);
+    released = latch_cv.wait_for(lock, std::chrono::seconds(30), [&fast_done]() { return fast_done == 40; });
+  });
+  for (int i = 0; i < 40; ++i) {
+    pool.Submit([&]() {
+      std::lock_guard lock(latch_mutex);
+      if (++fast_done == 40) latch_cv.notify_all();
+    });
+  }
+  pool.Wait();
+  CHECK(released);
+  CHECK(fast_done == 40);
+}
+
+TEST_CASE("WorkStealingPool reports task exceptions", "[group7][pool]") {
+  WorkStealingPool pool(2);
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 10; ++i) {
+    pool.Submit([&count, i]() {
+      ++count;
+      if (i == 3) throw std::runtime_error("task failed");
+    });
+  }
+  CHECK_THROWS_AS(pool.Wait(), std::runtime_error);
+  CHECK(count == 10);
+
+  // The error is only reported once
+  pool.Submit([&count]() { ++count; });
+  CHECK_NOTHROW(pool.Wait());
+  CHECK(count == 11);
+}
+
+TEST_CASE("WorkStealingPool runs ParallelFor inside its own tasks", "[group7][pool]") {
+  // More outer tasks than threads, so every worker ends up waiting on an inner loop
+  WorkStealingPool pool(2);
+  std::atomic<int> count = 0;
+  pool.ParallelFor(0, 8, [&pool, &count](size_t) {
+    pool.ParallelFor(0, 100, [&count](size_t) { ++count; }, 10);
+  });
+  CHECK(count == 800);
+
+  // An inner loop's exception reaches the task that ran it, not a later Wait()
+  std::atomic<int> caught = 0;
+  pool.ParallelFor(0, 4, [&pool, &caught](size_t outer) {
+    try {
+      pool.ParallelFor(0, 10, [outer](size_t i) {
+        if (outer == 2 && i == 5) throw std::runtime_error("inner task failed");
+      });
+    } catch (const std::runtime_error &) {
+      ++caught;
+    }
+  });
+  CHECK(caught == 1);
+  CHECK_NOTHROW(pool.Wait());
+}
@@ -0,0 +1,86 @@
+/**
+ * @file AgentActionRecorderTest.cpp
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+#include "DataCollection/AgentActionRecorder.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+    /// Agent that alternates between stepping right (action 2) and left (action 1).
+    class StepAgent : public cse491::AgentBase {
+    private:
+        size_t turn = 0;
+
+    public:
+        StepAgent(size_t id, const std::string & name) : AgentBase(id, name) {
+            AddAction("left", 1);
+            AddAction("right", 2);
+        }
+        size_t SelectAction(const cse491::WorldGrid &, const cse491::type_options_t &,
+                            const cse491::item_map_t &, const cse491::agent_map_t &) override {
+            return (turn++ % 2 == 0) ? 2 : 1;
+        }
+    };
+
+    /// World where actions 1 and 2 move the agent one cell left or right.
+    class StepWorld : public cse491::WorldBase {
+    public:
+        int DoAction(cse491::AgentBase & agent, size_t action_id) override {
+            double step = (action_id == 2) ? 1.0 : -1.0;
+            agent.SetPosition(agent.GetPosition().GetX() + step, agent.GetPosition().GetY());
+            return static_cast<int>(action_id);
+        }
+    };
+}
+
+TEST_CASE("AgentActionRecorderOff", "[AgentActionRecorderTest]")
+{
+    StepWorld world;
+    CHECK(world.GetActionRecorder() == nullptr);
+    auto & agent = world.AddAgent<StepAgent>("Stepper");
+    world.RunAgents();
+    CHECK(agent.GetLastAction() == 2);
+    CHECK(agent.GetActionResult() == 2);
+}
+
+TEST_CASE("AgentActionRecorderRecord", "[AgentActionRecorderTest]")
+{
+    StepWorld world;
+    auto recorder = std::make_shared<DataCollection::AgentActionRecorder>();
+    world.SetActionRecorder(recorder);
+    world.AddAgent<StepAgent>("Stepper1");
+    world.AddAgent<StepAgent>("Stepper2");
+    for (int tick = 0; tick < 3; ++tick) world.RunAgents();
+
+    CHECK(recorder->GetNumActions() == 6);
+    auto data = recorder->GetAgent("Stepper1");
+    REQUIRE(data != nullptr);
+    CHECK(data->GetActionIds() == std::vector<size_t>{2, 1, 2});
+    CHECK(data->GetAgentIds().empty());
+    REQUIRE(data->GetActionSize() == 1);
+    CHECK(data->GetActions()[0].at("right") == 2);
+    CHECK(recorder->GetAgent("Nobody") == nullptr);
+
+    // Detaching the recorder stops recording
+    world.SetActionRecorder(nullptr);
+    world.RunAgents();
+    CHECK(recorder->GetNumActions() == 6);
+}
+
+TEST_CASE("RunAgents benchmark", "[.][benchmark]")
+{
+    StepWorld world;
+    for (int i = 0; i < 1000; ++i) world.AddAgent<StepAgent>("Stepper" + std::to_string(i));
+
+    BENCHMARK("RunAgents, 1000 agents, recording off") {
+        world.RunAgents();
+    };
+
+    world.SetActionRecorder(std::make_shared<DataCollection::AgentActionRecorder>());
+    BENCHMARK("RunAgents, 1000 agents, recording on") {
+        world.RunAgents();
+    };
+}
@@ -40,5 +40,13 @@ TEST_CASE("AgentData class tests", ) {
             REQUIRE(ids[0] == 101);
             REQUIRE(ids[1] == 102);
         }
+
+        SECTION("Test storing action IDs") {
+            agent.StoreActionId(3);
+            agent.StoreActionId(1);
+
+            REQUIRE(agent.GetActionIds() == std::vector<size_t>{3, 1});
+            REQUIRE(agent.GetAgentIds().empty());
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+/**
+ * @file AgentEventLogTest.cpp
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+#include "DataCollection/AgentEventLog.hpp"
+#include "DataCollection/AgentReciever.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+    /// Agent that always asks to step right.
+    class StepAgent : public cse491::AgentBase {
+    public:
+        StepAgent(size_t id, const std::string & name) : AgentBase(id, name) {}
+        size_t SelectAction(const cse491::WorldGrid &, const cse491::type_options_t &,
+                            const cse491::item_map_t &, const cse491::agent_map_t &) override { return 2; }
+    };
+
+    /// World where every action moves the agent one cell right.
+    class StepWorld : public cse491::WorldBase {
+    public:
+        int DoAction(cse491::AgentBase & agent, size_t) override {
+            agent.SetPosition(agent.GetPosition().GetX() + 1, agent.GetPosition().GetY());
+            return 1;
+        }
+    };
+}
+
+TEST_CASE("AgentEventLogAppend", "[AgentEventLogTest]")
+{
+    DataCollection::AgentEventLog log;
+    CHECK(log.IsEmpty());
+    CHECK(log.GetNumChunks() == 0);
+
+    log.Append(7, 3, cse491::GridPosition{1, 2}, 4, 1);
+    CHECK_FALSE(log.IsEmpty());
+    CHECK(log.GetNumEvents() == 1);
+
+    auto event = log.GetEvent(0);
+    CHECK(event.agent_id == 7);
+    CHECK(event.tick == 3);
+    CHECK(event.position == cse491::GridPosition{1, 2});
+    CHECK(event.action == 4);
+    CHECK(event.result == 1);
+
+    log.Clear();
+    CHECK(log.IsEmpty());
+}
+
+TEST_CASE("AgentEventLogChunks", "[AgentEventLogTest]")
+{
+    constexpr size_t CHUNK_SIZE = DataCollection::AgentEventLog::CHUNK_SIZE;
+    DataCollection::AgentEventLog log;
+    const size_t num_events = CHUNK_SIZE * 2 + 5;
+    for (size_t i = 0; i < num_events; ++i) {
+        log.Append(i % 3, i / 3, cse491::GridPosition(static_cast<double>(i), 0), i % 5, 0);
+    }
+    CHECK(log.GetNumEvents() == num_events);
+    CHECK(log.GetNumChunks() == 3);
+
+    // Events on either side of a chunk boundary come back unchanged
+    for (size_t i : {CHUNK_SIZE - 1, CHUNK_SIZE, CHUNK_SIZE * 2, num_events - 1}) {
+        auto event = log.GetEvent(i);
+        CHECK(event.agent_id == i % 3);
+        CHECK(event.tick == i / 3);
+        CHECK(event.position.GetX() == static_cast<double>(i));
+        CHECK(event.action == i % 5);
+    }
+
+    size_t count = 0;
+    log.ForEachEvent([&count](const DataCollection::AgentEvent & event) {
+        CHECK(event.position.GetX() == static_cast<double>(count));
+        ++count;
+    });
+    CHECK(count == num_events);
+
+    // Copies are independent of the original
+    DataCollection::AgentEventLog copy(log);
+    log.Clear();
+    CHECK(copy.GetNumEvents() == num_events);
+    CHECK(copy.GetEvent(CHUNK_SIZE).position.GetX() == static_cast<double>(CHUNK_SIZE));
+}
+
+TEST_CASE("AgentEventLogTrajectory", "[AgentEventLogTest]")
+{
+    DataCollection::AgentEventLog log;
+    const size_t num_ticks = DataCollection::AgentEventLog::CHUNK_SIZE;
+    for (size_t tick = 0; tick < num_ticks; ++tick) {
+        log.Append(1, tick, cse491::GridPosition(static_cast<double>(tick), 1), 1, 1);
+        log.Append(2, tick, cse491::GridPosition(2, static_cast<double>(tick)), 2, 0);
+    }
+
+    auto trajectory = log.GetTrajectory(2);
+    REQUIRE(trajectory.size() == num_ticks);
+    for (size_t tick = 0; tick < num_ticks; ++tick) {
+        CHECK(trajectory[tick] == cse491::GridPosition(2, static_cast<double>(tick)));
+    }
+
+    auto events = log.GetAgentEvents(1);
+    REQUIRE(events.size() == num_ticks);
+    CHECK(events.back().tick == num_ticks - 1);
+    CHECK(events.back().position == cse491::GridPosition(static_cast<double>(num_ticks - 1), 1));
+
+    CHECK(log.GetTrajectory(3).empty());
+}
+
+TEST_CASE("AgentRecieverEventLog", "[AgentEventLogTest]")
+{
+    DataCollection::AgentReceiver agent_reciever;
+    agent_reciever.StoreData("Agent1", cse491::GridPosition{0, 0}, 1);
+    agent_reciever.StoreData("Agent2", cse491::GridPosition{5, 5}, 2);
+    agent_reciever.StoreData("Agent1", cse491::GridPosition{0, 1}, 3);
+
+    const auto & log = agent_reciever.GetEventLog();
+    CHECK(log.GetNumEvents() == 3);
+    auto events = log.GetAgentEvents(agent_reciever.GetAgentID("Agent1"));
+    REQUIRE(events.size() == 2);
+    CHECK(events[0].tick == 0);
+    CHECK(events[1].tick == 1);
+    CHECK(events[1].position == cse491::GridPosition{0, 1});
+    CHECK(events[1].action == 3);
+
+    agent_reciever.StoreEvent(10, 0, cse491::GridPosition{3, 4}, 2, 1);
+    CHECK(log.GetTrajectory(10) == std::vector<cse491::GridPosition>{cse491::GridPosition{3, 4}});
+}
+
+TEST_CASE("AgentEventLogWorld", "[AgentEventLogTest]")
+{
+    StepWorld world;
+    world.SetAgentReceiver(DataCollection::AgentReceiver());
+    size_t id = world.AddAgent<StepAgent>("Stepper").SetPosition(0, 3).GetID();
+    for (size_t tick = 0; tick < 5; ++tick) {
+        world.RunAgents();
+        world.CollectData();
+    }
+
+    const auto & log = world.GetAgentReceiver()->GetEventLog();
+    auto events = log.GetAgentEvents(id);
+    REQUIRE(events.size() == 5);
+    for (size_t tick = 0; tick < 5; ++tick) {
+        CHECK(events[tick].tick == tick);
+        CHECK(events[tick].position == cse491::GridPosition(static_cast<double>(tick + 1), 3));
+        CHECK(events[tick].action == 2);
+        CHECK(events[tick].result == 1);
+    }
+}
+
+TEST_CASE("AgentRecieverStoreData benchmark", "[.][benchmark]")
+{
+    // Each sample used to copy the agent's whole history; now every sample costs the same.
+    BENCHMARK("StoreData, 10 agents x 2000 ticks") {
+        DataCollection::AgentReceiver agent_reciever;
+        for (size_t tick = 0; tick < 2000; ++tick) {
+            for (int agent = 0; agent < 10; ++agent) {
+                agent_reciever.StoreData("Agent" + std::to_string(agent),
+                                         cse491::GridPosition(tick, agent), agent);
+            }
+        }
+        return agent_reciever.GetEventLog().GetNumEvents();
+    };
+}
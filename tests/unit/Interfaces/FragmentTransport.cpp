@@ -0,0 +1,237 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for FragmentTransport.hpp and Compression.hpp in source/Interfaces/NetWorth
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Class project
+#include "core/WorldBase.hpp"
+#include "Interfaces/NetWorth/Compression.hpp"
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
+#include "Interfaces/NetWorth/client/ClientManager.hpp"
+
+namespace {
+
+  /// World used to make a realistic snapshot; its agents never act.
+  class SnapshotWorld : public cse491::WorldBase {
+  public:
+    SnapshotWorld(size_t width, size_t height) {
+      AddCellType("floor", "Open ground.", ' ');
+      AddCellType("wall", "A wall.", '#');
+      main_grid.Resize(width, height);
+    }
+    void ConfigAgent(cse491::AgentBase & agent) override {
+      agent.AddAction("up", 1).AddAction("down", 2).AddAction("left", 3).AddAction("right", 4);
+    }
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+  };
+
+  std::string RandomBytes(size_t size, std::mt19937 & rng) {
+    std::string bytes(size, '\0');
+    for (char & c : bytes) c = static_cast<char>(rng());
+    return bytes;
+  }
+
+  /// Outcome of one transfer through the lossy loopback.
+  struct Result {
+    bool complete = false;
+    std::string payload;
+    size_t rounds = 0;
+    size_t sent = 0;
+    size_t resent = 0;
+    size_t fragments = 0;
+  };
+
+  /// Run a transfer where each packet, in either direction, is lost with the given chance and
+  /// each burst arrives shuffled.  As in receivePayload(), a poll is answered once the burst has
+  /// been drained; a round with no status counts as a timeout, as in sendPayload().
+  Result Transfer(const std::string & payload, const netWorth::TransportConfig & config, double loss,
+                  unsigned seed = 491, size_t max_rounds = 100000) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution lost(loss);
+    netWorth::FragmentSender sender(42, payload, config);
+    netWorth::FragmentReceiver receiver(config);
+
+    Result result;
+    std::vector<sf::Packet> burst, statuses;
+    while (!sender.isComplete() && result.rounds < max_rounds) {
+      ++result.rounds;
+      sender.nextBurst(burst);
+      std::shuffle(burst.begin(), burst.end(), rng);
+      statuses.clear();
+      bool polled = false;
+      for (auto & fragment : burst) {
+        if (lost(rng)) continue;
+        bool status_due = false;
+        REQUIRE(receiver.handleFragment(fragment, status_due));
+        polled = polled || status_due;
+      }
+      if (polled && !lost(rng)) statuses.push_back(receiver.statusPacket());
+      if (statuses.empty()) {
+        if (!sender.handleTimeout()) break;
+        // The receiver also reports on its own when it hears nothing for a while.
+        if (receiver.hasStarted() && !lost(rng)) statuses.push_back(receiver.statusPacket());
+      }
+      for (auto & status : statuses) CHECK(sender.handleStatus(status));
+    }
+    result.complete = sender.isComplete();
+    result.sent = sender.getFragmentsSent();
+    result.resent = sender.getFragmentsResent();
+    result.fragments = sender.getFragmentCount();
+    if (result.complete) CHECK(receiver.takePayload(result.payload));
+    return result;
+  }
+
+}
+
+TEST_CASE("Compression round trips and rejects corrupt streams", "[networth][transport]"){
+  std::mt19937 rng(7);
+  const std::string repetitive = [] {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "Agent " + std::to_string(i % 50) + " symbol=a Health=100;";
+    return text;
+  }();
+  for (const std::string & input : {std::string(), std::string("abc"), std::string(5000, 'x'), repetitive,
+                                    RandomBytes(10000, rng)}) {
+    const std::string packed = netWorth::compression::compress(input);
+    std::string unpacked;
+    CHECK(netWorth::compression::decompress(packed, input.size(), unpacked));
+    CHECK(unpacked == input);
+  }
+  CHECK(netWorth::compression::compress(repetitive).size() * 10 < repetitive.size());
+  CHECK(netWorth::compression::compress(std::string(5000, 'x')).size() < 20);
+
+  std::string packed = netWorth::compression::compress(repetitive), unpacked;
+  CHECK_FALSE(netWorth::compression::decompress(packed, repetitive.size() + 1, unpacked));
+  CHECK_FALSE(netWorth::compression::decompress(packed.substr(0, packed.size() / 2), repetitive.size(), unpacked));
+}
+
+TEST_CASE("Fragments stay small and a lossless transfer sends each once", "[networth][transport]"){
+  std::mt19937 rng(1);
+  const std::string payload = RandomBytes(3 << 20, rng);   // Three megabytes that do not compress
+  netWorth::TransportConfig config;
+
+  netWorth::FragmentSender sender(1, payload, config);
+  CHECK_FALSE(sender.isCompressed());
+  std::vector<sf::Packet> burst;
+  sender.nextBurst(burst);
+  REQUIRE(burst.size() == config.window);
+  for (auto & fragment : burst) CHECK(fragment.getDataSize() <= config.fragment_size + netWorth::transport::HEADER_SIZE);
+
+  const Result result = Transfer(payload, config, 0.0);
+  REQUIRE(result.complete);
+  CHECK(result.payload == payload);
+  CHECK(result.sent == result.fragments);
+  CHECK(result.resent == 0);
+  CHECK(result.rounds == (result.fragments + config.window - 1) / config.window);
+}
+
+TEST_CASE("Lost fragments and statuses are recovered by selective resends", "[networth][transport]"){
+  std::mt19937 rng(2);
+  const std::string payload = RandomBytes(1 << 20, rng);
+  netWorth::TransportConfig config;
+
+  for (double loss : {0.05, 0.2, 0.5}) {
+    const Result result = Transfer(payload, config, loss, 100 + static_cast<unsigned>(loss * 100));
+    INFO("loss " << loss);
+    REQUIRE(result.complete);
+    CHECK(result.payload == payload);
+    // Only lost fragments are sent again, plus the odd probe; never the whole payload over.
+    CHECK(result.resent < result.fragments * (loss / (1.0 - loss)) * 2 + 50);
+  }
+}
+
+TEST_CASE("The sender gives up when nothing answers", "[networth][transport]"){
+  netWorth::TransportConfig config;
+  config.max_silent = 5;
+  const Result result = Transfer(std::string(10000, 'q'), config, 1.0);
+  CHECK_FALSE(result.complete);
+  CHECK(result.rounds == 6);
+}
+
+TEST_CASE("A receiver only accepts fragments of its own transfer", "[networth][transport]"){
+  netWorth::TransportConfig config;
+  config.fragment_size = 100;
+  config.compress = false;
+  netWorth::FragmentSender first(1, std::string(250, 'a'), config), second(2, std::string(250, 'b'), config);
+  netWorth::FragmentReceiver receiver(config);
+  std::vector<sf::Packet> burst_a, burst_b;
+  first.nextBurst(burst_a);
+  second.nextBurst(burst_b);
+  REQUIRE(burst_a.size() == 3);
+
+  bool status_due = false;
+  CHECK(receiver.handleFragment(burst_a[2], status_due));
+  CHECK(status_due);                                      // The last fragment of a burst polls.
+  CHECK_FALSE(receiver.handleFragment(burst_b[0], status_due));
+  CHECK(receiver.handleFragment(burst_a[0], status_due));
+  CHECK_FALSE(status_due);
+  CHECK_FALSE(receiver.isComplete());
+
+  // The status lists fragment 1 as missing, so only it is sent again.
+  sf::Packet status = receiver.statusPacket();
+  CHECK(first.handleStatus(status));
+  first.nextBurst(burst_a);
+  REQUIRE(burst_a.size() == 1);
+  CHECK(receiver.handleFragment(burst_a[0], status_due));
+  CHECK(status_due);
+  std::string payload;
+  REQUIRE(receiver.takePayload(payload));
+  CHECK(payload == std::string(250, 'a'));
+
+  netWorth::TransportConfig small = config;
+  small.max_payload = 200;
+  netWorth::FragmentReceiver picky(small);
+  second.nextBurst(burst_b);
+  CHECK_FALSE(picky.handleFragment(burst_b[0], status_due));   // Larger than it will accept
+}
+
+TEST_CASE("A multi-megabyte world snapshot crosses a lossy link", "[networth][transport]"){
+  std::mt19937 rng(3);
+  SnapshotWorld world(1500, 1500);
+  auto & grid = world.GetGrid();
+  for (size_t y = 0; y < grid.GetHeight(); ++y) {
+    for (size_t x = 0; x < grid.GetWidth(); ++x) grid.At(x, y) = rng() % 3 == 0;
+  }
+  for (size_t i = 0; i < 2000; ++i) {
+    world.AddAgent<cse491::AgentBase>("Agent " + std::to_string(i)).SetPosition(i % 1500, i / 1500)
+        .SetProperty("symbol", 'a');
+  }
+  std::ostringstream os;
+  world.SerializeBinary(os);
+  const std::string snapshot = os.str();
+  REQUIRE(snapshot.size() > (1 << 20));
+
+  netWorth::TransportConfig config;
+  const Result result = Transfer(snapshot, config, 0.1);
+  REQUIRE(result.complete);
+  CHECK(result.payload == snapshot);
+  CHECK(result.fragments * config.fragment_size < snapshot.size());   // Compression paid off
+
+  std::istringstream is(result.payload);
+  SnapshotWorld copy(1, 1);
+  netWorth::ClientManager manager;
+  copy.DeserializeBinary(is, &manager);
+  CHECK(copy.GetGrid().GetWidth() == 1500);
+  CHECK(copy.GetNumAgents() == 2000);
+}
+
+TEST_CASE("Fragment transport benchmark", "[.][benchmark]"){
+  std::mt19937 rng(4);
+  std::string payload;
+  while (payload.size() < (8 << 20)) payload += "cell " + std::to_string(rng() % 64) + ";";
+  netWorth::TransportConfig config;
+
+  BENCHMARK("Compress 8 MB") { return netWorth::compression::compress(payload).size(); };
+  BENCHMARK("Send 8 MB over a link losing 5% of packets") { return Transfer(payload, config, 0.05).rounds; };
+}
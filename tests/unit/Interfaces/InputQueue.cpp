@@ -0,0 +1,123 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for InputQueue.hpp and ClientInputPoller.hpp in source/Interfaces/NetWorth
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+// Class project
+#include "Interfaces/NetWorth/InputQueue.hpp"
+#include "Interfaces/NetWorth/server/ClientInputPoller.hpp"
+#include "Interfaces/NetWorth/server/ServerManager.hpp"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("InputQueue keeps inputs in order and drops when full", "[networth][input]"){
+  netWorth::InputQueue<size_t, 4> queue;
+  size_t input = 0;
+  CHECK_FALSE(queue.tryPop(input));
+  for (size_t i = 1; i <= 4; ++i) CHECK(queue.push(i));
+  CHECK_FALSE(queue.push(5));
+  CHECK(queue.droppedCount() == 1);
+  CHECK(queue.size() == 4);
+
+  for (size_t i = 1; i <= 4; ++i) {
+    REQUIRE(queue.tryPop(input));
+    CHECK(input == i);
+  }
+  CHECK(queue.push(6));   // Wraps around the ring.
+  REQUIRE(queue.tryPop(input));
+  CHECK(input == 6);
+}
+
+TEST_CASE("InputQueue passes every input from one thread to another", "[networth][input]"){
+  constexpr size_t NUM_INPUTS = 200000;
+  netWorth::InputQueue<size_t, 256> queue;
+
+  std::thread producer([&queue]{
+    for (size_t i = 0; i < NUM_INPUTS; ) {
+      if (queue.push(i)) ++i;
+      else std::this_thread::yield();
+    }
+  });
+
+  size_t expected = 0, input = 0;
+  bool in_order = true;
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (expected < NUM_INPUTS && std::chrono::steady_clock::now() < deadline) {
+    if (!queue.tryPop(input)) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_order = in_order && input == expected;
+    ++expected;
+  }
+  producer.join();
+  CHECK(in_order);
+  CHECK(expected == NUM_INPUTS);
+}
+
+TEST_CASE("ClientInputPoller tracks clients without blocking the tick", "[networth][input]"){
+  netWorth::ClientInputPoller poller(5ms);
+  std::map<size_t, std::vector<size_t>> batch{{9, {1}}};
+  poller.collectInputs(batch);
+  CHECK(batch.empty());   // Cleared even with no clients.
+  CHECK_FALSE(poller.isRunning());
+
+  sf::UdpSocket socket_a, socket_b;
+  poller.addClient(1, socket_a);
+  poller.addClient(2, socket_b);
+  CHECK(poller.isRunning());
+  CHECK_FALSE(socket_a.isBlocking());
+
+  // Silent clients cost the tick nothing; collecting never waits for input.
+  const auto start = std::chrono::steady_clock::now();
+  poller.collectInputs(batch);
+  CHECK(batch.empty());
+  CHECK(std::chrono::steady_clock::now() - start < 2s);
+
+  poller.removeClient(1);
+  poller.removeClient(1);    // Removing twice is harmless.
+  poller.collectInputs(batch);
+  CHECK(batch.empty());
+  poller.stop();
+  CHECK_FALSE(poller.isRunning());
+}
+
+TEST_CASE("ServerManager sleeps until an interface joins", "[networth][input]"){
+  netWorth::ServerManager manager;
+  CHECK_FALSE(manager.waitForAgents(10ms));
+
+  std::thread joiner([&manager]{
+    std::this_thread::sleep_for(20ms);
+    manager.addToInterfaceSet(3);
+  });
+  CHECK(manager.waitForAgents(5s));
+  CHECK(manager.hasAgentsPresent());
+  joiner.join();
+
+  manager.removeInterface(3);
+  CHECK_FALSE(manager.hasAgentsPresent());
+}
+
+TEST_CASE("ServerManager batches the inputs of each tick", "[networth][input]"){
+  CHECK(netWorth::ServerManager::chooseInput({3}) == 3);
+  CHECK(netWorth::ServerManager::chooseInput({1, 4, 2}) == 2);          // Newest wins.
+  CHECK(netWorth::ServerManager::chooseInput({1, 9999, 2}) == 9999);    // Leaving is never lost.
+
+  netWorth::ServerManager manager;
+  sf::UdpSocket socket;
+  manager.addClientSocket(5, socket);
+  manager.collectInputs();
+  size_t action = 0;
+  CHECK_FALSE(manager.takeInput(5, action));   // Nothing arrived this tick.
+  manager.removeClientSocket(5);
+}
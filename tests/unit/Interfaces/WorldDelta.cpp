@@ -0,0 +1,777 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for WorldDelta.hpp and WorldReplicator.hpp in source/Interfaces/NetWorth
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Class project
+#include "core/WorldBase.hpp"
+#include "Interfaces/NetWorth/FragmentTransport.hpp"
+#include "Interfaces/NetWorth/WorldDelta.hpp"
+#include "Interfaces/NetWorth/server/ServerManager.hpp"
+#include "Interfaces/NetWorth/server/WorldReplicator.hpp"
+
+namespace {
+
+  /// World whose agents never act; the tests move them directly.
+  class DeltaWorld : public cse491::WorldBase {
+  public:
+    explicit DeltaWorld(size_t width = 60, size_t height = 30) {
+      AddCellType("floor", "Open ground.", ' ');
+      AddCellType("wall", "A wall.", '#');
+      main_grid.Resize(width, height);
+    }
+    void ConfigAgent(cse491::AgentBase & agent) override {
+      agent.AddAction("up", 1).AddAction("down", 2).AddAction("left", 3).AddAction("right", 4);
+    }
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+  };
+
+  /// One client in the loopback harness: a world, its manager, and acknowledgements in flight.
+  struct LoopbackClient {
+    DeltaWorld world{1, 1};
+    netWorth::ClientManager manager;
+    size_t key = 0;
+    std::deque<uint32_t> acks;    ///< Acknowledgements not yet delivered to the server
+  };
+
+  /// Send a delta through a packet and back, as it would cross the network.
+  size_t Transmit(const netWorth::WorldDelta & delta, netWorth::WorldDelta & received) {
+    sf::Packet sent, wire;
+    delta.toPacket(sent);
+    wire.append(sent.getData(), sent.getDataSize());
+    REQUIRE(received.fromPacket(wire));
+    return sent.getDataSize();
+  }
+
+  /// Move some agents, change some properties and cells, and now and then add or remove an agent.
+  void Step(DeltaWorld & world, std::mt19937 & rng, size_t tick) {
+    auto & grid = world.GetGrid();
+    const auto & agents = world.GetAgentRegistry();
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+      cse491::AgentBase & agent = agents.GetAgent(i);
+      if (rng() % 10 == 0) {
+        const auto pos = agent.GetPosition();
+        agent.SetPosition((pos.CellX() + 1) % grid.GetWidth(), pos.CellY());
+      }
+      if (rng() % 40 == 0) agent.SetProperty("Health", static_cast<int>(rng() % 100));
+    }
+    grid.At(rng() % grid.GetWidth(), rng() % grid.GetHeight()) = rng() % 2;
+    if (tick % 10 == 0) {
+      world.AddAgent<cse491::AgentBase>("Late " + std::to_string(tick)).SetPosition(tick % grid.GetWidth(), 0)
+          .SetProperty("symbol", 'L');
+    }
+    if (tick % 15 == 0) world.RemoveAgent(agents.GetID(rng() % agents.GetNumAgents()));
+  }
+
+  /// @return An empty string if the client's world matches the server's, or the first difference.
+  std::string Difference(DeltaWorld & server, DeltaWorld & client) {
+    if (client.GetNumAgents() != server.GetNumAgents()) return "agent count";
+    const auto & agents = server.GetAgentRegistry();
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+      const size_t id = agents.GetID(i);
+      const cse491::AgentBase & expected = agents.GetAgent(i);
+      if (!client.HasAgent(id)) return "missing agent " + std::to_string(id);
+      const cse491::AgentBase & agent = client.GetAgent(id);
+      if (agent.GetName() != expected.GetName()) return "name of agent " + std::to_string(id);
+      if (agent.GetPosition() != expected.GetPosition()) return "position of agent " + std::to_string(id);
+      if (agent.GetProperty<char>("symbol") != expected.GetProperty<char>("symbol")) return "symbol of agent " + std::to_string(id);
+      if (expected.HasProperty("Health") &&
+          (!agent.HasProperty("Health") || agent.GetProperty<int>("Health") != expected.GetProperty<int>("Health"))) {
+        return "health of agent " + std::to_string(id);
+      }
+    }
+    const auto & grid = server.GetGrid();
+    if (client.GetGrid().GetWidth() != grid.GetWidth() || client.GetGrid().GetHeight() != grid.GetHeight()) return "grid size";
+    for (size_t y = 0; y < grid.GetHeight(); ++y) {
+      for (size_t x = 0; x < grid.GetWidth(); ++x) {
+        if (client.GetGrid().At(x, y) != grid.At(x, y)) return "grid cell";
+      }
+    }
+    return "";
+  }
+
+  /// Move agents a cell at a time and change cells, adding and removing agents now and then;
+  /// the first num_fixed agents are never removed.
+  void Wander(DeltaWorld & world, std::mt19937 & rng, size_t tick, size_t num_fixed) {
+    auto & grid = world.GetGrid();
+    const auto & agents = world.GetAgentRegistry();
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+      if (rng() % 4 != 0) continue;
+      cse491::AgentBase & agent = agents.GetAgent(i);
+      const auto pos = agent.GetPosition();
+      const int dx = static_cast<int>(rng() % 3) - 1, dy = static_cast<int>(rng() % 3) - 1;
+      agent.SetPosition(std::clamp<int>(static_cast<int>(pos.CellX()) + dx, 0, static_cast<int>(grid.GetWidth()) - 1),
+                        std::clamp<int>(static_cast<int>(pos.CellY()) + dy, 0, static_cast<int>(grid.GetHeight()) - 1));
+    }
+    for (int i = 0; i < 5; ++i) grid.At(rng() % grid.GetWidth(), rng() % grid.GetHeight()) = rng() % 2;
+    if (tick % 10 == 0) {
+      world.AddAgent<cse491::AgentBase>("Late " + std::to_string(tick))
+          .SetPosition(rng() % grid.GetWidth(), rng() % grid.GetHeight()).SetProperty("symbol", 'L');
+      const size_t index = num_fixed + rng() % (agents.GetNumAgents() - num_fixed);
+      world.RemoveAgent(agents.GetID(index));
+    }
+  }
+
+  /// @return An empty string if the client has exactly the server's agents and cells in an area,
+  /// or the first difference.
+  std::string AreaDifference(DeltaWorld & server, DeltaWorld & client, const netWorth::InterestArea & area) {
+    const cse491::GridPosition center = server.GetAgent(area.agent_id).GetPosition();
+    const auto & agents = server.GetAgentRegistry();
+    size_t num_visible = 0;
+    for (size_t i = 0; i < agents.GetNumAgents(); ++i) {
+      const size_t id = agents.GetID(i);
+      const cse491::AgentBase & expected = agents.GetAgent(i);
+      const bool visible = area.contains(center, expected.GetPosition());
+      if (visible != client.HasAgent(id)) return (visible ? "missing agent " : "extra agent ") + std::to_string(id);
+      if (!visible) continue;
+      ++num_visible;
+      if (client.GetAgent(id).GetPosition() != expected.GetPosition()) return "position of agent " + std::to_string(id);
+    }
+    if (client.GetNumAgents() != num_visible) return "agent count";
+
+    const auto & grid = server.GetGrid();
+    for (size_t y = 0; y < grid.GetHeight(); ++y) {
+      for (size_t x = 0; x < grid.GetWidth(); ++x) {
+        if (std::abs(x - center.GetX()) > area.half_width || std::abs(y - center.GetY()) > area.half_height) continue;
+        if (client.GetGrid().At(x, y) != grid.At(x, y)) return "grid cell";
+      }
+    }
+    return "";
+  }
+
+  void Populate(DeltaWorld & world, size_t num_agents) {
+    const auto & grid = world.GetGrid();
+    for (size_t i = 0; i < num_agents; ++i) {
+      world.AddAgent<cse491::AgentBase>("Agent " + std::to_string(i))
+          .SetPosition(i % grid.GetWidth(), (i / grid.GetWidth()) % grid.GetHeight())
+          .SetProperty("symbol", static_cast<char>('a' + i % 26));
+    }
+  }
+
+}
+
+TEST_CASE("World deltas round trip through a packet", "[networth][delta]"){
+  netWorth::WorldDelta delta;
+  delta.tick = 300;
+  delta.baseline = 297;
+  delta.cells = {{3, 1}, {4, 0}, {70000, 2}, {70001, 2}, {70002, 2}, {70003, 1}};
+  delta.removed = {2, 9};
+  netWorth::AgentUpdate & moved = delta.agents.emplace_back();
+  moved.field_bits = netWorth::delta::POSITION;
+  moved.agent.id = 5;
+  moved.agent.position = cse491::GridPosition(-3, 12);
+  netWorth::AgentUpdate & added = delta.agents.emplace_back();
+  added.field_bits = netWorth::delta::ALL_FIELDS;
+  added.agent.id = 1000;
+  added.agent.name = "Newcomer";
+  added.agent.position = cse491::GridPosition().MakeInvalid();
+  added.agent.properties = {{"symbol", '@'}, {"Health", -4}, {"Speed", 1.25}, {"Title", std::string("Scout")}};
+
+  netWorth::WorldDelta copy;
+  const size_t bytes = Transmit(delta, copy);
+  CHECK(bytes < 100);
+  CHECK(copy.tick == 300);
+  CHECK(copy.baseline == 297);
+  CHECK_FALSE(copy.full_state);
+  CHECK_FALSE(copy.grid_full);
+  CHECK(copy.cells == delta.cells);
+  CHECK(copy.removed == delta.removed);
+  REQUIRE(copy.agents.size() == 2);
+  CHECK(copy.agents[0].field_bits == netWorth::delta::POSITION);
+  CHECK(copy.agents[0].agent.id == 5);
+  CHECK(copy.agents[0].agent.position == cse491::GridPosition(-3, 12));
+  CHECK(copy.agents[0].agent.name.empty());
+  CHECK(copy.agents[1].agent.id == 1000);
+  CHECK(copy.agents[1].agent.name == "Newcomer");
+  CHECK_FALSE(copy.agents[1].agent.position.IsValid());
+  CHECK(copy.agents[1].agent.properties == added.agent.properties);
+
+  uint32_t tick = 0;
+  sf::Packet ack = netWorth::ackToPacket(300);
+  CHECK(netWorth::packetToAck(ack, tick));
+  CHECK(tick == 300);
+  sf::Packet not_ack;
+  delta.toPacket(not_ack);
+  CHECK_FALSE(netWorth::packetToAck(not_ack, tick));
+}
+
+TEST_CASE("Malformed deltas are rejected without large allocations", "[networth][delta]"){
+  netWorth::WorldDelta delta;
+  const auto header = [](sf::Packet & pkt, uint8_t flags) {
+    pkt << netWorth::delta::WORLD_DELTA;
+    netWorth::delta::writeVarint(pkt, 5);
+    netWorth::delta::writeVarint(pkt, 0);
+    pkt << flags;
+  };
+
+  // A grid whose size overflows, or is far larger than any real world.
+  sf::Packet huge_grid;
+  header(huge_grid, netWorth::delta::GRID_FULL);
+  netWorth::delta::writeVarint(huge_grid, uint64_t(1) << 33);
+  netWorth::delta::writeVarint(huge_grid, uint64_t(1) << 33);
+  netWorth::delta::writeVarint(huge_grid, 0);
+  netWorth::delta::writeVarint(huge_grid, uint64_t(1) << 60);
+  CHECK_FALSE(delta.fromPacket(huge_grid));
+
+  // Counts of agents, removed agents, and string bytes that the packet cannot hold.
+  sf::Packet many_agents;
+  header(many_agents, netWorth::delta::FULL_STATE);
+  netWorth::delta::writeVarint(many_agents, 0);
+  netWorth::delta::writeVarint(many_agents, 0);
+  netWorth::delta::writeVarint(many_agents, uint64_t(1) << 50);
+  CHECK_FALSE(delta.fromPacket(many_agents));
+
+  sf::Packet many_removed;
+  header(many_removed, 0);
+  netWorth::delta::writeVarint(many_removed, 0);
+  netWorth::delta::writeVarint(many_removed, uint64_t(1) << 50);
+  CHECK_FALSE(delta.fromPacket(many_removed));
+
+  sf::Packet long_name;
+  header(long_name, 0);
+  netWorth::delta::writeVarint(long_name, 0);
+  netWorth::delta::writeVarint(long_name, 0);
+  netWorth::delta::writeVarint(long_name, 1);
+  netWorth::delta::writeVarint(long_name, 3);
+  long_name << netWorth::delta::NAME;
+  netWorth::delta::writeVarint(long_name, uint64_t(1) << 40);
+  CHECK_FALSE(delta.fromPacket(long_name));
+
+  // Property values of a type no delta sends.
+  sf::Packet bad_type;
+  header(bad_type, 0);
+  netWorth::delta::writeVarint(bad_type, 0);
+  netWorth::delta::writeVarint(bad_type, 0);
+  netWorth::delta::writeVarint(bad_type, 1);
+  netWorth::delta::writeVarint(bad_type, 3);
+  bad_type << netWorth::delta::PROPERTIES;
+  netWorth::delta::writeVarint(bad_type, 1);
+  netWorth::delta::writeString(bad_type, "Health");
+  bad_type << static_cast<uint8_t>(cse491::PropertyType::t_other);
+  netWorth::delta::writeString(bad_type, "odd");
+  CHECK_FALSE(delta.fromPacket(bad_type));
+
+  // A few bytes may not describe millions of changed cells.
+  sf::Packet many_cells;
+  header(many_cells, 0);
+  netWorth::delta::writeVarint(many_cells, netWorth::delta::MAX_CELLS);
+  netWorth::delta::writeVarint(many_cells, 1);
+  netWorth::delta::writeVarint(many_cells, 0);
+  netWorth::delta::writeVarint(many_cells, netWorth::delta::MAX_CELLS - 2);
+  CHECK_FALSE(delta.fromPacket(many_cells));
+
+  sf::Packet long_run;
+  header(long_run, 0);
+  netWorth::delta::writeVarint(long_run, netWorth::delta::MAX_RUN + 1);
+  netWorth::delta::writeVarint(long_run, 1);
+  netWorth::delta::writeVarint(long_run, 0);
+  netWorth::delta::writeVarint(long_run, netWorth::delta::MAX_RUN - 1);
+  for (int i = 0; i < 100; ++i) long_run << uint8_t(0);
+  CHECK_FALSE(delta.fromPacket(long_run));
+
+  // IDs must increase from one; a step of zero names ID 0 or repeats an ID.
+  for (uint8_t fields : {uint8_t(0), netWorth::delta::NAME}) {
+    sf::Packet zero_agent;
+    header(zero_agent, 0);
+    netWorth::delta::writeVarint(zero_agent, 0);
+    netWorth::delta::writeVarint(zero_agent, 0);
+    netWorth::delta::writeVarint(zero_agent, 1);
+    netWorth::delta::writeVarint(zero_agent, 0);
+    zero_agent << fields;
+    if (fields) netWorth::delta::writeString(zero_agent, "Zero");
+    CHECK_FALSE(delta.fromPacket(zero_agent));
+  }
+
+  sf::Packet repeated_removed;
+  header(repeated_removed, 0);
+  netWorth::delta::writeVarint(repeated_removed, 0);
+  netWorth::delta::writeVarint(repeated_removed, 2);
+  netWorth::delta::writeVarint(repeated_removed, 4);
+  netWorth::delta::writeVarint(repeated_removed, 0);
+  netWorth::delta::writeVarint(repeated_removed, 0);
+  CHECK_FALSE(delta.fromPacket(repeated_removed));
+
+  sf::Packet huge_id;
+  header(huge_id, 0);
+  netWorth::delta::writeVarint(huge_id, 0);
+  netWorth::delta::writeVarint(huge_id, 0);
+  netWorth::delta::writeVarint(huge_id, 1);
+  netWorth::delta::writeVarint(huge_id, netWorth::delta::MAX_ID + 1);
+  huge_id << uint8_t(0);
+  CHECK_FALSE(delta.fromPacket(huge_id));
+
+  // Cells outside the grid are refused before anything changes.
+  DeltaWorld client(10, 10);
+  netWorth::ClientManager manager;
+  netWorth::WorldDelta outside;
+  outside.tick = 1;
+  outside.full_state = true;
+  outside.cells = {{3, 1}, {100, 1}};
+  CHECK_FALSE(client.ApplyWorldDelta(outside, &manager));
+  CHECK(client.GetGrid().At(3, 0) == 0);
+  CHECK(manager.getWorldTick() == 0);
+
+  // So are agents with the reserved ID 0.
+  outside.cells = {{3, 1}};
+  outside.agents.push_back({netWorth::delta::ALL_FIELDS, cse491::SnapshotEntity{}});
+  CHECK_FALSE(client.ApplyWorldDelta(outside, &manager));
+  CHECK(client.GetGrid().At(3, 0) == 0);
+  CHECK(client.GetNumAgents() == 0);
+  outside.agents.clear();
+
+  outside.cells.clear();
+  outside.grid_full = true;
+  outside.grid_width = 4;
+  outside.grid_height = 4;
+  outside.grid_states.assign(15, 1);
+  CHECK_FALSE(client.ApplyWorldDelta(outside, &manager));
+  CHECK(client.GetGrid().GetWidth() == 10);
+  outside.grid_states.push_back(1);
+  CHECK(client.ApplyWorldDelta(outside, &manager));
+  CHECK(client.GetGrid().GetWidth() == 4);
+}
+
+TEST_CASE("Replicator sends only what changed since the acknowledged tick", "[networth][delta]"){
+  DeltaWorld server(20, 10);
+  Populate(server, 10);
+  netWorth::WorldReplicator replicator(4);
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+
+  // Nothing acknowledged yet: everything is sent.
+  netWorth::WorldDelta delta = replicator.buildDelta(1);
+  CHECK(delta.tick == 1);
+  CHECK(delta.full_state);
+  CHECK(delta.grid_full);
+  CHECK(delta.grid_states.size() == 200);
+  CHECK(delta.agents.size() == 10);
+
+  replicator.acknowledge(1, 1);
+  CHECK(replicator.buildDelta(1).agents.empty());
+
+  server.GetAgent(3).SetPosition(7, 7);
+  server.GetAgent(4).SetProperty("Health", 50);
+  server.GetGrid().At(2, 1) = 1;
+  server.GetGrid().At(3, 1) = 0;   // Unchanged; not sent.
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+  server.RemoveAgent(6);
+  server.AddAgent<cse491::AgentBase>("Eleven").SetProperty("symbol", 'E');
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+
+  delta = replicator.buildDelta(1);
+  CHECK(delta.tick == 3);
+  CHECK(delta.baseline == 1);
+  CHECK_FALSE(delta.full_state);
+  CHECK_FALSE(delta.grid_full);
+  CHECK(delta.cells == std::vector<std::pair<size_t, size_t>>{{22, 1}});
+  CHECK(delta.removed == std::vector<size_t>{6});
+  REQUIRE(delta.agents.size() == 3);
+  CHECK(delta.agents[0].agent.id == 3);
+  CHECK(delta.agents[0].field_bits == netWorth::delta::POSITION);
+  CHECK(delta.agents[1].agent.id == 4);
+  CHECK(delta.agents[1].field_bits == netWorth::delta::PROPERTIES);
+  CHECK(delta.agents[2].agent.id == 11);
+  CHECK(delta.agents[2].field_bits == netWorth::delta::ALL_FIELDS);
+
+  // A client that fell further behind than the history reaches gets the full state again.
+  for (int i = 0; i < 4; ++i) replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+  CHECK(replicator.buildDelta(1).full_state);
+  replicator.acknowledge(1, 6);
+  CHECK_FALSE(replicator.buildDelta(1).full_state);
+  replicator.removeClient(1);
+  CHECK(replicator.buildDelta(1).full_state);
+}
+
+TEST_CASE("Clients patch deltas into their worlds in place", "[networth][delta]"){
+  DeltaWorld server;
+  Populate(server, 20);
+  netWorth::WorldReplicator replicator;
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+
+  LoopbackClient client;
+  netWorth::WorldDelta delta;
+  Transmit(replicator.buildDelta(client.key), delta);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(client.manager.getWorldTick() == 1);
+  CHECK(Difference(server, client.world).empty());
+  const cse491::AgentBase * agent5 = &client.world.GetAgent(5);
+
+  // A repeated delta is ignored.
+  CHECK_FALSE(client.world.ApplyWorldDelta(delta, &client.manager));
+
+  replicator.acknowledge(client.key, 1);
+  server.GetAgent(5).SetPosition(1, 2);
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+  Transmit(replicator.buildDelta(client.key), delta);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(Difference(server, client.world).empty());
+  CHECK(&client.world.GetAgent(5) == agent5);     // Moved, not recreated.
+
+  // A delta built on a tick this client never had is skipped.
+  netWorth::WorldDelta future = delta;
+  future.baseline = 5;
+  future.tick = 6;
+  CHECK_FALSE(client.world.ApplyWorldDelta(future, &client.manager));
+}
+
+TEST_CASE("Deltas too large for one datagram cross as fragments", "[networth][delta]"){
+  std::mt19937 rng(16);
+  DeltaWorld server(400, 400);
+  auto & grid = server.GetGrid();
+  for (size_t y = 0; y < grid.GetHeight(); ++y) {
+    for (size_t x = 0; x < grid.GetWidth(); ++x) grid.At(x, y) = rng() % 2;
+  }
+  Populate(server, 30);
+  netWorth::WorldReplicator replicator;
+  replicator.captureTick(server.GetAgentRegistry(), grid);
+
+  // Fragment a delta as ServerManager does, and join it back up as ClientManager does.
+  const auto send_fragmented = [](const netWorth::WorldDelta & delta, netWorth::WorldDelta & received) {
+    sf::Packet pkt;
+    delta.toPacket(pkt);
+    REQUIRE(pkt.getDataSize() > sf::UdpSocket::MaxDatagramSize);
+    CHECK_FALSE(netWorth::isFragment(pkt));
+    netWorth::TransportConfig config;
+    netWorth::FragmentSender sender(7, std::string_view(static_cast<const char *>(pkt.getData()), pkt.getDataSize()), config);
+    netWorth::FragmentReceiver receiver(config);
+    std::vector<sf::Packet> burst;
+    for (size_t round = 0; !sender.isComplete() && round < 1000; ++round) {
+      sender.nextBurst(burst);
+      for (auto & fragment : burst) {
+        CHECK(fragment.getDataSize() <= config.fragment_size + netWorth::transport::HEADER_SIZE);
+        REQUIRE(netWorth::isFragment(fragment));
+        bool status_due = false;
+        REQUIRE(receiver.handleFragment(fragment, status_due));
+      }
+      sf::Packet status = receiver.statusPacket();
+      CHECK(sender.handleStatus(status));
+    }
+    std::string payload;
+    REQUIRE(receiver.takePayload(payload));
+    sf::Packet joined;
+    joined.append(payload.data(), payload.size());
+    REQUIRE(received.fromPacket(joined));
+  };
+
+  LoopbackClient client;
+  netWorth::WorldDelta delta;
+  send_fragmented(replicator.buildDelta(client.key), delta);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(Difference(server, client.world).empty());
+
+  // Once acknowledged, the following deltas fit in one datagram again.
+  replicator.acknowledge(client.key, 1);
+  server.GetAgent(2).SetPosition(5, 5);
+  grid.At(9, 9) = 1 - grid.At(9, 9);
+  replicator.captureTick(server.GetAgentRegistry(), grid);
+  CHECK(Transmit(replicator.buildDelta(client.key), delta) < 100);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(Difference(server, client.world).empty());
+
+  // A grid made larger is sent whole, in fragments again.
+  replicator.acknowledge(client.key, 2);
+  grid.Resize(500, 450);
+  for (size_t y = 0; y < grid.GetHeight(); ++y) {
+    for (size_t x = 0; x < grid.GetWidth(); ++x) grid.At(x, y) = rng() % 2;
+  }
+  replicator.captureTick(server.GetAgentRegistry(), grid);
+  send_fragmented(replicator.buildDelta(client.key), delta);
+  CHECK(delta.baseline == 2);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(Difference(server, client.world).empty());
+}
+
+TEST_CASE("The server sends large deltas a burst per tick without waiting on clients", "[networth][delta]"){
+  using namespace std::chrono_literals;
+  std::mt19937 rng(17);
+  DeltaWorld server(400, 400);
+  auto & grid = server.GetGrid();
+  for (size_t y = 0; y < grid.GetHeight(); ++y) {
+    for (size_t x = 0; x < grid.GetWidth(); ++x) grid.At(x, y) = rng() % 2;
+  }
+  Populate(server, 30);
+
+  netWorth::TransportConfig transport;
+  transport.status_timeout = 20ms;
+  transport.max_silent = 3;
+  transport.deadline = 10s;
+  netWorth::ServerManager server_manager(transport);
+
+  // One client that never answers, and one that receives and acknowledges on its own thread.
+  sf::UdpSocket silent;
+  REQUIRE(silent.bind(0) == sf::Socket::Status::Done);
+  server_manager.addToUpdatePairs(sf::IpAddress::LocalHost, silent.getLocalPort());
+
+  LoopbackClient client;
+  sf::UdpSocket client_socket;
+  client.manager.setUpdatePort(0);
+  client.manager.setupGameUpdateSocket(&client_socket);
+  server_manager.addToUpdatePairs(sf::IpAddress::LocalHost, client_socket.getLocalPort());
+
+  std::atomic<bool> applied = false, stop = false;
+  std::thread receiver([&]() {
+    netWorth::WorldDelta delta;
+    while (!stop) {
+      if (!client.manager.receiveWorldDelta(delta)) { std::this_thread::sleep_for(1ms); continue; }
+      if (client.world.ApplyWorldDelta(delta, &client.manager)) applied = true;
+      client.manager.acknowledgeTick();
+    }
+  });
+
+  // No tick waits for a whole transfer, even with a client that never answers.
+  auto longest_tick = 0ms;
+  const auto start = std::chrono::steady_clock::now();
+  while ((!applied || server_manager.getNumUpdateClients() > 1) && std::chrono::steady_clock::now() - start < 20s) {
+    const auto tick_start = std::chrono::steady_clock::now();
+    server_manager.replicateWorld(server.GetAgentRegistry(), grid);
+    longest_tick = std::max(longest_tick,
+                            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tick_start));
+    std::this_thread::sleep_for(5ms);
+  }
+  stop = true;
+  receiver.join();
+
+  CHECK(applied);
+  CHECK(server_manager.getNumUpdateClients() == 1);   // The silent client was dropped.
+  CHECK(longest_tick < 1s);
+  CHECK(Difference(server, client.world).empty());
+}
+
+TEST_CASE("Loopback harness keeps 32 clients in step with the server", "[networth][delta]"){
+  constexpr size_t NUM_CLIENTS = 32;
+  constexpr size_t NUM_TICKS = 120;
+  std::mt19937 rng(491);
+
+  DeltaWorld server;
+  Populate(server, 50);
+  netWorth::WorldReplicator replicator(16);
+
+  std::vector<std::unique_ptr<LoopbackClient>> clients;
+  for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+    clients.push_back(std::make_unique<LoopbackClient>());
+    clients.back()->key = i + 1;
+  }
+
+  size_t delta_bytes = 0, delta_count = 0, full_bytes = 0;
+  for (size_t tick = 1; tick <= NUM_TICKS; ++tick) {
+    if (tick > 1) Step(server, rng, tick);
+    replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+    const bool lossless = tick + 5 > NUM_TICKS;   // Let every client catch up at the end.
+
+    for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+      LoopbackClient & client = *clients[i];
+      netWorth::WorldDelta delta;
+      const size_t bytes = Transmit(replicator.buildDelta(client.key), delta);
+      if (delta.full_state) full_bytes = bytes;
+      else { delta_bytes += bytes; ++delta_count; }
+
+      // Odd clients lose some deltas; a few lose acknowledgements or send them late.
+      if (!lossless && i % 2 == 1 && (tick + i) % 7 == 0) continue;
+      client.world.ApplyWorldDelta(delta, &client.manager);
+      if (client.manager.getWorldTick() == tick) {
+        INFO("client " << i << " at tick " << tick);
+        REQUIRE(Difference(server, client.world) == "");
+      }
+
+      client.acks.push_back(client.manager.getWorldTick());
+      const size_t lag = (i % 4 == 2 && !lossless) ? 3 : 0;
+      while (client.acks.size() > lag) {
+        sf::Packet ack = netWorth::ackToPacket(client.acks.front());
+        uint32_t acked = 0;
+        if (netWorth::packetToAck(ack, acked) && !(i % 8 == 4 && tick % 5 == 0)) {
+          replicator.acknowledge(client.key, acked);
+        }
+        client.acks.pop_front();
+      }
+    }
+  }
+
+  for (const auto & client : clients) {
+    CHECK(client->manager.getWorldTick() == NUM_TICKS);
+    CHECK(Difference(server, client->world) == "");
+  }
+
+  REQUIRE(delta_count > 0);
+  const size_t bytes_per_delta = delta_bytes / delta_count;
+  WARN(NUM_CLIENTS << " clients, " << server.GetNumAgents() << " agents: " << bytes_per_delta
+       << " bytes per client per tick (" << bytes_per_delta * NUM_CLIENTS << " bytes/tick) vs "
+       << full_bytes << " bytes for a full state");
+  CHECK(bytes_per_delta * 10 < full_bytes);
+}
+
+TEST_CASE("Interest areas are rectangles or circles", "[networth][delta]"){
+  const cse491::GridPosition center(10, 10);
+  const auto box = netWorth::InterestArea::rectangle(1, 10, 4);
+  CHECK(box.contains(center, {15, 12}));
+  CHECK_FALSE(box.contains(center, {16, 10}));
+  CHECK_FALSE(box.contains(center, {10, 13}));
+  CHECK_FALSE(box.contains(center, cse491::GridPosition().MakeInvalid()));
+
+  const auto circle = netWorth::InterestArea::radius(1, 5);
+  CHECK(circle.contains(center, {13, 14}));
+  CHECK_FALSE(circle.contains(center, {14, 14}));
+}
+
+TEST_CASE("Clients with an area of interest are sent only what is near them", "[networth][delta]"){
+  constexpr size_t NUM_CLIENTS = 8;
+  constexpr size_t NUM_TICKS = 150;
+  std::mt19937 rng(17);
+
+  DeltaWorld server(160, 120);
+  for (size_t i = 0; i < 600; ++i) {
+    server.AddAgent<cse491::AgentBase>("Agent " + std::to_string(i))
+        .SetPosition(rng() % 160, rng() % 120).SetProperty("symbol", 'a');
+  }
+  netWorth::WorldReplicator replicator(16);
+
+  std::vector<std::unique_ptr<LoopbackClient>> clients;
+  std::vector<netWorth::InterestArea> areas;
+  for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+    clients.push_back(std::make_unique<LoopbackClient>());
+    clients.back()->key = i + 1;
+    const size_t followed = server.GetAgentRegistry().GetID(i);
+    areas.push_back(i % 2 ? netWorth::InterestArea::radius(followed, 12) : netWorth::InterestArea::rectangle(followed, 49, 21));
+    replicator.setInterest(i + 1, areas.back());
+    CHECK(replicator.hasInterest(i + 1));
+  }
+
+  size_t area_bytes = 0, area_count = 0;
+  for (size_t tick = 1; tick <= NUM_TICKS; ++tick) {
+    if (tick > 1) Wander(server, rng, tick, NUM_CLIENTS);
+    replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+    const bool lossless = tick + 5 > NUM_TICKS;
+
+    for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+      LoopbackClient & client = *clients[i];
+      netWorth::WorldDelta delta;
+      const size_t bytes = Transmit(replicator.buildDelta(client.key), delta);
+      if (!delta.grid_full) { area_bytes += bytes; ++area_count; }
+
+      if (!lossless && i % 2 == 1 && (tick + i) % 7 == 0) continue;
+      client.world.ApplyWorldDelta(delta, &client.manager);
+      if (client.manager.getWorldTick() == tick) {
+        INFO("client " << i << " at tick " << tick);
+        REQUIRE(AreaDifference(server, client.world, areas[i]) == "");
+      }
+      if (!(i % 4 == 2 && tick % 3 == 0) || lossless) replicator.acknowledge(client.key, client.manager.getWorldTick());
+    }
+  }
+
+  for (size_t i = 0; i < NUM_CLIENTS; ++i) {
+    CHECK(clients[i]->manager.getWorldTick() == NUM_TICKS);
+    CHECK(AreaDifference(server, clients[i]->world, areas[i]) == "");
+    CHECK(clients[i]->world.GetNumAgents() < server.GetNumAgents() / 4);
+  }
+
+  // Without an area, the same world costs far more per client.
+  sf::Packet everything, nearby;
+  replicator.buildDelta(NUM_CLIENTS + 1).toPacket(everything);
+  replicator.setInterest(NUM_CLIENTS + 2, areas[0]);
+  replicator.buildDelta(NUM_CLIENTS + 2).toPacket(nearby);
+  WARN("Full state: " << everything.getDataSize() << " bytes for the whole world, " << nearby.getDataSize()
+       << " bytes for one area; " << area_bytes / area_count << " bytes per area delta");
+  CHECK(nearby.getDataSize() * 5 < everything.getDataSize());
+
+  // Dropping the area sends the whole world again.
+  replicator.clearInterest(1);
+  CHECK_FALSE(replicator.hasInterest(1));
+  netWorth::WorldDelta delta = replicator.buildDelta(1);
+  CHECK(delta.full_state);
+  CHECK(delta.grid_full);
+  CHECK(delta.agents.size() == server.GetNumAgents());
+}
+
+TEST_CASE("A replaced grid sends a client with an area only the regions near it", "[networth][delta]"){
+  std::mt19937 rng(20);
+  DeltaWorld server(200, 200);
+  auto & grid = server.GetGrid();
+  const auto randomize = [&rng, &grid]() {
+    for (size_t y = 0; y < grid.GetHeight(); ++y) {
+      for (size_t x = 0; x < grid.GetWidth(); ++x) grid.At(x, y) = rng() % 2;
+    }
+  };
+  randomize();
+  server.AddAgent<cse491::AgentBase>("Player").SetPosition(100, 100).SetProperty("symbol", '@');
+  const auto area = netWorth::InterestArea::radius(1, 10);
+  netWorth::WorldReplicator replicator;
+  replicator.setInterest(1, area);
+
+  // The client has never seen the grid: it is sent the grid's size and the regions around it.
+  LoopbackClient client;
+  netWorth::WorldDelta delta;
+  replicator.captureTick(server.GetAgentRegistry(), grid);
+  Transmit(replicator.buildDelta(1), delta);
+  CHECK_FALSE(delta.grid_full);
+  CHECK(delta.grid_resized);
+  CHECK(delta.cells.size() <= 9 * netWorth::WorldReplicator::REGION_SIZE * netWorth::WorldReplicator::REGION_SIZE);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(client.world.GetGrid().GetWidth() == 200);
+  CHECK(AreaDifference(server, client.world, area) == "");
+  replicator.acknowledge(1, 1);
+
+  // Replacing the grid after a baseline does the same.
+  grid.Resize(300, 250);
+  randomize();
+  replicator.captureTick(server.GetAgentRegistry(), grid);
+  Transmit(replicator.buildDelta(1), delta);
+  CHECK(delta.baseline == 1);
+  CHECK_FALSE(delta.grid_full);
+  CHECK(delta.grid_resized);
+  CHECK(delta.cells.size() <= 9 * netWorth::WorldReplicator::REGION_SIZE * netWorth::WorldReplicator::REGION_SIZE);
+  REQUIRE(client.world.ApplyWorldDelta(delta, &client.manager));
+  CHECK(client.world.GetGrid().GetWidth() == 300);
+  CHECK(client.world.GetGrid().GetHeight() == 250);
+  CHECK(client.world.GetGrid().At(0, 0) == 0);   // Far away, so unknown
+  CHECK(AreaDifference(server, client.world, area) == "");
+}
+
+TEST_CASE("World delta benchmark", "[.][benchmark]"){
+  constexpr size_t NUM_CLIENTS = 32;
+  std::mt19937 rng(491);
+  DeltaWorld server(200, 200);
+  Populate(server, 2000);
+  netWorth::WorldReplicator replicator;
+
+  std::vector<size_t> keys(NUM_CLIENTS);
+  for (size_t i = 0; i < NUM_CLIENTS; ++i) keys[i] = i + 1;
+  size_t tick = 1;
+  replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+  for (size_t key : keys) replicator.acknowledge(key, 1);
+
+  std::ostringstream text;
+  server.SerializeAgentSet(text);
+  sf::Packet full;
+  replicator.buildDelta(NUM_CLIENTS + 1).toPacket(full);
+
+  size_t total = 0, ticks = 0;
+  BENCHMARK("Capture a tick and build 32 deltas") {
+    Step(server, rng, ++tick);
+    const uint32_t now = replicator.captureTick(server.GetAgentRegistry(), server.GetGrid());
+    for (size_t key : keys) {
+      sf::Packet pkt;
+      replicator.buildDelta(key).toPacket(pkt);
+      total += pkt.getDataSize();
+      replicator.acknowledge(key, now);
+    }
+    ++ticks;
+    return total;
+  };
+  WARN("2000 agents, 32 clients: " << total / ticks << " bytes/tick in deltas; the text agent set was "
+       << text.str().size() << " bytes per client (" << text.str().size() * NUM_CLIENTS
+       << " bytes/tick), a full binary state " << full.getDataSize() << " bytes");
+}
@@ -0,0 +1,117 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for BiomeGenerator.hpp and the row noise in PerlinNoise.hpp in source/Worlds
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Class project
+#include "Worlds/BiomeGenerator.hpp"
+#include "Worlds/PerlinNoise.hpp"
+
+namespace {
+
+  /// Are two values the same bits?  (Stricter than ==, which lets -0.0 match 0.0.)
+  template <typename T>
+  bool SameBits(T a, T b) {
+    return std::memcmp(&a, &b, sizeof(T)) == 0;
+  }
+
+  /// Coordinates spread over several lattice cells either side of zero.
+  template <typename T>
+  std::vector<T> RandomCoordinates(size_t count, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<T> dist(-300, 300);
+    std::vector<T> xs(count);
+    for (T & x : xs) x = dist(gen);
+    return xs;
+  }
+
+}
+
+TEST_CASE("Row noise matches noise2D exactly", "[World][Perlin]"){
+  const siv::PerlinNoise noise(491);
+  // Long enough for the vector path, and not a multiple of its width.
+  const auto xs = RandomCoordinates<double>(1027, 1);
+  std::vector<double> out(xs.size());
+  for (double y : {0.0, 0.5, -7.25, 123.456, 255.99, 1000.1}) {
+    noise.noise2DRow(xs.data(), y, out.data(), xs.size());
+    size_t mismatches = 0;
+    for (size_t i = 0; i < xs.size(); ++i) mismatches += !SameBits(out[i], noise.noise2D(xs[i], y));
+    CHECK(mismatches == 0);
+  }
+
+  // Short rows and lattice points
+  std::vector<double> lattice{0, 1, 2, 3, 255, 256, -1, -256};
+  noise.noise2DRow(lattice.data(), 3.0, out.data(), lattice.size());
+  for (size_t i = 0; i < lattice.size(); ++i) CHECK(SameBits(out[i], noise.noise2D(lattice[i], 3.0)));
+}
+
+TEST_CASE("Row noise matches for float and octaves", "[World][Perlin]"){
+  const siv::BasicPerlinNoise<float> float_noise(7);
+  const auto float_xs = RandomCoordinates<float>(600, 2);
+  std::vector<float> float_out(float_xs.size());
+  float_noise.noise2DRow(float_xs.data(), 4.5f, float_out.data(), float_xs.size());
+  for (size_t i = 0; i < float_xs.size(); ++i) CHECK(SameBits(float_out[i], float_noise.noise2D(float_xs[i], 4.5f)));
+
+  const siv::PerlinNoise noise(8);
+  // Longer than one chunk of octave2DRow.
+  const auto xs = RandomCoordinates<double>(2500, 3);
+  std::vector<double> out(xs.size());
+  for (int octaves : {1, 3, 8}) {
+    noise.octave2DRow(xs.data(), -2.75, out.data(), xs.size(), octaves, 0.6);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < xs.size(); ++i) mismatches += !SameBits(out[i], noise.octave2D(xs[i], -2.75, octaves, 0.6));
+    CHECK(mismatches == 0);
+  }
+}
+
+TEST_CASE("Banded generation matches the scalar path", "[World][BiomeGenerator]"){
+  for (int octaves : {1, 4}) {
+    BiomeGenerator scalar(BiomeType::Maze, 300, 260, 17);
+    scalar.setOctaves(octaves);
+    scalar.fillNoiseScalar();
+
+    for (unsigned int threads : {1u, 2u, 3u, 8u}) {
+      BiomeGenerator banded(BiomeType::Maze, 300, 260, 17);
+      banded.setOctaves(octaves);
+      banded.fillNoise(threads);
+      CHECK(banded.getGrid() == scalar.getGrid());
+    }
+  }
+
+  // Both tiles appear, in the expected places
+  BiomeGenerator generator(BiomeType::Grasslands, 100, 50, 5);
+  generator.fillNoise(4);
+  size_t mountains = 0;
+  for (char tile : generator.getGrid()) {
+    CHECK((tile == 'M' || tile == '~'));
+    mountains += tile == 'M';
+  }
+  CHECK(mountains > 0);
+  CHECK(mountains < generator.getGrid().size());
+  CHECK(generator.getTile(99, 49) == generator.getGrid().back());
+}
+
+TEST_CASE("BiomeGenerator benchmark", "[.][benchmark][World][BiomeGenerator]"){
+  constexpr unsigned int SIZE = 8192;
+  BiomeGenerator generator(BiomeType::Maze, SIZE, SIZE, 491);
+  const unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+  BENCHMARK("Scalar 8192x8192") { generator.fillNoiseScalar(); return generator.getTile(0, 0); };
+  BENCHMARK("Row noise, 1 thread, 8192x8192") { generator.fillNoise(1); return generator.getTile(0, 0); };
+  BENCHMARK("Row noise, " + std::to_string(threads) + " threads, 8192x8192") {
+    generator.fillNoise(threads);
+    return generator.getTile(0, 0);
+  };
+}
@@ -0,0 +1,179 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for AgentRegistry.hpp in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <memory>
+#include <vector>
+
+// Class project
+#include "core/AgentRegistry.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+
+  /// Agent that always picks action 1.
+  class StepAgent : public cse491::AgentBase {
+  public:
+    StepAgent(size_t id, const std::string & name) : AgentBase(id, name) { }
+    size_t SelectAction(const cse491::WorldGrid &, const cse491::type_options_t &,
+                        const cse491::item_map_t &, const cse491::agent_map_t &) override { return 1; }
+  };
+
+  /// World where every action steps the agent back and forth along its row, recording who moved.
+  class StepWorld : public cse491::WorldBase {
+  public:
+    std::vector<size_t> order;
+    bool record = false;
+
+    int DoAction(cse491::AgentBase & agent, size_t) override {
+      if (record) order.push_back(agent.GetID());
+      const auto pos = agent.GetPosition();
+      const double step = (static_cast<int>(pos.GetX()) % 2 == 0) ? 1.0 : -1.0;
+      agent.SetPosition(pos.GetX() + step, pos.GetY());
+      return 1;
+    }
+  };
+
+}
+
+TEST_CASE("AgentRegistry Add and Remove", "[core][registry]"){
+  cse491::AgentRegistry registry;
+  cse491::AgentBase agent3(3, "Three"), agent1(1, "One"), agent7(7, "Seven");
+  agent1.SetPosition(1, 1);
+  agent7.SetPosition(7, 7);
+
+  registry.Add(agent3);
+  registry.Add(agent7);
+  registry.Add(agent1);   // Out of order; should still end up first.
+  REQUIRE(registry.GetNumAgents() == 3);
+  CHECK(registry.GetID(0) == 1);
+  CHECK(registry.GetID(1) == 3);
+  CHECK(registry.GetID(2) == 7);
+  CHECK(&registry.GetAgent(0) == &agent1);
+  CHECK(registry.GetPosition(2) == cse491::GridPosition{7, 7});
+  CHECK(registry.GetGridID(0) == 0);
+
+  CHECK(registry.Has(3));
+  CHECK_FALSE(registry.Has(2));
+  CHECK_FALSE(registry.Has(1000));
+  CHECK(registry.Find(7) == &agent7);
+  CHECK(registry.Find(5) == nullptr);
+
+  registry.SetPosition(registry.IndexOf(3), {4, 5});
+  CHECK(registry.GetPosition(registry.IndexOf(3)) == cse491::GridPosition{4, 5});
+
+  registry.Remove(3);
+  CHECK_FALSE(registry.Has(3));
+  REQUIRE(registry.GetNumAgents() == 2);
+  CHECK(registry.IndexOf(7) == 1);
+  CHECK(registry.Find(7) == &agent7);
+  registry.Remove(3);   // Removing again does nothing.
+  CHECK(registry.GetNumAgents() == 2);
+
+  registry.Clear();
+  CHECK(registry.GetNumAgents() == 0);
+  CHECK_FALSE(registry.Has(1));
+}
+
+TEST_CASE("AgentRegistry removes many agents at once", "[core][registry]"){
+  cse491::AgentRegistry registry;
+  std::vector<std::unique_ptr<cse491::AgentBase>> agents;
+  for (size_t id = 1; id <= 10; ++id) {
+    agents.push_back(std::make_unique<cse491::AgentBase>(id, "Agent"));
+    agents.back()->SetPosition(static_cast<double>(id), 0);
+    registry.Add(*agents.back());
+  }
+  cse491::AgentBase far(size_t(1) << 40, "Far");
+  registry.Add(far);
+
+  // Unknown and repeated IDs are ignored.
+  registry.RemoveAll(std::vector<size_t>{8, 2, 3, 2, 50, size_t(1) << 40});
+  REQUIRE(registry.GetNumAgents() == 7);
+  const std::vector<size_t> expected{1, 4, 5, 6, 7, 9, 10};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    CHECK(registry.GetID(i) == expected[i]);
+    CHECK(registry.IndexOf(expected[i]) == i);
+    CHECK(registry.GetPosition(i) == cse491::GridPosition(static_cast<double>(expected[i]), 0));
+  }
+  CHECK_FALSE(registry.Has(2));
+  CHECK_FALSE(registry.Has(8));
+  CHECK_FALSE(registry.Has(size_t(1) << 40));
+  CHECK(registry.Find(9) == agents[8].get());
+
+  registry.RemoveAll(std::vector<size_t>{});
+  CHECK(registry.GetNumAgents() == 7);
+}
+
+TEST_CASE("AgentRegistry handles IDs far above the agent count", "[core][registry]"){
+  cse491::AgentRegistry registry;
+  // A huge ID (e.g., from a bad network packet) must not size the table by itself.
+  cse491::AgentBase huge(size_t(1) << 50, "Huge"), far(5000, "Far");
+  registry.Add(huge);
+  registry.Add(far);
+  CHECK(registry.Find(size_t(1) << 50) == &huge);
+  CHECK(registry.Find(5000) == &far);
+  CHECK_FALSE(registry.Has(4999));
+
+  // Once there are enough agents, smaller IDs move into the table and stay findable.
+  std::vector<std::unique_ptr<cse491::AgentBase>> agents;
+  for (size_t id = 1; id < 5000; ++id) {
+    agents.push_back(std::make_unique<cse491::AgentBase>(id, "Agent"));
+    registry.Add(*agents.back());
+  }
+  REQUIRE(registry.GetNumAgents() == 5001);
+  CHECK(registry.Find(5000) == &far);
+  CHECK(registry.IndexOf(5000) == 4999);
+  CHECK(registry.IndexOf(size_t(1) << 50) == 5000);
+  CHECK(registry.Find(1000) == agents[999].get());
+
+  registry.Remove(5000);
+  CHECK_FALSE(registry.Has(5000));
+  CHECK(registry.IndexOf(size_t(1) << 50) == 4999);
+  registry.Remove(size_t(1) << 50);
+  CHECK_FALSE(registry.Has(size_t(1) << 50));
+  CHECK(registry.GetNumAgents() == 4999);
+}
+
+TEST_CASE("AgentRegistry in WorldBase", "[core][registry]"){
+  StepWorld world;
+  std::vector<size_t> ids;
+  for (int i = 0; i < 10; ++i) ids.push_back(world.AddAgent<StepAgent>("Stepper").SetPosition(2 * i, i).GetID());
+
+  world.RemoveAgent(ids[4]);
+  CHECK_FALSE(world.HasAgent(ids[4]));
+  CHECK(world.GetNumAgents() == 9);
+  CHECK(world.GetAgent(ids[5]).GetPosition() == cse491::GridPosition{10, 5});
+
+  // Agents take turns in order of ID.
+  world.record = true;
+  world.RunAgents();
+  std::vector<size_t> expected = ids;
+  expected.erase(expected.begin() + 4);
+  CHECK(world.order == expected);
+
+  // Queries see where agents moved to.
+  CHECK(world.FindAgentsAt({11, 5}) == std::vector<size_t>{ids[5]});
+  CHECK(world.FindAgentsAt({10, 5}).empty());
+  CHECK(world.FindAgentsAt({9, 4}).empty());
+  CHECK(world.FindAgentsNear({11, 5}, 2.5) == std::vector<size_t>{ids[5], ids[6]});
+  CHECK(world.FindAgentsNear({0, 0}, 100).size() == 9);
+
+  world.Reset();
+  CHECK(world.GetNumAgents() == 0);
+  CHECK_FALSE(world.HasAgent(ids[0]));
+}
+
+TEST_CASE("RunAgents 50k agents benchmark", "[.][benchmark]"){
+  StepWorld world;
+  for (int i = 0; i < 50000; ++i) world.AddAgent<StepAgent>("Stepper").SetPosition(2 * (i % 300), i / 300);
+
+  BENCHMARK("RunAgents, 50000 agents") {
+    world.RunAgents();
+  };
+}
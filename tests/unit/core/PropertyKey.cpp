@@ -0,0 +1,145 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for PropertyKey.hpp and entity properties in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <memory>
+#include <sstream>
+#include <string>
+
+// Class project
+#include "core/PropertyKey.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+
+  const cse491::PropertyKey<int> STRENGTH_KEY{"Strength"};
+  const cse491::PropertyKey<bool> BATTLING_KEY{"Battling"};
+
+  /// World whose actions are all property updates, as in a battle.
+  class BattleWorld : public cse491::WorldBase {
+  public:
+    bool use_keys = true;
+
+    int DoAction(cse491::AgentBase & agent, size_t) override {
+      if (use_keys) {
+        const int strength = agent.GetProperty(STRENGTH_KEY);
+        agent.SetProperty(cse491::AgentBase::HEALTH_KEY, agent.GetProperty(cse491::AgentBase::HEALTH_KEY) - 1);
+        if (agent.GetProperty(cse491::AgentBase::HEALTH_KEY) <= 0) {
+          agent.SetProperty(cse491::AgentBase::HEALTH_KEY, agent.GetProperty(cse491::AgentBase::MAX_HEALTH_KEY));
+        }
+        agent.SetProperty(BATTLING_KEY, !agent.GetProperty(BATTLING_KEY));
+        agent.SetProperty(STRENGTH_KEY, strength);
+      } else {
+        const int strength = agent.GetProperty<int>("Strength");
+        agent.SetProperty<int>("Health", agent.GetProperty<int>("Health") - 1);
+        if (agent.GetProperty<int>("Health") <= 0) {
+          agent.SetProperty<int>("Health", agent.GetProperty<int>("Max_Health"));
+        }
+        agent.SetProperty<bool>("Battling", !agent.GetProperty<bool>("Battling"));
+        agent.SetProperty<int>("Strength", strength);
+      }
+      agent.UpdateAgentState(agent);
+      return 1;
+    }
+  };
+
+}
+
+TEST_CASE("PropertyRegistry", "[core][property]"){
+  size_t id = cse491::PropertyRegistry::Intern("Test_Registry_Name");
+  CHECK(cse491::PropertyRegistry::Intern("Test_Registry_Name") == id);
+  CHECK(cse491::PropertyRegistry::Find("Test_Registry_Name") == id);
+  CHECK(cse491::PropertyRegistry::GetName(id) == "Test_Registry_Name");
+  CHECK(cse491::PropertyRegistry::Find("Test_Never_Used") == cse491::PropertyRegistry::npos);
+
+  cse491::PropertyKey<double> key("Test_Registry_Name");
+  CHECK(key.GetID() == id);
+  CHECK(key.GetName() == "Test_Registry_Name");
+}
+
+TEST_CASE("Entity properties by key and name", "[core][property]"){
+  cse491::AgentBase agent(1, "Agent");
+  CHECK(agent.GetNumProperties() == 0);
+  CHECK_FALSE(agent.HasProperty(STRENGTH_KEY));
+  CHECK_FALSE(agent.HasProperty("Strength"));
+
+  // Keys and names reach the same property.
+  agent.SetProperty(STRENGTH_KEY, 5);
+  CHECK(agent.HasProperty("Strength"));
+  CHECK(agent.GetProperty<int>("Strength") == 5);
+  agent.SetProperty("Strength", 7);
+  CHECK(agent.GetProperty(STRENGTH_KEY) == 7);
+  CHECK(agent.GetPropertyType("Strength") == cse491::PropertyType::t_int);
+
+  // Values too big to store inline work the same way.
+  agent.SetProperties("Title", std::string("Sir"), "Speed", 1.5, "Symbol", '@');
+  CHECK(agent.GetProperty<std::string>("Title") == "Sir");
+  CHECK(agent.GetProperty("Speed") == 1.5);
+  CHECK(agent.GetProperty<char>("Symbol") == '@');
+  auto shared = std::make_shared<int>(3);
+  agent.SetProperty("Shared", shared);
+  CHECK(shared.use_count() == 2);
+  CHECK(*agent.GetProperty<std::shared_ptr<int>>("Shared") == 3);
+
+  CHECK(agent.GetPropertyNames() == std::vector<std::string>{"Strength", "Title", "Speed", "Symbol", "Shared"});
+
+  agent.RemoveProperty("Shared");
+  CHECK(shared.use_count() == 1);
+  agent.RemoveProperty(STRENGTH_KEY);
+  CHECK_FALSE(agent.HasProperty(STRENGTH_KEY));
+  agent.RemoveProperty("Never_Set");
+  CHECK(agent.GetPropertyNames() == std::vector<std::string>{"Title", "Speed", "Symbol"});
+}
+
+TEST_CASE("Agent state from health keys", "[core][property]"){
+  cse491::AgentBase agent(1, "Agent");
+  agent.SetProperties("Health", 10, "Max_Health", 20);
+  agent.UpdateAgentState(agent);
+  CHECK(agent.GetAgentState() == cse491::Healthy);
+  agent.SetProperty(cse491::AgentBase::HEALTH_KEY, 2);
+  agent.UpdateAgentState(agent);
+  CHECK(agent.GetAgentState() == cse491::Dying);
+  agent.SetProperty("Health", 0);
+  agent.UpdateAgentState(agent);
+  CHECK(agent.GetAgentState() == cse491::Deceased);
+}
+
+TEST_CASE("Item property serialization", "[core][property]"){
+  cse491::ItemBase item(1, "Sword");
+  item.SetProperties("Strength", 4, "Weight", 2.5, "Symbol", 's', "Owner", std::string("Nobody"));
+
+  std::stringstream ss;
+  item.Serialize(ss);
+  cse491::ItemBase copy(2, "");
+  copy.Deserialize(ss);
+  CHECK(copy.GetName() == "Sword");
+  CHECK(copy.GetPropertyNames() == item.GetPropertyNames());
+  CHECK(copy.GetProperty(STRENGTH_KEY) == 4);
+  CHECK(copy.GetProperty("Weight") == 2.5);
+  CHECK(copy.GetProperty<char>("Symbol") == 's');
+  CHECK(copy.GetProperty<std::string>("Owner") == "Nobody");
+}
+
+TEST_CASE("Property DoAction benchmark", "[.][benchmark]"){
+  BattleWorld world;
+  for (int i = 0; i < 100; ++i) {
+    world.AddAgent<cse491::AgentBase>("Fighter", "Strength", 5, "Health", i + 1, "Max_Health", 100,
+                                      "Direction", 0, "Battling", false, "Taking_Damage", false);
+  }
+
+  world.use_keys = false;
+  BENCHMARK("RunAgents, 100 agents, properties by name") {
+    world.RunAgents();
+  };
+
+  world.use_keys = true;
+  BENCHMARK("RunAgents, 100 agents, properties by key") {
+    world.RunAgents();
+  };
+}
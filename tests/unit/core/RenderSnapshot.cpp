@@ -0,0 +1,301 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for RenderSnapshot.hpp in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Class project
+#include "core/RenderSnapshot.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+
+  using namespace std::chrono_literals;
+
+  /// Floor, wall, and water cells.
+  cse491::type_options_t MakeTypes() {
+    return {cse491::CellType{"floor", "", ' '}, cse491::CellType{"wall", "", '#'},
+            cse491::CellType{"water", "", '~'}};
+  }
+
+  /// Check that a snapshot's cells match a grid exactly.
+  bool CellsMatch(const cse491::RenderSnapshot & snapshot, const cse491::WorldGrid & grid,
+                  const cse491::type_options_t & types) {
+    if (snapshot.width != grid.GetWidth() || snapshot.height != grid.GetHeight()) return false;
+    for (size_t y = 0; y < grid.GetHeight(); ++y) {
+      for (size_t x = 0; x < grid.GetWidth(); ++x) {
+        if (snapshot.cells[y * grid.GetWidth() + x] != types[grid.At(x, y)].symbol) return false;
+      }
+    }
+    return true;
+  }
+
+  /// World on a small open grid whose agents never act.
+  class SmallWorld : public cse491::WorldBase {
+  public:
+    SmallWorld() {
+      AddCellType("floor", "Open ground.", ' ');
+      AddCellType("wall", "Blocks movement.", '#');
+      main_grid.Resize(12, 8, 1);
+    }
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+    cse491::WorldGrid & Grid() { return main_grid; }
+  };
+
+}
+
+TEST_CASE("Nothing is read before the first publish", "[core][render]"){
+  cse491::RenderSnapshotBuffer buffer;
+  CHECK_FALSE(buffer.Acquire());
+  CHECK(buffer.Read().tick == 0);
+  CHECK(buffer.Read().cells.empty());
+}
+
+TEST_CASE("Acquire takes the newest snapshot once", "[core][render]"){
+  const auto types = MakeTypes();
+  cse491::WorldGrid grid(5, 4);
+  cse491::item_map_t items;
+  cse491::agent_map_t agents;
+  cse491::RenderSnapshotBuffer buffer;
+
+  grid.At(1, 1) = 1;
+  buffer.Publish(grid, types, items, agents, nullptr);
+  REQUIRE(buffer.Acquire());
+  CHECK(buffer.Read().tick == 1);
+  CHECK(CellsMatch(buffer.Read(), grid, types));
+  CHECK_FALSE(buffer.Acquire());
+  CHECK(buffer.Read().tick == 1);
+
+  // Snapshots the reader never saw are skipped, not queued.
+  for (size_t i = 0; i < 5; ++i) {
+    grid.At(i, 3) = 2;
+    buffer.Publish(grid, types, items, agents, nullptr);
+  }
+  REQUIRE(buffer.Acquire());
+  CHECK(buffer.Read().tick == 6);
+  CHECK(CellsMatch(buffer.Read(), grid, types));
+  CHECK_FALSE(buffer.Acquire());
+  CHECK(buffer.GetPublishCount() == 6);
+}
+
+TEST_CASE("Snapshots patched from changed cells match the grid", "[core][render]"){
+  const auto types = MakeTypes();
+  cse491::WorldGrid grid(20, 10);
+  cse491::item_map_t items;
+  cse491::agent_map_t agents;
+  cse491::RenderSnapshotBuffer buffer;
+  grid.TrackChanges();
+  buffer.Publish(grid, types, items, agents, nullptr);
+
+  std::vector<size_t> changes;
+  for (size_t tick = 0; tick < 40; ++tick) {
+    grid.At((tick * 7) % 20, (tick * 3) % 10) = tick % 3;
+    grid.At(tick % 20, tick % 10) = (tick + 1) % 3;
+    REQUIRE(grid.TakeChangedCells(changes));
+    buffer.Publish(grid, types, items, agents, &changes);
+    // Read only now and then, so slots fall several ticks behind before they are refilled.
+    if (tick % 5 == 0 && buffer.Acquire()) {
+      CHECK(CellsMatch(buffer.Read(), grid, types));
+    }
+  }
+
+  // A slot more ticks behind than the history holds is copied in full.
+  for (size_t tick = 0; tick < cse491::RenderSnapshotBuffer::HISTORY_SIZE + 3; ++tick) {
+    grid.At(tick, 0) = 1;
+    REQUIRE(grid.TakeChangedCells(changes));
+    buffer.Publish(grid, types, items, agents, &changes);
+  }
+  REQUIRE(buffer.Acquire());
+  CHECK(CellsMatch(buffer.Read(), grid, types));
+
+  // So is one that missed a replaced grid.
+  grid.Resize(6, 3);
+  buffer.Publish(grid, types, items, agents, nullptr);
+  REQUIRE(buffer.Acquire());
+  CHECK(buffer.Read().width == 6);
+  CHECK(CellsMatch(buffer.Read(), grid, types));
+}
+
+TEST_CASE("Entities carry their previous position", "[core][render]"){
+  const auto types = MakeTypes();
+  cse491::WorldGrid grid(10, 10);
+  cse491::item_map_t items;
+  cse491::agent_map_t agents;
+  cse491::RenderSnapshotBuffer buffer(1);
+
+  agents[1] = std::make_unique<cse491::AgentBase>(1, "Player");
+  agents[1]->SetPosition(2, 3).SetProperty("symbol", '@');
+  agents[2] = std::make_unique<cse491::AgentBase>(2, "Other");
+  agents[2]->SetPosition(5, 0);
+  // An item may share an ID with an agent; they are tracked separately.
+  items[1] = std::make_unique<cse491::ItemBase>(1, "Gem");
+  items[1]->SetPosition(2, 3);
+  items[3] = std::make_unique<cse491::ItemBase>(3, "Carried");
+  items[3]->SetOwner(*agents[2]);
+
+  buffer.Publish(grid, types, items, agents, nullptr);
+  REQUIRE(buffer.Acquire());
+  const cse491::RenderSnapshot & first = buffer.Read();
+  REQUIRE(first.entities.size() == 3);
+  // Sorted by cell: (5, 0), then the item and the agent at (2, 3).
+  CHECK(first.entities[0].id == 2);
+  CHECK(first.entities[1].to == first.entities[2].to);
+  REQUIRE(first.has_focus);
+  CHECK(first.focus.symbol == '@');
+  CHECK(first.focus.from == first.focus.to);
+
+  agents[1]->SetPosition(3, 3);
+  agents[2]->SetPosition(5, 1);
+  buffer.Publish(grid, types, items, agents, nullptr);
+  REQUIRE(buffer.Acquire());
+  const cse491::RenderSnapshot & second = buffer.Read();
+  REQUIRE(second.has_focus);
+  CHECK(second.focus.from == cse491::GridPosition(2, 3));
+  CHECK(second.focus.to == cse491::GridPosition(3, 3));
+  CHECK(second.focus.Interpolate(0.5) == cse491::GridPosition(2.5, 3));
+
+  // Within a cell the item comes first, so the agent is drawn over it.
+  size_t seen = 0;
+  std::vector<char> row_three;
+  second.ForEachEntityInCells(0, 3, 9, 3, [&](const cse491::RenderEntity & entity) {
+    ++seen;
+    row_three.push_back(entity.is_agent ? 'a' : 'i');
+  });
+  CHECK(seen == 2);
+  CHECK(row_three == std::vector<char>{'i', 'a'});
+  seen = 0;
+  second.ForEachEntityInCells(0, 0, 9, 1, [&](const cse491::RenderEntity & entity) {
+    ++seen;
+    CHECK(entity.id == 2);
+    CHECK(entity.from == cse491::GridPosition(5, 0));
+    CHECK(entity.symbol == '*');
+  });
+  CHECK(seen == 1);
+}
+
+TEST_CASE("Entity lookups visit only the cells asked for", "[core][render]"){
+  const auto types = MakeTypes();
+  cse491::WorldGrid grid(100, 100);
+  cse491::item_map_t items;
+  cse491::agent_map_t agents;
+  cse491::RenderSnapshotBuffer buffer;
+
+  // One agent on every tenth cell of every tenth row.
+  size_t id = 1;
+  for (size_t y = 0; y < 100; y += 10) {
+    for (size_t x = 0; x < 100; x += 10, ++id) {
+      agents[id] = std::make_unique<cse491::AgentBase>(id, "Agent");
+      agents[id]->SetPosition(x, y);
+    }
+  }
+  buffer.Publish(grid, types, items, agents, nullptr);
+  REQUIRE(buffer.Acquire());
+  const cse491::RenderSnapshot & snapshot = buffer.Read();
+
+  std::vector<std::pair<size_t, size_t>> found;
+  const auto collect = [&found](const cse491::RenderEntity & entity) {
+    found.emplace_back(entity.to.CellX(), entity.to.CellY());
+  };
+  snapshot.ForEachEntityInCells(15, 5, 30, 20, collect);
+  CHECK(found == std::vector<std::pair<size_t, size_t>>{{20, 10}, {30, 10}, {20, 20}, {30, 20}});
+
+  found.clear();
+  snapshot.ForEachEntityInCells(91, 0, 99, 99, collect);   // Between columns
+  CHECK(found.empty());
+  snapshot.ForEachEntityInCells(0, 95, 99, 99, collect);   // Past the last row
+  CHECK(found.empty());
+  snapshot.ForEachEntityInCells(90, 90, SIZE_MAX, SIZE_MAX, collect);
+  CHECK(found == std::vector<std::pair<size_t, size_t>>{{90, 90}});
+}
+
+TEST_CASE("Progress moves from the previous snapshot to this one", "[core][render]"){
+  cse491::RenderSnapshot snapshot;
+  const auto now = cse491::RenderSnapshot::clock_t::now();
+  snapshot.time = now;
+  snapshot.interval = 100ms;
+  CHECK(snapshot.Progress(now, 1s) == 0.0);
+  CHECK(std::abs(snapshot.Progress(now + 50ms, 1s) - 0.5) < 1e-9);
+  CHECK(snapshot.Progress(now + 200ms, 1s) == 1.0);
+  // A long wait between ticks (e.g., for the player) still moves quickly.
+  snapshot.interval = 5s;
+  CHECK(std::abs(snapshot.Progress(now + 75ms, 150ms) - 0.5) < 1e-9);
+  snapshot.interval = 0ms;
+  CHECK(snapshot.Progress(now, 1s) == 1.0);
+}
+
+TEST_CASE("Worlds publish to each live buffer", "[core][render]"){
+  SmallWorld world;
+  auto buffer = std::make_shared<cse491::RenderSnapshotBuffer>();
+  world.AddRenderSnapshots(buffer);
+  world.PublishRenderSnapshots();
+  REQUIRE(buffer->Acquire());
+  CHECK(buffer->Read().width == 12);
+
+  world.Grid().At(4, 4) = 2;
+  world.PublishRenderSnapshots();
+  REQUIRE(buffer->Acquire());
+  CHECK(buffer->Read().cells[4 * 12 + 4] == '#');
+
+  // Dropped buffers are forgotten.
+  buffer.reset();
+  CHECK_NOTHROW(world.PublishRenderSnapshots());
+}
+
+TEST_CASE("Readers on another thread never see a half-written snapshot", "[core][render]"){
+  const auto types = MakeTypes();
+  cse491::WorldGrid grid(64, 64);
+  cse491::item_map_t items;
+  cse491::agent_map_t agents;
+  agents[1] = std::make_unique<cse491::AgentBase>(1, "Runner");
+  cse491::RenderSnapshotBuffer buffer;
+
+  constexpr size_t NUM_TICKS = 2000;
+  std::atomic<bool> done = false;
+  size_t num_read = 0;
+  size_t num_torn = 0;
+  std::thread reader([&]() {
+    size_t last_tick = 0;
+    while (true) {
+      const bool finished = done;
+      if (!buffer.Acquire()) {
+        if (finished) break;
+        continue;
+      }
+      const cse491::RenderSnapshot & snapshot = buffer.Read();
+      // Every tick writes its own state everywhere and moves the runner to its own row.
+      const char expected = types[snapshot.tick % 3].symbol;
+      bool torn = snapshot.tick <= last_tick || snapshot.entities.size() != 1 ||
+                  snapshot.entities[0].to.CellY() != snapshot.tick % 64;
+      for (char cell : snapshot.cells) torn |= cell != expected;
+      num_torn += torn;
+      last_tick = snapshot.tick;
+      ++num_read;
+    }
+  });
+
+  for (size_t tick = 1; tick <= NUM_TICKS; ++tick) {
+    for (size_t y = 0; y < 64; ++y) {
+      for (size_t x = 0; x < 64; ++x) grid.At(x, y) = tick % 3;
+    }
+    agents[1]->SetPosition(0, tick % 64);
+    buffer.Publish(grid, types, items, agents, nullptr);
+  }
+  done = true;
+  reader.join();
+
+  CHECK(num_read > 0);
+  CHECK(num_torn == 0);
+  CHECK(buffer.Read().tick == NUM_TICKS);
+}
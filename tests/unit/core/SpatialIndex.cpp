@@ -0,0 +1,244 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for SpatialIndex.hpp in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// Class project
+#include "core/SpatialIndex.hpp"
+#include "core/WorldBase.hpp"
+
+namespace {
+
+  /// Collect (and sort) all IDs a query reports, to make comparisons simple.
+  std::vector<size_t> CollectAt(const cse491::SpatialIndex & index, cse491::GridPosition pos) {
+    std::vector<size_t> ids;
+    index.ForEachAt(pos, [&ids](size_t id){ ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  std::vector<size_t> CollectNear(const cse491::SpatialIndex & index, cse491::GridPosition pos, double dist) {
+    std::vector<size_t> ids;
+    index.ForEachNear(pos, dist, [&ids](size_t id){ ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  std::vector<size_t> CollectInRect(const cse491::SpatialIndex & index, cse491::GridPosition min_pos,
+                                    cse491::GridPosition max_pos) {
+    std::vector<size_t> ids;
+    index.ForEachInRect(min_pos, max_pos, [&ids](size_t id){ ids.push_back(id); });
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  /// Minimal world so that WorldBase queries can be tested directly.
+  class TestWorld : public cse491::WorldBase {
+  public:
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+
+    /// The original linear-scan versions of the queries, kept here for comparison.
+    std::vector<size_t> ScanAgentsAt(cse491::GridPosition pos) const {
+      std::vector<size_t> ids;
+      for (const auto & [id, agent_ptr] : agent_map) {
+        if (agent_ptr->IsOnGrid(0) && agent_ptr->GetPosition() == pos) ids.push_back(id);
+      }
+      return ids;
+    }
+    std::vector<size_t> ScanAgentsNear(cse491::GridPosition pos, double dist) const {
+      std::vector<size_t> ids;
+      for (const auto & [id, agent_ptr] : agent_map) {
+        if (agent_ptr->IsOnGrid(0) && agent_ptr->GetPosition().IsNear(pos, dist)) ids.push_back(id);
+      }
+      return ids;
+    }
+  };
+
+  /// Fill a world with agents scattered over a square region.
+  void Populate(TestWorld & world, size_t num_agents, double side, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> coord(0, static_cast<int>(side) - 1);
+    for (size_t i = 0; i < num_agents; ++i) {
+      world.AddAgent<cse491::AgentBase>("Agent").SetPosition(coord(gen), coord(gen));
+    }
+  }
+
+}
+
+TEST_CASE("SpatialIndex Update and Remove", "[core][spatial]"){
+  cse491::SpatialIndex index;
+  CHECK(index.GetNumEntities() == 0);
+  CHECK(index.GetNumBuckets() == 0);
+
+  index.Update(1, {2, 3});
+  index.Update(2, {2, 3});
+  index.Update(3, {5, 5});
+  CHECK(index.GetNumEntities() == 3);
+  CHECK(index.GetNumBuckets() == 2);
+  CHECK(index.Has(1));
+  CHECK(!index.Has(4));
+  CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{1, 2});
+  CHECK(CollectAt(index, {5, 5}) == std::vector<size_t>{3});
+  CHECK(CollectAt(index, {0, 0}).empty());
+
+  SECTION("Moving an entity"){
+    index.Update(1, {5, 5});
+    CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{2});
+    CHECK(CollectAt(index, {5, 5}) == std::vector<size_t>{1, 3});
+    CHECK(index.GetNumEntities() == 3);
+  }
+  SECTION("Removing an entity"){
+    index.Remove(2);
+    index.Remove(2);   // Removing twice is harmless.
+    CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{1});
+    index.Remove(1);
+    CHECK(CollectAt(index, {2, 3}).empty());
+    CHECK(index.GetNumBuckets() == 1);
+  }
+  SECTION("Invalid positions remove an entity"){
+    cse491::GridPosition pos(5, 5);
+    pos.MakeInvalid();
+    index.Update(3, pos);
+    CHECK(!index.Has(3));
+    CHECK(CollectAt(index, {5, 5}).empty());
+  }
+  SECTION("Clearing"){
+    index.Clear();
+    CHECK(index.GetNumEntities() == 0);
+    CHECK(index.GetNumBuckets() == 0);
+  }
+}
+
+TEST_CASE("SpatialIndex handles IDs far above the entity count", "[core][spatial]"){
+  cse491::SpatialIndex index;
+  // A huge ID (e.g., from a bad network packet) must not size the table by itself.
+  const size_t huge = size_t(1) << 50;
+  index.Update(huge, {2, 3});
+  index.Update(5000, {2, 3});
+  index.Update(1, {5, 5});
+  CHECK(index.GetNumEntities() == 3);
+  CHECK(index.Has(huge));
+  CHECK(index.Has(5000));
+  CHECK(!index.Has(huge + 1));
+  CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{5000, huge});
+
+  index.Update(huge, {5, 5});
+  CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{5000});
+  CHECK(CollectAt(index, {5, 5}) == std::vector<size_t>{1, huge});
+
+  // Far IDs are still found once many small IDs fill the table.
+  for (size_t id = 2; id < 1300; ++id) index.Update(id, {9, 9});
+  CHECK(index.Has(5000));
+  CHECK(CollectAt(index, {2, 3}) == std::vector<size_t>{5000});
+
+  index.Remove(huge);
+  index.Remove(huge);   // Removing twice is harmless.
+  index.Remove(5000);
+  CHECK(!index.Has(huge));
+  CHECK(!index.Has(5000));
+  CHECK(CollectAt(index, {2, 3}).empty());
+  CHECK(CollectAt(index, {5, 5}) == std::vector<size_t>{1});
+  CHECK(index.GetNumEntities() == 1299);
+}
+
+TEST_CASE("SpatialIndex neighborhood queries", "[core][spatial]"){
+  cse491::SpatialIndex index(4.0);
+  CHECK(index.GetBucketSize() == 4.0);
+  index.Update(1, {0, 0});
+  index.Update(2, {3, 3});     // Same bucket as 1.
+  index.Update(3, {-1, -1});   // Negative coordinates get their own bucket.
+  index.Update(4, {20, 20});
+
+  // At-queries return everything in the bucket, which callers then filter.
+  CHECK(CollectAt(index, {1, 1}) == std::vector<size_t>{1, 2});
+  CHECK(CollectAt(index, {-3, -2}) == std::vector<size_t>{3});
+
+  // Near-queries must include every entity within the distance.
+  CHECK(CollectNear(index, {0, 0}, 1.0) == std::vector<size_t>{1, 2, 3});
+  CHECK(CollectNear(index, {20, 20}, 0.0) == std::vector<size_t>{4});
+  CHECK(CollectNear(index, {10, 10}, 12.0) == std::vector<size_t>{1, 2, 3, 4});
+
+  // Rectangle queries visit only the buckets the rectangle overlaps.
+  CHECK(CollectInRect(index, {0, 0}, {3.5, 3.5}) == std::vector<size_t>{1, 2});
+  CHECK(CollectInRect(index, {-2, -2}, {21, 21}) == std::vector<size_t>{1, 2, 3, 4});
+  CHECK(CollectInRect(index, {5, 5}, {15, 15}).empty());
+
+  // Radii too large to count saturate rather than overflow.
+  CHECK(index.CountBucketsNear(1.0) == 4);
+  CHECK(index.CountBucketsNear(1e300) == SIZE_MAX);
+  CHECK(index.CountBucketsNear(std::numeric_limits<double>::infinity()) == SIZE_MAX);
+  CHECK(index.CountBucketsNear(std::numeric_limits<double>::quiet_NaN()) == SIZE_MAX);
+}
+
+TEST_CASE("WorldBase position queries track entities", "[core][spatial][world]"){
+  TestWorld world;
+  auto & agent1 = world.AddAgent<cse491::AgentBase>("Agent1");
+  auto & agent2 = world.AddAgent<cse491::AgentBase>("Agent2");
+  agent1.SetPosition(2, 2);
+  agent2.SetPosition(cse491::GridPosition(2, 3));
+
+  CHECK(world.FindAgentsAt({2, 2}) == std::vector<size_t>{agent1.GetID()});
+  CHECK(world.FindAgentsNear({2, 2}, 1.0) == std::vector<size_t>{agent1.GetID(), agent2.GetID()});
+
+  agent1.SetPosition(7, 7);
+  CHECK(world.FindAgentsAt({2, 2}).empty());
+  CHECK(world.FindAgentsAt({7, 7}) == std::vector<size_t>{agent1.GetID()});
+
+  world.RemoveAgent(agent2.GetID());
+  CHECK(world.FindAgentsNear({2, 2}, 1.0).empty());
+
+  SECTION("Items on the grid and in inventories"){
+    auto & item = world.AddItem<cse491::ItemBase>("Item");
+    world.AddItemToGrid(item.GetID(), {4, 4});
+    CHECK(world.FindItemsAt({4, 4}) == std::vector<size_t>{item.GetID()});
+    CHECK(world.FindItemsNear({5, 5}, 2.0) == std::vector<size_t>{item.GetID()});
+    CHECK(world.FindItemsAt({4, 4}, 1).empty());   // Wrong grid.
+
+    auto & agent = world.GetAgent(agent1.GetID());
+    agent.AddItem(item.GetID());
+    CHECK(world.FindItemsAt({4, 4}).empty());
+    CHECK(world.FindItemsNear({5, 5}, 2.0).empty());
+  }
+
+  SECTION("Results match the linear scan"){
+    Populate(world, 500, 40.0, 17);
+    for (double x = 0; x < 40; x += 3) {
+      for (double y = 0; y < 40; y += 5) {
+        CHECK(world.FindAgentsAt({x, y}) == world.ScanAgentsAt({x, y}));
+        CHECK(world.FindAgentsNear({x, y}, 2.5) == world.ScanAgentsNear({x, y}, 2.5));
+      }
+    }
+    // Large radii fall back to scanning, but must give the same answer.
+    CHECK(world.FindAgentsNear({20, 20}, 100.0) == world.ScanAgentsNear({20, 20}, 100.0));
+    const double inf = std::numeric_limits<double>::infinity();
+    CHECK(world.FindAgentsNear({20, 20}, inf) == world.ScanAgentsNear({20, 20}, inf));
+  }
+}
+
+TEST_CASE("SpatialIndex benchmark", "[.][benchmark][core][spatial]"){
+  for (size_t num_agents : {1000, 10000, 100000}) {
+    TestWorld world;
+    const double side = std::sqrt(static_cast<double>(num_agents)) * 2.0;  // ~1 agent per 4 cells
+    Populate(world, num_agents, side, 42);
+    const cse491::GridPosition center(side / 2.0, side / 2.0);
+    const std::string suffix = " (" + std::to_string(num_agents) + " agents)";
+
+    BENCHMARK("Indexed FindAgentsAt" + suffix) { return world.FindAgentsAt(center); };
+    BENCHMARK("Linear scan FindAgentsAt" + suffix) { return world.ScanAgentsAt(center); };
+    BENCHMARK("Indexed FindAgentsNear" + suffix) { return world.FindAgentsNear(center, 3.0); };
+    BENCHMARK("Linear scan FindAgentsNear" + suffix) { return world.ScanAgentsNear(center, 3.0); };
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for TickScheduler.hpp in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// Class project
+#include "core/TickScheduler.hpp"
+
+using namespace std::chrono_literals;
+using cse491::TickScheduler;
+
+TEST_CASE("TickScheduler configuration", "[core][tick]"){
+  TickScheduler scheduler(20.0);
+  CHECK(scheduler.GetPeriod() == 50ms);
+  CHECK(std::abs(scheduler.GetRate() - 20.0) < 1e-9);
+  scheduler.SetRate(100.0).SetCatchUp(TickScheduler::CatchUp::Skip);
+  CHECK(scheduler.GetPeriod() == 10ms);
+  CHECK(scheduler.GetCatchUp() == TickScheduler::CatchUp::Skip);
+}
+
+TEST_CASE("TickScheduler runs ticks on a fixed schedule", "[core][tick]"){
+  const TickScheduler::clock_t::time_point t0{};
+  TickScheduler scheduler(10.0);   // One tick every 100ms.
+  scheduler.Start(t0);
+
+  CHECK(scheduler.TicksDue(t0) == 1);
+  CHECK(scheduler.GetNextTickTime() == t0 + 100ms);
+  CHECK(scheduler.TicksDue(t0 + 50ms) == 0);
+  CHECK(scheduler.TicksDue(t0 + 130ms) == 1);
+  // The schedule keeps its phase, rather than drifting by how late a tick ran.
+  CHECK(scheduler.GetNextTickTime() == t0 + 200ms);
+  CHECK(scheduler.GetSkippedCount() == 0);
+}
+
+TEST_CASE("TickScheduler catch-up policies", "[core][tick]"){
+  const TickScheduler::clock_t::time_point t0{};
+
+  SECTION("Burst runs missed ticks back to back, up to a limit") {
+    TickScheduler scheduler(10.0, TickScheduler::CatchUp::Burst, 3);
+    scheduler.Start(t0);
+    CHECK(scheduler.TicksDue(t0 + 250ms) == 3);   // Ticks at 0, 100, and 200ms.
+    CHECK(scheduler.GetSkippedCount() == 0);
+    CHECK(scheduler.GetNextTickTime() == t0 + 300ms);
+
+    CHECK(scheduler.TicksDue(t0 + 1050ms) == 3);  // Eight owed; five are dropped.
+    CHECK(scheduler.GetSkippedCount() == 5);
+    CHECK(scheduler.GetNextTickTime() == t0 + 1100ms);
+  }
+
+  SECTION("Skip runs one tick and drops the rest") {
+    TickScheduler scheduler(10.0, TickScheduler::CatchUp::Skip);
+    scheduler.Start(t0);
+    CHECK(scheduler.TicksDue(t0 + 250ms) == 1);
+    CHECK(scheduler.GetSkippedCount() == 2);
+    CHECK(scheduler.GetNextTickTime() == t0 + 300ms);
+  }
+}
+
+TEST_CASE("TickScheduler overruns and percentiles", "[core][tick]"){
+  TickScheduler scheduler(100.0, TickScheduler::CatchUp::Burst, 5, 100);   // 10ms period.
+  for (int i = 1; i <= 100; ++i) scheduler.RecordTick(std::chrono::microseconds(100 * i));
+  scheduler.RecordTick(20ms);    // Replaces the oldest sample.
+
+  const auto stats = scheduler.GetStats();
+  CHECK(stats.ticks == 101);
+  CHECK(stats.overruns == 1);
+  CHECK(stats.max == 20ms);
+  CHECK(stats.p50 == 5200us);
+  CHECK(stats.p90 == 9200us);
+  CHECK(stats.p99 == 20ms);
+  CHECK(scheduler.GetPercentile(0.0) == 200us);
+
+  scheduler.ResetStats();
+  CHECK(scheduler.GetTickCount() == 0);
+  CHECK(scheduler.GetPercentile(0.5) == 0ns);
+}
+
+TEST_CASE("TickScheduler paces a loop", "[core][tick]"){
+  TickScheduler scheduler(200.0);   // 5ms period.
+  size_t ticks = 0;
+  const auto start = TickScheduler::clock_t::now();
+  scheduler.Run([&ticks]{ ++ticks; }, [&ticks]{ return ticks == 20; });
+  const auto elapsed = TickScheduler::clock_t::now() - start;
+
+  CHECK(scheduler.GetTickCount() == 20);
+  CHECK(elapsed >= 95ms);           // The 20th tick is due 95ms after the first.
+  CHECK(elapsed < 2s);
+
+  // A tick that takes three periods is followed by the ticks it held up.
+  ticks = 0;
+  size_t slow_ticks = 0;
+  scheduler.ResetStats();
+  scheduler.Run([&]{
+    if (++ticks == 2) { std::this_thread::sleep_for(15ms); ++slow_ticks; }
+  }, [&ticks]{ return ticks == 10; });
+  CHECK(slow_ticks == 1);
+  CHECK(scheduler.GetOverrunCount() >= 1);
+  CHECK(scheduler.GetPercentile(1.0) >= 15ms);
+}
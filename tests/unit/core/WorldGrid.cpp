@@ -7,7 +7,15 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch_all.hpp>
 
+// Std
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
 // Class project
+#include "core/WorldBase.hpp"
 #include "core/WorldGrid.hpp"
 
 TEST_CASE("WorldGrid Construction", "[core][grid]"){
@@ -47,3 +55,244 @@ TEST_CASE("WorldGrid Resize", "[core][grid]"){
     CHECK(grid.GetNumCells() == 100);
   }
 }
+
+TEST_CASE("WorldGrid Cell Flags", "[core][grid]"){
+  cse491::type_options_t types;
+  types.push_back(cse491::CellType{"floor", "", ' '});
+  types.push_back(cse491::CellType{"wall", "", '#'});
+  types.push_back(cse491::CellType{"water", "", '~'});
+  types[1].SetProperty(cse491::CellType::CELL_WALL);
+  types[2].SetProperty(cse491::CellType::CELL_WATER);
+
+  cse491::WorldGrid grid(4, 3);
+  CHECK(!grid.HasCellTypes());
+  grid.SetCellTypes(types);
+  CHECK(grid.HasCellTypes());
+  grid.At(1, 1) = 1;
+  grid.At(2, 2) = 2;
+
+  CHECK(grid.GetFlags(0, 0) == cse491::CellType::FLAG_WALKABLE);
+  CHECK(grid.GetFlags(1, 1) == cse491::CellType::FLAG_WALL);
+  CHECK(grid.HasFlags({2, 2}, cse491::CellType::FLAG_WATER | cse491::CellType::FLAG_WALKABLE));
+
+  SECTION("Writes through At() update flags"){
+    grid.At(1, 1) = 0;
+    grid[cse491::GridPosition(3, 0)] = 1;
+    CHECK(grid.GetFlags(1, 1) == cse491::CellType::FLAG_WALKABLE);
+    CHECK(grid.GetFlags(3, 0) == cse491::CellType::FLAG_WALL);
+  }
+  SECTION("Changing cell types updates flags"){
+    types[0].SetProperty(cse491::CellType::CELL_WALL);
+    grid.SetCellTypes(types);
+    CHECK(grid.GetFlags(0, 0) == cse491::CellType::FLAG_WALL);
+  }
+  SECTION("Resizing updates flags"){
+    grid.Resize(5, 5, 1);
+    CHECK(grid.GetFlags(4, 4) == cse491::CellType::FLAG_WALL);
+    CHECK(grid.GetFlags(1, 1) == cse491::CellType::FLAG_WALL);
+    CHECK(grid.GetFlags(0, 0) == cse491::CellType::FLAG_WALKABLE);
+  }
+  SECTION("Many writes between lookups"){
+    for (size_t x = 0; x < 4; ++x) {
+      for (size_t y = 0; y < 3; ++y) grid.At(x, y) = 1;
+    }
+    for (size_t x = 0; x < 4; ++x) {
+      for (size_t y = 0; y < 3; ++y) CHECK(grid.GetFlags(x, y) == cse491::CellType::FLAG_WALL);
+    }
+  }
+}
+
+TEST_CASE("WorldGrid cell widths", "[core][grid]"){
+  cse491::WorldGrid grid(3, 2);
+  CHECK(grid.GetCellBytes() == 1);
+  CHECK(grid.MaxState() == 255);
+  grid.At(2, 1) = 200;
+
+  grid.SetCellBytes(sizeof(size_t));
+  CHECK(grid.At(2, 1) == 200);
+  grid.SetCellBytes(1);
+  CHECK(grid.GetCellBytes() == 1);
+  CHECK(grid.At(2, 1) == 200);
+  CHECK(grid.At(0, 0) == 0);
+
+  grid.At(1, 1) = 60000;          // Widens automatically.
+  CHECK(grid.GetCellBytes() == 2);
+  CHECK(grid.At(1, 1) == 60000);
+  CHECK(grid.At(2, 1) == 200);
+
+  grid.Resize(4, 2, 70000);   // Default state too large for two bytes.
+  CHECK(grid.GetCellBytes() == sizeof(size_t));
+  CHECK(grid.At(3, 0) == 70000);
+  CHECK(grid.At(1, 1) == 60000);
+
+  grid.ReserveStates(100);        // Already wide enough; nothing changes.
+  CHECK(grid.GetCellBytes() == sizeof(size_t));
+  CHECK(cse491::WorldGrid(2, 2, 300).GetCellBytes() == 2);
+
+  CHECK(cse491::WorldGrid::CellBytesFor(19) == 1);
+  CHECK(cse491::WorldGrid::CellBytesFor(256) == 2);
+  CHECK(cse491::WorldGrid::CellBytesFor(65536) == sizeof(size_t));
+}
+
+TEST_CASE("WorldGrid cells widen as a world adds cell types", "[core][grid]"){
+  class TypeWorld : public cse491::WorldBase {
+  public:
+    using WorldBase::AddCellType;
+    TypeWorld() { main_grid.Resize(3, 3); }
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+  } world;
+
+  CHECK(world.GetGrid().GetCellBytes() == 1);
+  for (size_t i = world.GetCellTypes().size(); i <= 256; ++i) world.AddCellType("type " + std::to_string(i));
+  CHECK(world.GetGrid().GetCellBytes() == 2);
+  world.GetGrid().At(1, 1) = 256;
+  CHECK(world.GetGrid().At(1, 1) == 256);
+
+  std::stringstream ss;
+  world.GetGrid().Serialize(ss);
+  cse491::WorldGrid copy;
+  copy.Deserialize(ss);
+  CHECK(copy.GetCellBytes() == 2);
+  CHECK(copy.At(1, 1) == 256);
+}
+
+TEST_CASE("WorldGrid change tracking", "[core][grid]"){
+  cse491::WorldGrid grid(10, 5, 0);
+  std::vector<size_t> changed;
+  grid.At(1, 1) = 1;                   // Not tracked yet.
+  grid.TrackChanges();
+  CHECK(grid.TakeChangedCells(changed));
+  CHECK(changed.empty());
+
+  grid.At(4, 2) = 3;
+  grid.At(0, 0) = 2;
+  grid.At(4, 2) = 1;                   // Listed once.
+  grid.At(1, 1) = 1;                   // Same state; not a change.
+  CHECK(grid.TakeChangedCells(changed));
+  CHECK(changed == std::vector<size_t>{0, 24});
+  CHECK(grid.TakeChangedCells(changed));
+  CHECK(changed.empty());
+
+  grid.At(2, 0) = 300;                 // Widening the cells keeps the record.
+  CHECK(grid.TakeChangedCells(changed));
+  CHECK(changed == std::vector<size_t>{2});
+
+  grid.Resize(12, 5);
+  grid.At(3, 3) = 1;
+  CHECK_FALSE(grid.TakeChangedCells(changed));
+  CHECK(changed.empty());
+  CHECK(grid.TakeChangedCells(changed));
+}
+
+TEST_CASE("WorldGrid Read", "[core][grid]"){
+  cse491::type_options_t types;
+  types.push_back(cse491::CellType{"floor", "", ' '});
+  types.push_back(cse491::CellType{"wall", "", '#'});
+  types.push_back(cse491::CellType{"water", "", '~'});
+  const std::string text = "#~#\n# \n\n~~~~\n";
+
+  SECTION("From a stream"){
+    std::istringstream is(text);
+    cse491::WorldGrid grid;
+    grid.SetCellBytes(1);
+    grid.Read(is, types);
+    CHECK(grid.GetCellBytes() == 1);
+    REQUIRE(grid.GetWidth() == 4);    // Longest row.
+    REQUIRE(grid.GetHeight() == 4);   // Empty rows count; the final newline does not.
+    CHECK(grid.At(0, 0) == 1);
+    CHECK(grid.At(1, 0) == 2);
+    CHECK(grid.At(3, 0) == 0);        // Short rows are padded.
+    CHECK(grid.At(1, 1) == 0);
+    CHECK(grid.At(2, 2) == 0);
+    CHECK(grid.At(3, 3) == 2);
+
+    std::ostringstream os;
+    grid.Write(os, types);
+    CHECK(os.str() == "#~# \n#   \n    \n~~~~\n");
+  }
+  SECTION("Unknown symbols"){
+    std::istringstream is("#?\n");
+    cse491::WorldGrid grid;
+    grid.Read(is, types);
+    CHECK(grid.At(1, 0) == 0);
+  }
+  SECTION("From a file, in parallel"){
+    const std::string filename = "WorldGrid_read_test.grid";
+    {
+      std::ofstream os(filename);
+      for (size_t y = 0; y < 97; ++y) {
+        for (size_t x = 0; x < 61; ++x) os << " #~"[(x * y + x) % 3];
+        os << '\n';
+      }
+    }
+    cse491::WorldGrid serial, parallel;
+    REQUIRE(serial.Read(filename, types));
+    REQUIRE(parallel.Read(filename, types, 4));
+    std::remove(filename.c_str());
+    REQUIRE(serial.GetWidth() == 61);
+    REQUIRE(serial.GetHeight() == 97);
+    REQUIRE(parallel.GetWidth() == 61);
+    REQUIRE(parallel.GetHeight() == 97);
+    for (size_t y = 0; y < 97; ++y) {
+      for (size_t x = 0; x < 61; ++x) {
+        REQUIRE(serial.At(x, y) == (x * y + x) % 3);
+        REQUIRE(parallel.At(x, y) == (x * y + x) % 3);
+      }
+    }
+    CHECK_FALSE(serial.Read("no_such_file.grid", types));
+  }
+}
+
+TEST_CASE("WorldGrid Read 4096x4096 benchmark", "[.][benchmark]"){
+  cse491::type_options_t types;
+  types.push_back(cse491::CellType{"floor", "", ' '});
+  types.push_back(cse491::CellType{"wall", "", '#'});
+  types.push_back(cse491::CellType{"water", "", '~'});
+  const std::string filename = "WorldGrid_benchmark.grid";
+  {
+    std::ofstream os(filename);
+    std::string row(4096, ' ');
+    for (size_t y = 0; y < 4096; ++y) {
+      for (size_t x = 0; x < 4096; ++x) row[x] = " #~"[(x * 7 + y * 13) % 3];
+      os << row << '\n';
+    }
+  }
+
+  cse491::WorldGrid grid;
+  BENCHMARK("Read, size_t cells") {
+    grid.Read(filename, types);
+    return grid.GetNumCells();
+  };
+  grid.SetCellBytes(1);
+  BENCHMARK("Read, uint8_t cells") {
+    grid.Read(filename, types);
+    return grid.GetNumCells();
+  };
+  const size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+  BENCHMARK("Read, uint8_t cells, all threads") {
+    grid.Read(filename, types, num_threads);
+    return grid.GetNumCells();
+  };
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("WorldGrid 10000x10000 scan benchmark", "[.][benchmark]"){
+  cse491::WorldGrid grid(10000, 10000);
+  for (size_t y = 0; y < 10000; ++y) {
+    for (size_t x = 0; x < 10000; x += 7) grid.At(x, y) = 1 + (x + y) % 3;
+  }
+  const cse491::WorldGrid & const_grid = grid;
+  auto count_walls = [&const_grid]() {
+    size_t walls = 0;
+    for (size_t y = 0; y < 10000; ++y) {
+      for (size_t x = 0; x < 10000; ++x) walls += (const_grid.At(x, y) == 1);
+    }
+    return walls;
+  };
+
+  for (size_t bytes : {sizeof(size_t), size_t{1}}) {
+    grid.SetCellBytes(bytes);
+    WARN("10000x10000 grid, " << bytes << " byte(s) per cell: " << grid.GetNumCells() * bytes / (1024 * 1024) << " MiB");
+    BENCHMARK("Scan, " + std::to_string(bytes) + " byte(s) per cell") { return count_walls(); };
+  }
+}
@@ -0,0 +1,365 @@
+/**
+ * This file is part of the Fall 2023, CSE 491 course project.
+ * @brief Unit tests for WorldSnapshot.hpp in source/core
+ **/
+
+// Catch2
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_all.hpp>
+
+// Std
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Class project
+#include "core/WorldBase.hpp"
+#include "core/WorldSnapshot.hpp"
+
+namespace {
+
+  /// World on team8_grid_v2.grid whose agents never act.
+  class Team8World : public cse491::WorldBase {
+  public:
+    Team8World() {
+      AddCellType("floor", "Open ground.", ' ');
+      AddCellType("tree", "A tree.", '^');
+      main_grid.Read("../assets/grids/team8_grid_v2.grid", type_options);
+    }
+    void ConfigAgent(cse491::AgentBase & agent) override {
+      agent.AddAction("up", 1).AddAction("down", 2).AddAction("left", 3).AddAction("right", 4);
+    }
+    int DoAction(cse491::AgentBase &, size_t) override { return 0; }
+  };
+
+  /// Fill a world with agents (a few with extra properties) and items.
+  void Populate(Team8World & world, size_t num_agents) {
+    const auto & grid = world.GetGrid();
+    for (size_t i = 0; i < num_agents; ++i) {
+      auto & agent = world.AddAgent<cse491::AgentBase>("Agent " + std::to_string(i))
+                          .SetPosition(i % grid.GetWidth(), (i / grid.GetWidth()) % grid.GetHeight());
+      agent.SetProperty("symbol", static_cast<char>('a' + i % 26));
+      if (i % 10 == 0) agent.SetProperties("Health", 100 - static_cast<int>(i % 100), "Speed", 1.5);
+    }
+    world.AddItem("Sword", "Damage", 7.5, "Level", 3, "symbol", 'S').SetPosition(4, 5);
+    world.AddItem("Note", "Text", std::string("Hello, world"));
+  }
+
+}
+
+TEST_CASE("Snapshot grid sections round trip", "[core][snapshot]"){
+  cse491::WorldGrid grid(40, 3, 2);
+  grid.At(0, 0) = 0;
+  grid.At(39, 2) = 1000000;   // Needs a multi-byte varint.
+  for (size_t x = 10; x < 20; ++x) grid.At(x, 1) = 5;
+
+  std::stringstream ss;
+  cse491::SnapshotWriter writer(ss);
+  writer.WriteGrid(grid);
+  writer.BeginAgents(0);
+  writer.EndAgents();
+  writer.BeginItems(0);
+  writer.Finish();
+
+  // Runs keep the section far smaller than one byte per cell.
+  CHECK(ss.str().size() < grid.GetNumCells() / 2);
+
+  cse491::SnapshotReader reader(ss);
+  CHECK(reader.GetVersion() == cse491::snapshot::VERSION);
+  cse491::WorldGrid copy;
+  reader.ReadGrid(copy);
+  REQUIRE(copy.GetWidth() == 40);
+  REQUIRE(copy.GetHeight() == 3);
+  for (size_t y = 0; y < 3; ++y) {
+    for (size_t x = 0; x < 40; ++x) CHECK(copy.At(x, y) == grid.At(x, y));
+  }
+  CHECK(reader.BeginAgents() == 0);
+  cse491::SnapshotEntity agent;
+  CHECK_FALSE(reader.ReadAgent(agent));
+  CHECK(reader.BeginItems() == 0);
+  CHECK_NOTHROW(reader.Finish());
+}
+
+TEST_CASE("Snapshot agents and items keep typed properties", "[core][snapshot]"){
+  std::stringstream ss;
+  cse491::SnapshotWriter writer(ss);
+  writer.BeginGrid(1, 1);
+  writer.WriteCell(0);
+  writer.EndGrid();
+
+  cse491::AgentBase agent3(3, "Three"), agent70(70, "Seventy");
+  agent3.SetPosition(-2, 9);
+  agent3.SetProperties("symbol", '@', "Health", -12, "Speed", 0.25, "Title", std::string("Knight"));
+  agent3.SetProperty("Pointer", &agent70);   // Not a serializable type; skipped.
+  agent70.SetPosition(cse491::GridPosition().MakeInvalid());
+  agent70.SetProperty("Health", 5);          // Name already written once; sent by index.
+  writer.BeginAgents(80);
+  writer.WriteAgent(agent3);
+  writer.WriteAgent(agent70);
+  writer.EndAgents();
+
+  cse491::ItemBase item(1, "Shield");
+  item.SetProperties("Armor", 4, "Weight", 12.5);
+  writer.BeginItems(1);
+  writer.WriteItem(item);
+  writer.Finish();
+
+  cse491::SnapshotReader reader(ss);
+  cse491::WorldGrid grid;
+  reader.ReadGrid(grid);
+  CHECK(reader.BeginAgents() == 80);
+
+  cse491::SnapshotEntity entity;
+  REQUIRE(reader.ReadAgent(entity));
+  CHECK(entity.id == 3);
+  CHECK(entity.name == "Three");
+  CHECK(entity.position == cse491::GridPosition(-2, 9));
+  CHECK(entity.properties.size() == 4);
+  REQUIRE(entity.FindProperty<char>("symbol"));
+  CHECK(*entity.FindProperty<char>("symbol") == '@');
+  REQUIRE(entity.FindProperty<int>("Health"));
+  CHECK(*entity.FindProperty<int>("Health") == -12);
+  REQUIRE(entity.FindProperty<double>("Speed"));
+  CHECK(*entity.FindProperty<double>("Speed") == 0.25);
+  REQUIRE(entity.FindProperty<std::string>("Title"));
+  CHECK(*entity.FindProperty<std::string>("Title") == "Knight");
+  CHECK(entity.FindProperty<double>("Health") == nullptr);   // Wrong type.
+  CHECK(entity.FindProperty<int>("Pointer") == nullptr);
+
+  REQUIRE(reader.ReadAgent(entity));
+  CHECK(entity.id == 70);
+  CHECK_FALSE(entity.position.IsValid());
+  REQUIRE(entity.FindProperty<int>("Health"));
+  CHECK(*entity.FindProperty<int>("Health") == 5);
+  CHECK_FALSE(reader.ReadAgent(entity));
+
+  REQUIRE(reader.BeginItems() == 1);
+  reader.ReadItem(entity);
+  CHECK(entity.name == "Shield");
+  cse491::ItemBase copy(2, "");
+  entity.ApplyProperties(copy);
+  CHECK(copy.GetProperty<int>("Armor") == 4);
+  CHECK(copy.GetProperty<double>("Weight") == 12.5);
+  CHECK_NOTHROW(reader.Finish());
+}
+
+TEST_CASE("Snapshot reader rejects bad input", "[core][snapshot]"){
+  SECTION("Wrong magic") {
+    std::istringstream is("W491");
+    std::istringstream bad("XXXX\x01");
+    CHECK_THROWS_AS(cse491::SnapshotReader(bad), std::runtime_error);
+    CHECK_THROWS_AS(cse491::SnapshotReader(is), std::runtime_error);   // Missing version.
+  }
+  SECTION("Future version") {
+    std::istringstream is(std::string("W491") + static_cast<char>(cse491::snapshot::VERSION + 1));
+    CHECK_THROWS_AS(cse491::SnapshotReader(is), std::runtime_error);
+  }
+  SECTION("Truncated") {
+    std::stringstream ss;
+    cse491::SnapshotWriter writer(ss);
+    writer.WriteGrid(cse491::WorldGrid(5, 5, 1));
+    std::string data = ss.str();
+    std::istringstream is(data.substr(0, data.size() - 1));
+    cse491::SnapshotReader reader(is);
+    cse491::WorldGrid grid;
+    CHECK_THROWS_AS(reader.ReadGrid(grid), std::runtime_error);
+  }
+  SECTION("Sizes too large to allocate") {
+    const auto varint = [](uint64_t value) {
+      std::string bytes;
+      for (; value >= 0x80; value >>= 7) bytes += static_cast<char>((value & 0x7F) | 0x80);
+      return bytes + static_cast<char>(value);
+    };
+    const std::string header = std::string("W491") + static_cast<char>(cse491::snapshot::VERSION);
+    const std::string huge = varint(uint64_t(1) << 62);
+
+    std::istringstream big_grid(header + 'G' + varint(uint64_t(1) << 33) + varint(uint64_t(1) << 33));
+    cse491::WorldGrid grid;
+    CHECK_THROWS_AS(cse491::SnapshotReader(big_grid).ReadGrid(grid), std::runtime_error);
+
+    const std::string agent = header + 'A' + varint(1) + varint(1);
+    cse491::SnapshotEntity entity;
+    std::istringstream long_name(agent + huge);
+    cse491::SnapshotReader name_reader(long_name);
+    name_reader.BeginAgents();
+    CHECK_THROWS_AS(name_reader.ReadAgent(entity), std::runtime_error);
+
+    std::istringstream many_properties(agent + varint(1) + 'a' + varint(0) + huge);
+    cse491::SnapshotReader property_reader(many_properties);
+    property_reader.BeginAgents();
+    CHECK_THROWS_AS(property_reader.ReadAgent(entity), std::runtime_error);
+  }
+  SECTION("Too many items") {
+    std::stringstream ss;
+    cse491::SnapshotWriter writer(ss);
+    writer.WriteGrid(cse491::WorldGrid(5, 5, 1));
+    writer.BeginAgents(0);
+    writer.EndAgents();
+    writer.BeginItems(cse491::snapshot::MAX_ITEMS + 1);
+    cse491::SnapshotReader reader(ss);
+    cse491::WorldGrid grid;
+    reader.ReadGrid(grid);
+    reader.BeginAgents();
+    cse491::SnapshotEntity entity;
+    CHECK_FALSE(reader.ReadAgent(entity));
+    CHECK_THROWS_AS(reader.BeginItems(), std::runtime_error);
+  }
+  SECTION("Agent IDs too large to index") {
+    // An agent above the last ID the world gave out, or a huge last ID, is refused before any agent is added.
+    for (size_t last_id : {size_t(2), size_t(1) << 60}) {
+      std::stringstream ss;
+      cse491::SnapshotWriter writer(ss);
+      writer.WriteGrid(cse491::WorldGrid(5, 5, 1));
+      writer.BeginAgents(last_id);
+      cse491::SnapshotEntity huge;
+      huge.id = size_t(1) << 34;
+      huge.name = "Huge";
+      writer.WriteAgent(huge);
+      writer.EndAgents();
+      writer.BeginItems(0);
+      writer.Finish();
+
+      netWorth::ClientManager manager;
+      Team8World client;
+      CHECK_THROWS_AS(client.DeserializeBinary(ss, &manager), std::runtime_error);
+      CHECK(client.GetNumAgents() == 0);
+    }
+  }
+}
+
+TEST_CASE("Binary world snapshots restore the world on a client", "[core][snapshot]"){
+  Team8World server;
+  Populate(server, 500);
+  server.RemoveAgent(7);    // Leave a gap in the IDs.
+
+  std::stringstream ss;
+  server.SerializeBinary(ss);
+
+  netWorth::ClientManager manager;
+  Team8World client;
+  client.GetGrid().Resize(1, 1);
+  client.DeserializeBinary(ss, &manager);
+
+  const auto & grid = server.GetGrid();
+  REQUIRE(client.GetGrid().GetWidth() == grid.GetWidth());
+  REQUIRE(client.GetGrid().GetHeight() == grid.GetHeight());
+  for (size_t y = 0; y < grid.GetHeight(); ++y) {
+    for (size_t x = 0; x < grid.GetWidth(); ++x) REQUIRE(client.GetGrid().At(x, y) == grid.At(x, y));
+  }
+
+  REQUIRE(client.GetNumAgents() == server.GetNumAgents());
+  CHECK_FALSE(client.HasAgent(7));
+  for (size_t id : {1, 2, 8, 11, 500}) {
+    const auto & expected = server.GetAgent(id);
+    const auto & agent = client.GetAgent(id);
+    CHECK(agent.GetName() == expected.GetName());
+    CHECK(agent.GetPosition() == expected.GetPosition());
+    CHECK(agent.GetProperty<char>("symbol") == expected.GetProperty<char>("symbol"));
+  }
+  CHECK(client.GetAgent(11).GetProperty<int>("Health") == server.GetAgent(11).GetProperty<int>("Health"));
+  CHECK(client.GetAgent(11).GetProperty<double>("Speed") == 1.5);
+
+  // The client's next entity is given the same ID the server would give it.
+  CHECK(client.AddAgent<cse491::AgentBase>("Interface").GetID() == 503);
+
+  const auto & sword = client.GetItem(client.FindItemsAt({4, 5}).at(0));
+  CHECK(sword.GetName() == "Sword");
+  CHECK(sword.GetProperty<double>("Damage") == 7.5);
+  CHECK(sword.GetProperty<int>("Level") == 3);
+  CHECK(sword.GetProperty<char>("symbol") == 'S');
+}
+
+TEST_CASE("Text and binary world snapshots convert both ways", "[core][snapshot]"){
+  Team8World server;
+  Populate(server, 50);
+
+  std::stringstream text;
+  server.Serialize(text);
+
+  std::stringstream binary;
+  cse491::ConvertTextSnapshotToBinary(text, binary);
+  CHECK(binary.str().size() < text.str().size() / 10);
+
+  std::stringstream text_again;
+  cse491::ConvertBinarySnapshotToText(binary, text_again);
+  CHECK(text_again.str() == text.str());
+
+  // A converted snapshot loads the same as the text it came from.
+  binary.seekg(0);
+  netWorth::ClientManager manager;
+  Team8World from_binary;
+  from_binary.DeserializeBinary(binary, &manager);
+  CHECK(from_binary.GetNumAgents() == 50);
+  CHECK(from_binary.GetAgent(26).GetProperty<char>("symbol") == 'z');
+  CHECK(from_binary.GetAgent(26).GetPosition() == server.GetAgent(26).GetPosition());
+  CHECK(from_binary.GetNumItems() == 2);
+}
+
+TEST_CASE("Snapshot writing and conversion reject bad input", "[core][snapshot]"){
+  SECTION("Agents out of ID order") {
+    std::stringstream ss;
+    cse491::SnapshotWriter writer(ss);
+    writer.WriteGrid(cse491::WorldGrid(5, 5, 1));
+    writer.BeginAgents(10);
+    cse491::SnapshotEntity agent;
+    agent.id = 5;
+    writer.WriteAgent(agent);
+    CHECK_THROWS_AS(writer.WriteAgent(agent), std::runtime_error);
+    agent.id = 3;
+    CHECK_THROWS_AS(writer.WriteAgent(agent), std::runtime_error);
+  }
+  SECTION("Malformed text") {
+    const std::string grid = ":::START cse491::WorldGrid\n2 2 1 1 1 1\n:::END cse491::WorldGrid\n";
+    const std::string agents = ":::START agent_set\n2\n";
+    const std::string items = ":::START item_set\n0\n:::END item_set\n";
+    for (const std::string & text : {
+           std::string(":::START cse491::WorldGrid\nwide 2\n"),                            // Bad size
+           std::string(":::START cse491::WorldGrid\n2 2 1 1 x 1\n"),                       // Bad cell
+           std::string(":::START cse491::WorldGrid\n2 2 1 1\n"),                           // Too few cells
+           grid + agents + "A\nfive\n0\n0\n*\n:::END agent_set\n" + items,             // Bad ID
+           grid + agents + "A\n2\n0\n0\n*\nB\n1\n0\n0\n*\n:::END agent_set\n" + items,  // IDs out of order
+           grid + agents + "A\n1\n0\n0\n\n:::END agent_set\n" + items,                 // No symbol
+           grid + ":::START agent_set\n0\n:::END agent_set\n:::START item_set\n99999999999\n"}) {
+      std::istringstream is(text);
+      std::stringstream binary;
+      CHECK_THROWS_AS(cse491::ConvertTextSnapshotToBinary(is, binary), std::runtime_error);
+    }
+  }
+}
+
+TEST_CASE("World snapshot benchmark", "[.][benchmark]"){
+  Team8World server;
+  Populate(server, 5000);
+
+  std::stringstream text, binary;
+  server.Serialize(text);
+  server.SerializeBinary(binary);
+  WARN("team8_grid_v2 with 5000 agents: text " << text.str().size() << " bytes, binary "
+       << binary.str().size() << " bytes");
+
+  BENCHMARK("Serialize (text)") {
+    std::ostringstream os;
+    server.Serialize(os);
+    return os.str().size();
+  };
+  BENCHMARK("SerializeBinary") {
+    std::ostringstream os;
+    server.SerializeBinary(os);
+    return os.str().size();
+  };
+
+  netWorth::ClientManager manager;
+  const std::string text_data = text.str(), binary_data = binary.str();
+  BENCHMARK("Deserialize (text)") {
+    Team8World client;
+    std::istringstream is(text_data);
+    client.Deserialize(is, &manager);
+    return client.GetNumAgents();
+  };
+  BENCHMARK("DeserializeBinary") {
+    Team8World client;
+    std::istringstream is(binary_data);
+    client.DeserializeBinary(is, &manager);
+    return client.GetNumAgents();
+  };
+}